@@ -0,0 +1,86 @@
+/*
+  Using the SparkFun Cryptographic Co-processor Breakout ATECC508a (Qwiic)
+  License: This code is public domain but you can buy me a beer if you use this and we meet someday (Beerware license).
+
+  Feel like supporting our work? Please buy a board from SparkFun!
+  https://www.sparkfun.com/products/15573
+
+  //////////////////////////////
+  /////////////// ABOUT
+  //////////////////////////////
+
+  This example requests random numbers with the non-blocking API. The Random command is submitted
+  with submitCommand(), and loop() keeps blinking the LED (and counting its passes) while the IC
+  executes it. pollCommand() calls the callback once the response is there, and getCommandResult()
+  returns the 32 random bytes.
+
+  The blocking methods of the library (e.g. getRandomLong()) do the same, but wait in delay().
+*/
+
+#include <SparkFun_ATECCX08a_Arduino_Library.h> //Click here to get the library: http://librarymanager/All#SparkFun_ATECCX08a
+#include <Wire.h>
+
+ATECCX08A atecc;
+
+unsigned long passes = 0;  // passes of loop() while the command was executing
+
+void setup() {
+  Wire.begin();
+  Serial.begin(115200);
+  pinMode(LED_BUILTIN, OUTPUT);
+  if (atecc.begin() == true)
+  {
+    Serial.println("Successful wakeUp(). I2C connections are good.");
+  }
+  else
+  {
+    Serial.println("Device not found. Check wiring.");
+    while (1); // stall out forever
+  }
+  submitRandom();
+}
+
+void loop()
+{
+  passes++;
+  digitalWrite(LED_BUILTIN, (millis() / 250) % 2); // other work, it doesn't wait for the IC
+
+  atecc.pollCommand();
+}
+
+void submitRandom()
+{
+  passes = 0;
+  // Random: param1 0x00 (update seed), param2 0x0000, response count (1) + 32 bytes + crc (2)
+  if (atecc.submitCommand(COMMAND_OPCODE_RANDOM, 0x00, 0x0000, NULL, 0, 35, ATECC_CMD_RANDOM, randomDone, NULL) == false)
+  {
+    Serial.print("submitCommand failed, status 0x");
+    Serial.println(atecc.getStatus(), HEX);
+  }
+}
+
+// called by pollCommand() when the Random command has finished
+void randomDone(ATECCX08A *device, boolean success, void *context)
+{
+  uint8_t randomBytes[32];
+
+  if (success == true && device->getCommandResult(randomBytes, sizeof(randomBytes)) == sizeof(randomBytes))
+  {
+    Serial.print("Random bytes: ");
+    for (int i = 0; i < sizeof(randomBytes); i++)
+    {
+      if (randomBytes[i] < 0x10) Serial.print("0");
+      Serial.print(randomBytes[i], HEX);
+    }
+    Serial.println();
+  }
+  else
+  {
+    Serial.print("Random command failed, status 0x");
+    Serial.println(device->getStatus(), HEX);
+  }
+  Serial.print("Passes of loop() in the meantime: ");
+  Serial.println(passes);
+  delay(2000);
+  submitRandom();
+}
@@ -0,0 +1,130 @@
+/*
+  Using the SparkFun Cryptographic Co-processor Breakout ATECC508a (Qwiic)
+  License: This code is public domain but you can buy me a beer if you use this and we meet someday (Beerware license).
+
+  Feel like supporting our work? Please buy a board from SparkFun!
+  https://www.sparkfun.com/products/15573
+
+  //////////////////////////////
+  /////////////// ABOUT
+  //////////////////////////////
+
+  This example shows a symmetric "challenge and response" with the MAC and CheckMac commands
+  and compares its round trip time with the ECDSA version of Example6_Challenge_Alice/Bob.
+
+  Both roles run on one board, so no second board is needed:
+  Bob (verifier) creates a random challenge,
+  Alice (prover) answers with MAC(key, challenge),
+  Bob checks the answer with CheckMac.
+  On two boards each device would hold the same key in its slot.
+
+  The ECDSA version needs Random + Sign + Verify. The MAC version needs Random + MAC + CheckMac,
+  which is a fraction of the time.
+
+  //////////////////////////////
+  /////////////// CONFIGURATION
+  //////////////////////////////
+
+  The device must be configured and locked. MAC_SLOT must hold a 32 byte secret key
+  (written before the data zone was locked) that may be used by the MAC and CheckMac commands.
+  ECC_SLOT must hold a private ECC key (slot 0 with the SparkFun Standard Configuration).
+*/
+
+#include <SparkFun_ATECCX08a_Arduino_Library.h> //Click here to get the library: http://librarymanager/All#SparkFun_ATECCX08a
+#include <ATECCChallenge.h>
+#include <Wire.h>
+
+#define MAC_SLOT 5
+#define ECC_SLOT 0
+#define ROUNDS   10
+
+ATECCX08A atecc;
+
+ATECCChallengeProver   alice(&atecc, MAC_SLOT);
+ATECCChallengeVerifier bob(&atecc, MAC_SLOT);
+
+void setup() {
+  Wire.begin();
+  Serial.begin(115200);
+  if (atecc.begin() == true)
+  {
+    Serial.println("Successful wakeUp(). I2C connections are good.");
+  }
+  else
+  {
+    Serial.println("Device not found. Check wiring.");
+    while (1); // stall out forever
+  }
+
+  unsigned long macTime = measureMAC();
+  unsigned long ecdsaTime = measureECDSA();
+
+  Serial.println();
+  Serial.print("MAC round trip (average us): \t");
+  Serial.println(macTime);
+  Serial.print("ECDSA round trip (average us): \t");
+  Serial.println(ecdsaTime);
+}
+
+void loop()
+{
+  // do nothing.
+}
+
+// Random + MAC + CheckMac
+unsigned long measureMAC()
+{
+  uint8_t challenge[MAC_CHALLENGE_SIZE];
+  uint8_t response[MAC_RESPONSE_SIZE];
+  unsigned long total = 0;
+
+  for (int round = 0; round < ROUNDS; round++)
+  {
+    unsigned long start = micros();
+
+    bob.createChallenge(challenge, sizeof(challenge));           // Bob -> Alice
+    alice.respond(challenge, sizeof(challenge), response, sizeof(response)); // Alice -> Bob
+    boolean result = bob.verifyResponse(response, sizeof(response));
+
+    total += micros() - start;
+    if (result == false)
+    {
+      Serial.print("MAC verification failed, status: ");
+      Serial.println(bob.getStatus());
+      return 0;
+    }
+  }
+  return total / ROUNDS;
+}
+
+// Random + Sign + Verify, as in Example6_Challenge_Alice/Bob
+unsigned long measureECDSA()
+{
+  uint8_t token[32];
+  uint8_t signature[SIGNATURE_SIZE];
+  uint8_t publicKey[PUBLIC_KEY_SIZE];
+  unsigned long total = 0;
+
+  if (atecc.generatePublicKey(publicKey, sizeof(publicKey), ECC_SLOT) == false)
+  {
+    Serial.println("Failure to generate the public key");
+    return 0;
+  }
+
+  for (int round = 0; round < ROUNDS; round++)
+  {
+    unsigned long start = micros();
+
+    atecc.generateRandomBytes(token, sizeof(token));
+    atecc.createSignature(signature, sizeof(signature), token, ECC_SLOT);
+    boolean result = atecc.verifySignature(token, signature, publicKey);
+
+    total += micros() - start;
+    if (result == false)
+    {
+      Serial.println("ECDSA verification failed");
+      return 0;
+    }
+  }
+  return total / ROUNDS;
+}
@@ -0,0 +1,70 @@
+/*
+  Using the SparkFun Cryptographic Co-processor Breakout ATECC508a (Qwiic)
+  License: This code is public domain but you can buy me a beer if you use this and we meet someday (Beerware license).
+
+  Feel like supporting our work? Please buy a board from SparkFun!
+  https://www.sparkfun.com/products/15573
+
+  //////////////////////////////
+  /////////////// ABOUT
+  //////////////////////////////
+
+  This example shows the device model and ChipMode of the IC and uses the latency model
+  of the library to compare the clock dividers of the ATECC608A for a sign and a verify.
+
+  A slower clock needs less power, but the ECC commands take much longer. Pick the fastest
+  clock divider your power budget allows and write it with setChipMode() before the
+  configuration zone is locked (uncomment the line below).
+*/
+
+#include <SparkFun_ATECCX08a_Arduino_Library.h> //Click here to get the library: http://librarymanager/All#SparkFun_ATECCX08a
+#include <Wire.h>
+
+ATECCX08A atecc;
+
+// Nonce + Sign, then Verify, as in signTempKey() and verifySignature()
+const uint8_t commands[] = { ATECC_CMD_NONCE, ATECC_CMD_SIGN, ATECC_CMD_NONCE, ATECC_CMD_VERIFY };
+
+void setup() {
+  Wire.begin();
+  Serial.begin(115200);
+  if (atecc.begin() == true)
+  {
+    Serial.println("Successful wakeUp(). I2C connections are good.");
+  }
+  else
+  {
+    Serial.println("Device not found. Check wiring.");
+    while (1); // stall out forever
+  }
+
+  Serial.print("Model: \t\t\t");
+  Serial.println(atecc.getDeviceProfile()->name);
+  Serial.print("Clock divider: \t\t0x");
+  Serial.println(atecc.getClockDivider(), HEX);
+  Serial.print("Watchdog timeout (ms): \t");
+  Serial.println(atecc.getWatchdogTimeout());
+  Serial.println();
+
+  printLatency("M0 (full speed)", CHIP_MODE_CLOCK_DIVIDER_M0);
+  if (atecc.getModel() != ATECC_MODEL_508A)
+  {
+    printLatency("M1", CHIP_MODE_CLOCK_DIVIDER_M1);
+    printLatency("M2 (lowest power)", CHIP_MODE_CLOCK_DIVIDER_M2);
+  }
+
+  // atecc.setChipMode(CHIP_MODE_CLOCK_DIVIDER_M1, false); // only before the configuration zone is locked!
+}
+
+void loop()
+{
+  // do nothing.
+}
+
+void printLatency(const char *name, uint8_t clockDivider)
+{
+  Serial.print("Sign + verify with ");
+  Serial.print(name);
+  Serial.print(" (ms): \t");
+  Serial.println(ATECCX08A::estimateLatency(atecc.getModel(), clockDivider, commands, sizeof(commands)) / 1000);
+}
@@ -0,0 +1,392 @@
+/*
+  atecc_benchmark: runs the public operations of ATECCX08A and ATECCAES against the emulator and
+  prints what each one costs as JSON, so the numbers can be compared between releases.
+
+    atecc_benchmark [-m 508a|608a] [-n iterations] [-b bus speed in Hz] > results.json
+
+  For every operation (and size):
+  - wall_us       host time per call (mean and minimum over the iterations), mostly library and emulator code
+  - chip_us       modelled time on the target: bus transfers, wake pulses and execution times (ATECCEmulator)
+  - busy_us       the part of chip_us the IC executes commands
+  - i2c_bytes, wakes, commands, nacks   per call
+  - heap_peak     bytes allocated at most during a call, null unless linked with the malloc wrappers (see below)
+  - stack_peak    bytes of stack used at most during a call (stack painting), null if a call went below
+                  the painted STACK_PAINT_SIZE bytes
+
+  The modelled numbers are deterministic, wall_us depends on the host. The emulator runs inside the calls
+  of the transport, so wall_us, heap_peak and stack_peak include it (e.g. its ECDSA for sign and verify).
+  The device is set up once: configuration locked, key pair in slot 0, AES key in slot 9, data locked.
+  macRoundTrip and ecdsaRoundTrip are the two ways to authenticate a device (ATECCChallenge.h): the verifier and the
+  prover run on the same emulated IC, so chip_us is the round trip of both sides without the link between them.
+
+  Build on the host (from the repository root) with the library, the emulator and the host core:
+    g++ -O2 -DARDUINO=10810 -Iextras/host -Isrc -Iextras/emulator extras/benchmark/atecc_benchmark.cpp
+        src/(all .cpp) extras/host/Arduino.cpp extras/emulator/(all .cpp)
+        -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free -o atecc_benchmark
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <malloc.h>
+#include "SparkFun_ATECCX08a_Arduino_Library.h"
+#include "ATECCAES.h"
+#include "ATECCChallenge.h"
+#include "ATECCEmulator.h"
+
+#define BENCHMARK_ITERATIONS    10
+#define BENCHMARK_MAX_SIZE      4096
+#define STACK_PAINT_SIZE        (64 * 1024)
+#define STACK_PAINT_PATTERN     0xA5
+#define SLOT_KEY_PAIR           0
+#define SLOT_DATA               8
+#define SLOT_AES_KEY            9
+#define SLOT_SHARED_KEY         SLOT_AES_KEY   // the MAC challenge-response uses the AES key
+
+
+/*
+  heap high-water mark, with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free.
+  The __real_ functions are weak, so it links without the wrappers too (heap_peak is null then).
+*/
+
+extern "C" void *__real_malloc(size_t size) __attribute__((weak));
+extern "C" void *__real_calloc(size_t count, size_t size) __attribute__((weak));
+extern "C" void *__real_realloc(void *memory, size_t size) __attribute__((weak));
+extern "C" void  __real_free(void *memory) __attribute__((weak));
+
+static boolean heapTracking = false;
+static size_t  heapCurrent = 0;
+static size_t  heapPeak = 0;
+
+static void heapAllocated(void *memory)
+{
+	heapTracking = true;
+	if (memory == NULL)
+		return;
+	heapCurrent += malloc_usable_size(memory);
+	if (heapCurrent > heapPeak)
+		heapPeak = heapCurrent;
+}
+
+static void heapFreed(void *memory)
+{
+	if (memory != NULL)
+		heapCurrent -= malloc_usable_size(memory);
+}
+
+extern "C" void *__wrap_malloc(size_t size)
+{
+	void *memory = __real_malloc(size);
+
+	heapAllocated(memory);
+	return memory;
+}
+
+extern "C" void *__wrap_calloc(size_t count, size_t size)
+{
+	void *memory = __real_calloc(count, size);
+
+	heapAllocated(memory);
+	return memory;
+}
+
+extern "C" void *__wrap_realloc(void *memory, size_t size)
+{
+	heapFreed(memory);
+	memory = __real_realloc(memory, size);
+	heapAllocated(memory);
+	return memory;
+}
+
+extern "C" void __wrap_free(void *memory)
+{
+	heapFreed(memory);
+	__real_free(memory);
+}
+
+
+/* stack high-water mark: the stack below the caller is painted before the call and checked after it */
+
+static uintptr_t stackPainted;   // lowest painted address, the area is below the caller
+
+__attribute__((noinline)) static void paintStack()
+{
+	uint8_t area[STACK_PAINT_SIZE];
+
+	memset(area, STACK_PAINT_PATTERN, sizeof(area));
+	asm volatile("" : : "r"(area) : "memory");
+	stackPainted = (uintptr_t) area;
+}
+
+// bytes used below top since paintStack(), SIZE_MAX if the lowest painted byte was overwritten
+__attribute__((noinline)) static size_t stackUsed(const uint8_t *top)
+{
+	const uint8_t *lowest = (const uint8_t *) stackPainted;
+
+	if (*lowest != STACK_PAINT_PATTERN)
+		return SIZE_MAX;
+	while (lowest < (const uint8_t *) stackPainted + STACK_PAINT_SIZE && *lowest == STACK_PAINT_PATTERN)
+		lowest++;
+	return (lowest < top) ? top - lowest : 0;
+}
+
+
+/* operations */
+
+static ATECCEmulator *chip;
+static ATECCX08A     *atecc;
+static uint8_t        input[BENCHMARK_MAX_SIZE];
+static uint8_t        output[BENCHMARK_MAX_SIZE + AES_BLOCKSIZE];
+static uint8_t        publicKey[PUBLIC_KEY_SIZE];
+static uint8_t        digest[SHA256_SIZE];
+static uint8_t        signature[SIGNATURE_SIZE];
+static uint8_t        iv[AES_BLOCKSIZE];
+
+typedef boolean (*Operation)(int size);
+
+static boolean opBegin(int)
+{
+	ATECCX08A device;
+
+	return device.begin(*chip);
+}
+
+static boolean opReadConfigZone(int)
+{
+	return atecc->readConfigZone();
+}
+
+static boolean opRandom(int size)
+{
+	return atecc->generateRandomBytes(output, size);
+}
+
+static boolean opSha256(int size)
+{
+	return atecc->sha256(input, size, output);
+}
+
+static boolean opSign(int)
+{
+	return atecc->createSignature(signature, sizeof(signature), digest, SLOT_KEY_PAIR);
+}
+
+static boolean opVerify(int)
+{
+	return atecc->verifySignature(digest, signature, publicKey);
+}
+
+static boolean opWriteSlot(int size)
+{
+	return atecc->writeSlot(input, size, SLOT_DATA);
+}
+
+static boolean opReadSlot(int size)
+{
+	return atecc->readSlot(output, size, SLOT_DATA);
+}
+
+// challenge-response round trip with MAC: verifier Random (createChallenge), prover MAC, verifier CheckMac
+static boolean opMacRoundTrip(int)
+{
+	ATECCChallengeProver   prover(atecc, SLOT_SHARED_KEY);
+	ATECCChallengeVerifier verifier(atecc, SLOT_SHARED_KEY);
+	uint8_t challenge[MAC_CHALLENGE_SIZE], response[MAC_RESPONSE_SIZE];
+
+	return verifier.createChallenge(challenge, sizeof(challenge)) && prover.respond(challenge, sizeof(challenge), response, sizeof(response)) &&
+	       verifier.verifyResponse(response, sizeof(response));
+}
+
+// the same round trip with ECDSA: verifier Random, prover Sign, verifier Verify
+static boolean opEcdsaRoundTrip(int)
+{
+	uint8_t challenge[SHA256_SIZE], response[SIGNATURE_SIZE];
+
+	return atecc->generateRandomBytes(challenge, sizeof(challenge)) && atecc->createSignature(response, sizeof(response), challenge, SLOT_KEY_PAIR) &&
+	       atecc->verifySignature(challenge, response, publicKey);
+}
+
+static boolean opEncryptECB(int size)
+{
+	ATECCAES_ECB aes(atecc, NoPadding);
+	int length = sizeof(output);
+
+	return aes.encrypt(input, size, output, length, SLOT_AES_KEY, 0);
+}
+
+static boolean opDecryptECB(int size)
+{
+	ATECCAES_ECB aes(atecc, NoPadding);
+	int length = sizeof(output);
+
+	return aes.decrypt(input, size, output, length, SLOT_AES_KEY, 0);
+}
+
+static boolean opEncryptCBC(int size)
+{
+	ATECCAES_CBC aes(atecc, NoPadding, iv);
+	int length = sizeof(output);
+
+	return aes.encrypt(input, size, output, length, SLOT_AES_KEY, 0);
+}
+
+static boolean opDecryptCBC(int size)
+{
+	ATECCAES_CBC aes(atecc, NoPadding, iv);
+	int length = sizeof(output);
+
+	return aes.decrypt(input, size, output, length, SLOT_AES_KEY, 0);
+}
+
+typedef struct
+{
+	const char *name;
+	Operation   operation;
+	int         sizes[5];       // 0 terminated (unless all 5 are used), a single 0 for operations without a size
+	boolean     aes;            // ATECC608A only
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+	{ "begin",          opBegin,          { 0 },                      false },
+	{ "readConfigZone", opReadConfigZone, { 0 },                      false },
+	{ "random",         opRandom,         { 32, 0 },                  false },
+	{ "sha256",         opSha256,         { 32, 64, 256, 1024, 4096 },false },
+	{ "sign",           opSign,           { 0 },                      false },
+	{ "verify",         opVerify,         { 0 },                      false },
+	{ "macRoundTrip",   opMacRoundTrip,   { 0 },                      false },
+	{ "ecdsaRoundTrip", opEcdsaRoundTrip, { 0 },                      false },
+	{ "writeSlot",      opWriteSlot,      { 32, 416, 0 },             false },
+	{ "readSlot",       opReadSlot,       { 32, 416, 0 },             false },
+	{ "encryptECB",     opEncryptECB,     { 16, 256, 1024, 4096, 0 }, true  },
+	{ "decryptECB",     opDecryptECB,     { 16, 256, 1024, 4096, 0 }, true  },
+	{ "encryptCBC",     opEncryptCBC,     { 16, 256, 1024, 4096, 0 }, true  },
+	{ "decryptCBC",     opDecryptCBC,     { 16, 256, 1024, 4096, 0 }, true  },
+};
+
+
+static double wallMicros()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+// runs operation iterations times and prints its JSON object
+static boolean run(const Benchmark &benchmark, int size, int iterations, boolean first)
+{
+	uint8_t  top;
+	boolean  ok = true;
+	double   wallTotal = 0, wallMin = 0;
+	size_t   heapPeakCall = 0, stackPeak = 0;
+	unsigned long chipTime, busyTime, busBytes, wakes, commands, nacks;
+
+	chipTime = chip->micros();
+	chip->resetStatistics();
+	for (int i = 0; i < iterations; i++)
+	{
+		double start;
+		size_t heapStart = heapCurrent;
+
+		heapPeak = heapCurrent;
+		paintStack();
+		start = wallMicros();
+		ok &= benchmark.operation(size);
+		start = wallMicros() - start;
+		wallTotal += start;
+		if (i == 0 || start < wallMin)
+			wallMin = start;
+		if (stackUsed(&top) > stackPeak)
+			stackPeak = stackUsed(&top);
+		if (heapPeak - heapStart > heapPeakCall)
+			heapPeakCall = heapPeak - heapStart;
+	}
+	chipTime = chip->micros() - chipTime;
+	busyTime = chip->getBusyTime();
+	busBytes = chip->getBusBytes();
+	wakes = chip->getWakeCount();
+	commands = chip->getCommandCount();
+	nacks = chip->getNackCount();
+
+	printf("%s    { \"name\": \"%s\", \"size\": %d, \"ok\": %s, \"iterations\": %d, ", first ? "" : ",\n",
+	       benchmark.name, size, ok ? "true" : "false", iterations);
+	printf("\"wall_us\": { \"mean\": %.3f, \"min\": %.3f }, ", wallTotal / iterations, wallMin);
+	printf("\"chip_us\": %lu, \"busy_us\": %lu, \"i2c_bytes\": %lu, \"wakes\": %lu, \"commands\": %lu, \"nacks\": %lu, ",
+	       chipTime / iterations, busyTime / iterations, busBytes / iterations, wakes / iterations, commands / iterations, nacks / iterations);
+	if (heapTracking)
+		printf("\"heap_peak\": %zu, ", heapPeakCall);
+	else
+		printf("\"heap_peak\": null, ");
+	if (stackPeak != SIZE_MAX)
+		printf("\"stack_peak\": %zu }", stackPeak);
+	else
+		printf("\"stack_peak\": null }");
+	return ok;
+}
+
+// configuration locked, key pair in SLOT_KEY_PAIR, AES key in SLOT_AES_KEY, data and OTP locked
+static boolean setUp()
+{
+	uint8_t key[32];
+
+	for (int i = 0; i < (int) sizeof(key); i++)
+		key[i] = i;
+	for (int i = 0; i < (int) sizeof(input); i++)
+		input[i] = i * 7;
+	if (!atecc->begin(*chip) || !atecc->lockConfiguration() || !atecc->createNewKeyPair(publicKey, sizeof(publicKey), SLOT_KEY_PAIR))
+		return false;
+	if (!atecc->writeSlot(key, sizeof(key), SLOT_AES_KEY) || !atecc->lockDataAndOTP() || !atecc->readConfigZone())
+		return false;
+	if (!atecc->sha256(input, 64, digest))
+		return false;
+	return atecc->createSignature(signature, sizeof(signature), digest, SLOT_KEY_PAIR);
+}
+
+int main(int argc, char **argv)
+{
+	uint8_t  model = ATECC_MODEL_608A;
+	int      iterations = BENCHMARK_ITERATIONS;
+	unsigned long busSpeed = ATECC_EMULATOR_BUS_SPEED;
+	boolean  ok = true, first = true;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "-m") == 0)
+			model = (strcmp(argv[i + 1], "508a") == 0) ? ATECC_MODEL_508A : ATECC_MODEL_608A;
+		else if (strcmp(argv[i], "-n") == 0)
+			iterations = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "-b") == 0)
+			busSpeed = strtoul(argv[i + 1], NULL, 0);
+	}
+	if (argc % 2 == 0 || iterations < 1)
+	{
+		fprintf(stderr, "usage: atecc_benchmark [-m 508a|608a] [-n iterations] [-b bus speed in Hz]\n");
+		return 2;
+	}
+
+	void *volatile probe = malloc(1);   // sets heapTracking if the wrappers are linked
+	free(probe);
+	chip = new ATECCEmulator(model);
+	atecc = new ATECCX08A();
+	chip->setBusSpeed(busSpeed);
+	if (!setUp())
+	{
+		fprintf(stderr, "atecc_benchmark: set up of the emulated device failed\n");
+		return 1;
+	}
+
+	printf("{\n  \"model\": \"%s\",\n  \"bus_speed_hz\": %lu,\n  \"iterations\": %d,\n  \"results\": [\n",
+	       model == ATECC_MODEL_508A ? "ATECC508A" : "ATECC608A", busSpeed, iterations);
+	for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++)
+	{
+		if (benchmarks[b].aes && model == ATECC_MODEL_508A)
+			continue;
+		for (int s = 0; s < 5 && (s == 0 || benchmarks[b].sizes[s] != 0); s++)
+		{
+			ok &= run(benchmarks[b], benchmarks[b].sizes[s], iterations, first);
+			first = false;
+		}
+	}
+	printf("\n  ]\n}\n");
+	return ok ? 0 : 1;
+}
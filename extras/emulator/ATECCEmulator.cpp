@@ -0,0 +1,1059 @@
+#include "ATECCEmulator.h"
+
+
+// configuration zone of a fresh ATECC508A (see reference/), ChipMode, revision and AES enable are set per model
+static const uint8_t defaultConfigZone[CONFIG_ZONE_SIZE] = {
+	0x01, 0x23, 0xF5, 0x2E, 0x00, 0x00, 0x50, 0x00, 0x01, 0xF0, 0xC2, 0x01, 0xEE, 0xC0, 0x55, 0x00,
+	0xC0, 0x00, 0x55, 0x00, 0x83, 0x20, 0x87, 0x20, 0x8F, 0x20, 0xC4, 0x8F, 0x8F, 0x8F, 0x8F, 0x8F,
+	0x9F, 0x8F, 0xAF, 0x8F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0xAF, 0x8F, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+	0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x55, 0x55, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x33, 0x00, 0x33, 0x00, 0x33, 0x00, 0x1C, 0x00, 0x1C, 0x00, 0x1C, 0x00, 0x1C, 0x00, 0x1C, 0x00,
+	0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x1C, 0x00,
+};
+
+static const uint8_t wakeResponse[] = { 0x04, STATUS_WAKE_TOKEN_RECEIVED, 0x33, 0x43 };
+
+#define WORD_ADDRESS_RESET   0x00
+#define WORD_ADDRESS_SLEEP   0x01
+#define WAKE_LOW_TIME_US     60     // tWLO
+#define WAKE_HIGH_TIME_US    1500   // tWHI, the IC NACKs until it has passed
+#define LOCK_UNLOCKED        0x55
+#define KEY_CONFIG_PRIVATE   0x0001
+#define KEY_CONFIG_LOCKABLE  0x0020
+#define WRITE_CONFIG_SHIFT   12
+
+
+static uint32_t readLittleEndian32(const uint8_t *bytes)
+{
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+static void writeLittleEndian32(uint8_t *bytes, uint32_t value)
+{
+	for (int i = 0; i < 4; i++)
+		bytes[i] = value >> (8 * i);
+}
+
+
+ATECCEmulator::ATECCEmulator(uint8_t model, uint8_t address)
+{
+	for (int i = 0; i < ATECC_CMD_COUNT; i++)
+		customTiming[i] = false;
+	resetStatistics();
+	initImage(ownImage, model, address);
+	attach(&ownImage);
+}
+
+/** \brief
+
+	initImage(ATECCEmulatorImage &image, uint8_t model, uint8_t address, const uint8_t *serialNumber, uint32_t seed)
+
+	Initializes image as a fresh IC of model (ATECC_MODEL_*) with the I2C address: the configuration zone
+	of a new chip, unlocked, data and OTP zones erased (0xFF).
+	serialNumber (9 bytes, NULL for the default) and seed of the random numbers make devices distinct.
+*/
+
+void ATECCEmulator::initImage(ATECCEmulatorImage &image, uint8_t model, uint8_t address, const uint8_t *serialNumber, uint32_t seed)
+{
+	uint16_t crc;
+
+	memset(&image, 0, sizeof(image));
+	memcpy(image.magic, "AEMU", sizeof(image.magic));
+	image.version = ATECC_EMULATOR_IMAGE_VERSION;
+	image.model = model;
+
+	memcpy(image.configZone, defaultConfigZone, sizeof(image.configZone));
+	if (serialNumber != NULL)
+	{
+		memcpy(&image.configZone[CONFIG_ZONE_SERIAL_PART0], serialNumber, 4);
+		memcpy(&image.configZone[CONFIG_ZONE_SERIAL_PART1], serialNumber + 4, 5);
+	}
+	image.configZone[CONFIG_ZONE_REVISION_NUMBER + 2] = (model == ATECC_MODEL_508A) ? 0x50 : 0x60;
+	image.configZone[CONFIG_ZONE_REVISION_NUMBER + 3] = (model == ATECC_MODEL_608B) ? 0x03 : (model == ATECC_MODEL_608A) ? 0x02 : 0x00;
+	if (model != ATECC_MODEL_508A)
+	{
+		image.configZone[CONFIG_ZONE_AES_STATUS] = 0x01;   // AES enabled
+		memset(&image.configZone[CONFIG_ZONE_LAST_KEY_USE], 0x00, CONFIG_ZONE_USER_EXTRA - CONFIG_ZONE_LAST_KEY_USE);
+	}
+	image.configZone[CONFIG_ZONE_I2C_ADDRESS] = address << 1;
+	memset(image.dataZone, 0xFF, sizeof(image.dataZone));
+	memset(image.otpZone, 0xFF, sizeof(image.otpZone));
+
+	// xorshift128, the state must not be all zero
+	writeLittleEndian32(&image.rng[0], seed ^ 0x6A09E667);
+	writeLittleEndian32(&image.rng[4], 0xBB67AE85);
+	writeLittleEndian32(&image.rng[8], 0x3C6EF372);
+	writeLittleEndian32(&image.rng[12], 0xA54FF53A);
+
+	crc = ATECCX08A::calculateSummaryCrc((const uint8_t *) &image, sizeof(image) - sizeof(image.crc));
+	image.crc[0] = crc & 0xFF;
+	image.crc[1] = crc >> 8;
+}
+
+// true if image is an emulator image of this version with a valid CRC
+boolean ATECCEmulator::checkImage(const ATECCEmulatorImage &image)
+{
+	uint16_t crc;
+
+	if (memcmp(image.magic, "AEMU", sizeof(image.magic)) != 0 || image.version != ATECC_EMULATOR_IMAGE_VERSION)
+		return false;
+	if (image.model != ATECC_MODEL_508A && image.model != ATECC_MODEL_608A && image.model != ATECC_MODEL_608B)
+		return false;
+	crc = ATECCX08A::calculateSummaryCrc((const uint8_t *) &image, sizeof(image) - sizeof(image.crc));
+	return image.crc[0] == (crc & 0xFF) && image.crc[1] == (crc >> 8);
+}
+
+/** \brief
+
+	attach(ATECCEmulatorImage *image)
+
+	Uses image as the non volatile memory of the emulated IC, e.g. a file mapped into memory.
+	All changes go straight to image, which must stay valid as long as it's attached.
+	The model is the one of the image, the IC is power cycled.
+	Returns false (and keeps the current image) if image isn't valid (see checkImage()).
+*/
+
+boolean ATECCEmulator::attach(ATECCEmulatorImage *image)
+{
+	if (image == NULL || !checkImage(*image))
+		return false;
+
+	this->image = image;
+	configZone = image->configZone;
+	dataZone = image->dataZone;
+	otpZone = image->otpZone;
+	for (int i = 0; i < 4; i++)
+		rng[i] = readLittleEndian32(&image->rng[4 * i]);
+	imageChanged = false;
+
+	model = image->model;
+	revision = configZone[CONFIG_ZONE_REVISION_NUMBER + 3];
+	powerCycle();
+	return true;
+}
+
+ATECCEmulatorImage *ATECCEmulator::getImage()
+{
+	return image;
+}
+
+// stores the RNG state and the CRC after a command that changed the image
+void ATECCEmulator::storeImage()
+{
+	uint16_t crc;
+
+	if (!imageChanged)
+		return;
+	for (int i = 0; i < 4; i++)
+		writeLittleEndian32(&image->rng[4 * i], rng[i]);
+	crc = ATECCX08A::calculateSummaryCrc((const uint8_t *) image, sizeof(*image) - sizeof(image->crc));
+	image->crc[0] = crc & 0xFF;
+	image->crc[1] = crc >> 8;
+	imageChanged = false;
+}
+
+/** \brief
+
+	powerCycle()
+
+	Like removing and applying power: the IC is asleep, TempKey and the SHA context are lost.
+	The I2C address and the clock divider (execution times) of the configuration zone take effect.
+*/
+
+void ATECCEmulator::powerCycle()
+{
+	const ATECCDeviceProfile *profile;
+	uint8_t clockDivider = CHIP_MODE_CLOCK_DIVIDER_M0;
+
+	goToSleep();
+	busyUntil = now;
+	address = configZone[CONFIG_ZONE_I2C_ADDRESS] >> 1;
+	if (model != ATECC_MODEL_508A)
+		clockDivider = configZone[CONFIG_ZONE_CHIP_MODE] & CHIP_MODE_CLOCK_DIVIDER_MASK;
+	profile = ATECCX08A::findDeviceProfile(model, clockDivider);
+	for (int i = 0; i < ATECC_CMD_COUNT; i++)
+	{
+		if (customTiming[i] == false)
+			executionTime[i] = profile->executionTime[i] * 1000UL;
+	}
+}
+
+/** \brief
+
+	setExecutionTime(uint8_t command, unsigned long us)
+
+	Sets the execution time of command (ATECC_CMD_*) in us. The IC NACKs the response until the
+	time has passed. By default it's the worst case time the library waits for (ATECCDeviceProfile).
+*/
+
+void ATECCEmulator::setExecutionTime(uint8_t command, unsigned long us)
+{
+	if (command >= ATECC_CMD_COUNT)
+		return;
+	executionTime[command] = us;
+	customTiming[command] = true;
+}
+
+unsigned long ATECCEmulator::getExecutionTime(uint8_t command)
+{
+	if (command >= ATECC_CMD_COUNT)
+		return 0;
+	return executionTime[command];
+}
+
+// I2C clock, every byte on the bus takes 9 clock cycles of the simulated time
+void ATECCEmulator::setBusSpeed(unsigned long hz)
+{
+	if (hz > 0)
+		busSpeed = hz;
+}
+
+void ATECCEmulator::setSeed(uint32_t seed)
+{
+	// xorshift128, the state must not be all zero
+	rng[0] = seed ^ 0x6A09E667;
+	rng[1] = 0xBB67AE85;
+	rng[2] = 0x3C6EF372;
+	rng[3] = 0xA54FF53A;
+	imageChanged = true;
+	storeImage();
+}
+
+uint8_t ATECCEmulator::getState()
+{
+	update();
+	return powerState;
+}
+
+uint8_t *ATECCEmulator::getConfigZone()
+{
+	return configZone;
+}
+
+// contents of slot, or NULL if slot is invalid. The whole data zone with slot = 0.
+uint8_t *ATECCEmulator::getDataZone(int slot)
+{
+	if (slot < 0 || slot > 15)
+		return NULL;
+	return &dataZone[slotOffset(slot)];
+}
+
+uint8_t *ATECCEmulator::getOTPZone()
+{
+	return otpZone;
+}
+
+boolean ATECCEmulator::isConfigLocked()
+{
+	return configZone[CONFIG_ZONE_LOCK_STATUS] != LOCK_UNLOCKED;
+}
+
+boolean ATECCEmulator::isDataLocked()
+{
+	return configZone[CONFIG_ZONE_OTP_LOCK] != LOCK_UNLOCKED;
+}
+
+
+/* ATECCTransport */
+
+boolean ATECCEmulator::wake()
+{
+	update();
+	wakeCount++;
+	now += WAKE_LOW_TIME_US;
+	if (powerState == ATECC_EMULATOR_AWAKE)
+		return true;      // ignored while awake
+	powerState = ATECC_EMULATOR_AWAKE;
+	watchdogStart = now;
+	busyUntil = now + WAKE_HIGH_TIME_US;
+	memcpy(output, wakeResponse, sizeof(wakeResponse));
+	outputLength = sizeof(wakeResponse);
+	outputIndex = 0;
+	return true;
+}
+
+boolean ATECCEmulator::write(uint8_t address, const uint8_t *data, size_t length)
+{
+	update();
+	busTransfer(1);
+	if (address != this->address || powerState != ATECC_EMULATOR_AWAKE || now < busyUntil)
+	{
+		nackCount++;
+		return false;
+	}
+	busTransfer(length);
+	if (length == 0)
+		return true;
+	switch (data[0])
+	{
+		case WORD_ADDRESS_RESET:
+			outputIndex = 0;
+			break;
+		case WORD_ADDRESS_SLEEP:
+			goToSleep();
+			break;
+		case WORD_ADDRESS_VALUE_IDLE:
+			powerState = ATECC_EMULATOR_IDLE;  // TempKey, SHA context and RNG seed are kept
+			break;
+		case WORD_ADDRESS_VALUE_COMMAND:
+			execute(data + 1, length - 1);
+			break;
+	}
+	return true;
+}
+
+int ATECCEmulator::read(uint8_t address, uint8_t *data, size_t length)
+{
+	update();
+	busTransfer(1);
+	if (address != this->address || powerState != ATECC_EMULATOR_AWAKE || now < busyUntil)
+	{
+		nackCount++;
+		return 0;
+	}
+	busTransfer(length);
+	for (size_t i = 0; i < length; i++)
+		data[i] = (outputIndex < outputLength) ? output[outputIndex++] : 0xFF;  // 0xFF after the end of the response
+	return length;
+}
+
+unsigned long ATECCEmulator::micros()
+{
+	return now;
+}
+
+void ATECCEmulator::delayMicroseconds(unsigned long us)
+{
+	now += us;
+}
+
+void ATECCEmulator::advance(unsigned long us)
+{
+	now += us;
+}
+
+// the watchdog puts the IC to sleep a fixed time after the wake up, even while it's busy
+void ATECCEmulator::update()
+{
+	unsigned long timeout = (configZone[CONFIG_ZONE_CHIP_MODE] & CHIP_MODE_WATCHDOG_10S) ? WATCHDOG_TIMEOUT_LONG : WATCHDOG_TIMEOUT_SHORT;
+
+	if (powerState == ATECC_EMULATOR_AWAKE && now - watchdogStart >= timeout * 1000UL)
+		goToSleep();
+}
+
+void ATECCEmulator::busTransfer(size_t bytes)
+{
+	busBytes += bytes;
+	now += (bytes * 9 * 1000000UL + busSpeed - 1) / busSpeed;
+}
+
+void ATECCEmulator::goToSleep()
+{
+	powerState = ATECC_EMULATOR_SLEEP;
+	tempKeyValid = false;
+	shaActive = false;
+	outputLength = 0;
+	outputIndex = 0;
+}
+
+
+/* commands */
+
+// packet: count, opcode, param1, param2 (2 bytes), data, CRC (2 bytes)
+void ATECCEmulator::execute(const uint8_t *packet, size_t length)
+{
+	uint16_t crc;
+	uint8_t  opcode, param1, timing, status;
+	uint16_t param2;
+
+	commandCount++;
+	outputLength = 0;
+	outputIndex = 0;
+	if (length < 7 || packet[0] != length)
+	{
+		respondStatus(STATUS_PARSE_ERROR);
+		return;
+	}
+	crc = ATECCX08A::calculateSummaryCrc(packet, length - CRC_SIZE);
+	if (packet[length - 2] != (crc & 0xFF) || packet[length - 1] != (crc >> 8))
+	{
+		respondStatus(STATUS_CRC_ERROR);
+		return;
+	}
+	opcode = packet[1];
+	param1 = packet[2];
+	param2 = packet[3] | (packet[4] << 8);
+	opcodeCount[opcode & 0x7F]++;
+
+	timing = timingOf(opcode, param1);  // before the command changes the SHA state
+	status = executeCommand(opcode, param1, param2, &packet[5], length - 7);
+	if (outputLength == 0)
+		respondStatus(status);
+	if (status == STATUS_SUCCESS && (opcode == COMMAND_OPCODE_WRITE || opcode == COMMAND_OPCODE_LOCK))
+		imageChanged = true;
+	storeImage();
+	// a parse error is reported right away, everything else takes the execution time
+	if (status != STATUS_PARSE_ERROR && timing < ATECC_CMD_COUNT)
+	{
+		busyUntil = now + executionTime[timing];
+		busyTime += executionTime[timing];
+	}
+}
+
+// a handler either responds with data or returns the status byte of the response
+uint8_t ATECCEmulator::executeCommand(uint8_t opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length)
+{
+	switch (opcode)
+	{
+		case COMMAND_OPCODE_INFO:
+			return info(param1);
+		case COMMAND_OPCODE_READ:
+			return readZone(param1, param2);
+		case COMMAND_OPCODE_WRITE:
+			return writeZone(param1, param2, data, length);
+		case COMMAND_OPCODE_LOCK:
+			return lock(param1, param2);
+		case COMMAND_OPCODE_RANDOM:
+			return random(param1);
+		case COMMAND_OPCODE_NONCE:
+			return nonce(param1, data, length);
+		case COMMAND_OPCODE_SHA:
+			return sha(param1, param2, data, length);
+		case COMMAND_OPCODE_GENKEY:
+			return genKey(param1, param2);
+		case COMMAND_OPCODE_SIGN:
+			return sign(param1, param2);
+		case COMMAND_OPCODE_VERIFY:
+			return verify(param1, param2, data, length);
+		case COMMAND_OPCODE_MAC:
+			return mac(param1, param2, data, length);
+		case COMMAND_OPCODE_CHECKMAC:
+			return checkMac(param1, param2, data, length);
+		case COMMAND_OPCODE_AES:
+			if (model == ATECC_MODEL_508A)
+				return STATUS_PARSE_ERROR;
+			return aes(param1, param2, data, length);
+	}
+	return STATUS_PARSE_ERROR;
+}
+
+uint8_t ATECCEmulator::timingOf(uint8_t opcode, uint8_t param1)
+{
+	switch (opcode)
+	{
+		case COMMAND_OPCODE_INFO:   return ATECC_CMD_INFO;
+		case COMMAND_OPCODE_READ:   return ATECC_CMD_READ;
+		case COMMAND_OPCODE_WRITE:  return ATECC_CMD_WRITE;
+		case COMMAND_OPCODE_LOCK:   return ATECC_CMD_LOCK;
+		case COMMAND_OPCODE_RANDOM: return ATECC_CMD_RANDOM;
+		case COMMAND_OPCODE_NONCE:  return ATECC_CMD_NONCE;
+		case COMMAND_OPCODE_GENKEY: return ATECC_CMD_GENKEY;
+		case COMMAND_OPCODE_SIGN:   return ATECC_CMD_SIGN;
+		case COMMAND_OPCODE_VERIFY: return ATECC_CMD_VERIFY;
+		case COMMAND_OPCODE_MAC:    return ATECC_CMD_MAC;
+		case COMMAND_OPCODE_CHECKMAC: return ATECC_CMD_CHECKMAC;
+		case COMMAND_OPCODE_AES:    return ATECC_CMD_AES;
+		case COMMAND_OPCODE_SHA:
+			// the HMAC end runs the inner and the outer hash
+			if ((param1 & 0x07) == SHA_HMAC_END || ((param1 & 0x07) == SHA_608_HMAC_END && shaActive && shaHmac))
+				return ATECC_CMD_HMAC;
+			return ATECC_CMD_SHA;
+	}
+	return ATECC_CMD_COUNT;
+}
+
+// count, data, CRC
+void ATECCEmulator::respond(const uint8_t *data, size_t length)
+{
+	uint16_t crc;
+
+	output[0] = RESPONSE_COUNT_SIZE + length + CRC_SIZE;
+	memcpy(&output[1], data, length);
+	crc = ATECCX08A::calculateSummaryCrc(output, RESPONSE_COUNT_SIZE + length);
+	output[1 + length] = crc & 0xFF;
+	output[2 + length] = crc >> 8;
+	outputLength = output[0];
+	outputIndex = 0;
+}
+
+void ATECCEmulator::respondStatus(uint8_t status)
+{
+	respond(&status, 1);
+}
+
+uint8_t ATECCEmulator::info(uint8_t mode)
+{
+	uint8_t response[RESPONSE_INFO_SIZE] = { 0x00, 0x00, 0x00, 0x00 };
+
+	if (mode > 3)
+		return STATUS_PARSE_ERROR;
+	if (mode == 0x00)
+	{
+		// revision
+		response[2] = (model == ATECC_MODEL_508A) ? 0x50 : 0x60;
+		response[3] = revision;
+	}
+	respond(response, sizeof(response));
+	return STATUS_SUCCESS;
+}
+
+int ATECCEmulator::slotOffset(int slot)
+{
+	int offset = 0;
+
+	for (int i = 0; i < slot; i++)
+		offset += ATECCX08A::getSlotSize(i);
+	return offset;
+}
+
+uint16_t ATECCEmulator::slotConfig(int slot)
+{
+	return configZone[CONFIG_ZONE_SLOT_CONFIG + 2 * slot] | (configZone[CONFIG_ZONE_SLOT_CONFIG + 2 * slot + 1] << 8);
+}
+
+uint16_t ATECCEmulator::keyConfig(int slot)
+{
+	return configZone[CONFIG_ZONE_KEY_CONFIG + 2 * slot] | (configZone[CONFIG_ZONE_KEY_CONFIG + 2 * slot + 1] << 8);
+}
+
+boolean ATECCEmulator::isSlotLocked(int slot)
+{
+	return (configZone[CONFIG_ZONE_SLOTS_LOCK0 + slot / 8] & (1 << (slot % 8))) == 0;
+}
+
+boolean ATECCEmulator::isPrivateKeySlot(int slot)
+{
+	return (keyConfig(slot) & KEY_CONFIG_PRIVATE) != 0;
+}
+
+/** \brief
+
+	zoneOffset(uint8_t zone, uint16_t address, boolean block, int &size)
+
+	Offset of the 4 (or 32 if block is true) bytes at address in configZone, otpZone or dataZone,
+	-1 if the address is out of range. size is set to 4 or 32.
+*/
+
+int ATECCEmulator::zoneOffset(uint8_t zone, uint16_t address, boolean block, int &size)
+{
+	int offset;
+	int slot;
+
+	size = block ? 32 : 4;
+	if (zone == ZONE_CONFIG || zone == ZONE_OTP)
+	{
+		offset = ((address >> 3) & 0x03) * 32 + (block ? 0 : (address & 0x07) * 4);
+		if (offset + size > ((zone == ZONE_CONFIG) ? CONFIG_ZONE_SIZE : ATECC_EMULATOR_OTP_SIZE))
+			return -1;
+		return offset;
+	}
+	slot = (address >> 3) & 0x0F;
+	offset = ((address >> 8) & 0x0F) * 32 + (block ? 0 : (address & 0x07) * 4);
+	if (offset + size > ATECCX08A::getSlotSize(slot))
+		return -1;
+	return slotOffset(slot) + offset;
+}
+
+uint8_t ATECCEmulator::readZone(uint8_t param1, uint16_t address)
+{
+	uint8_t zone = param1 & 0x03;
+	int     offset, size, slot = (address >> 3) & 0x0F;
+
+	if (zone > ZONE_DATA)
+		return STATUS_PARSE_ERROR;
+	offset = zoneOffset(zone, address, (param1 & 0x80) != 0, size);
+	if (offset < 0)
+		return STATUS_PARSE_ERROR;
+	if (zone == ZONE_CONFIG)
+	{
+		respond(&configZone[offset], size);
+		return STATUS_SUCCESS;
+	}
+	// the data and OTP zones can't be read before they are locked
+	if (!isDataLocked())
+		return STATUS_EXECUTION_ERROR;
+	if (zone == ZONE_OTP)
+	{
+		respond(&otpZone[offset], size);
+		return STATUS_SUCCESS;
+	}
+	// secrets are never read, encrypted reads aren't emulated
+	if (slotConfig(slot) & (SLOT_CONFIG_IS_SECRET | SLOT_CONFIG_ENCRYPT_READ))
+		return STATUS_EXECUTION_ERROR;
+	respond(&dataZone[offset], size);
+	return STATUS_SUCCESS;
+}
+
+uint8_t ATECCEmulator::writeZone(uint8_t param1, uint16_t address, const uint8_t *data, size_t length)
+{
+	uint8_t zone = param1 & 0x03;
+	uint8_t writeConfig;
+	int     offset, size, slot = (address >> 3) & 0x0F;
+
+	if (zone > ZONE_DATA)
+		return STATUS_PARSE_ERROR;
+	offset = zoneOffset(zone, address, (param1 & 0x80) != 0, size);
+	if (offset < 0 || (int) length != size)
+		return STATUS_PARSE_ERROR;
+	if (param1 & 0x40)
+		return STATUS_EXECUTION_ERROR;   // encrypted writes aren't emulated
+
+	if (zone == ZONE_CONFIG)
+	{
+		if (isConfigLocked() || offset < CONFIG_ZONE_WRITABLE_START)
+			return STATUS_EXECUTION_ERROR;
+		for (int i = 0; i < size; i++)
+		{
+			// UserExtra, Selector and the lock bytes are kept
+			if (offset + i < CONFIG_ZONE_USER_EXTRA || offset + i > CONFIG_ZONE_LOCK_STATUS)
+				configZone[offset + i] = data[i];
+		}
+		return STATUS_SUCCESS;
+	}
+	if (zone == ZONE_OTP)
+	{
+		if (!isDataLocked())
+			memcpy(&otpZone[offset], data, size);
+		else if (configZone[CONFIG_ZONE_OTP_MODE] == 0x55)
+		{
+			// consumption mode: bits can only be cleared
+			for (int i = 0; i < size; i++)
+				otpZone[offset + i] &= data[i];
+		}
+		else
+			return STATUS_EXECUTION_ERROR;
+		return STATUS_SUCCESS;
+	}
+
+	if (isDataLocked())
+	{
+		writeConfig = slotConfig(slot) >> WRITE_CONFIG_SHIFT;
+		// Always and PubInvalid allow clear text writes, Never and Encrypt don't
+		if (isSlotLocked(slot) || writeConfig > 0x01 || isPrivateKeySlot(slot))
+			return STATUS_EXECUTION_ERROR;
+	}
+	memcpy(&dataZone[offset], data, size);
+	return STATUS_SUCCESS;
+}
+
+uint8_t ATECCEmulator::lock(uint8_t mode, uint16_t summaryCrc)
+{
+	boolean  checkSummary = (mode & LOCK_MODE_IGNORE_SUMMARY) == 0;
+	int      slot = (mode >> 2) & 0x0F;
+	uint16_t crc;
+
+	switch (mode & 0x03)
+	{
+		case 0x00:  // configuration zone
+			if (isConfigLocked())
+				return STATUS_EXECUTION_ERROR;
+			if (checkSummary && ATECCX08A::calculateSummaryCrc(configZone, CONFIG_ZONE_SIZE) != summaryCrc)
+				return STATUS_EXECUTION_ERROR;
+			configZone[CONFIG_ZONE_LOCK_STATUS] = 0x00;
+			break;
+
+		case 0x01:  // data and OTP zones
+			if (!isConfigLocked() || isDataLocked())
+				return STATUS_EXECUTION_ERROR;
+			crc = ATECCX08A::calculateSummaryCrc(dataZone, ATECC_EMULATOR_DATA_SIZE);
+			crc = ATECCX08A::calculateSummaryCrc(otpZone, ATECC_EMULATOR_OTP_SIZE, crc);
+			if (checkSummary && crc != summaryCrc)
+				return STATUS_EXECUTION_ERROR;
+			configZone[CONFIG_ZONE_OTP_LOCK] = 0x00;
+			break;
+
+		case 0x02:  // single slot
+			if (!isConfigLocked() || isSlotLocked(slot) || (keyConfig(slot) & KEY_CONFIG_LOCKABLE) == 0)
+				return STATUS_EXECUTION_ERROR;
+			if (checkSummary && ATECCX08A::calculateSummaryCrc(&dataZone[slotOffset(slot)], ATECCX08A::getSlotSize(slot)) != summaryCrc)
+				return STATUS_EXECUTION_ERROR;
+			configZone[CONFIG_ZONE_SLOTS_LOCK0 + slot / 8] &= ~(1 << (slot % 8));
+			break;
+
+		default:
+			return STATUS_PARSE_ERROR;
+	}
+	return STATUS_SUCCESS;
+}
+
+void ATECCEmulator::nextRandom(uint8_t *output, size_t length)
+{
+	imageChanged = true;
+	for (size_t i = 0; i < length; i++)
+	{
+		if (i % 4 == 0)
+		{
+			uint32_t t = rng[3];
+			uint32_t s = rng[0];
+
+			rng[3] = rng[2];
+			rng[2] = rng[1];
+			rng[1] = s;
+			t ^= t << 11;
+			t ^= t >> 8;
+			rng[0] = t ^ s ^ (s >> 19);
+		}
+		output[i] = rng[0] >> (8 * (i % 4));
+	}
+}
+
+uint8_t ATECCEmulator::random(uint8_t mode)
+{
+	uint8_t value[RESPONSE_RANDOM_SIZE];
+
+	if (mode > 0x01)   // 0x00 updates the seed, 0x01 doesn't, the emulator has no seed in the EEPROM
+		return STATUS_PARSE_ERROR;
+	if (isConfigLocked())
+		nextRandom(value, sizeof(value));
+	else
+	{
+		// the fixed pattern of an IC with unlocked configuration
+		for (unsigned int i = 0; i < sizeof(value); i++)
+			value[i] = (i % 4 < 2) ? 0xFF : 0x00;
+	}
+	respond(value, sizeof(value));
+	return STATUS_SUCCESS;
+}
+
+uint8_t ATECCEmulator::nonce(uint8_t mode, const uint8_t *data, size_t length)
+{
+	uint8_t message[32 + 20 + 3];
+
+	switch (mode & 0x03)
+	{
+		case NONCE_MODE_PASSTHROUGH:
+			if (length != 32 || (mode & 0xC0) != 0)   // only TempKey as the target
+				return STATUS_PARSE_ERROR;
+			memcpy(tempKey, data, 32);
+			tempKeyValid = true;
+			return STATUS_SUCCESS;
+
+		case 0x00:
+		case 0x01:
+			// TempKey = SHA-256(RandOut, NumIn, opcode, mode, 0x00), RandOut is the response
+			if (length != 20)
+				return STATUS_PARSE_ERROR;
+			nextRandom(message, 32);
+			memcpy(&message[32], data, 20);
+			message[52] = COMMAND_OPCODE_NONCE;
+			message[53] = mode;
+			message[54] = 0x00;
+			ATECCSoftSha256::hash(message, sizeof(message), tempKey);
+			tempKeyValid = true;
+			respond(message, 32);
+			return STATUS_SUCCESS;
+	}
+	return STATUS_PARSE_ERROR;
+}
+
+uint8_t ATECCEmulator::sha(uint8_t mode, uint16_t param2, const uint8_t *data, size_t length)
+{
+	uint8_t digest[SHA256_SIZE];
+	uint8_t pad[SHA_BLOCK_SIZE];
+	uint8_t context[SHA_CONTEXT_MAX_SIZE];
+	boolean is508 = (model == ATECC_MODEL_508A);
+	int     slot = param2 & 0x0F;
+
+	switch (mode & 0x07)
+	{
+		case SHA_START:
+			shaContext.begin();
+			shaActive = true;
+			shaHmac = false;
+			return STATUS_SUCCESS;
+
+		case SHA_HMAC_START:
+			// the key is the first 32 bytes of the slot
+			if (param2 > 15 || !isDataLocked())
+				return STATUS_EXECUTION_ERROR;
+			memcpy(hmacKey, &dataZone[slotOffset(slot)], sizeof(hmacKey));
+			memset(pad, 0x36, sizeof(pad));
+			for (unsigned int i = 0; i < sizeof(hmacKey); i++)
+				pad[i] ^= hmacKey[i];
+			shaContext.begin();
+			shaContext.update(pad, sizeof(pad));
+			shaActive = true;
+			shaHmac = true;
+			return STATUS_SUCCESS;
+
+		case SHA_UPDATE:
+			// the ATECC508A only takes complete blocks
+			if (length > SHA_BLOCK_SIZE || (is508 && length != SHA_BLOCK_SIZE))
+				return STATUS_PARSE_ERROR;
+			if (!shaActive)
+				return STATUS_EXECUTION_ERROR;
+			shaContext.update(data, length);
+			return STATUS_SUCCESS;
+
+		case SHA_END:
+		case SHA_HMAC_END:
+			// the ATECC608A ends an HMAC with SHA_END, the ATECC508A with SHA_HMAC_END
+			if (length >= SHA_BLOCK_SIZE || ((mode & 0x07) == SHA_HMAC_END && !is508))
+				return STATUS_PARSE_ERROR;
+			if (!shaActive || (is508 && shaHmac != ((mode & 0x07) == SHA_HMAC_END)))
+				return STATUS_EXECUTION_ERROR;
+			shaContext.update(data, length);
+			shaContext.end(digest);
+			if (shaHmac)
+			{
+				memset(pad, 0x5C, sizeof(pad));
+				for (unsigned int i = 0; i < sizeof(hmacKey); i++)
+					pad[i] ^= hmacKey[i];
+				shaContext.begin();
+				shaContext.update(pad, sizeof(pad));
+				shaContext.update(digest, sizeof(digest));
+				shaContext.end(digest);
+			}
+			shaActive = false;
+			// the ATECC608A writes TempKey only if it's the target
+			if (is508 || (mode & SHA_MODE_TARGET_OUTPUT) == 0)
+			{
+				memcpy(tempKey, digest, sizeof(tempKey));
+				tempKeyValid = true;
+			}
+			respond(digest, sizeof(digest));
+			return STATUS_SUCCESS;
+
+		case SHA_READ_CONTEXT:
+			if (is508)
+				return STATUS_PARSE_ERROR;
+			if (!shaActive)
+				return STATUS_EXECUTION_ERROR;
+			respond(context, shaContext.saveContext(context));
+			return STATUS_SUCCESS;
+
+		case SHA_WRITE_CONTEXT:
+			if (is508 || shaContext.restoreContext(data, length) == false)
+				return STATUS_PARSE_ERROR;
+			shaActive = true;
+			shaHmac = false;
+			return STATUS_SUCCESS;
+	}
+	return STATUS_PARSE_ERROR;
+}
+
+// private key of slot (stored after 4 pad bytes, like the public keys)
+boolean ATECCEmulator::privateKey(int slot, uint8_t *key)
+{
+	memcpy(key, &dataZone[slotOffset(slot) + 4], 32);
+	return ATECCSoftP256::isValidPrivateKey(key);
+}
+
+uint8_t ATECCEmulator::genKey(uint8_t mode, uint16_t slot)
+{
+	uint8_t key[32];
+	uint8_t publicKey[PUBLIC_KEY_SIZE];
+
+	if (slot > 15 || (mode != GENKEY_MODE_PUBLIC && mode != GENKEY_MODE_NEW_PRIVATE))
+		return STATUS_PARSE_ERROR;
+	if (!isConfigLocked() || !isPrivateKeySlot(slot))
+		return STATUS_EXECUTION_ERROR;
+	if (mode == GENKEY_MODE_NEW_PRIVATE)
+	{
+		if (isSlotLocked(slot))
+			return STATUS_EXECUTION_ERROR;
+		do
+		{
+			nextRandom(key, sizeof(key));
+		} while (!ATECCSoftP256::isValidPrivateKey(key));
+		memset(&dataZone[slotOffset(slot)], 0x00, 4);
+		memcpy(&dataZone[slotOffset(slot) + 4], key, sizeof(key));
+		imageChanged = true;
+	}
+	else if (!privateKey(slot, key))
+		return STATUS_EXECUTION_ERROR;
+	if (!ATECCSoftP256::publicKey(key, publicKey))
+		return STATUS_ECC_FAULT;
+	respond(publicKey, sizeof(publicKey));
+	return STATUS_SUCCESS;
+}
+
+uint8_t ATECCEmulator::sign(uint8_t mode, uint16_t slot)
+{
+	uint8_t key[32];
+	uint8_t k[32];
+	uint8_t signature[SIGNATURE_SIZE];
+
+	// only external messages in TempKey
+	if (slot > 15 || mode != SIGN_MODE_TEMPKEY)
+		return STATUS_PARSE_ERROR;
+	if (!isDataLocked() || !tempKeyValid || !isPrivateKeySlot(slot) || !privateKey(slot, key))
+		return STATUS_EXECUTION_ERROR;
+	do
+	{
+		nextRandom(k, sizeof(k));
+	} while (!ATECCSoftP256::sign(key, tempKey, k, signature));
+	respond(signature, sizeof(signature));
+	return STATUS_SUCCESS;
+}
+
+uint8_t ATECCEmulator::verify(uint8_t mode, uint16_t keyType, const uint8_t *data, size_t length)
+{
+	// only external public keys and messages in TempKey
+	if (mode != VERIFY_MODE_EXTERNAL || keyType != VERIFY_PARAM2_KEYTYPE_ECC || length != SIGNATURE_SIZE + PUBLIC_KEY_SIZE)
+		return STATUS_PARSE_ERROR;
+	if (!tempKeyValid)
+		return STATUS_EXECUTION_ERROR;
+	if (!ATECCSoftP256::verify(&data[SIGNATURE_SIZE], tempKey, data))
+		return STATUS_VERIFICATION_ERROR;
+	return STATUS_SUCCESS;
+}
+
+/** \brief
+
+	mac(uint8_t mode, uint16_t slot, const uint8_t *data, size_t length)
+
+	MAC with the key of slot and the challenge of the input (mode bits 0 and 1 clear), optionally
+	with the OTP bytes (bits 4 and 5) and the complete serial number (bit 6):
+	SHA-256(key, challenge, opcode, mode, slot, OTP[0:7], OTP[8:10], SN[8], SN[4:7], SN[0:1], SN[2:3])
+	The optional parts are zeros when they are not included, SN[8] and SN[0:1] are always included.
+*/
+
+uint8_t ATECCEmulator::mac(uint8_t mode, uint16_t slot, const uint8_t *data, size_t length)
+{
+	uint8_t message[ATECC_EMULATOR_MAC_MESSAGE_SIZE] = { 0 };
+	uint8_t digest[SHA256_SIZE];
+
+	// TempKey as key or challenge isn't emulated
+	if (slot > 15 || (mode & ~0x74) != 0 || length != MAC_CHALLENGE_SIZE)
+		return STATUS_PARSE_ERROR;
+	if (!isDataLocked())
+		return STATUS_EXECUTION_ERROR;
+	memcpy(&message[0], &dataZone[slotOffset(slot)], 32);
+	memcpy(&message[32], data, MAC_CHALLENGE_SIZE);
+	message[64] = COMMAND_OPCODE_MAC;
+	message[65] = mode;
+	message[66] = slot & 0xFF;
+	message[67] = slot >> 8;
+	if (mode & 0x20)
+		memcpy(&message[68], &otpZone[0], 8);
+	if (mode & 0x10)
+		memcpy(&message[76], &otpZone[8], 3);
+	message[79] = configZone[CONFIG_ZONE_SERIAL_PART1 + 4];
+	if (mode & 0x40)
+		memcpy(&message[80], &configZone[CONFIG_ZONE_SERIAL_PART1], 4);
+	memcpy(&message[84], &configZone[CONFIG_ZONE_SERIAL_PART0], 2);
+	if (mode & 0x40)
+		memcpy(&message[86], &configZone[CONFIG_ZONE_SERIAL_PART0 + 2], 2);
+	ATECCSoftSha256::hash(message, sizeof(message), digest);
+	respond(digest, sizeof(digest));
+	return STATUS_SUCCESS;
+}
+
+/** \brief
+
+	checkMac(uint8_t mode, uint16_t slot, const uint8_t *data, size_t length)
+
+	CheckMac with the key of slot and ClientChal of the input (mode bits 0 and 1 clear), optionally
+	with OTP[0:7] (bit 5). data is ClientChal (32), ClientResp (32) and OtherData (13), the MAC is
+	SHA-256(key, ClientChal, OtherData[0:3], OTP[0:7], OtherData[4:6], SN[8], OtherData[7:10], SN[0:1], OtherData[11:12])
+	and must be ClientResp. Responds with 0x00 if it matches, CHECKMAC_MISMATCH otherwise.
+*/
+
+uint8_t ATECCEmulator::checkMac(uint8_t mode, uint16_t slot, const uint8_t *data, size_t length)
+{
+	uint8_t message[ATECC_EMULATOR_MAC_MESSAGE_SIZE] = { 0 };
+	uint8_t digest[SHA256_SIZE];
+	const uint8_t *otherData = &data[MAC_CHALLENGE_SIZE + MAC_RESPONSE_SIZE];
+
+	if (slot > 15 || (mode & ~0x24) != 0 || length != MAC_CHALLENGE_SIZE + MAC_RESPONSE_SIZE + CHECKMAC_OTHER_DATA_SIZE)
+		return STATUS_PARSE_ERROR;
+	if (!isDataLocked())
+		return STATUS_EXECUTION_ERROR;
+	memcpy(&message[0], &dataZone[slotOffset(slot)], 32);
+	memcpy(&message[32], data, MAC_CHALLENGE_SIZE);
+	memcpy(&message[64], &otherData[0], 4);
+	if (mode & 0x20)
+		memcpy(&message[68], &otpZone[0], 8);
+	memcpy(&message[76], &otherData[4], 3);
+	message[79] = configZone[CONFIG_ZONE_SERIAL_PART1 + 4];
+	memcpy(&message[80], &otherData[7], 4);
+	memcpy(&message[84], &configZone[CONFIG_ZONE_SERIAL_PART0], 2);
+	memcpy(&message[86], &otherData[11], 2);
+	ATECCSoftSha256::hash(message, sizeof(message), digest);
+	tempKeyValid = false;   // the IC invalidates TempKey
+	if (memcmp(digest, &data[MAC_CHALLENGE_SIZE], MAC_RESPONSE_SIZE) != 0)
+		return CHECKMAC_MISMATCH;
+	return STATUS_SUCCESS;
+}
+
+uint8_t ATECCEmulator::aes(uint8_t mode, uint16_t slot, const uint8_t *data, size_t length)
+{
+	uint8_t keyIndex = mode >> 6;
+	uint8_t result[AES_BLOCKSIZE];
+	const uint8_t *key;
+
+	if ((mode & 0x07) > AES_DECRYPT || length != AES_BLOCKSIZE)
+		return STATUS_PARSE_ERROR;
+	if ((configZone[CONFIG_ZONE_AES_STATUS] & 0x01) == 0)
+		return STATUS_EXECUTION_ERROR;
+	if (slot == 0xFFFF)
+	{
+		// key in TempKey
+		if (!tempKeyValid || keyIndex > 1)
+			return STATUS_EXECUTION_ERROR;
+		key = &tempKey[keyIndex * AES_BLOCKSIZE];
+	}
+	else
+	{
+		if (slot > 15 || (keyIndex + 1) * AES_BLOCKSIZE > ATECCX08A::getSlotSize(slot))
+			return STATUS_PARSE_ERROR;
+		if (!isDataLocked())
+			return STATUS_EXECUTION_ERROR;
+		key = &dataZone[slotOffset(slot) + keyIndex * AES_BLOCKSIZE];
+	}
+	if ((mode & 0x07) == AES_ENCRYPT)
+		ATECCSoftAES128::encrypt(key, data, result);
+	else
+		ATECCSoftAES128::decrypt(key, data, result);
+	respond(result, sizeof(result));
+	return STATUS_SUCCESS;
+}
+
+
+/* statistics */
+
+unsigned long ATECCEmulator::getCommandCount()
+{
+	return commandCount;
+}
+
+unsigned long ATECCEmulator::getCommandCount(uint8_t opcode)
+{
+	return opcodeCount[opcode & 0x7F];
+}
+
+unsigned long ATECCEmulator::getWakeCount()
+{
+	return wakeCount;
+}
+
+// bytes on the bus incl. the address bytes
+unsigned long ATECCEmulator::getBusBytes()
+{
+	return busBytes;
+}
+
+// sum of the execution times of the commands (us)
+unsigned long ATECCEmulator::getBusyTime()
+{
+	return busyTime;
+}
+
+// transfers the IC didn't acknowledge (asleep, idle, busy or another address)
+unsigned long ATECCEmulator::getNackCount()
+{
+	return nackCount;
+}
+
+void ATECCEmulator::resetStatistics()
+{
+	commandCount = 0;
+	memset(opcodeCount, 0, sizeof(opcodeCount));
+	wakeCount = 0;
+	busBytes = 0;
+	busyTime = 0;
+	nackCount = 0;
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "SparkFun_ATECCX08a_Arduino_Library.h"
+#include "ATECCEmulatorCrypto.h"
+
+
+/*
+  Host-side emulator of an ATECC508A or ATECC608A behind the ATECCTransport interface, so the
+  library (and everything built on it) runs and can be measured without a chip:
+
+    ATECCEmulator chip(ATECC_MODEL_608A);
+    ATECCX08A atecc;
+    atecc.begin(chip);               // the emulator is the transport and the clock
+    ...
+    chip.micros();                   // simulated time used so far
+
+  What is emulated:
+  - framing and CRC of the commands and responses, the word addresses (reset, sleep, idle, command)
+  - the power states: the IC NACKs while asleep or idle and until a command has finished, wake pulse,
+    sleep, idle and the watchdog (1.3 s or 10 s, ChipMode) which puts the IC to sleep and clears
+    TempKey and the SHA context
+  - configuration, data and OTP zones with the lock rules (read only bytes, no data/OTP reads before
+    the data zone is locked, IsSecret, WriteConfig, slot locks, OTP consumption mode, summary CRCs)
+  - Info, Read, Write, Lock, Random, Nonce, SHA (incl. HMAC and the SHA context of the ATECC608A),
+    GenKey, Sign and Verify (ECDSA P-256), MAC and CheckMac (key from a slot, challenge from the input)
+    and AES (ATECC608A only). Other opcodes return a parse error.
+  - time: a simulated clock in us. Every I2C transfer takes its bus time (setBusSpeed()), every command
+    its execution time (setExecutionTime(), the worst case times of the library by default).
+
+  The non volatile memory (zones, lock state, keys and the RNG state) is an ATECCEmulatorImage. By default
+  the emulator has its own, attach() puts it on any other, e.g. a file mapped into memory with
+  ATECCEmulatorImageFile, so a device keeps its keys and locks from one run to the next.
+
+  Not emulated: encrypted reads and writes, MAC and CheckMac with TempKey, KDF, GenDig, DeriveKey, the counters,
+  the self test and anything outside the behaviour of the I2C interface (e.g. power consumption).
+  Random numbers are deterministic (setSeed()), and the ECC math isn't constant time, so the emulator
+  must never be used for real keys.
+*/
+
+#define ATECC_EMULATOR_DATA_SIZE    1208  // slots 0-15: 8 * 36 + 416 + 7 * 72
+#define ATECC_EMULATOR_OTP_SIZE       64
+#define ATECC_EMULATOR_BUFFER_SIZE   160  // longest command (Verify: count, opcode, params, 128 bytes, CRC)
+#define ATECC_EMULATOR_BUS_SPEED  100000  // Hz, default of the Wire library
+#define ATECC_EMULATOR_MAC_MESSAGE_SIZE 88 // message hashed by MAC and CheckMac
+
+#define ATECC_EMULATOR_IMAGE_VERSION  1
+
+/*
+  Non volatile memory of an emulated IC. Only bytes, so it can be stored (or mapped) as it is.
+  The lock state is in the configuration zone (bytes 86 - 89), private keys are in their slots
+  (4 zero bytes followed by the 32 byte key), so the image is the whole state of the device.
+  crc is the CRC of all bytes before and is updated after every command that changes the image.
+*/
+typedef struct
+{
+	uint8_t magic[4];                              // 'A', 'E', 'M', 'U'
+	uint8_t version;                               // ATECC_EMULATOR_IMAGE_VERSION
+	uint8_t model;                                 // ATECC_MODEL_*
+	uint8_t reserved[2];
+	uint8_t rng[16];                               // state of the random number generator, 4 words little endian
+	uint8_t configZone[CONFIG_ZONE_SIZE];
+	uint8_t dataZone[ATECC_EMULATOR_DATA_SIZE];
+	uint8_t otpZone[ATECC_EMULATOR_OTP_SIZE];
+	uint8_t crc[2];
+} ATECCEmulatorImage;
+
+// power state, see ATECCEmulator::getState()
+#define ATECC_EMULATOR_SLEEP   0
+#define ATECC_EMULATOR_IDLE    1
+#define ATECC_EMULATOR_AWAKE   2
+
+class ATECCEmulator : public ATECCTransport
+{
+  public:
+	  ATECCEmulator(uint8_t model = ATECC_MODEL_608A, uint8_t address = ATECC508A_ADDRESS_DEFAULT);
+
+		// ATECCTransport
+		boolean wake();
+		boolean write(uint8_t address, const uint8_t *data, size_t length);
+		int     read(uint8_t address, uint8_t *data, size_t length);
+		unsigned long micros();
+		void    delayMicroseconds(unsigned long us);
+
+		// non volatile memory
+		static void initImage(ATECCEmulatorImage &image, uint8_t model, uint8_t address = ATECC508A_ADDRESS_DEFAULT,
+		                      const uint8_t *serialNumber = NULL, uint32_t seed = 1);
+		static boolean checkImage(const ATECCEmulatorImage &image);
+		boolean attach(ATECCEmulatorImage *image);
+		ATECCEmulatorImage *getImage();
+
+		// timing
+		void    setExecutionTime(uint8_t command, unsigned long us);
+		unsigned long getExecutionTime(uint8_t command);
+		void    setBusSpeed(unsigned long hz);
+		void    advance(unsigned long us);
+
+		// state of the emulated IC
+		void    powerCycle();
+		void    setSeed(uint32_t seed);
+		uint8_t getState();
+		uint8_t *getConfigZone();
+		uint8_t *getDataZone(int slot);
+		uint8_t *getOTPZone();
+		boolean isConfigLocked();
+		boolean isDataLocked();
+
+		// statistics
+		unsigned long getCommandCount();
+		unsigned long getCommandCount(uint8_t opcode);
+		unsigned long getWakeCount();
+		unsigned long getBusBytes();
+		unsigned long getBusyTime();
+		unsigned long getNackCount();
+		void    resetStatistics();
+
+	private:
+	  void    update();
+		void    busTransfer(size_t bytes);
+		void    goToSleep();
+		void    execute(const uint8_t *packet, size_t length);
+		uint8_t executeCommand(uint8_t opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length);
+		void    respond(const uint8_t *data, size_t length);
+		void    respondStatus(uint8_t status);
+		uint8_t timingOf(uint8_t opcode, uint8_t param1);
+
+		uint8_t info(uint8_t mode);
+		uint8_t readZone(uint8_t param1, uint16_t address);
+		uint8_t writeZone(uint8_t param1, uint16_t address, const uint8_t *data, size_t length);
+		uint8_t lock(uint8_t mode, uint16_t summaryCrc);
+		uint8_t random(uint8_t mode);
+		uint8_t nonce(uint8_t mode, const uint8_t *data, size_t length);
+		uint8_t sha(uint8_t mode, uint16_t param2, const uint8_t *data, size_t length);
+		uint8_t genKey(uint8_t mode, uint16_t slot);
+		uint8_t sign(uint8_t mode, uint16_t slot);
+		uint8_t verify(uint8_t mode, uint16_t keyType, const uint8_t *data, size_t length);
+		uint8_t mac(uint8_t mode, uint16_t slot, const uint8_t *data, size_t length);
+		uint8_t checkMac(uint8_t mode, uint16_t slot, const uint8_t *data, size_t length);
+		uint8_t aes(uint8_t mode, uint16_t slot, const uint8_t *data, size_t length);
+
+		int     zoneOffset(uint8_t zone, uint16_t address, boolean block, int &size);
+		int     slotOffset(int slot);
+		uint16_t slotConfig(int slot);
+		uint16_t keyConfig(int slot);
+		boolean isSlotLocked(int slot);
+		boolean isPrivateKeySlot(int slot);
+		void    nextRandom(uint8_t *output, size_t length);
+		boolean privateKey(int slot, uint8_t *key);
+		void    storeImage();
+
+		// configuration
+		uint8_t  model;
+		uint8_t  revision;
+		uint8_t  address;                  // latched at power-up from configZone[16]
+		unsigned long executionTime[ATECC_CMD_COUNT];  // us
+		boolean  customTiming[ATECC_CMD_COUNT];
+		unsigned long busSpeed = ATECC_EMULATOR_BUS_SPEED;
+
+		// non volatile memory, the zones point into image
+		ATECCEmulatorImage  ownImage;
+		ATECCEmulatorImage *image = NULL;
+		uint8_t *configZone;
+		uint8_t *dataZone;
+		uint8_t *otpZone;
+		boolean  imageChanged = false;     // the image CRC (and RNG state) must be stored
+
+		// volatile state
+		uint8_t  powerState = ATECC_EMULATOR_SLEEP;
+		unsigned long now = 0;             // simulated clock, us
+		unsigned long watchdogStart = 0;   // the watchdog runs from the wake up
+		unsigned long busyUntil = 0;       // end of the execution time of the last command
+		uint8_t  output[ATECC_EMULATOR_BUFFER_SIZE];
+		size_t   outputLength = 0;
+		size_t   outputIndex = 0;
+		uint8_t  tempKey[32];
+		boolean  tempKeyValid = false;
+		ATECCSoftSha256 shaContext;
+		boolean  shaActive = false;
+		boolean  shaHmac = false;          // the SHA context was started with HMAC start
+		uint8_t  hmacKey[32];
+		uint32_t rng[4];                   // working copy of image->rng
+
+		// statistics
+		unsigned long commandCount = 0;
+		unsigned long opcodeCount[128];
+		unsigned long wakeCount = 0;
+		unsigned long busBytes = 0;
+		unsigned long busyTime = 0;
+		unsigned long nackCount = 0;
+};
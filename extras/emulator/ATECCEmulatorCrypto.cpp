@@ -0,0 +1,784 @@
+#include "ATECCEmulatorCrypto.h"
+
+
+/* SHA-256 (FIPS 180-4) */
+
+static const uint32_t shaRoundConstants[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t shaInitialState[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static inline uint32_t rotr(uint32_t x, int n)
+{
+	return (x >> n) | (x << (32 - n));
+}
+
+ATECCSoftSha256::ATECCSoftSha256()
+{
+	begin();
+}
+
+void ATECCSoftSha256::begin()
+{
+	memcpy(state, shaInitialState, sizeof(state));
+	blocks = 0;
+	bufferLength = 0;
+}
+
+void ATECCSoftSha256::compress(uint32_t *state, const uint8_t *block)
+{
+	uint32_t w[64];
+	uint32_t a, b, c, d, e, f, g, h;
+
+	for (int i = 0; i < 16; i++)
+		w[i] = ((uint32_t) block[4 * i] << 24) | ((uint32_t) block[4 * i + 1] << 16) | ((uint32_t) block[4 * i + 2] << 8) | block[4 * i + 3];
+	for (int i = 16; i < 64; i++)
+	{
+		uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+	a = state[0]; b = state[1]; c = state[2]; d = state[3];
+	e = state[4]; f = state[5]; g = state[6]; h = state[7];
+	for (int i = 0; i < 64; i++)
+	{
+		uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + shaRoundConstants[i] + w[i];
+		uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void ATECCSoftSha256::update(const uint8_t *data, size_t length)
+{
+	while (length > 0)
+	{
+		size_t chunk = sizeof(buffer) - bufferLength;
+
+		if (chunk > length)
+			chunk = length;
+		memcpy(&buffer[bufferLength], data, chunk);
+		bufferLength += chunk;
+		data += chunk;
+		length -= chunk;
+		if (bufferLength == sizeof(buffer))
+		{
+			compress(state, buffer);
+			blocks++;
+			bufferLength = 0;
+		}
+	}
+}
+
+void ATECCSoftSha256::end(uint8_t *digest)
+{
+	uint64_t bits = ((uint64_t) blocks * sizeof(buffer) + bufferLength) * 8;
+	uint8_t  padding[sizeof(buffer) + 8];
+	size_t   padLength;
+
+	// 0x80, zeros up to 56 mod 64, then the length in bits (big endian)
+	padLength = (bufferLength < 56) ? 56 - bufferLength : 120 - bufferLength;
+	memset(padding, 0, sizeof(padding));
+	padding[0] = 0x80;
+	for (int i = 0; i < 8; i++)
+		padding[padLength + i] = (uint8_t) (bits >> (56 - 8 * i));
+	update(padding, padLength + 8);
+	for (int i = 0; i < 8; i++)
+	{
+		digest[4 * i]     = state[i] >> 24;
+		digest[4 * i + 1] = state[i] >> 16;
+		digest[4 * i + 2] = state[i] >> 8;
+		digest[4 * i + 3] = state[i];
+	}
+	begin();
+}
+
+void ATECCSoftSha256::hash(const uint8_t *data, size_t length, uint8_t *digest)
+{
+	ATECCSoftSha256 sha;
+
+	sha.update(data, length);
+	sha.end(digest);
+}
+
+size_t ATECCSoftSha256::saveContext(uint8_t *context)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		context[4 * i]     = state[i] >> 24;
+		context[4 * i + 1] = state[i] >> 16;
+		context[4 * i + 2] = state[i] >> 8;
+		context[4 * i + 3] = state[i];
+	}
+	for (int i = 0; i < 4; i++)
+		context[32 + i] = blocks >> (8 * i);
+	memcpy(&context[ATECC_SOFT_SHA_CONTEXT_MIN_SIZE], buffer, bufferLength);
+	return ATECC_SOFT_SHA_CONTEXT_MIN_SIZE + bufferLength;
+}
+
+boolean ATECCSoftSha256::restoreContext(const uint8_t *context, size_t length)
+{
+	if (length < ATECC_SOFT_SHA_CONTEXT_MIN_SIZE || length >= ATECC_SOFT_SHA_CONTEXT_MIN_SIZE + sizeof(buffer))
+		return false;
+	for (int i = 0; i < 8; i++)
+		state[i] = ((uint32_t) context[4 * i] << 24) | ((uint32_t) context[4 * i + 1] << 16) | ((uint32_t) context[4 * i + 2] << 8) | context[4 * i + 3];
+	blocks = 0;
+	for (int i = 0; i < 4; i++)
+		blocks |= (uint32_t) context[32 + i] << (8 * i);
+	bufferLength = length - ATECC_SOFT_SHA_CONTEXT_MIN_SIZE;
+	memcpy(buffer, &context[ATECC_SOFT_SHA_CONTEXT_MIN_SIZE], bufferLength);
+	return true;
+}
+
+
+/* AES-128 (FIPS 197) */
+
+static const uint8_t aesSbox[256] = {
+	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+	0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+	0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+	0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+	0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+	0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+	0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+	0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+	0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+	0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+	0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+	0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+	0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+	0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+	0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+	0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+// multiplication in GF(2^8) with the AES polynomial
+static uint8_t gmul(uint8_t a, uint8_t b)
+{
+	uint8_t product = 0;
+
+	while (b)
+	{
+		if (b & 1)
+			product ^= a;
+		a = (a << 1) ^ ((a & 0x80) ? 0x1b : 0x00);
+		b >>= 1;
+	}
+	return product;
+}
+
+static uint8_t aesInverseSbox(uint8_t value)
+{
+	static uint8_t inverse[256];
+	static boolean initialized = false;
+
+	if (!initialized)
+	{
+		for (int i = 0; i < 256; i++)
+			inverse[aesSbox[i]] = i;
+		initialized = true;
+	}
+	return inverse[value];
+}
+
+void ATECCSoftAES128::expandKey(const uint8_t *key, uint8_t *roundKeys)
+{
+	uint8_t rcon = 0x01;
+
+	memcpy(roundKeys, key, 16);
+	for (int i = 16; i < 176; i += 4)
+	{
+		uint8_t t[4] = { roundKeys[i - 4], roundKeys[i - 3], roundKeys[i - 2], roundKeys[i - 1] };
+
+		if (i % 16 == 0)
+		{
+			// RotWord, SubWord, Rcon
+			uint8_t first = t[0];
+			t[0] = aesSbox[t[1]] ^ rcon;
+			t[1] = aesSbox[t[2]];
+			t[2] = aesSbox[t[3]];
+			t[3] = aesSbox[first];
+			rcon = gmul(rcon, 2);
+		}
+		for (int j = 0; j < 4; j++)
+			roundKeys[i + j] = roundKeys[i - 16 + j] ^ t[j];
+	}
+}
+
+void ATECCSoftAES128::encrypt(const uint8_t *key, const uint8_t *input, uint8_t *output)
+{
+	uint8_t roundKeys[176];
+	uint8_t s[16], t[16];
+
+	expandKey(key, roundKeys);
+	for (int i = 0; i < 16; i++)
+		s[i] = input[i] ^ roundKeys[i];
+	for (int round = 1; round <= 10; round++)
+	{
+		// SubBytes and ShiftRows (byte i is row i % 4 of column i / 4)
+		for (int i = 0; i < 16; i++)
+			t[i] = aesSbox[s[(i + 4 * (i % 4)) % 16]];
+		if (round < 10)
+		{
+			// MixColumns
+			for (int c = 0; c < 16; c += 4)
+			{
+				uint8_t a0 = t[c], a1 = t[c + 1], a2 = t[c + 2], a3 = t[c + 3];
+				t[c]     = gmul(a0, 2) ^ gmul(a1, 3) ^ a2 ^ a3;
+				t[c + 1] = a0 ^ gmul(a1, 2) ^ gmul(a2, 3) ^ a3;
+				t[c + 2] = a0 ^ a1 ^ gmul(a2, 2) ^ gmul(a3, 3);
+				t[c + 3] = gmul(a0, 3) ^ a1 ^ a2 ^ gmul(a3, 2);
+			}
+		}
+		for (int i = 0; i < 16; i++)
+			s[i] = t[i] ^ roundKeys[16 * round + i];
+	}
+	memcpy(output, s, 16);
+}
+
+void ATECCSoftAES128::decrypt(const uint8_t *key, const uint8_t *input, uint8_t *output)
+{
+	uint8_t roundKeys[176];
+	uint8_t s[16], t[16];
+
+	expandKey(key, roundKeys);
+	for (int i = 0; i < 16; i++)
+		s[i] = input[i] ^ roundKeys[160 + i];
+	for (int round = 9; round >= 0; round--)
+	{
+		// InvShiftRows and InvSubBytes
+		for (int i = 0; i < 16; i++)
+			t[(i + 4 * (i % 4)) % 16] = aesInverseSbox(s[i]);
+		for (int i = 0; i < 16; i++)
+			t[i] ^= roundKeys[16 * round + i];
+		if (round > 0)
+		{
+			// InvMixColumns
+			for (int c = 0; c < 16; c += 4)
+			{
+				uint8_t a0 = t[c], a1 = t[c + 1], a2 = t[c + 2], a3 = t[c + 3];
+				t[c]     = gmul(a0, 14) ^ gmul(a1, 11) ^ gmul(a2, 13) ^ gmul(a3, 9);
+				t[c + 1] = gmul(a0, 9) ^ gmul(a1, 14) ^ gmul(a2, 11) ^ gmul(a3, 13);
+				t[c + 2] = gmul(a0, 13) ^ gmul(a1, 9) ^ gmul(a2, 14) ^ gmul(a3, 11);
+				t[c + 3] = gmul(a0, 11) ^ gmul(a1, 13) ^ gmul(a2, 9) ^ gmul(a3, 14);
+			}
+		}
+		memcpy(s, t, 16);
+	}
+	memcpy(output, s, 16);
+}
+
+
+/*
+  ECDSA P-256 (FIPS 186-4). Numbers are 8 little endian 32 bit words. The field and the group order
+  use Montgomery multiplication, points Jacobian coordinates in the Montgomery domain of the field.
+*/
+
+typedef uint32_t Number[8];
+
+typedef struct
+{
+	Number   modulus;
+	Number   rr;        // R^2 mod modulus, R = 2^256
+	uint32_t n0;        // -modulus^-1 mod 2^32
+} Modulus;
+
+typedef struct
+{
+	Number x, y, z;     // z = 0 is the point at infinity
+} Point;
+
+static const uint8_t curvePrime[32] = {
+	0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+static const uint8_t curveOrder[32] = {
+	0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xbc, 0xe6, 0xfa, 0xad, 0xa7, 0x17, 0x9e, 0x84, 0xf3, 0xb9, 0xca, 0xc2, 0xfc, 0x63, 0x25, 0x51,
+};
+static const uint8_t curveB[32] = {
+	0x5a, 0xc6, 0x35, 0xd8, 0xaa, 0x3a, 0x93, 0xe7, 0xb3, 0xeb, 0xbd, 0x55, 0x76, 0x98, 0x86, 0xbc,
+	0x65, 0x1d, 0x06, 0xb0, 0xcc, 0x53, 0xb0, 0xf6, 0x3b, 0xce, 0x3c, 0x3e, 0x27, 0xd2, 0x60, 0x4b,
+};
+static const uint8_t curveGx[32] = {
+	0x6b, 0x17, 0xd1, 0xf2, 0xe1, 0x2c, 0x42, 0x47, 0xf8, 0xbc, 0xe6, 0xe5, 0x63, 0xa4, 0x40, 0xf2,
+	0x77, 0x03, 0x7d, 0x81, 0x2d, 0xeb, 0x33, 0xa0, 0xf4, 0xa1, 0x39, 0x45, 0xd8, 0x98, 0xc2, 0x96,
+};
+static const uint8_t curveGy[32] = {
+	0x4f, 0xe3, 0x42, 0xe2, 0xfe, 0x1a, 0x7f, 0x9b, 0x8e, 0xe7, 0xeb, 0x4a, 0x7c, 0x0f, 0x9e, 0x16,
+	0x2b, 0xce, 0x33, 0x57, 0x6b, 0x31, 0x5e, 0xce, 0xcb, 0xb6, 0x40, 0x68, 0x37, 0xbf, 0x51, 0xf5,
+};
+
+static void numberFromBytes(Number r, const uint8_t *bytes)
+{
+	for (int i = 0; i < 8; i++)
+		r[i] = ((uint32_t) bytes[28 - 4 * i] << 24) | ((uint32_t) bytes[29 - 4 * i] << 16) | ((uint32_t) bytes[30 - 4 * i] << 8) | bytes[31 - 4 * i];
+}
+
+static void numberToBytes(uint8_t *bytes, const Number a)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		bytes[28 - 4 * i] = a[i] >> 24;
+		bytes[29 - 4 * i] = a[i] >> 16;
+		bytes[30 - 4 * i] = a[i] >> 8;
+		bytes[31 - 4 * i] = a[i];
+	}
+}
+
+static void numberSet(Number r, uint32_t value)
+{
+	memset(r, 0, sizeof(Number));
+	r[0] = value;
+}
+
+static boolean numberIsZero(const Number a)
+{
+	uint32_t bits = 0;
+
+	for (int i = 0; i < 8; i++)
+		bits |= a[i];
+	return bits == 0;
+}
+
+static int numberCompare(const Number a, const Number b)
+{
+	for (int i = 7; i >= 0; i--)
+	{
+		if (a[i] != b[i])
+			return (a[i] > b[i]) ? 1 : -1;
+	}
+	return 0;
+}
+
+static uint32_t numberAdd(Number r, const Number a, const Number b)
+{
+	uint64_t carry = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		carry += (uint64_t) a[i] + b[i];
+		r[i] = (uint32_t) carry;
+		carry >>= 32;
+	}
+	return (uint32_t) carry;
+}
+
+static uint32_t numberSub(Number r, const Number a, const Number b)
+{
+	int64_t borrow = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		borrow += (int64_t) a[i] - b[i];
+		r[i] = (uint32_t) borrow;
+		borrow = (borrow < 0) ? -1 : 0;
+	}
+	return (uint32_t) -borrow;
+}
+
+static void modAdd(Number r, const Number a, const Number b, const Modulus &m)
+{
+	if (numberAdd(r, a, b) != 0 || numberCompare(r, m.modulus) >= 0)
+		numberSub(r, r, m.modulus);
+}
+
+static void modSub(Number r, const Number a, const Number b, const Modulus &m)
+{
+	if (numberSub(r, a, b) != 0)
+		numberAdd(r, r, m.modulus);
+}
+
+// r = a * b * R^-1 mod m (CIOS)
+static void modMul(Number r, const Number a, const Number b, const Modulus &m)
+{
+	uint32_t t[10] = { 0 };
+
+	for (int i = 0; i < 8; i++)
+	{
+		uint64_t carry = 0;
+		uint32_t q;
+
+		for (int j = 0; j < 8; j++)
+		{
+			carry += (uint64_t) t[j] + (uint64_t) a[j] * b[i];
+			t[j] = (uint32_t) carry;
+			carry >>= 32;
+		}
+		carry += t[8];
+		t[8] = (uint32_t) carry;
+		t[9] = (uint32_t) (carry >> 32);
+
+		q = t[0] * m.n0;
+		carry = (uint64_t) t[0] + (uint64_t) q * m.modulus[0];
+		carry >>= 32;
+		for (int j = 1; j < 8; j++)
+		{
+			carry += (uint64_t) t[j] + (uint64_t) q * m.modulus[j];
+			t[j - 1] = (uint32_t) carry;
+			carry >>= 32;
+		}
+		carry += t[8];
+		t[7] = (uint32_t) carry;
+		t[8] = t[9] + (uint32_t) (carry >> 32);
+	}
+	if (t[8] != 0 || numberCompare(t, m.modulus) >= 0)
+		numberSub(t, t, m.modulus);
+	memcpy(r, t, sizeof(Number));
+}
+
+static void modInit(Modulus &m, const uint8_t *modulus)
+{
+	uint32_t inverse = 1;
+
+	numberFromBytes(m.modulus, modulus);
+	// Newton iteration for modulus^-1 mod 2^32
+	for (int i = 0; i < 5; i++)
+		inverse *= 2 - m.modulus[0] * inverse;
+	m.n0 = -inverse;
+	// R^2 mod m by doubling 1 512 times
+	numberSet(m.rr, 1);
+	for (int i = 0; i < 512; i++)
+		modAdd(m.rr, m.rr, m.rr, m);
+}
+
+static void toMontgomery(Number r, const Number a, const Modulus &m)
+{
+	modMul(r, a, m.rr, m);
+}
+
+static void fromMontgomery(Number r, const Number a, const Modulus &m)
+{
+	Number one;
+
+	numberSet(one, 1);
+	modMul(r, a, one, m);
+}
+
+// r = a^-1 (a and r in the Montgomery domain), a^(m - 2) as m is prime
+static void modInverse(Number r, const Number a, const Modulus &m)
+{
+	Number exponent, two, result;
+
+	numberSet(two, 2);
+	numberSub(exponent, m.modulus, two);
+	numberSet(result, 1);
+	toMontgomery(result, result, m);
+	for (int i = 255; i >= 0; i--)
+	{
+		modMul(result, result, result, m);
+		if ((exponent[i / 32] >> (i % 32)) & 1)
+			modMul(result, result, a, m);
+	}
+	memcpy(r, result, sizeof(Number));
+}
+
+// a * b mod m for numbers outside of the Montgomery domain
+static void modMulPlain(Number r, const Number a, const Number b, const Modulus &m)
+{
+	modMul(r, a, b, m);
+	modMul(r, r, m.rr, m);
+}
+
+static void modInversePlain(Number r, const Number a, const Modulus &m)
+{
+	toMontgomery(r, a, m);
+	modInverse(r, r, m);
+	fromMontgomery(r, r, m);
+}
+
+typedef struct
+{
+	Modulus field;
+	Modulus order;
+	Number  b;          // Montgomery domain
+	Point   g;          // Montgomery domain
+} Curve;
+
+static const Curve &curve()
+{
+	static Curve c;
+	static boolean initialized = false;
+
+	if (!initialized)
+	{
+		modInit(c.field, curvePrime);
+		modInit(c.order, curveOrder);
+		numberFromBytes(c.b, curveB);
+		toMontgomery(c.b, c.b, c.field);
+		numberFromBytes(c.g.x, curveGx);
+		numberFromBytes(c.g.y, curveGy);
+		toMontgomery(c.g.x, c.g.x, c.field);
+		toMontgomery(c.g.y, c.g.y, c.field);
+		numberSet(c.g.z, 1);
+		toMontgomery(c.g.z, c.g.z, c.field);
+		initialized = true;
+	}
+	return c;
+}
+
+// dbl-2001-b, a = -3
+static void pointDouble(Point &r, const Point &p)
+{
+	const Modulus &f = curve().field;
+	Number delta, gamma, beta, alpha, t1, t2;
+
+	if (numberIsZero(p.z) || numberIsZero(p.y))
+	{
+		memset(&r, 0, sizeof(r));
+		return;
+	}
+	modMul(delta, p.z, p.z, f);
+	modMul(gamma, p.y, p.y, f);
+	modMul(beta, p.x, gamma, f);
+	modSub(t1, p.x, delta, f);
+	modAdd(t2, p.x, delta, f);
+	modMul(alpha, t1, t2, f);
+	modAdd(t1, alpha, alpha, f);
+	modAdd(alpha, t1, alpha, f);
+	// Z3 = (Y + Z)^2 - gamma - delta, before X and Y are overwritten
+	modAdd(t1, p.y, p.z, f);
+	modMul(t1, t1, t1, f);
+	modSub(t1, t1, gamma, f);
+	modSub(r.z, t1, delta, f);
+	// X3 = alpha^2 - 8 beta
+	modAdd(beta, beta, beta, f);
+	modAdd(beta, beta, beta, f);    // 4 beta
+	modAdd(t2, beta, beta, f);      // 8 beta
+	modMul(t1, alpha, alpha, f);
+	modSub(r.x, t1, t2, f);
+	// Y3 = alpha (4 beta - X3) - 8 gamma^2
+	modSub(t1, beta, r.x, f);
+	modMul(t1, alpha, t1, f);
+	modMul(gamma, gamma, gamma, f);
+	modAdd(gamma, gamma, gamma, f);
+	modAdd(gamma, gamma, gamma, f);
+	modAdd(gamma, gamma, gamma, f);
+	modSub(r.y, t1, gamma, f);
+}
+
+// add-2007-bl
+static void pointAdd(Point &r, const Point &p, const Point &q)
+{
+	const Modulus &f = curve().field;
+	Number z1z1, z2z2, u1, u2, s1, s2, h, i, j, rr, v, t;
+
+	if (numberIsZero(p.z))
+	{
+		r = q;
+		return;
+	}
+	if (numberIsZero(q.z))
+	{
+		r = p;
+		return;
+	}
+	modMul(z1z1, p.z, p.z, f);
+	modMul(z2z2, q.z, q.z, f);
+	modMul(u1, p.x, z2z2, f);
+	modMul(u2, q.x, z1z1, f);
+	modMul(s1, p.y, q.z, f);
+	modMul(s1, s1, z2z2, f);
+	modMul(s2, q.y, p.z, f);
+	modMul(s2, s2, z1z1, f);
+	modSub(h, u2, u1, f);
+	modSub(rr, s2, s1, f);
+	if (numberIsZero(h))
+	{
+		if (numberIsZero(rr))
+			pointDouble(r, p);
+		else
+			memset(&r, 0, sizeof(r));
+		return;
+	}
+	modAdd(rr, rr, rr, f);
+	modAdd(i, h, h, f);
+	modMul(i, i, i, f);
+	modMul(j, h, i, f);
+	modMul(v, u1, i, f);
+	// Z3 = ((Z1 + Z2)^2 - Z1Z1 - Z2Z2) H
+	modAdd(t, p.z, q.z, f);
+	modMul(t, t, t, f);
+	modSub(t, t, z1z1, f);
+	modSub(t, t, z2z2, f);
+	modMul(r.z, t, h, f);
+	// X3 = r^2 - J - 2 V
+	modMul(t, rr, rr, f);
+	modSub(t, t, j, f);
+	modSub(t, t, v, f);
+	modSub(r.x, t, v, f);
+	// Y3 = r (V - X3) - 2 S1 J
+	modSub(t, v, r.x, f);
+	modMul(t, rr, t, f);
+	modMul(s1, s1, j, f);
+	modAdd(s1, s1, s1, f);
+	modSub(r.y, t, s1, f);
+}
+
+static void pointMultiply(Point &r, const Number k, const Point &p)
+{
+	Point result;
+
+	memset(&result, 0, sizeof(result));
+	for (int i = 255; i >= 0; i--)
+	{
+		pointDouble(result, result);
+		if ((k[i / 32] >> (i % 32)) & 1)
+			pointAdd(result, result, p);
+	}
+	r = result;
+}
+
+// affine coordinates outside of the Montgomery domain, false for the point at infinity
+static boolean pointToAffine(Number x, Number y, const Point &p)
+{
+	const Modulus &f = curve().field;
+	Number zInverse, t;
+
+	if (numberIsZero(p.z))
+		return false;
+	modInverse(zInverse, p.z, f);
+	modMul(t, zInverse, zInverse, f);
+	modMul(x, p.x, t, f);
+	modMul(t, t, zInverse, f);
+	modMul(y, p.y, t, f);
+	fromMontgomery(x, x, f);
+	fromMontgomery(y, y, f);
+	return true;
+}
+
+static boolean pointFromBytes(Point &p, const uint8_t *publicKey)
+{
+	const Curve &c = curve();
+	Number lhs, rhs, t;
+
+	numberFromBytes(p.x, publicKey);
+	numberFromBytes(p.y, publicKey + 32);
+	if (numberCompare(p.x, c.field.modulus) >= 0 || numberCompare(p.y, c.field.modulus) >= 0)
+		return false;
+	toMontgomery(p.x, p.x, c.field);
+	toMontgomery(p.y, p.y, c.field);
+	numberSet(p.z, 1);
+	toMontgomery(p.z, p.z, c.field);
+	// y^2 = x^3 - 3x + b
+	modMul(lhs, p.y, p.y, c.field);
+	modMul(rhs, p.x, p.x, c.field);
+	modMul(rhs, rhs, p.x, c.field);
+	modAdd(t, p.x, p.x, c.field);
+	modAdd(t, t, p.x, c.field);
+	modSub(rhs, rhs, t, c.field);
+	modAdd(rhs, rhs, c.b, c.field);
+	return numberCompare(lhs, rhs) == 0;
+}
+
+// 0 < value < n
+static boolean inOrderRange(const Number value)
+{
+	return !numberIsZero(value) && numberCompare(value, curve().order.modulus) < 0;
+}
+
+// digest as a number mod n (it has as many bits as n, so one subtraction is enough)
+static void digestToNumber(Number e, const uint8_t *digest)
+{
+	numberFromBytes(e, digest);
+	if (numberCompare(e, curve().order.modulus) >= 0)
+		numberSub(e, e, curve().order.modulus);
+}
+
+boolean ATECCSoftP256::isValidPrivateKey(const uint8_t *privateKey)
+{
+	Number d;
+
+	numberFromBytes(d, privateKey);
+	return inOrderRange(d);
+}
+
+boolean ATECCSoftP256::isValidPublicKey(const uint8_t *publicKey)
+{
+	Point q;
+
+	return pointFromBytes(q, publicKey);
+}
+
+boolean ATECCSoftP256::publicKey(const uint8_t *privateKey, uint8_t *publicKey)
+{
+	Number d, x, y;
+	Point  q;
+
+	numberFromBytes(d, privateKey);
+	if (!inOrderRange(d))
+		return false;
+	pointMultiply(q, d, curve().g);
+	if (!pointToAffine(x, y, q))
+		return false;
+	numberToBytes(publicKey, x);
+	numberToBytes(publicKey + 32, y);
+	return true;
+}
+
+boolean ATECCSoftP256::sign(const uint8_t *privateKey, const uint8_t *digest, const uint8_t *nonce, uint8_t *signature)
+{
+	const Modulus &n = curve().order;
+	Number d, k, e, r, s, y;
+	Point  p;
+
+	numberFromBytes(d, privateKey);
+	numberFromBytes(k, nonce);
+	if (!inOrderRange(d) || !inOrderRange(k))
+		return false;
+	digestToNumber(e, digest);
+	// r = x(kG) mod n
+	pointMultiply(p, k, curve().g);
+	if (!pointToAffine(r, y, p))
+		return false;
+	if (numberCompare(r, n.modulus) >= 0)
+		numberSub(r, r, n.modulus);
+	if (numberIsZero(r))
+		return false;
+	// s = k^-1 (e + r d) mod n
+	modMulPlain(s, r, d, n);
+	modAdd(s, s, e, n);
+	modInversePlain(k, k, n);
+	modMulPlain(s, s, k, n);
+	if (numberIsZero(s))
+		return false;
+	numberToBytes(signature, r);
+	numberToBytes(signature + 32, s);
+	return true;
+}
+
+boolean ATECCSoftP256::verify(const uint8_t *publicKey, const uint8_t *digest, const uint8_t *signature)
+{
+	const Modulus &n = curve().order;
+	Number r, s, e, w, u1, u2, x, y;
+	Point  q, p1, p2;
+
+	numberFromBytes(r, signature);
+	numberFromBytes(s, signature + 32);
+	if (!inOrderRange(r) || !inOrderRange(s) || !pointFromBytes(q, publicKey))
+		return false;
+	digestToNumber(e, digest);
+	modInversePlain(w, s, n);
+	modMulPlain(u1, e, w, n);
+	modMulPlain(u2, r, w, n);
+	pointMultiply(p1, u1, curve().g);
+	pointMultiply(p2, u2, q);
+	pointAdd(p1, p1, p2);
+	if (!pointToAffine(x, y, p1))
+		return false;
+	if (numberCompare(x, n.modulus) >= 0)
+		numberSub(x, x, n.modulus);
+	return numberCompare(x, r) == 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Arduino.h"
+
+
+/*
+  Software crypto of the emulator: SHA-256, AES-128 and ECDSA P-256. Straightforward implementations
+  for the host, neither fast nor hardened against side channels. Don't use them for real keys.
+*/
+
+class ATECCSoftSha256
+{
+  public:
+	  ATECCSoftSha256();
+		void    begin();
+		void    update(const uint8_t *data, size_t length);
+		void    end(uint8_t *digest);
+		static void hash(const uint8_t *data, size_t length, uint8_t *digest);
+
+		// the context (state, number of blocks, unprocessed bytes) as bytes, for the SHA context commands
+		size_t  saveContext(uint8_t *context);
+		boolean restoreContext(const uint8_t *context, size_t length);
+
+	private:
+	  static void compress(uint32_t *state, const uint8_t *block);
+
+		uint32_t state[8];
+		uint32_t blocks;        // 64 byte blocks compressed so far
+		uint8_t  buffer[64];
+		uint8_t  bufferLength;
+};
+
+#define ATECC_SOFT_SHA_CONTEXT_MIN_SIZE 36  // state and block count, followed by up to 63 unprocessed bytes
+
+
+class ATECCSoftAES128
+{
+  public:
+	  static void encrypt(const uint8_t *key, const uint8_t *input, uint8_t *output);
+		static void decrypt(const uint8_t *key, const uint8_t *input, uint8_t *output);
+
+	private:
+	  static void expandKey(const uint8_t *key, uint8_t *roundKeys);
+};
+
+
+// numbers are 32 bytes big endian, public keys X || Y (64 bytes), signatures R || S (64 bytes) as on the IC
+class ATECCSoftP256
+{
+  public:
+	  static boolean isValidPrivateKey(const uint8_t *privateKey);
+		static boolean isValidPublicKey(const uint8_t *publicKey);
+		static boolean publicKey(const uint8_t *privateKey, uint8_t *publicKey);
+		static boolean sign(const uint8_t *privateKey, const uint8_t *digest, const uint8_t *nonce, uint8_t *signature);
+		static boolean verify(const uint8_t *publicKey, const uint8_t *digest, const uint8_t *signature);
+};
@@ -0,0 +1,110 @@
+#include "ATECCEmulatorImageFile.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+ATECCEmulatorImageFile::ATECCEmulatorImageFile()
+{
+}
+
+ATECCEmulatorImageFile::~ATECCEmulatorImageFile()
+{
+	close();
+}
+
+/** \brief
+
+	create(const char *path, uint8_t model, uint8_t address, const uint8_t *serialNumber, uint32_t seed)
+
+	Creates (or overwrites) the file path with the image of a fresh IC (see ATECCEmulator::initImage())
+	and maps it. Returns false if the file can't be created or mapped.
+*/
+
+boolean ATECCEmulatorImageFile::create(const char *path, uint8_t model, uint8_t address, const uint8_t *serialNumber, uint32_t seed)
+{
+	int fd;
+
+	close();
+	fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return false;
+	if (ftruncate(fd, sizeof(ATECCEmulatorImage)) != 0 || !map(fd, false))
+	{
+		::close(fd);
+		return false;
+	}
+	::close(fd);   // the mapping stays
+	ATECCEmulator::initImage(*image, model, address, serialNumber, seed);
+	return sync();
+}
+
+/** \brief
+
+	open(const char *path, boolean readOnly)
+
+	Maps the image in the file path. Returns false if the file can't be mapped, has the wrong size
+	or isn't a valid image (ATECCEmulator::checkImage()).
+	A read only image must not be attached to an emulator, it's for inspecting the file.
+*/
+
+boolean ATECCEmulatorImageFile::open(const char *path, boolean readOnly)
+{
+	int fd;
+	struct stat status;
+
+	close();
+	fd = ::open(path, readOnly ? O_RDONLY : O_RDWR);
+	if (fd < 0)
+		return false;
+	if (fstat(fd, &status) != 0 || status.st_size != sizeof(ATECCEmulatorImage) || !map(fd, readOnly))
+	{
+		::close(fd);
+		return false;
+	}
+	::close(fd);
+	if (!ATECCEmulator::checkImage(*image))
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+boolean ATECCEmulatorImageFile::map(int fd, boolean readOnly)
+{
+	void *memory = mmap(NULL, sizeof(ATECCEmulatorImage), readOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if (memory == MAP_FAILED)
+		return false;
+	image = (ATECCEmulatorImage *) memory;
+	this->readOnly = readOnly;
+	return true;
+}
+
+// writes the changes to the file now, otherwise the kernel does it when it likes (or at close())
+boolean ATECCEmulatorImageFile::sync()
+{
+	if (image == NULL)
+		return false;
+	if (readOnly)
+		return true;
+	return msync(image, sizeof(ATECCEmulatorImage), MS_SYNC) == 0;
+}
+
+void ATECCEmulatorImageFile::close()
+{
+	if (image == NULL)
+		return;
+	sync();
+	munmap(image, sizeof(ATECCEmulatorImage));
+	image = NULL;
+}
+
+// the mapped image, NULL if no file is open
+ATECCEmulatorImage *ATECCEmulatorImageFile::getImage()
+{
+	return image;
+}
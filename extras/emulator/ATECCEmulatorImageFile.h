@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ATECCEmulator.h"
+
+
+/*
+  An ATECCEmulatorImage in a file, mapped into memory (POSIX mmap, shared), so the emulator starts
+  without loading anything and every change of the emulated IC goes straight to the file:
+
+    ATECCEmulatorImageFile file;
+    ATECCEmulator chip;
+    if (!file.open("device.img") && !file.create("device.img", ATECC_MODEL_608A))
+      ...
+    chip.attach(file.getImage());
+    ...
+    file.close();                    // after the emulator is done with it
+
+  The file is the image as it is (sizeof(ATECCEmulatorImage) bytes), see extras/tools/atecc_image.cpp
+  to create, inspect and compare them.
+*/
+
+class ATECCEmulatorImageFile
+{
+  public:
+	  ATECCEmulatorImageFile();
+		~ATECCEmulatorImageFile();
+
+		boolean create(const char *path, uint8_t model, uint8_t address = ATECC508A_ADDRESS_DEFAULT,
+		               const uint8_t *serialNumber = NULL, uint32_t seed = 1);
+		boolean open(const char *path, boolean readOnly = false);
+		boolean sync();
+		void    close();
+		ATECCEmulatorImage *getImage();
+
+	private:
+	  boolean map(int fd, boolean readOnly);
+
+		ATECCEmulatorImage *image = NULL;
+		boolean  readOnly = false;
+};
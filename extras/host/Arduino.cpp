@@ -0,0 +1,102 @@
+#include "Arduino.h"
+#include "Wire.h"
+
+#include <stdio.h>
+#include <time.h>
+
+HostSerial Serial;
+TwoWire Wire;
+
+
+static unsigned long long monotonicMicros()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long) now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+static const unsigned long long startMicros = monotonicMicros();
+
+unsigned long micros()
+{
+	return (unsigned long) (monotonicMicros() - startMicros);
+}
+
+unsigned long millis()
+{
+	return (unsigned long) ((monotonicMicros() - startMicros) / 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	struct timespec duration = { (time_t) (us / 1000000), (long) (us % 1000000) * 1000 };
+
+	nanosleep(&duration, NULL);
+}
+
+void delay(unsigned long ms)
+{
+	struct timespec duration = { (time_t) (ms / 1000), (long) (ms % 1000) * 1000000 };
+
+	nanosleep(&duration, NULL);
+}
+
+
+std::string String::format(unsigned long value, unsigned char base)
+{
+	char digits[8 * sizeof(long) + 1];
+	int  i = sizeof(digits) - 1;
+
+	if (base < 2)
+		base = DEC;
+	digits[i] = '\0';
+	do
+	{
+		digits[--i] = "0123456789ABCDEF"[value % base];
+		value /= base;
+	} while (value > 0);
+	return std::string(&digits[i]);
+}
+
+std::string String::format(long value, unsigned char base)
+{
+	// like Arduino, only decimal numbers get a sign
+	if (value < 0 && base == DEC)
+		return "-" + format((unsigned long) -value, base);
+	return format((unsigned long) value, base);
+}
+
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+	size_t n = 0;
+
+	while (n < size && write(buffer[n]) == 1)
+		n++;
+	return n;
+}
+
+size_t Print::print(double value, int digits)
+{
+	char text[64];
+
+	snprintf(text, sizeof(text), "%.*f", digits, value);
+	return write(text);
+}
+
+
+size_t HostSerial::write(uint8_t c)
+{
+	return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HostSerial::write(const uint8_t *buffer, size_t size)
+{
+	return fwrite(buffer, 1, size, stdout);
+}
+
+void HostSerial::flush()
+{
+	fflush(stdout);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+/*
+  Minimal Arduino core for host builds of the library (tests, the emulator, benchmarks on Linux).
+  Only what the library and the host tools use: integer types, the time functions,
+  String, Print/Stream and Serial (stdout). Wire is in Wire.h.
+
+  Build with -DARDUINO=10810 -Iextras/host and link extras/host/Arduino.cpp.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+
+void          delay(unsigned long ms);
+void          delayMicroseconds(unsigned int us);
+unsigned long millis();
+unsigned long micros();
+
+
+class String
+{
+  public:
+	  String(const char *text = "") : text(text != NULL ? text : "") {}
+		String(char c) : text(1, c) {}
+		String(int value, unsigned char base = DEC) : text(format((long) value, base)) {}
+		String(unsigned int value, unsigned char base = DEC) : text(format((unsigned long) value, base)) {}
+		String(long value, unsigned char base = DEC) : text(format(value, base)) {}
+		String(unsigned long value, unsigned char base = DEC) : text(format(value, base)) {}
+
+		String operator+(const String &other) const { return String((text + other.text).c_str()); }
+		String &operator+=(const String &other) { text += other.text; return *this; }
+		bool operator==(const String &other) const { return text == other.text; }
+		const char *c_str() const { return text.c_str(); }
+		unsigned int length() const { return text.length(); }
+
+	private:
+	  static std::string format(unsigned long value, unsigned char base);
+		static std::string format(long value, unsigned char base);
+
+		std::string text;
+};
+
+inline String operator+(const char *left, const String &right)
+{
+	return String(left) + right;
+}
+
+
+class Print
+{
+  public:
+	  virtual ~Print() {}
+		virtual size_t write(uint8_t c) = 0;
+		virtual size_t write(const uint8_t *buffer, size_t size);
+		size_t write(const char *text) { return write((const uint8_t *) text, strlen(text)); }
+
+		size_t print(const char *text) { return write(text); }
+		size_t print(const String &text) { return write(text.c_str()); }
+		size_t print(char c) { return write((uint8_t) c); }
+		size_t print(unsigned char value, int base = DEC) { return print((unsigned long) value, base); }
+		size_t print(int value, int base = DEC) { return print((long) value, base); }
+		size_t print(unsigned int value, int base = DEC) { return print((unsigned long) value, base); }
+		size_t print(long value, int base = DEC) { return print(String(value, base)); }
+		size_t print(unsigned long value, int base = DEC) { return print(String(value, base)); }
+		size_t print(double value, int digits = 2);
+
+		size_t println() { return write("\r\n"); }
+		template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+		template <typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+		virtual void flush() {}
+};
+
+
+class Stream : public Print
+{
+  public:
+	  virtual int available() { return 0; }
+		virtual int read() { return -1; }
+		virtual int peek() { return -1; }
+};
+
+
+// Serial of the host build, writes to stdout and never has input
+class HostSerial : public Stream
+{
+  public:
+	  using Print::write;
+		void   begin(unsigned long /* baud */) {}
+		size_t write(uint8_t c);
+		size_t write(const uint8_t *buffer, size_t size);
+		void   flush();
+		operator bool() { return true; }
+};
+
+extern HostSerial Serial;
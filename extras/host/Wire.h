@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Arduino.h"
+
+/*
+  TwoWire of the host build. There is no bus: transmissions are NACKed and nothing can be read.
+  On the host the IC is accessed through an ATECCTransport (ATECCLinuxTransport, ATECCMockTransport
+  or the emulator in extras/emulator), Wire only has to exist for ATECCX08A::begin(i2caddr, wirePort).
+*/
+
+class TwoWire : public Stream
+{
+  public:
+	  void    begin() {}
+		void    setClock(uint32_t /* frequency */) {}
+		void    beginTransmission(uint8_t /* address */) {}
+		uint8_t endTransmission(bool /* sendStop */ = true) { return 2; }  // address NACK
+		uint8_t requestFrom(uint8_t /* address */, uint8_t /* quantity */) { return 0; }
+		size_t  write(uint8_t /* data */) { return 1; }
+		size_t  write(const uint8_t * /* data */, size_t quantity) { return quantity; }
+		int     available() { return 0; }
+		int     read() { return -1; }
+};
+
+extern TwoWire Wire;
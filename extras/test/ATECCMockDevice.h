@@ -0,0 +1,108 @@
+#pragma once
+
+#include "SparkFun_ATECCX08a_Arduino_Library.h"
+
+
+/*
+  A small scripted IC for the tests on ATECCMockTransport, where the emulator would hide what a
+  test wants to see (the frames, NACKs, short reads, broken responses):
+
+    ATECCMockDevice device;
+    ATECCMockTransport mock;
+    mock.setHandler(mockDeviceHandler, &device);
+    atecc.begin(mock);
+
+  It answers Info (ATECC608A), Read and Write of the configuration zone and the first 72 bytes of
+  every slot, Random (0x00, 0x01, ... plus a counter) and KDF into a slot (the first 32 bytes of the
+  target slot become the KDF count); every other command gets the status in device.status.
+  Both zones are locked and all slots are clear read/write, so their blocks can be cached.
+  With device.respond = false the handler doesn't answer at all, device.nacks lets the reads after
+  every command fail a number of times.
+*/
+
+#define MOCK_DEVICE_SLOT_SIZE 72
+
+struct ATECCMockDevice
+{
+	uint8_t  configZone[CONFIG_ZONE_SIZE] = {};
+	uint8_t  slots[16][MOCK_DEVICE_SLOT_SIZE] = {};
+	uint8_t  status = STATUS_SUCCESS;
+	boolean  respond = true;
+	unsigned int nacks = 0;             // reads NACKed after every command, like a busy IC
+	unsigned long commands[128] = {};   // per opcode
+	uint8_t  kdfCount = 0;
+
+	ATECCMockDevice()
+	{
+		configZone[CONFIG_ZONE_OTP_LOCK] = 0x00;     // data and OTP locked
+		configZone[CONFIG_ZONE_LOCK_STATUS] = 0x00;  // configuration locked
+		configZone[CONFIG_ZONE_SLOTS_LOCK0] = 0xFF;
+		configZone[CONFIG_ZONE_SLOTS_LOCK1] = 0xFF;
+	}
+};
+
+// word or block of the Read/Write address in param2
+inline uint8_t *mockDeviceMemory(ATECCMockDevice &device, uint8_t zone, uint16_t address, int size)
+{
+	int offset = (size == 32) ? 0 : (address & 0x07) * 4;
+
+	if ((zone & 0x03) == ZONE_CONFIG)
+		return &device.configZone[((address >> 3) & 0x03) * 32 + offset];
+	offset += ((address >> 8) & 0x0F) * 32;
+	if ((zone & 0x03) != ZONE_DATA || offset + size > MOCK_DEVICE_SLOT_SIZE)
+		return NULL;
+	return &device.slots[(address >> 3) & 0x0F][offset];
+}
+
+inline void mockDeviceHandler(ATECCMockTransport *mock, const uint8_t *frame, size_t length, void *context)
+{
+	ATECCMockDevice &device = *(ATECCMockDevice *) context;
+	uint8_t  opcode = frame[2];
+	uint8_t  param1 = frame[3];
+	uint16_t param2 = frame[4] | (frame[5] << 8);
+	const uint8_t *data = &frame[6];
+	int      size = (param1 & 0x80) ? 32 : 4;
+	uint8_t *memory;
+	uint8_t  random[32];
+
+	(void) length;
+	device.commands[opcode & 0x7F]++;
+	mock->setNacks(device.nacks);
+	if (device.respond == false)
+		return;
+	switch (opcode)
+	{
+		case COMMAND_OPCODE_INFO:
+		{
+			const uint8_t revision[] = { 0x00, 0x00, 0x60, 0x02 };
+			mock->queueData(revision, sizeof(revision));
+			return;
+		}
+		case COMMAND_OPCODE_READ:
+			memory = mockDeviceMemory(device, param1, param2, size);
+			if (memory == NULL)
+				break;
+			mock->queueData(memory, size);
+			return;
+		case COMMAND_OPCODE_WRITE:
+			memory = mockDeviceMemory(device, param1, param2, size);
+			if (memory == NULL)
+				break;
+			memcpy(memory, data, size);
+			mock->queueStatus(STATUS_SUCCESS);
+			return;
+		case COMMAND_OPCODE_RANDOM:
+			for (int i = 0; i < 32; i++)
+				random[i] = i + device.commands[COMMAND_OPCODE_RANDOM];
+			mock->queueData(random, sizeof(random));
+			return;
+		case COMMAND_OPCODE_KDF:
+			if ((param1 & KDF_MODE_TARGET_MASK) != KDF_MODE_TARGET_SLOT)
+				break;
+			device.kdfCount++;
+			memset(device.slots[(param2 >> 8) & 0x0F], device.kdfCount, 32);
+			mock->queueStatus(STATUS_SUCCESS);
+			return;
+	}
+	mock->queueStatus(device.status);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdio.h>
+
+
+/*
+  Checks of the host tests (extras/test, run by ctest, see extras/CMakeLists.txt):
+
+    CHECK(atecc.begin(mock) == true);
+    CHECK_EQUAL(STATUS_TIMEOUT_ERROR, atecc.getStatus());
+    ...
+    return testResult();
+
+  A failed check prints the file, the line and the expression and the test goes on,
+  testResult() prints the summary and returns the exit code of the test program.
+*/
+
+inline int testChecks = 0;
+inline int testFailures = 0;
+
+#define CHECK(condition) \
+	do { \
+		testChecks++; \
+		if (!(condition)) \
+		{ \
+			testFailures++; \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+		} \
+	} while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+	do { \
+		long long checkExpected = (long long) (expected); \
+		long long checkActual = (long long) (actual); \
+		testChecks++; \
+		if (checkExpected != checkActual) \
+		{ \
+			testFailures++; \
+			printf("%s:%d: CHECK_EQUAL(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #expected, #actual, checkExpected, checkActual); \
+		} \
+	} while (0)
+
+#define RUN_TEST(test) \
+	do { \
+		printf("%s\n", #test); \
+		test(); \
+	} while (0)
+
+inline int testResult()
+{
+	printf("%d checks, %d failed\n", testChecks, testFailures);
+	return testFailures == 0 ? 0 : 1;
+}
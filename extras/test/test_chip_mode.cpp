@@ -0,0 +1,62 @@
+/*
+  Tests of the execution time table begin() selects from ChipMode, for every raw ChipMode byte
+  of an ATECC608A on ATECCMockTransport, and of ChipMode in ATECCConfigBuilder.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCMockDevice.h"
+#include "ATECCConfigBuilder.h"
+
+
+static void testChipModeTables()
+{
+	const ATECCDeviceProfile *m0 = ATECCX08A::findDeviceProfile(ATECC_MODEL_608A, CHIP_MODE_CLOCK_DIVIDER_M0);
+	const ATECCDeviceProfile *m1 = ATECCX08A::findDeviceProfile(ATECC_MODEL_608A, CHIP_MODE_CLOCK_DIVIDER_M1);
+	const ATECCDeviceProfile *m2 = ATECCX08A::findDeviceProfile(ATECC_MODEL_608A, CHIP_MODE_CLOCK_DIVIDER_M2);
+
+	// divider 0x05 (M1) is slower than full speed, divider 0x0D (M2) the slowest
+	CHECK_EQUAL(0x05, CHIP_MODE_CLOCK_DIVIDER_M1 >> 3);
+	CHECK_EQUAL(0x0D, CHIP_MODE_CLOCK_DIVIDER_M2 >> 3);
+	CHECK_EQUAL(CHIP_MODE_CLOCK_DIVIDER_M1, m1->clockDivider);
+	CHECK_EQUAL(CHIP_MODE_CLOCK_DIVIDER_M2, m2->clockDivider);
+	CHECK(m0->executionTime[ATECC_CMD_SIGN] < m1->executionTime[ATECC_CMD_SIGN]);
+	CHECK(m1->executionTime[ATECC_CMD_SIGN] < m2->executionTime[ATECC_CMD_SIGN]);
+
+	for (int mode = 0; mode < 256; mode++)
+	{
+		ATECCMockDevice device;
+		ATECCMockTransport mock;
+		ATECCX08A atecc;
+		uint8_t divider = mode & CHIP_MODE_CLOCK_DIVIDER_MASK;
+		const ATECCDeviceProfile *expected = m2;   // unknown dividers get the slowest table
+
+		if (divider == CHIP_MODE_CLOCK_DIVIDER_M0)
+			expected = m0;
+		else if (divider == CHIP_MODE_CLOCK_DIVIDER_M1)
+			expected = m1;
+
+		device.configZone[CONFIG_ZONE_CHIP_MODE] = mode;
+		mock.setHandler(mockDeviceHandler, &device);
+		CHECK(atecc.begin(mock) == true);
+		CHECK_EQUAL(divider, atecc.getClockDivider());
+		CHECK(atecc.getDeviceProfile() == expected);
+	}
+
+	// the ATECC508A has one table
+	CHECK(ATECCX08A::findDeviceProfile(ATECC_MODEL_508A, CHIP_MODE_CLOCK_DIVIDER_M0)->model == ATECC_MODEL_508A);
+}
+
+static void testConfigBuilder()
+{
+	CHECK_EQUAL(0, ATECCConfigBuilder().chipMode(CHIP_MODE_CLOCK_DIVIDER_M1 | CHIP_MODE_WATCHDOG_10S).getError());
+	CHECK_EQUAL(0, ATECCConfigBuilder().chipMode(CHIP_MODE_CLOCK_DIVIDER_M2).getError());
+	CHECK_EQUAL(ATECCCONFIG_INVALID_CLOCK_DIVIDER, ATECCConfigBuilder().chipMode(0x0D).getError());
+	CHECK_EQUAL(ATECCCONFIG_INVALID_CLOCK_DIVIDER, ATECCConfigBuilder().chipMode(0x08).getError());
+}
+
+int main()
+{
+	RUN_TEST(testChipModeTables);
+	RUN_TEST(testConfigBuilder);
+	return testResult();
+}
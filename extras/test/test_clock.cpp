@@ -0,0 +1,153 @@
+/*
+  Tests of the non-blocking commands (submitCommand(), pollCommand(), getCommandResult()) on
+  ATECCMockTransport, with a fake clock from setClock() and with the default time base, the
+  simulated micros() of the transport: the response is taken exactly when the execution time
+  of the command has passed, a missing response fails with STATUS_TIMEOUT_ERROR.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCMockDevice.h"
+
+
+static unsigned long fakeTime;         // ms
+static unsigned long callbackTime;
+static int           callbackCount;
+static boolean       callbackResult;
+
+static unsigned long fakeClock()
+{
+	return fakeTime;
+}
+
+static void commandFinished(ATECCX08A * /* atecc */, boolean success, void *context)
+{
+	callbackCount++;
+	callbackResult = success;
+	callbackTime = *(unsigned long *) context;
+}
+
+// polls once per ms from the current time, returns the time at which the command left ATECC_COMMAND_BUSY
+static unsigned long pollUntilFinished(ATECCX08A &atecc, unsigned long limit)
+{
+	while (atecc.pollCommand() == ATECC_COMMAND_BUSY && fakeTime < limit)
+		fakeTime++;
+	return fakeTime;
+}
+
+static void testSubmitPollResult()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	uint8_t random[32];
+	unsigned long start = 1000;
+	unsigned long executionTime;
+
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+	atecc.setClock(fakeClock);
+	executionTime = atecc.getExecutionTime(ATECC_CMD_RANDOM);
+	CHECK(executionTime > 0);
+
+	fakeTime = start;
+	callbackCount = 0;
+	CHECK(atecc.submitCommand(COMMAND_OPCODE_RANDOM, 0x00, 0x0000, NULL, 0, 35, ATECC_CMD_RANDOM, commandFinished, &fakeTime) == true);
+	CHECK_EQUAL(ATECC_COMMAND_BUSY, atecc.getCommandState());
+	CHECK_EQUAL(1, device.commands[COMMAND_OPCODE_RANDOM]);
+	CHECK_EQUAL(-1, atecc.getCommandResult(random, sizeof(random)));
+
+	// only one command at a time
+	CHECK(atecc.submitCommand(COMMAND_OPCODE_RANDOM, 0x00, 0x0000, NULL, 0, 35, ATECC_CMD_RANDOM) == false);
+	CHECK_EQUAL(STATUS_COMMAND_PENDING, atecc.getStatus());
+	CHECK_EQUAL(1, device.commands[COMMAND_OPCODE_RANDOM]);
+
+	// busy for the execution time, done on the tick it has passed
+	fakeTime = start + executionTime - 1;
+	CHECK_EQUAL(ATECC_COMMAND_BUSY, atecc.pollCommand());
+	CHECK_EQUAL(0, callbackCount);
+	fakeTime = start;
+	CHECK_EQUAL(start + executionTime, pollUntilFinished(atecc, start + 1000));
+	CHECK_EQUAL(ATECC_COMMAND_DONE, atecc.getCommandState());
+	CHECK_EQUAL(1, callbackCount);
+	CHECK_EQUAL(start + executionTime, callbackTime);
+	CHECK(callbackResult == true);
+
+	// the state stays DONE until the result is taken
+	fakeTime += 100;
+	CHECK_EQUAL(ATECC_COMMAND_DONE, atecc.pollCommand());
+	CHECK_EQUAL(1, callbackCount);
+	CHECK_EQUAL(32, atecc.getCommandResult(random, sizeof(random)));
+	for (int i = 0; i < 32; i++)
+		CHECK_EQUAL(i + 1, random[i]);
+	CHECK_EQUAL(ATECC_COMMAND_IDLE, atecc.getCommandState());
+	CHECK_EQUAL(-1, atecc.getCommandResult(random, sizeof(random)));
+}
+
+static void testTimeout()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	uint8_t random[32];
+	unsigned long start = 5000;
+	unsigned long executionTime;
+
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+	atecc.setClock(fakeClock);
+	executionTime = atecc.getExecutionTime(ATECC_CMD_RANDOM);
+
+	// the IC doesn't answer: the command fails when the execution time has passed
+	device.respond = false;
+	fakeTime = start;
+	callbackCount = 0;
+	CHECK(atecc.submitCommand(COMMAND_OPCODE_RANDOM, 0x00, 0x0000, NULL, 0, 35, ATECC_CMD_RANDOM, commandFinished, &fakeTime) == true);
+	CHECK_EQUAL(start + executionTime, pollUntilFinished(atecc, start + 1000));
+	CHECK_EQUAL(ATECC_COMMAND_FAILED, atecc.getCommandState());
+	CHECK_EQUAL(STATUS_TIMEOUT_ERROR, atecc.getStatus());
+	CHECK_EQUAL(1, callbackCount);
+	CHECK(callbackResult == false);
+	CHECK_EQUAL(-1, atecc.getCommandResult(random, sizeof(random)));
+
+	// a failed command doesn't block the next one
+	device.respond = true;
+	CHECK(atecc.submitCommand(COMMAND_OPCODE_RANDOM, 0x00, 0x0000, NULL, 0, 35, ATECC_CMD_RANDOM) == true);
+	fakeTime += executionTime;
+	CHECK_EQUAL(ATECC_COMMAND_DONE, atecc.pollCommand());
+	CHECK_EQUAL(32, atecc.getCommandResult(random, sizeof(random)));
+
+	// a command which answers with a status fails with the status
+	device.status = STATUS_EXECUTION_ERROR;
+	CHECK(atecc.submitCommand(COMMAND_OPCODE_NONCE, 0x03, 0x0000, NULL, 0, 4, ATECC_CMD_NONCE) == true);
+	fakeTime += atecc.getExecutionTime(ATECC_CMD_NONCE) - 1;
+	CHECK_EQUAL(ATECC_COMMAND_BUSY, atecc.pollCommand());
+	fakeTime++;
+	CHECK_EQUAL(ATECC_COMMAND_FAILED, atecc.pollCommand());
+	CHECK_EQUAL(STATUS_EXECUTION_ERROR, atecc.getStatus());
+}
+
+static void testTransportClock()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	unsigned long executionTime;
+
+	// without setClock() the time base is micros() of the transport
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+	executionTime = atecc.getExecutionTime(ATECC_CMD_RANDOM);
+	CHECK(atecc.submitCommand(COMMAND_OPCODE_RANDOM, 0x00, 0x0000, NULL, 0, 35, ATECC_CMD_RANDOM) == true);
+	mock.advance(executionTime * 1000 - 1);
+	CHECK_EQUAL(ATECC_COMMAND_BUSY, atecc.pollCommand());
+	mock.advance(1);
+	CHECK_EQUAL(ATECC_COMMAND_DONE, atecc.pollCommand());
+}
+
+int main()
+{
+	RUN_TEST(testSubmitPollResult);
+	RUN_TEST(testTimeout);
+	RUN_TEST(testTransportClock);
+	return testResult();
+}
@@ -0,0 +1,74 @@
+/*
+  Tests of ATECCConfigBuilder: the default image against the configuration zone of a fresh IC
+  (the emulator's factory image) for both models, and lockCrc() against the CRC the Lock
+  command of the emulator accepts.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCEmulator.h"
+#include "ATECCConfigBuilder.h"
+
+
+static constexpr ATECCConfigImage defaultImage = ATECCConfigBuilder().build();
+static constexpr ATECCConfigImage defaultImage608 = ATECCConfigBuilder(ATECC_MODEL_608A).build();
+
+// slot 9 a clear HMAC key, slot 10 a private key which can be regenerated
+static constexpr ATECCConfigImage customImage = ATECCConfigBuilder(ATECC_MODEL_608A)
+	.slot(9, ATECCConfigBuilder::slotConfig(0, false, false, false, false, 0, WRITE_CONFIG_ALWAYS),
+	         ATECCConfigBuilder::keyConfig(false, false, KEY_TYPE_SHA, true, false, false, 0))
+	.slot(10, ATECCConfigBuilder::slotConfig(0, false, false, false, true, 0, WRITE_CONFIG_NEVER),
+	          ATECCConfigBuilder::keyConfig(true, true, KEY_TYPE_P256, true, false, false, 0))
+	.build();
+
+static void testFactoryImage()
+{
+	ATECCEmulatorImage image;
+
+	ATECCEmulator::initImage(image, ATECC_MODEL_508A);
+	for (int i = CONFIG_ZONE_WRITABLE_START; i < CONFIG_ZONE_SIZE; i++)
+		CHECK_EQUAL(image.configZone[i], defaultImage.bytes[i]);
+
+	ATECCEmulator::initImage(image, ATECC_MODEL_608A);
+	for (int i = CONFIG_ZONE_WRITABLE_START; i < CONFIG_ZONE_SIZE; i++)
+		CHECK_EQUAL(image.configZone[i], defaultImage608.bytes[i]);
+
+	// Counter[0] and Counter[1] hold the encoding of 0
+	for (int i = 52; i < 68; i += 8)
+	{
+		CHECK_EQUAL(0xFFFFFFFF, defaultImage.bytes[i] | (defaultImage.bytes[i + 1] << 8) | (defaultImage.bytes[i + 2] << 16) |
+		                        ((uint32_t) defaultImage.bytes[i + 3] << 24));
+		CHECK_EQUAL(0, defaultImage.bytes[i + 4] | defaultImage.bytes[i + 5] | defaultImage.bytes[i + 6] | defaultImage.bytes[i + 7]);
+	}
+}
+
+static void lockWithImage(const ATECCConfigImage &image)
+{
+	ATECCEmulator chip;
+	ATECCX08A atecc;
+	uint16_t crc;
+
+	CHECK(atecc.begin(chip) == true);
+	CHECK(atecc.provisionConfigZone(image.bytes) == true);
+	CHECK(atecc.readConfigZone() == true);
+	crc = image.lockCrc(atecc.getConfigZone());
+	CHECK_EQUAL(ATECCX08A::calculateSummaryCrc(chip.getConfigZone(), CONFIG_ZONE_SIZE), crc);
+
+	// a wrong CRC is rejected, the right one locks the configuration
+	CHECK(atecc.lock(LOCK_MODE_ZONE_CONFIG, crc ^ 0x0001) == false);
+	CHECK(chip.isConfigLocked() == false);
+	CHECK(atecc.lock(LOCK_MODE_ZONE_CONFIG, crc) == true);
+	CHECK(chip.isConfigLocked() == true);
+}
+
+static void testLockCrc()
+{
+	lockWithImage(defaultImage608);
+	lockWithImage(customImage);
+}
+
+int main()
+{
+	RUN_TEST(testFactoryImage);
+	RUN_TEST(testLockCrc);
+	return testResult();
+}
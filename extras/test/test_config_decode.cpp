@@ -0,0 +1,108 @@
+/*
+  Tests of the decoded configuration zone: getConfig() and the per slot queries of an emulated
+  ATECC508A against the reference dump of its factory configuration zone (the emulator's
+  defaultConfigZone, written out here byte by byte), without bus traffic after the first read,
+  and the lock states after locking.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCEmulator.h"
+
+
+// reference dump, bytes 0-127 of the configuration zone with the serial number below
+static const uint8_t serialNumber[SERIAL_NUMBER_SIZE] = { 0x01, 0x23, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xEE };
+static const uint8_t referenceDump[CONFIG_ZONE_SIZE] = {
+	0x01, 0x23, 0x44, 0x55, 0x00, 0x00, 0x50, 0x00, 0x66, 0x77, 0x88, 0x99, 0xEE, 0xC0, 0x55, 0x00,
+	0xC0, 0x00, 0x55, 0x00, 0x83, 0x20, 0x87, 0x20, 0x8F, 0x20, 0xC4, 0x8F, 0x8F, 0x8F, 0x8F, 0x8F,
+	0x9F, 0x8F, 0xAF, 0x8F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0xAF, 0x8F, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+	0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x55, 0x55, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x33, 0x00, 0x33, 0x00, 0x33, 0x00, 0x1C, 0x00, 0x1C, 0x00, 0x1C, 0x00, 0x1C, 0x00, 0x1C, 0x00,
+	0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x1C, 0x00,
+};
+
+// SlotConfig and KeyConfig of the dump, little endian words of bytes 20-51 and 96-127
+static const uint16_t slotConfigs[16] = {
+	0x2083, 0x2087, 0x208F, 0x8FC4, 0x8F8F, 0x8F8F, 0x8F9F, 0x8FAF,
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x8FAF
+};
+static const uint16_t keyConfigs[16] = {
+	0x0033, 0x0033, 0x0033, 0x001C, 0x001C, 0x001C, 0x001C, 0x001C,
+	0x003C, 0x003C, 0x003C, 0x003C, 0x003C, 0x003C, 0x003C, 0x001C
+};
+
+static void testDecode()
+{
+	ATECCEmulator chip(ATECC_MODEL_508A);
+	ATECCX08A atecc;
+	const ATECCConfig *config;
+	unsigned long commands;
+
+	ATECCEmulator::initImage(*chip.getImage(), ATECC_MODEL_508A, ATECC508A_ADDRESS_DEFAULT, serialNumber);
+	chip.powerCycle();
+	CHECK(atecc.begin(chip) == true);
+	CHECK(atecc.readConfigZone() == true);
+	CHECK(memcmp(atecc.getConfigZone(), referenceDump, CONFIG_ZONE_SIZE) == 0);
+
+	commands = chip.getCommandCount();
+	config = atecc.getConfig();
+	CHECK(config != NULL);
+	CHECK(memcmp(config->serialNumber, serialNumber, SERIAL_NUMBER_SIZE) == 0);
+	CHECK_EQUAL(0x00, config->revisionNumber[0]);
+	CHECK_EQUAL(0x00, config->revisionNumber[1]);
+	CHECK_EQUAL(0x50, config->revisionNumber[2]);
+	CHECK_EQUAL(0x00, config->revisionNumber[3]);
+	CHECK_EQUAL(0xC0, config->aesEnable);
+	CHECK_EQUAL(0x55, config->i2cEnable);
+	CHECK_EQUAL(0xC0, config->i2cAddress);
+	CHECK_EQUAL(0x55, config->otpMode);
+	CHECK_EQUAL(0x00, config->chipMode);
+	for (int slot = 0; slot < 16; slot++)
+	{
+		CHECK_EQUAL(slotConfigs[slot], config->slotConfig[slot]);
+		CHECK_EQUAL(keyConfigs[slot], config->keyConfig[slot]);
+		CHECK_EQUAL(slotConfigs[slot], atecc.getSlotConfig(slot));
+		CHECK_EQUAL(keyConfigs[slot], atecc.getKeyConfig(slot));
+		CHECK(atecc.isSlotLocked(slot) == false);
+		CHECK(atecc.containsPrivateKey(slot) == (slot < 3));
+	}
+	CHECK_EQUAL(0x0000, config->slotsLocked);
+	CHECK(config->configLocked == false);
+	CHECK(config->dataOTPLocked == false);
+
+	// the queries are answered from the decoded copy
+	CHECK_EQUAL(commands, chip.getCommandCount());
+}
+
+static void testLockStates()
+{
+	ATECCEmulator chip(ATECC_MODEL_508A);
+	ATECCX08A atecc;
+	const ATECCConfig *config;
+	uint8_t key[32] = { 0 };
+
+	CHECK(atecc.begin(chip) == true);
+	CHECK(atecc.lockConfiguration() == true);
+	CHECK(atecc.createNewKeyPair(NULL, 0, 0) == true);
+	CHECK(atecc.writeSlot(key, sizeof(key), 9) == true);
+	CHECK(atecc.lockDataAndOTP() == true);
+	CHECK(atecc.lockDataSlot(1) == true);
+	CHECK(atecc.readConfigZone() == true);
+
+	config = atecc.getConfig();
+	CHECK(config != NULL);
+	CHECK(config->configLocked == true);
+	CHECK(config->dataOTPLocked == true);
+	CHECK_EQUAL(1 << 1, config->slotsLocked);
+	CHECK(atecc.isSlotLocked(1) == true);
+	CHECK(atecc.isSlotLocked(0) == false);
+	CHECK(memcmp(atecc.getConfigZone(), chip.getConfigZone(), CONFIG_ZONE_SIZE) == 0);
+}
+
+int main()
+{
+	RUN_TEST(testDecode);
+	RUN_TEST(testLockStates);
+	return testResult();
+}
@@ -0,0 +1,184 @@
+/*
+  Tests of the coroutine front-end (ATECCCoroutine.h, C++20): a sequence of commands on the
+  emulator resumes exactly when the poll after each execution time finds the response, errors
+  and timeouts reach the awaiting coroutine, and a task destroyed in the middle of a command
+  leaves neither a waiter in the scheduler nor a locked device behind.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCMockDevice.h"
+#include "ATECCEmulator.h"
+#include "ATECCCoroutine.h"
+
+
+// two tasks in a row, as a sketch would write them: the second runs only if the first succeeded
+static ATECCTask<int> randomThenHash(ATECCCoroutineDevice &device, uint8_t *value, const uint8_t *data, size_t length, uint8_t *hash)
+{
+	boolean result;
+
+	// co_await in an if condition isn't compiled correctly by GCC 12, the results go through a variable
+	result = co_await device.random(value, 32);
+	if (result == false)
+		co_return 1;
+	result = co_await device.sha256(data, length, hash, SHA256_SIZE);
+	if (result == false)
+		co_return 2;
+	co_return 0;
+}
+
+static void testResumeAfterPoll()
+{
+	ATECCEmulator chip;
+	ATECCX08A atecc;
+	ATECCScheduler scheduler;
+	ATECCCoroutineDevice device(&atecc, &scheduler);
+	uint8_t data[100];
+	uint8_t hash[SHA256_SIZE], expected[SHA256_SIZE];
+	unsigned long shaTime;
+
+	for (size_t i = 0; i < sizeof(data); i++)
+		data[i] = i;
+	CHECK(atecc.begin(chip) == true);
+	shaTime = atecc.getExecutionTime(ATECC_CMD_SHA) * 1000UL;
+
+	// Start, one Update with the first 64 bytes, End with the other 36
+	ATECCTask<boolean> task = device.sha256(data, sizeof(data), hash, sizeof(hash));
+	scheduler.start(task);
+	for (unsigned long command = 1; command <= 3; command++)
+	{
+		CHECK_EQUAL(command, chip.getCommandCount(COMMAND_OPCODE_SHA));
+		CHECK_EQUAL(1, scheduler.getPending());
+
+		// not resumed before the execution time has passed
+		chip.advance(shaTime - 1000);
+		CHECK(scheduler.poll() == true);
+		CHECK_EQUAL(command, chip.getCommandCount(COMMAND_OPCODE_SHA));
+		CHECK(task.done() == false);
+
+		// resumed by the next poll, the coroutine submits its next command (or finishes)
+		chip.advance(1000);
+		CHECK(scheduler.poll() == (command < 3));
+	}
+	CHECK(task.done() == true);
+	CHECK(task.result() == true);
+	CHECK_EQUAL(0, scheduler.getPending());
+	CHECK_EQUAL(3, chip.getCommandCount(COMMAND_OPCODE_SHA));
+
+	CHECK(atecc.sha256(data, sizeof(data), expected) == true);
+	CHECK(memcmp(hash, expected, sizeof(hash)) == 0);
+}
+
+static void testErrors()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	ATECCScheduler scheduler;
+	ATECCCoroutineDevice coroutineDevice(&atecc, &scheduler);
+	uint8_t value[32], hash[SHA256_SIZE];
+	uint8_t data[4] = { 1, 2, 3, 4 };
+
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+
+	// both tasks succeed on the mock up to the SHA Start, which gets an error status
+	device.status = STATUS_EXECUTION_ERROR;
+	{
+		ATECCTask<int> job = randomThenHash(coroutineDevice, value, data, sizeof(data), hash);
+		scheduler.start(job);
+		while (scheduler.poll() == true)
+			mock.advance(1000);
+		CHECK(job.done() == true);
+		CHECK_EQUAL(2, job.result());
+		CHECK_EQUAL(STATUS_EXECUTION_ERROR, atecc.getStatus());
+		CHECK_EQUAL(1, value[0]);
+		CHECK_EQUAL(1, device.commands[COMMAND_OPCODE_SHA]);   // the sequence stopped after Start
+	}
+
+	// no response: the first task times out, the second isn't started
+	device.respond = false;
+	{
+		ATECCTask<int> job = randomThenHash(coroutineDevice, value, data, sizeof(data), hash);
+		scheduler.start(job);
+		while (scheduler.poll() == true)
+			mock.advance(1000);
+		CHECK_EQUAL(1, job.result());
+		CHECK_EQUAL(STATUS_TIMEOUT_ERROR, atecc.getStatus());
+		CHECK_EQUAL(1, device.commands[COMMAND_OPCODE_SHA]);
+	}
+
+	// the device is free again after a failed sequence
+	device.respond = true;
+	ATECCTask<boolean> task = coroutineDevice.random(value, sizeof(value));
+	scheduler.start(task);
+	while (scheduler.poll() == true)
+		mock.advance(1000);
+	CHECK(task.result() == true);
+}
+
+static void testDestroyMidCommand()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	ATECCScheduler scheduler;
+	ATECCCoroutineDevice coroutineDevice(&atecc, &scheduler);
+	uint8_t value[32], hash[SHA256_SIZE];
+	uint8_t data[4] = { 1, 2, 3, 4 };
+
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+
+	// destroyed while the Random command is executed
+	{
+		ATECCTask<int> job = randomThenHash(coroutineDevice, value, data, sizeof(data), hash);
+		scheduler.start(job);
+		CHECK_EQUAL(1, scheduler.getPending());
+		CHECK_EQUAL(ATECC_COMMAND_BUSY, atecc.getCommandState());
+	}
+	CHECK_EQUAL(0, scheduler.getPending());
+	CHECK(scheduler.poll() == false);
+
+	// the device isn't locked, but the IC is busy until the abandoned command has been polled
+	{
+		ATECCTask<boolean> task = coroutineDevice.random(value, sizeof(value));
+		scheduler.start(task);
+		CHECK(task.done() == true);
+		CHECK(task.result() == false);
+		CHECK_EQUAL(STATUS_COMMAND_PENDING, atecc.getStatus());
+	}
+	mock.advance(atecc.getExecutionTime(ATECC_CMD_RANDOM) * 1000UL);
+	CHECK_EQUAL(ATECC_COMMAND_DONE, atecc.pollCommand());
+
+	// destroyed in the second task, between two SHA commands
+	{
+		ATECCTask<int> job = randomThenHash(coroutineDevice, value, data, sizeof(data), hash);
+		scheduler.start(job);
+		while (device.commands[COMMAND_OPCODE_SHA] < 1)
+		{
+			mock.advance(1000);
+			scheduler.poll();
+		}
+		CHECK_EQUAL(1, scheduler.getPending());
+	}
+	CHECK_EQUAL(0, scheduler.getPending());
+	mock.advance(atecc.getExecutionTime(ATECC_CMD_SHA) * 1000UL);
+	atecc.pollCommand();
+
+	ATECCTask<boolean> task = coroutineDevice.random(value, sizeof(value));
+	scheduler.start(task);
+	while (task.done() == false)
+	{
+		mock.advance(1000);
+		scheduler.poll();
+	}
+	CHECK(task.result() == true);
+}
+
+int main()
+{
+	RUN_TEST(testResumeAfterPoll);
+	RUN_TEST(testErrors);
+	RUN_TEST(testDestroyMidCommand);
+	return testResult();
+}
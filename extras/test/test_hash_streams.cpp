@@ -0,0 +1,119 @@
+/*
+  Tests of ATECCHashStreams on the emulated ATECC608A: three streams fed in interleaved pieces of
+  different sizes (so their contexts are swapped on the IC), each digest against the software
+  SHA-256 of the emulator, sha256() between suspend() and the next update, and the handle limits.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCEmulator.h"
+#include "ATECCEmulatorCrypto.h"
+#include "ATECCHashStreams.h"
+
+#define STREAM_COUNT 3
+
+
+static void testInterleaved()
+{
+	static const int lengths[STREAM_COUNT] = { 1000, 130, 0 };
+	static const int pieces[] = { 1, 7, 64, 100, 3, 63, 65, 200 };
+	ATECCEmulator chip;
+	ATECCX08A atecc;
+	ATECCHashStreams streams(&atecc);
+	uint8_t message[STREAM_COUNT][1000];
+	uint8_t hash[SHA256_SIZE], expected[SHA256_SIZE];
+	int handles[STREAM_COUNT], sent[STREAM_COUNT] = { 0 };
+	boolean more = true;
+
+	CHECK(atecc.begin(chip) == true);
+	for (int s = 0; s < STREAM_COUNT; s++)
+	{
+		for (int i = 0; i < lengths[s]; i++)
+			message[s][i] = (uint8_t) (i * (s + 3) + s);
+		handles[s] = streams.open();
+		CHECK(handles[s] >= 0);
+	}
+
+	// round robin, every stream gets a piece of another size each turn
+	for (int turn = 0; more; turn++)
+	{
+		more = false;
+		for (int s = 0; s < STREAM_COUNT; s++)
+		{
+			int length = pieces[(turn + s) % (sizeof(pieces) / sizeof(pieces[0]))];
+
+			if (length > lengths[s] - sent[s])
+				length = lengths[s] - sent[s];
+			if (length == 0)
+				continue;
+			CHECK(streams.update(handles[s], &message[s][sent[s]], length) == true);
+			sent[s] += length;
+			more = true;
+		}
+	}
+	CHECK(streams.getSwapCount() > 1);
+
+	for (int s = 0; s < STREAM_COUNT; s++)
+	{
+		CHECK(streams.finish(handles[s], hash, sizeof(hash)) == true);
+		ATECCSoftSha256::hash(message[s], lengths[s], expected);
+		CHECK(memcmp(hash, expected, sizeof(hash)) == 0);
+		streams.close(handles[s]);
+	}
+}
+
+static void testSuspend()
+{
+	ATECCEmulator chip;
+	ATECCX08A atecc;
+	ATECCHashStreams streams(&atecc);
+	uint8_t message[300], hash[SHA256_SIZE], expected[SHA256_SIZE];
+	int handle;
+
+	for (int i = 0; i < (int) sizeof(message); i++)
+		message[i] = i * 13;
+	CHECK(atecc.begin(chip) == true);
+	handle = streams.open();
+	CHECK(streams.update(handle, message, 150) == true);
+
+	// the SHA engine is used by sha256() in between
+	CHECK(streams.suspend() == true);
+	CHECK(atecc.sha256(message, 100, hash) == true);
+	ATECCSoftSha256::hash(message, 100, expected);
+	CHECK(memcmp(hash, expected, sizeof(hash)) == 0);
+
+	CHECK(streams.update(handle, &message[150], 150) == true);
+	CHECK(streams.finish(handle, hash, sizeof(hash)) == true);
+	ATECCSoftSha256::hash(message, sizeof(message), expected);
+	CHECK(memcmp(hash, expected, sizeof(hash)) == 0);
+	streams.close(handle);
+}
+
+static void testHandles()
+{
+	ATECCEmulator chip;
+	ATECCX08A atecc;
+	ATECCHashStreams streams(&atecc);
+	uint8_t data[4] = { 1, 2, 3, 4 }, hash[SHA256_SIZE];
+	int handles[ATECCHASHSTREAMS_MAX_STREAMS];
+
+	CHECK(atecc.begin(chip) == true);
+	for (int i = 0; i < ATECCHASHSTREAMS_MAX_STREAMS; i++)
+		CHECK((handles[i] = streams.open()) >= 0);
+	CHECK(streams.open() < 0);
+	CHECK_EQUAL(ATECCHASHSTREAMS_NO_FREE_STREAM, streams.getStatus());
+
+	streams.close(handles[1]);
+	CHECK(streams.update(handles[1], data, sizeof(data)) == false);
+	CHECK_EQUAL(ATECCHASHSTREAMS_INVALID_HANDLE, streams.getStatus());
+	CHECK(streams.finish(-1, hash, sizeof(hash)) == false);
+	CHECK_EQUAL(ATECCHASHSTREAMS_INVALID_HANDLE, streams.getStatus());
+	CHECK(streams.open() == handles[1]);
+}
+
+int main()
+{
+	RUN_TEST(testInterleaved);
+	RUN_TEST(testSuspend);
+	RUN_TEST(testHandles);
+	return testResult();
+}
@@ -0,0 +1,124 @@
+/*
+  Tests of the on-chip HMAC-SHA256 with a slot key on the emulated ATECC508A and ATECC608A:
+  a known answer of RFC 4231, hmac() and beginHMAC()/updateHMAC()/endHMAC() against an HMAC
+  computed on the host with the key of the slot, for messages around the block size.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCEmulator.h"
+#include "ATECCEmulatorCrypto.h"
+
+#define SLOT_HMAC_KEY 9
+
+
+// RFC 2104 on the host, the 32 byte key is padded with zeros to the block size
+static void softHMAC(const uint8_t *key, const uint8_t *data, size_t length, uint8_t *mac)
+{
+	ATECCSoftSha256 sha;
+	uint8_t pad[SHA_BLOCK_SIZE], inner[SHA256_SIZE];
+
+	memset(pad, 0x36, sizeof(pad));
+	for (int i = 0; i < 32; i++)
+		pad[i] ^= key[i];
+	sha.begin();
+	sha.update(pad, sizeof(pad));
+	sha.update(data, length);
+	sha.end(inner);
+
+	memset(pad, 0x5C, sizeof(pad));
+	for (int i = 0; i < 32; i++)
+		pad[i] ^= key[i];
+	sha.begin();
+	sha.update(pad, sizeof(pad));
+	sha.update(inner, sizeof(inner));
+	sha.end(mac);
+}
+
+// configuration and data locked, key in SLOT_HMAC_KEY
+static boolean setUp(ATECCX08A &atecc, ATECCEmulator &chip, const uint8_t *key)
+{
+	return atecc.begin(chip) && atecc.lockConfiguration() && atecc.writeSlot(key, 32, SLOT_HMAC_KEY) &&
+	       atecc.lockDataAndOTP();
+}
+
+static void testKnownAnswer(uint8_t model)
+{
+	// RFC 4231 test case 2, a key shorter than the block is padded with zeros like the 32 byte slot key
+	static const uint8_t expected[HMAC_SIZE] = {
+		0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e, 0x6a, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xc7,
+		0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27, 0x39, 0x83, 0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43
+	};
+	const char *message = "what do ya want for nothing?";
+	ATECCEmulator chip(model);
+	ATECCX08A atecc;
+	uint8_t key[32] = { 'J', 'e', 'f', 'e' };
+	uint8_t mac[HMAC_SIZE];
+
+	CHECK(setUp(atecc, chip, key) == true);
+	CHECK(atecc.hmac((const uint8_t *) message, strlen(message), SLOT_HMAC_KEY, mac) == true);
+	CHECK(memcmp(mac, expected, sizeof(mac)) == 0);
+}
+
+static void testKnownAnswer508()
+{
+	testKnownAnswer(ATECC_MODEL_508A);
+}
+
+static void testKnownAnswer608()
+{
+	testKnownAnswer(ATECC_MODEL_608A);
+}
+
+static void testSoftwareHMAC(uint8_t model)
+{
+	static const int lengths[] = { 0, 1, 55, 63, 64, 65, 128, 200 };
+	ATECCEmulator chip(model);
+	ATECCX08A atecc;
+	uint8_t key[32], data[200];
+	uint8_t mac[HMAC_SIZE], expected[HMAC_SIZE];
+
+	for (int i = 0; i < 32; i++)
+		key[i] = 0xA0 ^ (i * 5);
+	for (int i = 0; i < (int) sizeof(data); i++)
+		data[i] = i * 11 + 1;
+	CHECK(setUp(atecc, chip, key) == true);
+
+	for (unsigned int n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++)
+	{
+		softHMAC(key, data, lengths[n], expected);
+		CHECK(atecc.hmac(data, lengths[n], SLOT_HMAC_KEY, mac) == true);
+		CHECK(memcmp(mac, expected, sizeof(mac)) == 0);
+
+		// the same message in pieces of 7 bytes
+		CHECK(atecc.beginHMAC(SLOT_HMAC_KEY) == true);
+		for (int offset = 0; offset < lengths[n]; offset += 7)
+			CHECK(atecc.updateHMAC(&data[offset], (lengths[n] - offset < 7) ? lengths[n] - offset : 7) == true);
+		CHECK(atecc.endHMAC(mac, sizeof(mac)) == true);
+		CHECK(memcmp(mac, expected, sizeof(mac)) == 0);
+	}
+
+	// another key gives another MAC
+	key[0] ^= 0x01;
+	softHMAC(key, data, 64, expected);
+	CHECK(atecc.hmac(data, 64, SLOT_HMAC_KEY, mac) == true);
+	CHECK(memcmp(mac, expected, sizeof(mac)) != 0);
+}
+
+static void testSoftwareHMAC508()
+{
+	testSoftwareHMAC(ATECC_MODEL_508A);
+}
+
+static void testSoftwareHMAC608()
+{
+	testSoftwareHMAC(ATECC_MODEL_608A);
+}
+
+int main()
+{
+	RUN_TEST(testKnownAnswer508);
+	RUN_TEST(testKnownAnswer608);
+	RUN_TEST(testSoftwareHMAC508);
+	RUN_TEST(testSoftwareHMAC608);
+	return testResult();
+}
@@ -0,0 +1,136 @@
+/*
+  Tests of the persistent emulator image (ATECCEmulatorImageFile): a device created in a file keeps
+  its locks, keys, slot contents and RNG state when the file is opened again by another emulator,
+  and damaged files (a changed byte, a wrong size, a wrong magic) are refused by the CRC check.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "ATECCTest.h"
+#include "ATECCEmulator.h"
+#include "ATECCEmulatorImageFile.h"
+
+#define SLOT_KEY_PAIR 0
+#define SLOT_DATA     9
+
+
+static char path[] = "/tmp/atecc_test_imageXXXXXX";
+
+// overwrites size bytes at offset of the file
+static boolean patchFile(long offset, const void *data, size_t size)
+{
+	FILE *file = fopen(path, "r+b");
+	boolean result;
+
+	if (file == NULL)
+		return false;
+	result = fseek(file, offset, SEEK_SET) == 0 && fwrite(data, 1, size, file) == size;
+	fclose(file);
+	return result;
+}
+
+static void testPersistence()
+{
+	const uint8_t serialNumber[SERIAL_NUMBER_SIZE] = { 0x01, 0x23, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xEE };
+	ATECCEmulatorImageFile file, reopened;
+	ATECCEmulatorImage copy;
+	ATECCEmulator chip, chip2, twin;
+	ATECCX08A atecc, atecc2, twinDevice;
+	uint8_t publicKey[PUBLIC_KEY_SIZE], publicKey2[PUBLIC_KEY_SIZE];
+	uint8_t data[32], data2[32], random[32], random2[32];
+
+	for (int i = 0; i < (int) sizeof(data); i++)
+		data[i] = 0x30 + i;
+	CHECK(file.create(path, ATECC_MODEL_608A, ATECC508A_ADDRESS_DEFAULT, serialNumber, 7) == true);
+	CHECK(chip.attach(file.getImage()) == true);
+	CHECK(atecc.begin(chip) == true);
+	CHECK(atecc.lockConfiguration() == true);
+	CHECK(atecc.createNewKeyPair(publicKey, sizeof(publicKey), SLOT_KEY_PAIR) == true);
+	CHECK(atecc.writeSlot(data, sizeof(data), SLOT_DATA) == true);
+	CHECK(atecc.lockDataAndOTP() == true);
+	CHECK(ATECCEmulator::checkImage(*file.getImage()) == true);
+	file.close();
+
+	// another emulator on the same file
+	CHECK(reopened.open(path) == true);
+	CHECK(chip2.attach(reopened.getImage()) == true);
+	CHECK(atecc2.begin(chip2) == true);
+	CHECK(atecc2.readConfigZone() == true);
+	CHECK(memcmp(atecc2.getConfig()->serialNumber, serialNumber, SERIAL_NUMBER_SIZE) == 0);
+	CHECK(atecc2.getConfig()->configLocked == true);
+	CHECK(atecc2.getConfig()->dataOTPLocked == true);
+	CHECK(atecc2.generatePublicKey(publicKey2, sizeof(publicKey2), SLOT_KEY_PAIR) == true);
+	CHECK(memcmp(publicKey, publicKey2, sizeof(publicKey)) == 0);
+	CHECK(atecc2.readSlot(data2, sizeof(data2), SLOT_DATA) == true);
+	CHECK(memcmp(data, data2, sizeof(data)) == 0);
+
+	// the RNG continues from the stored state: a copy of the image gives the same numbers
+	memcpy(&copy, reopened.getImage(), sizeof(copy));
+	CHECK(twin.attach(&copy) == true);
+	CHECK(twinDevice.begin(twin) == true);
+	CHECK(atecc2.generateRandomBytes(random, sizeof(random)) == true);
+	CHECK(twinDevice.generateRandomBytes(random2, sizeof(random2)) == true);
+	CHECK(memcmp(random, random2, sizeof(random)) == 0);
+	CHECK(atecc2.generateRandomBytes(random2, sizeof(random2)) == true);
+	CHECK(memcmp(random, random2, sizeof(random)) != 0);
+	CHECK(ATECCEmulator::checkImage(*reopened.getImage()) == true);
+	reopened.close();
+}
+
+static void testDamagedFiles()
+{
+	ATECCEmulatorImageFile file;
+	ATECCEmulatorImage image;
+	ATECCEmulator chip;
+	const uint8_t changed = 0x5A;
+	long dataOffset = (long) ((const uint8_t *) &image.dataZone[100] - (const uint8_t *) &image);
+	uint8_t original;
+
+	CHECK(file.create(path, ATECC_MODEL_508A) == true);
+	original = file.getImage()->dataZone[100];
+	file.close();
+	CHECK(file.open(path, true) == true);
+	file.close();
+
+	// one byte of the data zone
+	CHECK(patchFile(dataOffset, &changed, 1) == true);
+	CHECK(file.open(path) == false);
+	CHECK(file.getImage() == NULL);
+	CHECK(patchFile(dataOffset, &original, 1) == true);
+	CHECK(file.open(path) == true);
+	file.close();
+
+	// the magic
+	CHECK(patchFile(0, "XEMU", 4) == true);
+	CHECK(file.open(path) == false);
+	CHECK(patchFile(0, "AEMU", 4) == true);
+
+	// the size
+	CHECK(truncate(path, sizeof(ATECCEmulatorImage) - 1) == 0);
+	CHECK(file.open(path) == false);
+	CHECK(file.open("/nonexistent/atecc.img") == false);
+
+	// attach() refuses a damaged image and keeps its own
+	ATECCEmulator::initImage(image, ATECC_MODEL_608A);
+	image.configZone[20] ^= 0x01;
+	CHECK(chip.attach(&image) == false);
+	CHECK(chip.getImage() != &image);
+	CHECK(ATECCEmulator::checkImage(*chip.getImage()) == true);
+}
+
+int main()
+{
+	int fd = mkstemp(path);
+
+	if (fd < 0)
+	{
+		printf("can't create a temporary file\n");
+		return 1;
+	}
+	close(fd);
+	RUN_TEST(testPersistence);
+	RUN_TEST(testDamagedFiles);
+	unlink(path);
+	return testResult();
+}
@@ -0,0 +1,56 @@
+/*
+  Tests of the parameter checks of kdf() and encryptDecryptBlock() on ATECCMockTransport.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCMockDevice.h"
+
+
+static void testEmptyMessage()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	const uint8_t *frame;
+	size_t length;
+
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+
+	// HKDF without info: word address, count, opcode, param1, param2, 4 bytes details, CRC
+	CHECK(atecc.kdf(KDF_MODE_ALG_HKDF | KDF_MODE_TARGET_SLOT | KDF_MODE_SOURCE_SLOT, 0x0A09, 0, NULL, 0) == true);
+	CHECK_EQUAL(1, device.commands[COMMAND_OPCODE_KDF]);
+	frame = mock.getLastFrame(length);
+	CHECK_EQUAL(12, length);
+	CHECK_EQUAL(COMMAND_OPCODE_KDF, frame[2]);
+	CHECK_EQUAL(0, frame[9]);   // message length in the details
+
+	// a message without a buffer
+	CHECK(atecc.kdf(KDF_MODE_ALG_HKDF | KDF_MODE_TARGET_SLOT | KDF_MODE_SOURCE_SLOT, 0x0A09, 0, NULL, 4) == false);
+	CHECK_EQUAL(STATUS_INVALID_PARAMETER, atecc.getStatus());
+	CHECK_EQUAL(1, device.commands[COMMAND_OPCODE_KDF]);
+}
+
+static void testAESParameters()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	uint8_t block[AES_BLOCKSIZE] = { 0 };
+
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+
+	CHECK(atecc.encryptDecryptBlock(block, sizeof(block), block, sizeof(block), 16, 0, AES_ENCRYPT) == false);
+	CHECK_EQUAL(STATUS_INVALID_PARAMETER, atecc.getStatus());
+	CHECK(atecc.encryptDecryptBlock(block, sizeof(block), block, sizeof(block), 9, 4, AES_ENCRYPT) == false);
+	CHECK_EQUAL(STATUS_INVALID_PARAMETER, atecc.getStatus());
+	CHECK_EQUAL(0, device.commands[COMMAND_OPCODE_AES]);
+}
+
+int main()
+{
+	RUN_TEST(testEmptyMessage);
+	RUN_TEST(testAESParameters);
+	return testResult();
+}
@@ -0,0 +1,103 @@
+/*
+  Tests of locking against a summary CRC on the emulator: known answers of calculateSummaryCrc(),
+  and the Lock command of the configuration zone, the data and OTP zones and a single slot, which
+  rejects a wrong CRC (the zone stays unlocked) and accepts the computed one.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCEmulator.h"
+
+#define SLOT_KEY_PAIR 0   // lockable
+#define SLOT_DATA     9
+
+
+static void testKnownAnswers()
+{
+	// the CRCs of the wake response (04 11 33 43) and of the success response (04 00 03 40)
+	const uint8_t wake[2] = { 0x04, 0x11 };
+	const uint8_t success[2] = { 0x04, 0x00 };
+	uint8_t data[100];
+	uint16_t crc = 0;
+
+	CHECK_EQUAL(0x4333, ATECCX08A::calculateSummaryCrc(wake, sizeof(wake)));
+	CHECK_EQUAL(0x4003, ATECCX08A::calculateSummaryCrc(success, sizeof(success)));
+
+	// in pieces
+	for (int i = 0; i < (int) sizeof(data); i++)
+		data[i] = i * 29 + 3;
+	for (int i = 0; i < (int) sizeof(data); i += 7)
+		crc = ATECCX08A::calculateSummaryCrc(&data[i], (sizeof(data) - i < 7) ? sizeof(data) - i : 7, crc);
+	CHECK_EQUAL(ATECCX08A::calculateSummaryCrc(data, sizeof(data)), crc);
+}
+
+static void testConfigZone()
+{
+	ATECCEmulator chip;
+	ATECCX08A atecc;
+	uint8_t image[CONFIG_ZONE_SIZE];
+	uint16_t crc;
+
+	CHECK(atecc.begin(chip) == true);
+	CHECK(atecc.readConfigZone() == true);
+	memcpy(image, atecc.getConfigZone(), sizeof(image));
+	image[CONFIG_ZONE_SLOT_CONFIG + 2 * 10] = 0x0F;
+
+	// the image isn't provisioned yet
+	CHECK(atecc.lockConfiguration(image) == false);
+	CHECK_EQUAL(STATUS_EXECUTION_ERROR, atecc.getStatus());
+	CHECK(chip.isConfigLocked() == false);
+
+	CHECK(atecc.provisionConfigZone(image) == true);
+	CHECK(atecc.getConfigZoneCrc(image, crc) == true);
+	CHECK_EQUAL(ATECCX08A::calculateSummaryCrc(chip.getConfigZone(), CONFIG_ZONE_SIZE), crc);
+	CHECK(atecc.lock(LOCK_MODE_ZONE_CONFIG, crc ^ 0x0100) == false);
+	CHECK_EQUAL(STATUS_EXECUTION_ERROR, atecc.getStatus());
+	CHECK(chip.isConfigLocked() == false);
+	CHECK(atecc.lockConfiguration(image) == true);
+	CHECK(chip.isConfigLocked() == true);
+}
+
+static void testDataZones()
+{
+	ATECCEmulator chip;
+	ATECCX08A atecc;
+	uint8_t data[32];
+	uint16_t crc = 0;
+
+	for (int i = 0; i < (int) sizeof(data); i++)
+		data[i] = 0xC0 + i;
+	CHECK(atecc.begin(chip) == true);
+	CHECK(atecc.lockConfiguration() == true);
+	CHECK(atecc.createNewKeyPair(NULL, 0, SLOT_KEY_PAIR) == true);
+	CHECK(atecc.writeSlot(data, sizeof(data), SLOT_DATA) == true);
+
+	// all slots with their full sizes, then the OTP zone
+	for (int slot = 0; slot < 16; slot++)
+		crc = ATECCX08A::calculateSummaryCrc(chip.getDataZone(slot), ATECCX08A::getSlotSize(slot), crc);
+	crc = ATECCX08A::calculateSummaryCrc(chip.getOTPZone(), ATECC_EMULATOR_OTP_SIZE, crc);
+
+	CHECK(atecc.lockDataAndOTP(crc ^ 0x0001) == false);
+	CHECK_EQUAL(STATUS_EXECUTION_ERROR, atecc.getStatus());
+	CHECK(chip.isDataLocked() == false);
+	CHECK(atecc.lockDataAndOTP(crc) == true);
+	CHECK(chip.isDataLocked() == true);
+
+	// a single slot
+	crc = ATECCX08A::calculateSummaryCrc(chip.getDataZone(SLOT_KEY_PAIR), ATECCX08A::getSlotSize(SLOT_KEY_PAIR));
+	CHECK(atecc.lockDataSlot(SLOT_KEY_PAIR, crc ^ 0x8000) == false);
+	CHECK_EQUAL(STATUS_EXECUTION_ERROR, atecc.getStatus());
+	CHECK(atecc.readConfigZone() == true);
+	CHECK(atecc.isSlotLocked(SLOT_KEY_PAIR) == false);
+	CHECK(atecc.lockDataSlot(SLOT_KEY_PAIR, crc) == true);
+	CHECK(atecc.readConfigZone() == true);
+	CHECK(atecc.isSlotLocked(SLOT_KEY_PAIR) == true);
+	CHECK(atecc.createNewKeyPair(NULL, 0, SLOT_KEY_PAIR) == false);
+}
+
+int main()
+{
+	RUN_TEST(testKnownAnswers);
+	RUN_TEST(testConfigZone);
+	RUN_TEST(testDataZones);
+	return testResult();
+}
@@ -0,0 +1,205 @@
+/*
+  Tests of ATECCLog: the record ring wrapping around with the dropped count and the sequence gaps,
+  the payload ring wrapping around and ATECC_LOG_PAYLOAD_LOST for overwritten payloads, the payload
+  limit, print(), and the records the library adds for commands on ATECCMockTransport.
+*/
+
+#include <string>
+#include "ATECCTest.h"
+#include "ATECCMockDevice.h"
+#include "ATECCLog.h"
+
+#define LOG_RECORDS 4
+#define LOG_PAYLOAD 16
+
+
+// collects the output of print()
+class PrintBuffer : public Print
+{
+  public:
+		size_t write(uint8_t c) { text += (char) c; return 1; }
+		std::string text;
+};
+
+// record n with 3 payload bytes n, n + 1, n + 2
+static void addRecord(ATECCLog &log, uint8_t n)
+{
+	const uint8_t data[3] = { n, (uint8_t) (n + 1), (uint8_t) (n + 2) };
+
+	log.add(COMMAND_OPCODE_RANDOM, n, 0x0000, ATECC_CMD_RANDOM, STATUS_SUCCESS, true, 1000 * n, 10, data, sizeof(data));
+}
+
+static void testRecordRing()
+{
+	ATECCLogRecord records[LOG_RECORDS];
+	uint8_t payload[LOG_PAYLOAD], data[8];
+	ATECCLog log(records, LOG_RECORDS, payload, sizeof(payload));
+	ATECCLogRecord record;
+
+	for (int n = 0; n < 6; n++)
+		addRecord(log, n);
+	CHECK_EQUAL(LOG_RECORDS, log.available());
+	CHECK_EQUAL(2, log.getDropped());
+
+	// the oldest two are gone, 18 payload bytes have been written into 16
+	for (int n = 2; n < 6; n++)
+	{
+		CHECK(log.read(record) == true);
+		CHECK_EQUAL(n, record.sequence);
+		CHECK_EQUAL(n, record.param1);
+		CHECK_EQUAL(1000 * n, record.time);
+		CHECK_EQUAL(3, log.readPayload(record, data, sizeof(data)));
+		CHECK_EQUAL(n, data[0]);
+		CHECK_EQUAL(n + 2, data[2]);
+	}
+	CHECK(log.read(record) == false);
+	CHECK_EQUAL(0, log.available());
+
+	// the ring keeps going after it was emptied, the sequence continues
+	addRecord(log, 6);
+	CHECK(log.read(record) == true);
+	CHECK_EQUAL(6, record.sequence);
+	CHECK_EQUAL(2, log.getDropped());
+
+	log.clear();
+	CHECK_EQUAL(0, log.available());
+	CHECK_EQUAL(0, log.getDropped());
+	addRecord(log, 7);
+	CHECK(log.read(record) == true);
+	CHECK_EQUAL(0, record.sequence);
+}
+
+static void testPayloadRing()
+{
+	ATECCLogRecord records[LOG_RECORDS];
+	uint8_t payload[LOG_PAYLOAD], data[8];
+	ATECCLog log(records, LOG_RECORDS, payload, sizeof(payload));
+	ATECCLogRecord first, record;
+
+	// record 5 wraps around the end of the payload ring (bytes 15, 0, 1)
+	for (int n = 0; n < 6; n++)
+		addRecord(log, 10 * n);
+	CHECK(log.read(first) == true);
+	CHECK_EQUAL(2, first.sequence);
+	while (log.read(record) == true)
+		;
+	CHECK_EQUAL(5, record.sequence);
+	CHECK_EQUAL(15, record.payloadPosition % LOG_PAYLOAD);
+	CHECK_EQUAL(3, log.readPayload(record, data, sizeof(data)));
+	CHECK_EQUAL(50, data[0]);
+	CHECK_EQUAL(51, data[1]);
+	CHECK_EQUAL(52, data[2]);
+	CHECK_EQUAL(-1, log.readPayload(record, data, 2));
+
+	// a record which was read keeps its payload until newer payloads overwrite it
+	CHECK_EQUAL(3, log.readPayload(first, data, sizeof(data)));
+	addRecord(log, 60);
+	addRecord(log, 70);
+	CHECK_EQUAL(ATECC_LOG_PAYLOAD_LOST, log.readPayload(first, data, sizeof(data)));
+	CHECK_EQUAL(3, log.readPayload(record, data, sizeof(data)));
+
+	// the payload limit, and a log without a payload ring
+	log.setPayloadLimit(2);
+	addRecord(log, 80);
+	log.setPayloadLimit(0);
+	addRecord(log, 90);
+	while (log.read(record) == true && record.param1 != 80)
+		;
+	CHECK_EQUAL(2, log.readPayload(record, data, sizeof(data)));
+	CHECK_EQUAL(81, data[1]);
+	CHECK(log.read(record) == true);
+	CHECK_EQUAL(0, log.readPayload(record, data, sizeof(data)));
+
+	ATECCLog noPayload(records, LOG_RECORDS);
+	addRecord(noPayload, 1);
+	CHECK(noPayload.read(record) == true);
+	CHECK_EQUAL(0, record.payloadLength);
+	CHECK_EQUAL(0, noPayload.readPayload(record, data, sizeof(data)));
+
+	// paused
+	noPayload.setEnabled(false);
+	addRecord(noPayload, 2);
+	CHECK_EQUAL(0, noPayload.available());
+}
+
+static void testPrint()
+{
+	ATECCLogRecord records[LOG_RECORDS];
+	uint8_t payload[8];
+	ATECCLog log(records, LOG_RECORDS, payload, sizeof(payload));
+	PrintBuffer output;
+
+	addRecord(log, 0);
+	CHECK_EQUAL(1, log.print(output, 1));
+	CHECK(output.text.find("#0 t=0 op=0x1B p1=0x0 p2=0x0 cmd=") == 0);
+	CHECK(output.text.find(" ok 10 us") != std::string::npos);
+	CHECK(output.text.find("payload lost") == std::string::npos);
+
+	// 12 payload bytes in a ring of 8: the payload of record 1 is overwritten by 3 and 4
+	output.text = "";
+	for (int n = 1; n < 5; n++)
+		addRecord(log, n);
+	CHECK_EQUAL(LOG_RECORDS, log.print(output, 10));
+	CHECK(output.text.find("#1 ") == 0);
+	CHECK(output.text.find("payload lost") != std::string::npos);
+	CHECK_EQUAL(0, log.available());
+}
+
+static void testLibrary()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	ATECCLogRecord records[8], record;
+	uint8_t payload[256], data[64], random[32];
+	ATECCLog log(records, 8, payload, sizeof(payload));
+
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+	atecc.setLog(&log);
+
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == true);
+	CHECK(log.read(record) == true);
+	CHECK_EQUAL(COMMAND_OPCODE_RANDOM, record.opcode);
+	CHECK_EQUAL(ATECC_CMD_RANDOM, record.command);
+	CHECK_EQUAL(STATUS_SUCCESS, record.status);
+	CHECK(record.success == true);
+	CHECK_EQUAL(32, log.readPayload(record, data, sizeof(data)));
+	CHECK(memcmp(data, random, sizeof(random)) == 0);
+
+	// an error status of the IC, its status byte is the payload
+	device.status = STATUS_EXECUTION_ERROR;
+	CHECK(atecc.createSignature(data, SIGNATURE_SIZE, random, 0) == false);
+	CHECK(log.read(record) == true);
+	CHECK_EQUAL(COMMAND_OPCODE_NONCE, record.opcode);
+	CHECK_EQUAL(STATUS_EXECUTION_ERROR, record.status);
+	CHECK(record.success == false);
+	CHECK_EQUAL(1, log.readPayload(record, data, sizeof(data)));
+	CHECK_EQUAL(STATUS_EXECUTION_ERROR, data[0]);
+	CHECK(log.read(record) == true);               // createSignature() sends Sign anyway
+	CHECK_EQUAL(COMMAND_OPCODE_SIGN, record.opcode);
+	CHECK(record.success == false);
+	CHECK_EQUAL(0, log.available());
+
+	// no response at all
+	device.respond = false;
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == false);
+	CHECK(log.read(record) == true);
+	CHECK_EQUAL(STATUS_TIMEOUT_ERROR, record.status);
+	CHECK(record.success == false);
+	CHECK(record.latency > 0);
+
+	atecc.setLog(NULL);
+	device.respond = true;
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == true);
+	CHECK_EQUAL(0, log.available());
+}
+
+int main()
+{
+	RUN_TEST(testRecordRing);
+	RUN_TEST(testPayloadRing);
+	RUN_TEST(testPrint);
+	RUN_TEST(testLibrary);
+	return testResult();
+}
@@ -0,0 +1,110 @@
+/*
+  Tests of the MAC/CheckMac challenge-response on two emulated ICs (prover and verifier) which
+  share the key in slot 9: generateMAC()/checkMAC() and ATECCChallengeProver/ATECCChallengeVerifier,
+  including tampered responses and challenges.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCEmulator.h"
+#include "ATECCChallenge.h"
+
+#define SLOT_SHARED_KEY 9
+
+
+// configuration and data locked, the shared key in SLOT_SHARED_KEY
+static boolean setUp(ATECCX08A &atecc, ATECCEmulator &chip, const uint8_t *key)
+{
+	return atecc.begin(chip) && atecc.lockConfiguration() && atecc.writeSlot(key, 32, SLOT_SHARED_KEY) &&
+	       atecc.lockDataAndOTP();
+}
+
+static void testMAC()
+{
+	const uint8_t proverSerial[9] = { 0x01, 0x23, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0xEE };
+	const uint8_t verifierSerial[9] = { 0x01, 0x23, 0x11, 0x21, 0x31, 0x41, 0x51, 0x61, 0xEE };
+	ATECCEmulator prover, verifier, other;
+	ATECCX08A proverDevice, verifierDevice, otherDevice;
+	uint8_t key[32], otherKey[32];
+	uint8_t challenge[MAC_CHALLENGE_SIZE], response[MAC_RESPONSE_SIZE], response2[MAC_RESPONSE_SIZE];
+
+	for (int i = 0; i < 32; i++)
+	{
+		key[i] = 0x40 + i;
+		otherKey[i] = 0x80 + i;
+		challenge[i] = 3 * i;
+	}
+	// different serial numbers, only SN[0:1] and SN[8] are part of the MAC
+	ATECCEmulator::initImage(*prover.getImage(), ATECC_MODEL_608A, ATECC508A_ADDRESS_DEFAULT, proverSerial);
+	ATECCEmulator::initImage(*verifier.getImage(), ATECC_MODEL_608A, ATECC508A_ADDRESS_DEFAULT, verifierSerial);
+	prover.powerCycle();
+	verifier.powerCycle();
+	CHECK(setUp(proverDevice, prover, key) == true);
+	CHECK(setUp(verifierDevice, verifier, key) == true);
+	CHECK(setUp(otherDevice, other, otherKey) == true);
+
+	CHECK(proverDevice.generateMAC(challenge, SLOT_SHARED_KEY, response, sizeof(response)) == true);
+	CHECK(verifierDevice.checkMAC(challenge, response, SLOT_SHARED_KEY) == true);
+	CHECK_EQUAL(STATUS_SUCCESS, verifierDevice.getStatus());
+
+	// the same challenge gives the same response, another challenge another one
+	CHECK(proverDevice.generateMAC(challenge, SLOT_SHARED_KEY, response2, sizeof(response2)) == true);
+	CHECK(memcmp(response, response2, sizeof(response)) == 0);
+	challenge[0] ^= 0x01;
+	CHECK(proverDevice.generateMAC(challenge, SLOT_SHARED_KEY, response2, sizeof(response2)) == true);
+	CHECK(memcmp(response, response2, sizeof(response)) != 0);
+
+	// tampered challenge
+	CHECK(verifierDevice.checkMAC(challenge, response, SLOT_SHARED_KEY) == false);
+	CHECK_EQUAL(CHECKMAC_MISMATCH, verifierDevice.getStatus());
+	challenge[0] ^= 0x01;
+
+	// tampered response
+	response[31] ^= 0x80;
+	CHECK(verifierDevice.checkMAC(challenge, response, SLOT_SHARED_KEY) == false);
+	CHECK_EQUAL(CHECKMAC_MISMATCH, verifierDevice.getStatus());
+	response[31] ^= 0x80;
+
+	// a prover with another key
+	CHECK(otherDevice.generateMAC(challenge, SLOT_SHARED_KEY, response2, sizeof(response2)) == true);
+	CHECK(verifierDevice.checkMAC(challenge, response2, SLOT_SHARED_KEY) == false);
+	CHECK(verifierDevice.checkMAC(challenge, response, SLOT_SHARED_KEY) == true);
+}
+
+static void testChallengeResponse()
+{
+	ATECCEmulator prover, verifier;
+	ATECCX08A proverDevice, verifierDevice;
+	uint8_t key[32];
+	uint8_t challenge[MAC_CHALLENGE_SIZE], response[MAC_RESPONSE_SIZE];
+
+	for (int i = 0; i < 32; i++)
+		key[i] = 0xA0 ^ i;
+	CHECK(setUp(proverDevice, prover, key) == true);
+	CHECK(setUp(verifierDevice, verifier, key) == true);
+
+	ATECCChallengeProver proverRole(&proverDevice, SLOT_SHARED_KEY);
+	ATECCChallengeVerifier verifierRole(&verifierDevice, SLOT_SHARED_KEY);
+
+	CHECK(verifierRole.createChallenge(challenge, sizeof(challenge)) == true);
+	CHECK(proverRole.respond(challenge, sizeof(challenge), response, sizeof(response)) == true);
+	CHECK(verifierRole.verifyResponse(response, sizeof(response)) == true);
+	CHECK_EQUAL(ATECCCHALLENGE_SUCCESS, verifierRole.getStatus());
+
+	// a challenge is used only once
+	CHECK(verifierRole.verifyResponse(response, sizeof(response)) == false);
+	CHECK_EQUAL(ATECCCHALLENGE_NO_CHALLENGE, verifierRole.getStatus());
+
+	// tampered response
+	CHECK(verifierRole.createChallenge(challenge, sizeof(challenge)) == true);
+	CHECK(proverRole.respond(challenge, sizeof(challenge), response, sizeof(response)) == true);
+	response[0] ^= 0x01;
+	CHECK(verifierRole.verifyResponse(response, sizeof(response)) == false);
+	CHECK_EQUAL(ATECCCHALLENGE_MISMATCH, verifierRole.getStatus());
+}
+
+int main()
+{
+	RUN_TEST(testMAC);
+	RUN_TEST(testChallengeResponse);
+	return testResult();
+}
@@ -0,0 +1,116 @@
+/*
+  Tests of the command metrics (built with ATECC_ENABLE_METRICS 1) on ATECCMockTransport:
+  every counter of ATECCCommandMetrics and the wake counters of ATECCMetrics.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCMockDevice.h"
+
+#if !ATECC_ENABLE_METRICS
+#error "test_metrics needs ATECC_ENABLE_METRICS 1"
+#endif
+
+
+static void testCommandMetrics()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	ATECCMetrics metrics;
+	uint8_t random[32];
+	uint8_t response[35] = {};
+	uint8_t nonce[32] = {};
+	unsigned long executionTime;
+
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+	atecc.resetMetrics();
+	executionTime = atecc.getExecutionTime(ATECC_CMD_RANDOM) * 1000UL;
+
+	// a successful command: count and latency (the mock clock only moves while the library waits)
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == true);
+	atecc.getMetrics(metrics);
+	CHECK_EQUAL(1, metrics.command[ATECC_CMD_RANDOM].count);
+	CHECK_EQUAL(0, metrics.command[ATECC_CMD_RANDOM].failures);
+	CHECK(metrics.command[ATECC_CMD_RANDOM].totalLatency >= executionTime);
+	CHECK_EQUAL(metrics.command[ATECC_CMD_RANDOM].totalLatency, metrics.command[ATECC_CMD_RANDOM].maxLatency);
+	CHECK_EQUAL(0, metrics.command[ATECC_CMD_RANDOM].retries);
+	CHECK_EQUAL(1, metrics.wakes);
+	CHECK_EQUAL(0, metrics.wakeFailures);
+
+	// 35 bytes in pieces of 5: the reads of 32, 27, 22, 17, 12 and 7 bytes are short
+	mock.setReadLimit(5);
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == true);
+	mock.setReadLimit(0);
+	atecc.getMetrics(metrics);
+	CHECK_EQUAL(2, metrics.command[ATECC_CMD_RANDOM].count);
+	CHECK_EQUAL(6, metrics.command[ATECC_CMD_RANDOM].retries);
+	CHECK(metrics.command[ATECC_CMD_RANDOM].maxLatency <= metrics.command[ATECC_CMD_RANDOM].totalLatency);
+
+	// no response
+	device.nacks = ATRCC508A_MAX_RETRIES;
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == false);
+	CHECK_EQUAL(STATUS_TIMEOUT_ERROR, atecc.getStatus());
+	device.nacks = 0;
+	mock.clearResponses();
+
+	// a wrong count byte, a wrong CRC
+	device.respond = false;
+	response[0] = 34;
+	mock.queueResponse(response, sizeof(response));
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == false);
+	CHECK_EQUAL(STATUS_MESSAGE_COUNT_ERROR, atecc.getStatus());
+	response[0] = 35;
+	mock.queueResponse(response, sizeof(response));
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == false);
+	CHECK_EQUAL(STATUS_MESSAGE_CRC_ERROR, atecc.getStatus());
+	device.respond = true;
+
+	atecc.getMetrics(metrics);
+	CHECK_EQUAL(5, metrics.command[ATECC_CMD_RANDOM].count);
+	CHECK_EQUAL(3, metrics.command[ATECC_CMD_RANDOM].failures);
+	CHECK_EQUAL(1, metrics.command[ATECC_CMD_RANDOM].timeouts);
+	CHECK_EQUAL(1, metrics.command[ATECC_CMD_RANDOM].countErrors);
+	CHECK_EQUAL(1, metrics.command[ATECC_CMD_RANDOM].crcErrors);
+	CHECK_EQUAL(0, metrics.command[ATECC_CMD_RANDOM].watchdogErrors);
+
+	// the watchdog expired, counted for the command which got the status
+	device.status = STATUS_WATCHDOG_EXPIRATION;
+	CHECK(atecc.submitCommand(COMMAND_OPCODE_NONCE, 0x03, 0x0000, nonce, sizeof(nonce), 4, ATECC_CMD_NONCE) == true);
+	mock.advance(atecc.getExecutionTime(ATECC_CMD_NONCE) * 1000UL);
+	CHECK_EQUAL(ATECC_COMMAND_FAILED, atecc.pollCommand());
+	atecc.getMetrics(metrics, true);
+	CHECK_EQUAL(1, metrics.command[ATECC_CMD_NONCE].count);
+	CHECK_EQUAL(1, metrics.command[ATECC_CMD_NONCE].failures);
+	CHECK_EQUAL(1, metrics.command[ATECC_CMD_NONCE].watchdogErrors);
+	CHECK_EQUAL(0, metrics.command[ATECC_CMD_NONCE].timeouts);
+	CHECK_EQUAL(6, metrics.wakes);
+
+	// getMetrics(metrics, true) has reset the counters
+	atecc.getMetrics(metrics);
+	CHECK_EQUAL(0, metrics.command[ATECC_CMD_RANDOM].count);
+	CHECK_EQUAL(0, metrics.command[ATECC_CMD_NONCE].watchdogErrors);
+	CHECK_EQUAL(0, metrics.wakes);
+}
+
+static void testWakeMetrics()
+{
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	ATECCMetrics metrics;
+
+	// no wake response: receiveResponseData() fails with a timeout
+	mock.setNacks(ATRCC508A_MAX_RETRIES);
+	CHECK(atecc.begin(mock) == false);
+	CHECK_EQUAL(STATUS_TIMEOUT_ERROR, atecc.getStatus());
+	atecc.getMetrics(metrics);
+	CHECK_EQUAL(1, metrics.wakes);
+	CHECK_EQUAL(1, metrics.wakeFailures);
+}
+
+int main()
+{
+	RUN_TEST(testCommandMetrics);
+	RUN_TEST(testWakeMetrics);
+	return testResult();
+}
@@ -0,0 +1,60 @@
+/*
+  Tests of the read cache on ATECCMockTransport: hits, and the invalidation by the commands
+  which change a slot (write, KDF into a slot, GenKey).
+*/
+
+#include "ATECCTest.h"
+#include "ATECCMockDevice.h"
+
+
+static void testInvalidation()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	uint8_t data[32];
+	uint8_t other[32];
+	unsigned long reads;
+
+	memset(device.slots[9], 0x99, MOCK_DEVICE_SLOT_SIZE);
+	memset(device.slots[10], 0xAA, MOCK_DEVICE_SLOT_SIZE);
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+	CHECK(atecc.enableReadCache(1024) == true);
+
+	CHECK(atecc.readSlot(data, sizeof(data), 9) == true);
+	CHECK(atecc.readSlot(other, sizeof(other), 10) == true);
+	CHECK_EQUAL(0x99, data[0]);
+	reads = device.commands[COMMAND_OPCODE_READ];
+	CHECK(atecc.readSlot(data, sizeof(data), 9) == true);
+	CHECK_EQUAL(reads, device.commands[COMMAND_OPCODE_READ]);   // from the cache
+
+	// KDF into slot 9 (source slot 10): slot 9 is read again, slot 10 is still cached
+	CHECK(atecc.kdf(KDF_MODE_ALG_HKDF | KDF_MODE_TARGET_SLOT | KDF_MODE_SOURCE_SLOT, (9 << 8) | 10, 0, NULL, 0) == true);
+	CHECK(atecc.readSlot(data, sizeof(data), 9) == true);
+	CHECK_EQUAL(reads + 1, device.commands[COMMAND_OPCODE_READ]);
+	CHECK_EQUAL(device.kdfCount, data[0]);
+	CHECK(atecc.readSlot(other, sizeof(other), 10) == true);
+	CHECK_EQUAL(reads + 1, device.commands[COMMAND_OPCODE_READ]);
+	CHECK_EQUAL(0xAA, other[0]);
+
+	// GenKey into slot 9 (the mock answers with a status, the command fails after it was sent)
+	memset(device.slots[9], 0x42, 32);
+	atecc.createNewKeyPair(NULL, 0, 9);
+	CHECK(atecc.readSlot(data, sizeof(data), 9) == true);
+	CHECK_EQUAL(reads + 2, device.commands[COMMAND_OPCODE_READ]);
+	CHECK_EQUAL(0x42, data[0]);
+
+	// write
+	memset(data, 0x17, sizeof(data));
+	CHECK(atecc.write(ZONE_DATA, 9 << 3, data, 32) == true);
+	CHECK(atecc.readSlot(data, sizeof(data), 9) == true);
+	CHECK_EQUAL(reads + 3, device.commands[COMMAND_OPCODE_READ]);
+	CHECK_EQUAL(0x17, data[0]);
+}
+
+int main()
+{
+	RUN_TEST(testInvalidation);
+	return testResult();
+}
@@ -0,0 +1,157 @@
+/*
+  Tests of ATECCRecordLog on the emulator: sets of several keys across several compactions, and
+  a power loss after every write command of a compaction, after which begin() must find the
+  latest value of every key.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCEmulator.h"
+#include "ATECCRecordLog.h"
+
+#define RECORD_LOG_KEYS 6
+
+
+// the emulator until the power is cut after a number of Write commands
+class PowerCutTransport : public ATECCTransport
+{
+  public:
+	  PowerCutTransport(ATECCEmulator *chip, int writes) : chip(chip), writes(writes) {}
+
+		boolean wake()
+		{
+			return writes >= 0 && chip->wake();
+		}
+		boolean write(uint8_t address, const uint8_t *data, size_t length)
+		{
+			if (length >= 3 && data[0] == WORD_ADDRESS_VALUE_COMMAND && data[2] == COMMAND_OPCODE_WRITE)
+				writes--;
+			return writes >= 0 && chip->write(address, data, length);
+		}
+		int read(uint8_t address, uint8_t *data, size_t length)
+		{
+			return (writes >= 0) ? chip->read(address, data, length) : 0;
+		}
+		unsigned long micros()
+		{
+			return chip->micros();
+		}
+		void delayMicroseconds(unsigned long us)
+		{
+			chip->delayMicroseconds(us);
+		}
+
+	private:
+	  ATECCEmulator *chip;
+		int           writes;
+};
+
+// configuration and data zone locked, slot 8 is a clear read/write slot
+static boolean setUp(ATECCX08A &atecc, ATECCEmulator &chip)
+{
+	return atecc.begin(chip) && atecc.lockConfiguration() && atecc.lockDataAndOTP();
+}
+
+static void makeValue(uint8_t key, int round, uint8_t *value, int &length)
+{
+	length = 4 + (key * 5 + round) % (ATECCRECORDLOG_MAX_VALUE_SIZE - 3);
+	for (int i = 0; i < length; i++)
+		value[i] = key * 16 + round + i;
+}
+
+static void checkAll(ATECCRecordLog &log, uint8_t expected[][ATECCRECORDLOG_MAX_VALUE_SIZE], const int *lengths)
+{
+	uint8_t value[ATECCRECORDLOG_MAX_VALUE_SIZE];
+
+	for (int key = 0; key < RECORD_LOG_KEYS; key++)
+	{
+		CHECK_EQUAL(lengths[key], log.get(key, value, sizeof(value)));
+		CHECK(memcmp(value, expected[key], lengths[key]) == 0);
+	}
+}
+
+static void testCompactions()
+{
+	ATECCEmulator chip;
+	ATECCX08A atecc, other;
+	ATECCRecordLog log(&atecc);
+	uint8_t expected[RECORD_LOG_KEYS][ATECCRECORDLOG_MAX_VALUE_SIZE];
+	int     lengths[RECORD_LOG_KEYS];
+	int     round = 0;
+
+	CHECK(setUp(atecc, chip) == true);
+	CHECK(log.begin() == true);
+
+	// every set is checked against all keys, also the sets which compact the slot
+	while (log.getCompactionCount() < 3 && round < 200)
+	{
+		for (int key = 0; key < RECORD_LOG_KEYS; key++)
+		{
+			makeValue(key, round, expected[key], lengths[key]);
+			CHECK(log.set(key, expected[key], lengths[key]) == true);
+			if (key < RECORD_LOG_KEYS - 1 && round == 0)
+				continue;
+			checkAll(log, expected, lengths);
+		}
+		round++;
+	}
+	CHECK(log.getCompactionCount() >= 3);
+	CHECK_EQUAL(log.getCompactionCount(), log.getGeneration());
+
+	// the index built from the slot is the same
+	ATECCRecordLog reopened(&other);
+	CHECK(other.begin(chip) == true);
+	CHECK(reopened.begin(false) == true);
+	CHECK_EQUAL(log.getGeneration(), reopened.getGeneration());
+	checkAll(reopened, expected, lengths);
+}
+
+static void testPowerLoss()
+{
+	boolean finished = false;
+
+	for (int writes = 0; writes < 40 && finished == false; writes++)
+	{
+		ATECCEmulator chip;
+		ATECCX08A atecc, cut, restarted;
+		ATECCRecordLog log(&atecc);
+		PowerCutTransport transport(&chip, writes);
+		uint8_t expected[RECORD_LOG_KEYS][ATECCRECORDLOG_MAX_VALUE_SIZE];
+		int     lengths[RECORD_LOG_KEYS];
+		uint8_t generation;
+
+		// a log with several old records of every key, nearly full
+		CHECK(setUp(atecc, chip) == true);
+		CHECK(log.begin() == true);
+		for (int i = 0; i < RECORD_LOG_KEYS || log.getFreeSpace() > 64; i++)
+		{
+			int key = i % RECORD_LOG_KEYS;
+
+			makeValue(key, i / RECORD_LOG_KEYS, expected[key], lengths[key]);
+			CHECK(log.set(key, expected[key], lengths[key]) == true);
+		}
+		CHECK_EQUAL(0, log.getCompactionCount());
+		generation = log.getGeneration();
+
+		// compaction until the power is cut
+		ATECCRecordLog interrupted(&cut);
+		CHECK(cut.begin(transport) == true);
+		CHECK(interrupted.begin(false) == true);
+		finished = interrupted.compact();
+
+		// power on: begin() finishes the compaction if it has written anything
+		chip.powerCycle();
+		ATECCRecordLog recovered(&restarted);
+		CHECK(restarted.begin(chip) == true);
+		CHECK(recovered.begin(false) == true);
+		CHECK_EQUAL((uint8_t) (generation + (writes > 0 ? 1 : 0)), recovered.getGeneration());
+		checkAll(recovered, expected, lengths);
+	}
+	CHECK(finished == true);
+}
+
+int main()
+{
+	RUN_TEST(testCompactions);
+	RUN_TEST(testPowerLoss);
+	return testResult();
+}
@@ -0,0 +1,168 @@
+/*
+  Tests of planSlotTransfer() for the three slot sizes (36, 72 and 416 bytes): the number of
+  32 byte blocks and 4 byte words, their addresses and buffer offsets, invalid ranges, and
+  readSlotData() on the emulator with the planned number of Read commands.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCEmulator.h"
+
+#define SLOT_SMALL   4   // 36 bytes, made readable by setUp()
+#define SLOT_LARGE   8   // 416 bytes
+#define SLOT_MEDIUM  9   // 72 bytes
+
+
+static const int slots[3] = { SLOT_SMALL, SLOT_MEDIUM, SLOT_LARGE };
+
+static int countSteps(const ATECCTransfer *plan, int steps, int size)
+{
+	int count = 0;
+
+	for (int i = 0; i < steps; i++)
+	{
+		if (plan[i].size == size)
+			count++;
+	}
+	return count;
+}
+
+// the steps cover offset..offset+length without gaps
+static boolean isContiguous(const ATECCTransfer *plan, int steps, int length)
+{
+	int position = 0;
+
+	for (int i = 0; i < steps; i++)
+	{
+		if (plan[i].bufferOffset != position || plan[i].first + plan[i].count > plan[i].size)
+			return false;
+		position += plan[i].count;
+	}
+	return position == length;
+}
+
+static void testWholeSlots()
+{
+	// slot, size, blocks, words
+	static const int expected[3][4] = {
+		{ SLOT_SMALL,  SLOT_SIZE_SMALL,  1,  1 },
+		{ SLOT_MEDIUM, SLOT_SIZE_MEDIUM, 2,  2 },
+		{ SLOT_LARGE,  SLOT_SIZE_LARGE,  13, 0 },
+	};
+	ATECCX08A atecc;
+	ATECCTransfer plan[ATECC_MAX_TRANSFER_STEPS];
+
+	for (int i = 0; i < 3; i++)
+	{
+		int slot = expected[i][0], steps;
+
+		CHECK_EQUAL(expected[i][1], ATECCX08A::getSlotSize(slot));
+		steps = atecc.planSlotTransfer(slot, 0, expected[i][1], plan, ATECC_MAX_TRANSFER_STEPS);
+		CHECK_EQUAL(expected[i][2] + expected[i][3], steps);
+		CHECK_EQUAL(expected[i][2], countSteps(plan, steps, 32));
+		CHECK_EQUAL(expected[i][3], countSteps(plan, steps, 4));
+		CHECK(isContiguous(plan, steps, expected[i][1]));
+	}
+
+	// addresses: slot in bits 3-6, block in bits 8-11, word in bits 0-2
+	CHECK_EQUAL(4, atecc.planSlotTransfer(SLOT_MEDIUM, 0, SLOT_SIZE_MEDIUM, plan, ATECC_MAX_TRANSFER_STEPS));
+	CHECK_EQUAL(0x0048, plan[0].address);
+	CHECK_EQUAL(0x0148, plan[1].address);
+	CHECK_EQUAL(0x0248, plan[2].address);
+	CHECK_EQUAL(0x0249, plan[3].address);
+	CHECK_EQUAL(2, atecc.planSlotTransfer(SLOT_SMALL, 0, SLOT_SIZE_SMALL, plan, ATECC_MAX_TRANSFER_STEPS));
+	CHECK_EQUAL(0x0020, plan[0].address);
+	CHECK_EQUAL(0x0120, plan[1].address);
+	CHECK_EQUAL(4, plan[1].size);
+	CHECK_EQUAL(32, plan[1].bufferOffset);
+}
+
+static void testPartialRanges()
+{
+	ATECCX08A atecc;
+	ATECCTransfer plan[ATECC_MAX_TRANSFER_STEPS];
+
+	// two words of one block: one block access
+	CHECK_EQUAL(1, atecc.planSlotTransfer(SLOT_MEDIUM, 4, 8, plan, ATECC_MAX_TRANSFER_STEPS));
+	CHECK_EQUAL(32, plan[0].size);
+	CHECK_EQUAL(4, plan[0].first);
+	CHECK_EQUAL(8, plan[0].count);
+
+	// one word of each of two blocks: two word accesses
+	CHECK_EQUAL(2, atecc.planSlotTransfer(SLOT_MEDIUM, 28, 8, plan, ATECC_MAX_TRANSFER_STEPS));
+	CHECK_EQUAL(2, countSteps(plan, 2, 4));
+	CHECK_EQUAL(0x004F, plan[0].address);
+	CHECK_EQUAL(0x0148, plan[1].address);
+
+	// the middle of slot 8: two words of block 1, blocks 2-4, one word of block 5
+	CHECK_EQUAL(5, atecc.planSlotTransfer(SLOT_LARGE, 56, 108, plan, ATECC_MAX_TRANSFER_STEPS));
+	CHECK_EQUAL(4, countSteps(plan, 5, 32));
+	CHECK_EQUAL(8, plan[0].count);
+	CHECK_EQUAL(4, plan[4].size);
+	CHECK(isContiguous(plan, 5, 108));
+
+	// invalid ranges and a plan which is too small
+	CHECK_EQUAL(-1, atecc.planSlotTransfer(SLOT_SMALL, 0, SLOT_SIZE_SMALL + 4, plan, ATECC_MAX_TRANSFER_STEPS));
+	CHECK_EQUAL(-1, atecc.planSlotTransfer(SLOT_MEDIUM, 2, 8, plan, ATECC_MAX_TRANSFER_STEPS));
+	CHECK_EQUAL(-1, atecc.planSlotTransfer(SLOT_MEDIUM, 0, 6, plan, ATECC_MAX_TRANSFER_STEPS));
+	CHECK_EQUAL(-1, atecc.planSlotTransfer(16, 0, 4, plan, ATECC_MAX_TRANSFER_STEPS));
+	CHECK_EQUAL(-1, atecc.planSlotTransfer(SLOT_LARGE, 0, SLOT_SIZE_LARGE, plan, 12));
+	CHECK_EQUAL(0, atecc.planSlotTransfer(SLOT_LARGE, 0, 0, plan, ATECC_MAX_TRANSFER_STEPS));
+}
+
+// SLOT_SMALL readable, the slots written with known data, configuration and data locked
+static boolean setUp(ATECCX08A &atecc, ATECCEmulator &chip)
+{
+	uint8_t image[CONFIG_ZONE_SIZE], data[SLOT_SIZE_LARGE];
+
+	if (!atecc.begin(chip) || !atecc.readConfigZone())
+		return false;
+	memcpy(image, atecc.getConfigZone(), sizeof(image));
+	image[CONFIG_ZONE_SLOT_CONFIG + 2 * SLOT_SMALL] = 0x00;
+	image[CONFIG_ZONE_SLOT_CONFIG + 2 * SLOT_SMALL + 1] = 0x00;
+	if (!atecc.provisionConfigZone(image) || !atecc.lockConfiguration())
+		return false;
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < (int) sizeof(data); j++)
+			data[j] = slots[i] * 16 + j;
+		if (!atecc.writeSlot(data, ATECCX08A::getSlotSize(slots[i]), slots[i]))
+			return false;
+	}
+	return atecc.lockDataAndOTP();
+}
+
+static void testReads()
+{
+	ATECCEmulator chip;
+	ATECCX08A atecc;
+	ATECCTransfer plan[ATECC_MAX_TRANSFER_STEPS];
+	uint8_t data[SLOT_SIZE_LARGE], expected[SLOT_SIZE_LARGE];
+
+	CHECK(setUp(atecc, chip) == true);
+	for (int i = 0; i < 3; i++)
+	{
+		int size = ATECCX08A::getSlotSize(slots[i]);
+		int steps = atecc.planSlotTransfer(slots[i], 0, size, plan, ATECC_MAX_TRANSFER_STEPS);
+
+		for (int j = 0; j < size; j++)
+			expected[j] = slots[i] * 16 + j;
+		chip.resetStatistics();
+		CHECK(atecc.readSlotData(slots[i], 0, data, size) == true);
+		CHECK_EQUAL(steps, chip.getCommandCount(COMMAND_OPCODE_READ));
+		CHECK(memcmp(data, expected, size) == 0);
+
+		// a range across a block boundary
+		chip.resetStatistics();
+		CHECK(atecc.readSlotData(slots[i], 28, data, 8) == true);
+		CHECK_EQUAL(2, chip.getCommandCount(COMMAND_OPCODE_READ));
+		CHECK(memcmp(data, &expected[28], 8) == 0);
+	}
+}
+
+int main()
+{
+	RUN_TEST(testWholeSlots);
+	RUN_TEST(testPartialRanges);
+	RUN_TEST(testReads);
+	return testResult();
+}
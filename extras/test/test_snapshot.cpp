@@ -0,0 +1,136 @@
+/*
+  Tests of the warm start snapshot on the emulator: createSnapshot() and restoreSnapshot() on
+  another instance after a power cycle (two reads, the same configuration zone), stale public keys
+  of slots which aren't locked, and warmStart() falling back to the full discovery for a damaged
+  snapshot and for another IC.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCEmulator.h"
+
+#define SLOT_LOCKED_KEY   0
+#define SLOT_UNLOCKED_KEY 1
+
+
+static const uint8_t keySlots[2] = { SLOT_LOCKED_KEY, SLOT_UNLOCKED_KEY };
+
+// configuration locked, key pairs in both slots, data locked and SLOT_LOCKED_KEY locked
+static boolean setUp(ATECCX08A &atecc, ATECCEmulator &chip)
+{
+	return atecc.begin(chip) && atecc.lockConfiguration() && atecc.createNewKeyPair(NULL, 0, SLOT_LOCKED_KEY) &&
+	       atecc.createNewKeyPair(NULL, 0, SLOT_UNLOCKED_KEY) && atecc.lockDataAndOTP() && atecc.lockDataSlot(SLOT_LOCKED_KEY);
+}
+
+static void testSaveRestore()
+{
+	ATECCEmulator chip;
+	ATECCX08A atecc, warm;
+	ATECCSnapshot snapshot;
+	uint8_t publicKey[PUBLIC_KEY_SIZE], stored[PUBLIC_KEY_SIZE];
+
+	CHECK(setUp(atecc, chip) == true);
+	CHECK(atecc.createSnapshot(snapshot, keySlots, 2) == true);
+	CHECK(atecc.isSnapshotKeyCurrent(SLOT_LOCKED_KEY) == true);
+	CHECK(atecc.isSnapshotKeyCurrent(SLOT_UNLOCKED_KEY) == true);
+	for (int i = 0; i < 2; i++)
+	{
+		CHECK(atecc.generatePublicKey(publicKey, sizeof(publicKey), keySlots[i]) == true);
+		CHECK(ATECCX08A::getSnapshotPublicKey(snapshot, keySlots[i], stored, sizeof(stored)) == true);
+		CHECK(memcmp(publicKey, stored, sizeof(publicKey)) == 0);
+	}
+	CHECK(ATECCX08A::getSnapshotPublicKey(snapshot, 2, stored, sizeof(stored)) == false);
+
+	// after a reset: two reads instead of the discovery, the same configuration zone
+	chip.powerCycle();
+	CHECK(warm.begin(chip) == true);
+	chip.resetStatistics();
+	CHECK(warm.restoreSnapshot(snapshot, keySlots, 2) == true);
+	CHECK_EQUAL(2, chip.getCommandCount(COMMAND_OPCODE_READ));
+	CHECK_EQUAL(0, chip.getCommandCount(COMMAND_OPCODE_GENKEY));
+	CHECK(memcmp(warm.getConfigZone(), chip.getConfigZone(), CONFIG_ZONE_SIZE) == 0);
+
+	// only the key of the locked slot is known to be current
+	CHECK(warm.isSnapshotKeyCurrent(SLOT_LOCKED_KEY) == true);
+	CHECK(warm.isSnapshotKeyCurrent(SLOT_UNLOCKED_KEY) == false);
+	CHECK(warm.isSnapshotKeyCurrent(2) == false);
+
+	// the other slots must match too
+	CHECK(warm.restoreSnapshot(snapshot, keySlots, 1) == false);
+	CHECK_EQUAL(STATUS_VERIFICATION_ERROR, warm.getStatus());
+}
+
+static void testRegeneratedKey()
+{
+	ATECCEmulator chip;
+	ATECCX08A atecc, warm;
+	ATECCSnapshot snapshot;
+	uint8_t publicKey[PUBLIC_KEY_SIZE], stored[PUBLIC_KEY_SIZE];
+
+	CHECK(setUp(atecc, chip) == true);
+	CHECK(atecc.createSnapshot(snapshot, keySlots, 2) == true);
+
+	// GenKey replaces the key of the unlocked slot, the locked slot refuses
+	CHECK(atecc.createNewKeyPair(publicKey, sizeof(publicKey), SLOT_UNLOCKED_KEY) == true);
+	CHECK(atecc.isSnapshotKeyCurrent(SLOT_UNLOCKED_KEY) == false);
+	CHECK(atecc.isSnapshotKeyCurrent(SLOT_LOCKED_KEY) == true);
+	CHECK(ATECCX08A::getSnapshotPublicKey(snapshot, SLOT_UNLOCKED_KEY, stored, sizeof(stored)) == true);
+	CHECK(memcmp(publicKey, stored, sizeof(publicKey)) != 0);
+	CHECK(atecc.createNewKeyPair(NULL, 0, SLOT_LOCKED_KEY) == false);
+
+	// after a reset the stale key is flagged
+	chip.powerCycle();
+	CHECK(warm.begin(chip) == true);
+	CHECK(warm.restoreSnapshot(snapshot, keySlots, 2) == true);
+	CHECK(warm.isSnapshotKeyCurrent(SLOT_UNLOCKED_KEY) == false);
+	CHECK(warm.isSnapshotKeyCurrent(SLOT_LOCKED_KEY) == true);
+	CHECK(ATECCX08A::getSnapshotPublicKey(snapshot, SLOT_LOCKED_KEY, stored, sizeof(stored)) == true);
+	CHECK(warm.generatePublicKey(publicKey, sizeof(publicKey), SLOT_LOCKED_KEY) == true);
+	CHECK(memcmp(publicKey, stored, sizeof(publicKey)) == 0);
+}
+
+static void testWarmStart()
+{
+	const uint8_t otherSerial[9] = { 0x01, 0x23, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0xEE };
+	ATECCEmulator chip, other;
+	ATECCX08A atecc, warm, otherDevice;
+	ATECCSnapshot snapshot, damaged;
+	boolean updated = true;
+
+	CHECK(setUp(atecc, chip) == true);
+	CHECK(atecc.createSnapshot(snapshot, keySlots, 2) == true);
+
+	// an intact snapshot of this IC is used as it is
+	chip.powerCycle();
+	CHECK(warm.begin(chip) == true);
+	damaged = snapshot;
+	CHECK(warm.warmStart(damaged, keySlots, 2, updated) == true);
+	CHECK(updated == false);
+	CHECK(memcmp(&damaged, &snapshot, sizeof(snapshot)) == 0);
+
+	// a damaged snapshot is replaced by the full discovery
+	damaged.publicKey[0][5] ^= 0x01;
+	CHECK(warm.restoreSnapshot(damaged) == false);
+	CHECK_EQUAL(STATUS_VERIFICATION_ERROR, warm.getStatus());
+	CHECK(warm.warmStart(damaged, keySlots, 2, updated) == true);
+	CHECK(updated == true);
+	CHECK(memcmp(&damaged, &snapshot, sizeof(snapshot)) == 0);
+	CHECK(warm.isSnapshotKeyCurrent(SLOT_UNLOCKED_KEY) == true);
+
+	// the snapshot of another IC
+	ATECCEmulator::initImage(*other.getImage(), ATECC_MODEL_608A, ATECC508A_ADDRESS_DEFAULT, otherSerial);
+	other.powerCycle();
+	CHECK(setUp(otherDevice, other) == true);
+	damaged = snapshot;
+	CHECK(otherDevice.restoreSnapshot(damaged) == false);
+	CHECK(otherDevice.warmStart(damaged, keySlots, 2, updated) == true);
+	CHECK(updated == true);
+	CHECK(memcmp(damaged.configZone, other.getConfigZone(), CONFIG_ZONE_SIZE) == 0);
+}
+
+int main()
+{
+	RUN_TEST(testSaveRestore);
+	RUN_TEST(testRegeneratedKey);
+	RUN_TEST(testWarmStart);
+	return testResult();
+}
@@ -0,0 +1,167 @@
+/*
+  Tests of the bus trace: ATECCTraceTransport records a session of the library with the emulator,
+  ATECCReplayTransport plays it back to another ATECCX08A with the same results, detects the record
+  where the library diverges from the trace, and a small ring buffer drops the oldest records.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCEmulator.h"
+#include "ATECCTrace.h"
+
+#define TRACE_BUFFER_SIZE 8192
+
+
+static uint8_t traceBuffer[TRACE_BUFFER_SIZE];
+static uint8_t trace[TRACE_BUFFER_SIZE + ATECC_TRACE_HEADER_SIZE];
+
+// number of complete records of a trace, -1 if a record is cut off
+static long countRecords(const uint8_t *data, size_t length, long types[4])
+{
+	ATECCTraceRecord record;
+	size_t offset = ATECC_TRACE_HEADER_SIZE;
+	long count = 0;
+
+	while (offset < length)
+	{
+		int size = ATECCTraceTransport::parseRecord(&data[offset], length - offset, record);
+
+		if (size == 0 || record.type < ATECC_TRACE_WAKE || record.type > ATECC_TRACE_READ)
+			return -1;
+		if (types != NULL)
+			types[record.type]++;
+		offset += size;
+		count++;
+	}
+	return count;
+}
+
+// the session which is recorded and replayed
+static boolean runSession(ATECCX08A &atecc, uint8_t *random, uint8_t *digest, const uint8_t *message)
+{
+	return atecc.readConfigZone() && atecc.generateRandomBytes(random, 32) && atecc.sha256(message, 100, digest);
+}
+
+static void testRecordReplay()
+{
+	ATECCEmulator chip;
+	ATECCTraceTransport recorder(chip, traceBuffer, sizeof(traceBuffer));
+	ATECCX08A atecc, replayed;
+	uint8_t message[100], random[32], random2[32], digest[32], digest2[32];
+	long types[4] = { 0 };
+	unsigned long dropped = 1;
+	size_t length;
+
+	for (int i = 0; i < (int) sizeof(message); i++)
+		message[i] = i ^ 0x5A;
+	CHECK(atecc.begin(recorder) == true);
+	CHECK(atecc.lockConfiguration() == true);   // random numbers instead of the fixed pattern
+	CHECK(runSession(atecc, random, digest, message) == true);
+
+	length = recorder.getTrace(trace, sizeof(trace));
+	CHECK(length == recorder.getTraceSize());
+	CHECK(ATECCTraceTransport::checkHeader(trace, length, &dropped) == true);
+	CHECK_EQUAL(0, dropped);
+	CHECK(countRecords(trace, length, types) > 0);
+	CHECK(types[ATECC_TRACE_WAKE] > 0);
+	CHECK(types[ATECC_TRACE_WRITE] > 0);
+	CHECK(types[ATECC_TRACE_READ] >= types[ATECC_TRACE_WRITE]);
+
+	// the replay gives the library the same responses
+	ATECCReplayTransport replay(trace, length);
+	CHECK(replay.isValid() == true);
+	CHECK(replayed.begin(replay) == true);
+	CHECK(replayed.lockConfiguration() == true);
+	CHECK(runSession(replayed, random2, digest2, message) == true);
+	CHECK(memcmp(random, random2, sizeof(random)) == 0);
+	CHECK(memcmp(digest, digest2, sizeof(digest)) == 0);
+	CHECK(memcmp(atecc.getConfigZone(), replayed.getConfigZone(), CONFIG_ZONE_SIZE) == 0);
+	CHECK(replay.hasDiverged() == false);
+	CHECK(replay.isFinished() == true);
+	CHECK_EQUAL(countRecords(trace, length, NULL), replay.getPosition());
+}
+
+static void testDivergence()
+{
+	ATECCEmulator chip;
+	ATECCTraceTransport recorder(chip, traceBuffer, sizeof(traceBuffer));
+	ATECCX08A atecc, replayed;
+	uint8_t message[100], random[32], digest[32];
+	ATECCTraceRecord record;
+	size_t length, offset = ATECC_TRACE_HEADER_SIZE;
+	long prefix;
+
+	for (int i = 0; i < (int) sizeof(message); i++)
+		message[i] = i;
+	CHECK(atecc.begin(recorder) == true);
+	CHECK(atecc.readConfigZone() == true);
+	prefix = countRecords(trace, recorder.getTrace(trace, sizeof(trace)), NULL);
+	CHECK(atecc.sha256(message, sizeof(message), digest) == true);
+	length = recorder.getTrace(trace, sizeof(trace));
+
+	// another frame: the first message byte differs, the SHA start frame doesn't
+	message[0] ^= 0x01;
+	ATECCReplayTransport replay(trace, length);
+	CHECK(replayed.begin(replay) == true);
+	CHECK(replayed.readConfigZone() == true);
+	CHECK_EQUAL(prefix, replay.getPosition());
+	CHECK(replayed.sha256(message, sizeof(message), digest) == false);
+	CHECK(replay.hasDiverged() == true);
+	CHECK(replay.getDivergence() > prefix);
+	for (long i = 0; i < replay.getDivergence(); i++)
+		offset += ATECCTraceTransport::parseRecord(&trace[offset], length - offset, record);
+	CHECK(ATECCTraceTransport::parseRecord(&trace[offset], length - offset, record) > 0);
+	CHECK_EQUAL(ATECC_TRACE_WRITE, record.type);
+	CHECK_EQUAL(message[0] ^ 0x01, record.data[6]);   // word address, count, opcode, param1, param2 (2)
+
+	// another call: the wake and its response match, the SHA start frame of the trace doesn't
+	ATECCReplayTransport replay2(trace, length);
+	CHECK(replayed.begin(replay2) == true);
+	CHECK(replayed.readConfigZone() == true);
+	CHECK(replayed.generateRandomBytes(random, sizeof(random)) == false);
+	CHECK(replay2.hasDiverged() == true);
+	CHECK_EQUAL(prefix + 2, replay2.getDivergence());
+
+	// after a divergence every call fails
+	CHECK(replayed.readConfigZone() == false);
+	CHECK_EQUAL(prefix + 2, replay2.getDivergence());
+
+	// a damaged header
+	trace[0] = 'X';
+	ATECCReplayTransport replay3(trace, length);
+	CHECK(replay3.isValid() == false);
+	CHECK(replayed.begin(replay3) == false);
+}
+
+static void testDropped()
+{
+	ATECCEmulator chip;
+	uint8_t small[256];
+	ATECCTraceTransport recorder(chip, small, sizeof(small));
+	ATECCX08A atecc;
+	unsigned long dropped = 0;
+	size_t length;
+
+	CHECK(atecc.begin(recorder) == true);
+	CHECK(atecc.readConfigZone() == true);
+	CHECK(recorder.getDropped() > 0);
+	CHECK(recorder.getTraceSize() <= ATECC_TRACE_HEADER_SIZE + sizeof(small));
+
+	// the oldest records are dropped as a whole, the remaining ones are complete
+	length = recorder.getTrace(trace, sizeof(trace));
+	CHECK(ATECCTraceTransport::checkHeader(trace, length, &dropped) == true);
+	CHECK_EQUAL(recorder.getDropped(), dropped);
+	CHECK(countRecords(trace, length, NULL) > 0);
+	CHECK_EQUAL(0, recorder.getTrace(trace, recorder.getTraceSize() - 1));
+
+	recorder.clear();
+	CHECK_EQUAL(0, recorder.getDropped());
+	CHECK_EQUAL(ATECC_TRACE_HEADER_SIZE, recorder.getTraceSize());
+}
+
+int main()
+{
+	RUN_TEST(testRecordReplay);
+	RUN_TEST(testDivergence);
+	RUN_TEST(testDropped);
+	return testResult();
+}
@@ -0,0 +1,126 @@
+/*
+  Tests of the transport split: the library driven through ATECCMockTransport (round trip of
+  wake, command and response, NACKs, short reads) and ATECCLinuxTransport without a device.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCMockDevice.h"
+#include "ATECCLinuxTransport.h"
+
+
+static void testRoundTrip()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	uint8_t random[32];
+	const uint8_t *frame;
+	size_t length;
+
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+	CHECK(mock.getWakeCount() > 0);
+	CHECK(atecc.getModel() == ATECC_MODEL_608A);
+
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == true);
+	CHECK_EQUAL(STATUS_SUCCESS, atecc.getStatus());
+	for (int i = 0; i < 32; i++)
+		CHECK_EQUAL(i + 1, random[i]);
+
+	// word address, count, opcode, param1, param2, CRC
+	frame = mock.getLastFrame(length);
+	CHECK_EQUAL(8, length);
+	CHECK_EQUAL(WORD_ADDRESS_VALUE_COMMAND, frame[0]);
+	CHECK_EQUAL(7, frame[1]);
+	CHECK_EQUAL(COMMAND_OPCODE_RANDOM, frame[2]);
+	CHECK_EQUAL(0x00, frame[3]);
+	CHECK_EQUAL(0x0000, frame[4] | (frame[5] << 8));
+	CHECK_EQUAL(ATECCX08A::calculateSummaryCrc(&frame[1], 5), frame[6] | (frame[7] << 8));
+	CHECK(mock.getIdleCount() > 0);   // the IC goes idle after every command
+}
+
+static void testWakeFailure()
+{
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+
+	mock.setNacks(ATRCC508A_MAX_RETRIES);
+	CHECK(atecc.begin(mock) == false);
+	CHECK_EQUAL(ATRCC508A_MAX_RETRIES, mock.getNackCount());
+	CHECK_EQUAL(0, mock.getFrameCount());
+}
+
+static void testNacks()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	uint8_t random[32];
+
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+
+	// the IC is still busy for a few reads, the library retries
+	device.nacks = 3;
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == true);
+	CHECK_EQUAL(3, mock.getNackCount());
+	CHECK_EQUAL(1, random[0]);
+
+	// no answer within the retries
+	device.nacks = ATRCC508A_MAX_RETRIES;
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == false);
+	CHECK_EQUAL(STATUS_TIMEOUT_ERROR, atecc.getStatus());
+	CHECK_EQUAL(3 + ATRCC508A_MAX_RETRIES, mock.getNackCount());
+	mock.clearResponses();
+}
+
+static void testShortReads()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	uint8_t random[32];
+	uint8_t truncated[10] = { 35 };
+
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+
+	// 35 bytes arrive in pieces of 5
+	mock.setReadLimit(5);
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == true);
+	for (int i = 0; i < 32; i++)
+		CHECK_EQUAL(i + 1, random[i]);
+
+	// the IC stops after 10 bytes
+	mock.setReadLimit(0);
+	device.respond = false;
+	mock.queueResponse(truncated, sizeof(truncated));
+	CHECK(atecc.generateRandomBytes(random, sizeof(random)) == false);
+	CHECK_EQUAL(STATUS_TIMEOUT_ERROR, atecc.getStatus());
+}
+
+static void testLinuxTransport()
+{
+	ATECCLinuxTransport bus("/dev/i2c-does-not-exist");
+	uint8_t data[4] = { 0 };
+	unsigned long start;
+
+	CHECK(bus.begin() == false);
+	CHECK(bus.wake() == false);
+	CHECK(bus.write(ATECC508A_ADDRESS_DEFAULT, data, sizeof(data)) == false);
+	CHECK_EQUAL(0, bus.read(ATECC508A_ADDRESS_DEFAULT, data, sizeof(data)));
+
+	start = bus.micros();
+	bus.delayMicroseconds(2000);
+	CHECK(bus.micros() - start >= 2000);
+}
+
+int main()
+{
+	RUN_TEST(testRoundTrip);
+	RUN_TEST(testWakeFailure);
+	RUN_TEST(testNacks);
+	RUN_TEST(testShortReads);
+	RUN_TEST(testLinuxTransport);
+	return testResult();
+}
@@ -0,0 +1,97 @@
+/*
+  Tests of the write counters of writeSlotDifferential() and provisionConfigZone() on
+  ATECCMockTransport: getWritesIssued() counts write commands, getWritesSkipped() 4 byte words.
+*/
+
+#include "ATECCTest.h"
+#include "ATECCMockDevice.h"
+
+
+static void testSlotDifferential()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	uint8_t data[32];
+
+	memset(device.slots[9], 0x55, MOCK_DEVICE_SLOT_SIZE);
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+	memset(data, 0x55, sizeof(data));
+
+	// nothing changed: the 8 words of the block are skipped
+	CHECK(atecc.writeSlotDifferential(9, 0, data, sizeof(data)) == true);
+	CHECK_EQUAL(0, atecc.getWritesIssued());
+	CHECK_EQUAL(8, atecc.getWritesSkipped());
+
+	// one changed word: a 4 byte write, 7 words skipped
+	atecc.resetWriteCounters();
+	data[4] = 0x01;
+	CHECK(atecc.writeSlotDifferential(9, 0, data, sizeof(data)) == true);
+	CHECK_EQUAL(1, atecc.getWritesIssued());
+	CHECK_EQUAL(7, atecc.getWritesSkipped());
+	CHECK_EQUAL(0x01, device.slots[9][4]);
+
+	// two changed words: one 32 byte write, nothing skipped
+	atecc.resetWriteCounters();
+	data[0] = 0x02;
+	data[28] = 0x03;
+	CHECK(atecc.writeSlotDifferential(9, 0, data, sizeof(data)) == true);
+	CHECK_EQUAL(1, atecc.getWritesIssued());
+	CHECK_EQUAL(0, atecc.getWritesSkipped());
+	CHECK(memcmp(device.slots[9], data, sizeof(data)) == 0);
+
+	// a range of 3 words in the second block
+	atecc.resetWriteCounters();
+	CHECK(atecc.writeSlotDifferential(9, 36, &device.slots[9][36], 12) == true);
+	CHECK_EQUAL(0, atecc.getWritesIssued());
+	CHECK_EQUAL(3, atecc.getWritesSkipped());
+}
+
+static void testProvisionConfigZone()
+{
+	ATECCMockDevice device;
+	ATECCMockTransport mock;
+	ATECCX08A atecc;
+	uint8_t image[CONFIG_ZONE_SIZE];
+	int     writableWords = 0;
+
+	device.configZone[CONFIG_ZONE_LOCK_STATUS] = 0x55;   // configuration not locked
+	mock.setHandler(mockDeviceHandler, &device);
+	CHECK(atecc.begin(mock) == true);
+	for (int word = 0; word < CONFIG_ZONE_SIZE; word += 4)
+	{
+		if (ATECCX08A::isConfigByteWritable(word) == true)
+			writableWords++;
+	}
+
+	// nothing changed: every writable word is skipped
+	memcpy(image, device.configZone, sizeof(image));
+	CHECK(atecc.provisionConfigZone(image) == true);
+	CHECK_EQUAL(0, atecc.getWritesIssued());
+	CHECK_EQUAL(writableWords, atecc.getWritesSkipped());
+
+	// one word in block 0 (word by word) and one in block 1 (4 byte write)
+	atecc.resetWriteCounters();
+	image[20] = 0x8F;
+	image[40] = 0x11;
+	CHECK(atecc.provisionConfigZone(image) == true);
+	CHECK_EQUAL(2, atecc.getWritesIssued());
+	CHECK_EQUAL(writableWords - 2, atecc.getWritesSkipped());
+
+	// two more words in block 1: one 32 byte write, its 8 words aren't skipped
+	atecc.resetWriteCounters();
+	image[44] = 0x22;
+	image[60] = 0x33;
+	CHECK(atecc.provisionConfigZone(image) == true);
+	CHECK_EQUAL(1, atecc.getWritesIssued());
+	CHECK_EQUAL(writableWords - 8, atecc.getWritesSkipped());
+	CHECK(memcmp(device.configZone, image, sizeof(image)) == 0);
+}
+
+int main()
+{
+	RUN_TEST(testSlotDifferential);
+	RUN_TEST(testProvisionConfigZone);
+	return testResult();
+}
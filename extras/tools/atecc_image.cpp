@@ -0,0 +1,275 @@
+/*
+  atecc_image: creates, inspects and compares ATECCEmulatorImage files of the emulator.
+
+    atecc_image create <file> [-m 508a|608a|608b] [-a address] [-s serial] [-r seed] [-n count]
+    atecc_image info <file>
+    atecc_image diff <file1> <file2>
+
+  create writes the image of a fresh (unlocked) IC. serial are the 9 bytes of the serial number in hex,
+  seed the seed of the random numbers. With -n count, file is a printf pattern (e.g. dev%03d.img) and
+  count devices are created, device i with serial + i (bytes 4-7) and seed + i, so they are distinct.
+  diff exits with 0 if the images are the same, 1 if they differ and 2 on errors, like diff.
+
+  Build on the host (from the repository root) with the library, the emulator and the host core:
+    g++ -DARDUINO=10810 -Iextras/host -Isrc -Iextras/emulator extras/tools/atecc_image.cpp
+        src/(all .cpp) extras/host/Arduino.cpp extras/emulator/(all .cpp) -o atecc_image
+*/
+
+#include <stdio.h>
+#include "ATECCEmulatorImageFile.h"
+
+
+static const uint8_t defaultSerialNumber[9] = { 0x01, 0x23, 0xF5, 0x2E, 0x01, 0xF0, 0xC2, 0x01, 0xEE };
+
+static const char *modelName(uint8_t model)
+{
+	switch (model)
+	{
+		case ATECC_MODEL_508A: return "ATECC508A";
+		case ATECC_MODEL_608A: return "ATECC608A";
+		case ATECC_MODEL_608B: return "ATECC608A (revision 3)";
+	}
+	return "unknown";
+}
+
+static int slotOffset(int slot)
+{
+	int offset = 0;
+
+	for (int i = 0; i < slot; i++)
+		offset += ATECCX08A::getSlotSize(i);
+	return offset;
+}
+
+static boolean isErased(const uint8_t *data, int length)
+{
+	for (int i = 0; i < length; i++)
+	{
+		if (data[i] != 0xFF)
+			return false;
+	}
+	return true;
+}
+
+static boolean parseSerialNumber(const char *text, uint8_t *serialNumber)
+{
+	unsigned int value;
+
+	if (strlen(text) != 18)
+		return false;
+	for (int i = 0; i < 9; i++)
+	{
+		if (sscanf(&text[2 * i], "%2x", &value) != 1)
+			return false;
+		serialNumber[i] = value;
+	}
+	return true;
+}
+
+static int usage()
+{
+	fprintf(stderr, "usage: atecc_image create <file> [-m 508a|608a|608b] [-a address] [-s serial] [-r seed] [-n count]\n"
+	                "       atecc_image info <file>\n"
+	                "       atecc_image diff <file1> <file2>\n");
+	return 2;
+}
+
+
+static int create(int argc, char **argv)
+{
+	const char *pattern = argv[0];
+	uint8_t  model = ATECC_MODEL_608A;
+	uint8_t  address = ATECC508A_ADDRESS_DEFAULT;
+	uint8_t  serialNumber[9];
+	uint32_t seed = 1;
+	long     count = 0;
+
+	memcpy(serialNumber, defaultSerialNumber, sizeof(serialNumber));
+	for (int i = 1; i < argc; i++)
+	{
+		if (i + 1 >= argc)
+			return usage();
+		if (strcmp(argv[i], "-m") == 0)
+		{
+			i++;
+			if (strcmp(argv[i], "508a") == 0)
+				model = ATECC_MODEL_508A;
+			else if (strcmp(argv[i], "608a") == 0)
+				model = ATECC_MODEL_608A;
+			else if (strcmp(argv[i], "608b") == 0)
+				model = ATECC_MODEL_608B;
+			else
+				return usage();
+		}
+		else if (strcmp(argv[i], "-a") == 0)
+			address = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "-s") == 0)
+		{
+			if (!parseSerialNumber(argv[++i], serialNumber))
+				return usage();
+		}
+		else if (strcmp(argv[i], "-r") == 0)
+			seed = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "-n") == 0)
+			count = strtol(argv[++i], NULL, 0);
+		else
+			return usage();
+	}
+
+	for (long n = 0; n < (count > 0 ? count : 1); n++)
+	{
+		ATECCEmulatorImageFile file;
+		char     path[4096];
+		uint8_t  deviceSerialNumber[9];
+		uint32_t part = 0;
+
+		if (count > 0)
+			snprintf(path, sizeof(path), pattern, (int) n);
+		else
+			snprintf(path, sizeof(path), "%s", pattern);
+		// serial number bytes 4-7 + n
+		memcpy(deviceSerialNumber, serialNumber, sizeof(deviceSerialNumber));
+		for (int i = 4; i < 8; i++)
+			part = (part << 8) | deviceSerialNumber[i];
+		part += n;
+		for (int i = 7; i >= 4; i--, part >>= 8)
+			deviceSerialNumber[i] = part & 0xFF;
+
+		if (!file.create(path, model, address, deviceSerialNumber, seed + n))
+		{
+			fprintf(stderr, "atecc_image: can't create %s\n", path);
+			return 2;
+		}
+		file.close();
+	}
+	return 0;
+}
+
+
+static int info(const char *path)
+{
+	ATECCEmulatorImageFile file;
+	const ATECCEmulatorImage *image;
+	const uint8_t *config;
+
+	if (!file.open(path, true))
+	{
+		fprintf(stderr, "atecc_image: %s isn't a valid image\n", path);
+		return 2;
+	}
+	image = file.getImage();
+	config = image->configZone;
+
+	printf("image     %s, version %d, %d bytes, CRC ok\n", path, image->version, (int) sizeof(*image));
+	printf("model     %s, revision %02X %02X %02X %02X\n", modelName(image->model),
+	       config[CONFIG_ZONE_REVISION_NUMBER], config[CONFIG_ZONE_REVISION_NUMBER + 1],
+	       config[CONFIG_ZONE_REVISION_NUMBER + 2], config[CONFIG_ZONE_REVISION_NUMBER + 3]);
+	printf("serial    %02X%02X%02X%02X%02X%02X%02X%02X%02X\n", config[0], config[1], config[2], config[3],
+	       config[8], config[9], config[10], config[11], config[12]);
+	printf("address   0x%02X\n", config[CONFIG_ZONE_I2C_ADDRESS] >> 1);
+	printf("chip mode 0x%02X\n", config[CONFIG_ZONE_CHIP_MODE]);
+	printf("config    %s\n", config[CONFIG_ZONE_LOCK_STATUS] == 0x55 ? "unlocked" : "locked");
+	printf("data/OTP  %s\n", config[CONFIG_ZONE_OTP_LOCK] == 0x55 ? "unlocked" : "locked");
+	printf("OTP       %s\n", isErased(image->otpZone, sizeof(image->otpZone)) ? "erased" : "written");
+	printf("\nslot  size  SlotConfig  KeyConfig  locked  contents\n");
+	for (int slot = 0; slot < 16; slot++)
+	{
+		uint16_t slotConfig = config[CONFIG_ZONE_SLOT_CONFIG + 2 * slot] | (config[CONFIG_ZONE_SLOT_CONFIG + 2 * slot + 1] << 8);
+		uint16_t keyConfig = config[CONFIG_ZONE_KEY_CONFIG + 2 * slot] | (config[CONFIG_ZONE_KEY_CONFIG + 2 * slot + 1] << 8);
+		boolean  locked = ((config[CONFIG_ZONE_SLOTS_LOCK0 + slot / 8] >> (slot % 8)) & 0x01) == 0;
+		const uint8_t *data = &image->dataZone[slotOffset(slot)];
+		const char *contents = "data";
+
+		if (isErased(data, ATECCX08A::getSlotSize(slot)))
+			contents = "erased";
+		else if ((keyConfig & 0x0001) && data[0] == 0 && data[1] == 0 && data[2] == 0 && data[3] == 0)
+			contents = "private key";
+		printf("%4d  %4d  0x%04X      0x%04X     %-6s  %s\n", slot, ATECCX08A::getSlotSize(slot), slotConfig, keyConfig,
+		       locked ? "yes" : "no", contents);
+	}
+	return 0;
+}
+
+
+// prints the ranges of zone where a and b differ, returns the number of differing bytes
+static int diffRange(const char *zone, int base, const uint8_t *a, const uint8_t *b, int length)
+{
+	int differences = 0;
+
+	for (int i = 0; i < length; )
+	{
+		int end = i;
+
+		if (a[i] == b[i])
+		{
+			i++;
+			continue;
+		}
+		while (end < length && a[end] != b[end])
+			end++;
+		printf("%s bytes %d-%d:", zone, base + i, base + end - 1);
+		if (end - i <= 16)
+		{
+			printf(" ");
+			for (int j = i; j < end; j++)
+				printf("%02X", a[j]);
+			printf(" -> ");
+			for (int j = i; j < end; j++)
+				printf("%02X", b[j]);
+		}
+		else
+			printf(" %d bytes", end - i);
+		printf("\n");
+		differences += end - i;
+		i = end;
+	}
+	return differences;
+}
+
+static int diff(const char *path1, const char *path2)
+{
+	ATECCEmulatorImageFile file1, file2;
+	const ATECCEmulatorImage *a, *b;
+	int differences = 0;
+
+	if (!file1.open(path1, true) || !file2.open(path2, true))
+	{
+		fprintf(stderr, "atecc_image: %s isn't a valid image\n", file1.getImage() == NULL ? path1 : path2);
+		return 2;
+	}
+	a = file1.getImage();
+	b = file2.getImage();
+
+	if (a->model != b->model)
+	{
+		printf("model: %s -> %s\n", modelName(a->model), modelName(b->model));
+		differences++;
+	}
+	if (memcmp(a->rng, b->rng, sizeof(a->rng)) != 0)
+	{
+		printf("RNG state differs\n");
+		differences++;
+	}
+	differences += diffRange("config", 0, a->configZone, b->configZone, sizeof(a->configZone));
+	for (int slot = 0; slot < 16; slot++)
+	{
+		char zone[16];
+
+		snprintf(zone, sizeof(zone), "slot %d", slot);
+		differences += diffRange(zone, 0, &a->dataZone[slotOffset(slot)], &b->dataZone[slotOffset(slot)], ATECCX08A::getSlotSize(slot));
+	}
+	differences += diffRange("OTP", 0, a->otpZone, b->otpZone, sizeof(a->otpZone));
+	return differences > 0 ? 1 : 0;
+}
+
+
+int main(int argc, char **argv)
+{
+	if (argc >= 3 && strcmp(argv[1], "create") == 0)
+		return create(argc - 2, argv + 2);
+	if (argc == 3 && strcmp(argv[1], "info") == 0)
+		return info(argv[2]);
+	if (argc == 4 && strcmp(argv[1], "diff") == 0)
+		return diff(argv[2], argv[3]);
+	return usage();
+}
@@ -0,0 +1,222 @@
+/*
+  atecc_trace: decodes a bus trace of ATECCTraceTransport (src/ATECCTrace.h).
+
+    atecc_trace [-s] <file>
+
+  Prints one line per record (time since the first record in us, the call, the decoded frame or
+  response) followed by a summary per opcode: number of commands and the time from the command frame
+  until the last read of its response (mean and maximum). -s prints the summary only.
+
+  Build on the host (from the repository root) with the library and the host core:
+    g++ -DARDUINO=10810 -Iextras/host -Isrc extras/tools/atecc_trace.cpp src/(all .cpp)
+        extras/host/Arduino.cpp -o atecc_trace
+*/
+
+#include <stdio.h>
+#include "SparkFun_ATECCX08a_Arduino_Library.h"
+#include "ATECCTrace.h"
+
+#define TRACE_MAX_SIZE  (16 * 1024 * 1024)
+
+
+static const char *opcodeName(uint8_t opcode)
+{
+	switch (opcode)
+	{
+		case COMMAND_OPCODE_INFO:     return "Info";
+		case COMMAND_OPCODE_LOCK:     return "Lock";
+		case COMMAND_OPCODE_RANDOM:   return "Random";
+		case COMMAND_OPCODE_READ:     return "Read";
+		case COMMAND_OPCODE_WRITE:    return "Write";
+		case COMMAND_OPCODE_SHA:      return "SHA";
+		case COMMAND_OPCODE_GENKEY:   return "GenKey";
+		case COMMAND_OPCODE_NONCE:    return "Nonce";
+		case COMMAND_OPCODE_SIGN:     return "Sign";
+		case COMMAND_OPCODE_VERIFY:   return "Verify";
+		case COMMAND_OPCODE_AES:      return "AES";
+		case COMMAND_OPCODE_KDF:      return "KDF";
+		case COMMAND_OPCODE_MAC:      return "MAC";
+		case COMMAND_OPCODE_CHECKMAC: return "CheckMac";
+	}
+	return "unknown";
+}
+
+static const char *statusName(uint8_t status)
+{
+	switch (status)
+	{
+		case STATUS_SUCCESS:             return "success";
+		case STATUS_VERIFICATION_ERROR:  return "verification error";
+		case STATUS_PARSE_ERROR:         return "parse error";
+		case STATUS_ECC_FAULT:           return "ECC fault";
+		case STATUS_SELFTEST_ERROR:      return "self test error";
+		case STATUS_EXECUTION_ERROR:     return "execution error";
+		case STATUS_WAKE_TOKEN_RECEIVED: return "wake";
+		case STATUS_WATCHDOG_EXPIRATION: return "watchdog expiration";
+		case STATUS_CRC_ERROR:           return "CRC error";
+	}
+	return "unknown";
+}
+
+static void printHex(const uint8_t *data, int length)
+{
+	for (int i = 0; i < length; i++)
+		printf("%02X", data[i]);
+}
+
+static boolean checkFrameCrc(const uint8_t *packet, int length)
+{
+	uint16_t crc;
+
+	if (length < 3)
+		return false;
+	crc = ATECCX08A::calculateSummaryCrc(packet, length - CRC_SIZE);
+	return packet[length - 2] == (crc & 0xFF) && packet[length - 1] == (crc >> 8);
+}
+
+static void printRecord(const ATECCTraceRecord &record, uint32_t time)
+{
+	printf("%10lu  ", (unsigned long) time);
+	switch (record.type)
+	{
+		case ATECC_TRACE_WAKE:
+			printf("wake%s\n", record.param ? "" : " failed");
+			return;
+
+		case ATECC_TRACE_WRITE:
+			printf("write 0x%02X%s ", record.address, record.param ? "" : " NACK");
+			if (record.length == 0)
+				printf("(empty)");
+			else if (record.data[0] == WORD_ADDRESS_VALUE_COMMAND && record.length >= 8)
+			{
+				const uint8_t *packet = &record.data[1];
+
+				printf("%s param1 0x%02X param2 0x%04X", opcodeName(packet[1]), packet[2], packet[3] | (packet[4] << 8));
+				if (record.length > 8)
+				{
+					printf(" data ");
+					printHex(&packet[5], record.length - 8);
+				}
+				if (packet[0] != record.length - 1 || !checkFrameCrc(packet, record.length - 1))
+					printf(" (bad count or CRC)");
+			}
+			else if (record.data[0] == WORD_ADDRESS_VALUE_IDLE)
+				printf("idle");
+			else if (record.data[0] == 0x01)
+				printf("sleep");
+			else if (record.data[0] == 0x00)
+				printf("reset");
+			else
+				printHex(record.data, record.length);
+			printf("\n");
+			return;
+
+		case ATECC_TRACE_READ:
+			printf("read  0x%02X %d/%d ", record.address, record.length, record.param);
+			if (record.length == 0)
+				printf("NACK");
+			else
+				printHex(record.data, record.length);
+			// a complete status response
+			if (record.length == 4 && record.data[0] == 4 && checkFrameCrc(record.data, 4))
+				printf(" (%s)", statusName(record.data[1]));
+			printf("\n");
+			return;
+	}
+	printf("unknown record %d\n", record.type);
+}
+
+
+typedef struct
+{
+	unsigned long count;
+	unsigned long total;      // us
+	unsigned long maximum;    // us
+} OpcodeSummary;
+
+int main(int argc, char **argv)
+{
+	static uint8_t trace[TRACE_MAX_SIZE];
+	static OpcodeSummary summary[256];
+	const char *path = argv[argc - 1];
+	boolean  summaryOnly = (argc == 3 && strcmp(argv[1], "-s") == 0);
+	unsigned long dropped, records = 0;
+	size_t   length, offset = ATECC_TRACE_HEADER_SIZE;
+	uint32_t start = 0, commandTime = 0, lastRead = 0;
+	int      opcode = -1;    // command whose response is read
+	FILE    *file;
+
+	if (argc != 2 && !summaryOnly)
+	{
+		fprintf(stderr, "usage: atecc_trace [-s] <file>\n");
+		return 2;
+	}
+	file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "atecc_trace: can't open %s\n", path);
+		return 2;
+	}
+	length = fread(trace, 1, sizeof(trace), file);
+	fclose(file);
+	if (!ATECCTraceTransport::checkHeader(trace, length, &dropped))
+	{
+		fprintf(stderr, "atecc_trace: %s isn't a trace of version %d\n", path, ATECC_TRACE_VERSION);
+		return 2;
+	}
+
+	while (offset < length)
+	{
+		ATECCTraceRecord record;
+		int size = ATECCTraceTransport::parseRecord(&trace[offset], length - offset, record);
+
+		if (size == 0)
+		{
+			fprintf(stderr, "atecc_trace: truncated record at byte %lu\n", (unsigned long) offset);
+			break;
+		}
+		if (records == 0)
+			start = record.time;
+		if (!summaryOnly)
+			printRecord(record, record.time - start);
+
+		// a command ends with the last read before the next wake or write
+		if (record.type == ATECC_TRACE_READ && record.length > 0)
+			lastRead = record.time;
+		else if (record.type != ATECC_TRACE_READ)
+		{
+			if (opcode >= 0 && lastRead != commandTime)
+			{
+				summary[opcode].count++;
+				summary[opcode].total += lastRead - commandTime;
+				if (lastRead - commandTime > summary[opcode].maximum)
+					summary[opcode].maximum = lastRead - commandTime;
+			}
+			opcode = -1;
+			if (record.type == ATECC_TRACE_WRITE && record.length >= 8 && record.data[0] == WORD_ADDRESS_VALUE_COMMAND)
+			{
+				opcode = record.data[2];
+				commandTime = record.time;
+				lastRead = commandTime;
+			}
+		}
+		offset += size;
+		records++;
+	}
+	if (opcode >= 0 && lastRead != commandTime)
+	{
+		summary[opcode].count++;
+		summary[opcode].total += lastRead - commandTime;
+		if (lastRead - commandTime > summary[opcode].maximum)
+			summary[opcode].maximum = lastRead - commandTime;
+	}
+
+	printf("%s%lu records, %lu dropped\n\n", summaryOnly ? "" : "\n", records, dropped);
+	printf("opcode      count    mean us     max us\n");
+	for (int i = 0; i < 256; i++)
+	{
+		if (summary[i].count > 0)
+			printf("%-10s %6lu %10lu %10lu\n", opcodeName(i), summary[i].count, summary[i].total / summary[i].count, summary[i].maximum);
+	}
+	return 0;
+}
@@ -29,21 +29,15 @@ void  ATECCAES::setStatus(int status)
 
 void ATECCAES::printHexValue(byte value)
 {
-	if ((value >> 4) == 0) 
-		Serial.print("0"); // print preceeding high nibble if it's zero
-	Serial.print(value, HEX);
+	static const char digits[] = "0123456789ABCDEF";
+	char text[2] = { digits[value >> 4], digits[value & 0x0F] };
+
+	Serial.write((const uint8_t *) text, sizeof(text));
 }
 
 void ATECCAES::printHexValue(const uint8_t *value, int length, const char *separator)
 {
-	for (int index = 0; index < length; index++)
-	{
-		printHexValue(value[index]);
-	  Serial.print(String(separator));
-		if ((index + 1) % 16 == 0)
-		  Serial.println();
-	}
-	Serial.println();
+	ATECCX08A::printHex(Serial, value, length, separator);
 }
 
 
@@ -273,11 +267,8 @@ boolean ATECCAES_CBC::encrypt(const uint8_t *plainText, int sizePlainText, uint8
 		offset = index * AES_BLOCKSIZE;
 		xorBlock(&inputBuffer[offset], ivBlock, AES_BLOCKSIZE);
 	  result = getCryptoAdapter()->encryptDecryptBlock(&inputBuffer[offset], AES_BLOCKSIZE, &encrypted[offset], AES_BLOCKSIZE, slot, keyIndex, AES_ENCRYPT, debug);
-		if (debug == true)
-		{
+		if (ATECC_DEBUG_OUTPUT(debug))
 		  printHexValue(encrypted, totalSize, " ");
-		  Serial.println();
-		}
 		if (result == false)
 		{
 			free(inputBuffer);
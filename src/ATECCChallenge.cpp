@@ -0,0 +1,139 @@
+#include "ATECCChallenge.h"
+
+
+ATECCChallengeProver::ATECCChallengeProver(ATECCX08A *atecc, uint16_t slot)
+{
+	this->atecc = atecc;
+	this->slot = slot;
+	this->status = ATECCCHALLENGE_SUCCESS;
+}
+
+int ATECCChallengeProver::getStatus()
+{
+	return status;
+}
+
+void ATECCChallengeProver::setStatus(int status)
+{
+	this->status = status;
+}
+
+/** \brief
+
+	respond(const uint8_t *challenge, int sizeChallenge, uint8_t *response, int sizeResponse, boolean debug)
+
+	Calculates the response to a challenge received from the verifier.
+*/
+
+boolean ATECCChallengeProver::respond(const uint8_t *challenge, int sizeChallenge, uint8_t *response, int sizeResponse, boolean debug)
+{
+	if (sizeChallenge != MAC_CHALLENGE_SIZE || sizeResponse < MAC_RESPONSE_SIZE)
+	{
+		setStatus(ATECCCHALLENGE_INVALID_LENGTH);
+		return false;
+	}
+	if (atecc->generateMAC(challenge, slot, response, sizeResponse, debug) == false)
+	{
+		setStatus(ATECCCHALLENGE_DEVICE_ERROR);
+		return false;
+	}
+	setStatus(ATECCCHALLENGE_SUCCESS);
+	return true;
+}
+
+
+ATECCChallengeVerifier::ATECCChallengeVerifier(ATECCX08A *atecc, uint16_t slot, unsigned long timeToLive)
+{
+	this->atecc = atecc;
+	this->slot = slot;
+	this->timeToLive = timeToLive;
+	this->status = ATECCCHALLENGE_SUCCESS;
+}
+
+int ATECCChallengeVerifier::getStatus()
+{
+	return status;
+}
+
+void ATECCChallengeVerifier::setStatus(int status)
+{
+	this->status = status;
+}
+
+/** \brief
+
+	createChallenge(uint8_t *challenge, int sizeChallenge, boolean debug)
+
+	Creates a new random 32 byte challenge to be sent to the prover.
+	The challenge is kept until verifyResponse() is called or timeToLive has passed.
+*/
+
+boolean ATECCChallengeVerifier::createChallenge(uint8_t *challenge, int sizeChallenge, boolean debug)
+{
+	invalidateChallenge();
+	if (sizeChallenge < MAC_CHALLENGE_SIZE)
+	{
+		setStatus(ATECCCHALLENGE_INVALID_LENGTH);
+		return false;
+	}
+	if (atecc->generateRandomBytes(this->challenge, MAC_CHALLENGE_SIZE, debug) == false)
+	{
+		setStatus(ATECCCHALLENGE_DEVICE_ERROR);
+		return false;
+	}
+	memcpy(challenge, this->challenge, MAC_CHALLENGE_SIZE);
+	challengeTime = millis();
+	challengeValid = true;
+	setStatus(ATECCCHALLENGE_SUCCESS);
+	return true;
+}
+
+/** \brief
+
+	verifyResponse(const uint8_t *response, int sizeResponse, boolean debug)
+
+	Checks the response of the prover against the current challenge.
+	The challenge is used only once, whatever the result is.
+*/
+
+boolean ATECCChallengeVerifier::verifyResponse(const uint8_t *response, int sizeResponse, boolean debug)
+{
+	boolean result;
+
+	if (challengeValid == false)
+	{
+		setStatus(ATECCCHALLENGE_NO_CHALLENGE);
+		return false;
+	}
+	if ((millis() - challengeTime) > timeToLive)
+	{
+		invalidateChallenge();
+		setStatus(ATECCCHALLENGE_EXPIRED);
+		return false;
+	}
+	if (sizeResponse != MAC_RESPONSE_SIZE)
+	{
+		invalidateChallenge();
+		setStatus(ATECCCHALLENGE_INVALID_LENGTH);
+		return false;
+	}
+
+	result = atecc->checkMAC(challenge, response, slot, debug);
+	invalidateChallenge();
+	if (result == false)
+	{
+		if (atecc->getStatus() == CHECKMAC_MISMATCH)
+			setStatus(ATECCCHALLENGE_MISMATCH);
+		else
+			setStatus(ATECCCHALLENGE_DEVICE_ERROR);
+		return false;
+	}
+	setStatus(ATECCCHALLENGE_SUCCESS);
+	return true;
+}
+
+void ATECCChallengeVerifier::invalidateChallenge()
+{
+	challengeValid = false;
+	memset(challenge, 0, sizeof(challenge));
+}
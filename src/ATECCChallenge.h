@@ -0,0 +1,61 @@
+#pragma once
+
+#include "SparkFun_ATECCX08a_Arduino_Library.h"
+
+
+#define ATECCCHALLENGE_SUCCESS                0
+#define ATECCCHALLENGE_INVALID_LENGTH       -20
+#define ATECCCHALLENGE_NO_CHALLENGE         -21
+#define ATECCCHALLENGE_EXPIRED              -22
+#define ATECCCHALLENGE_MISMATCH             -23
+#define ATECCCHALLENGE_DEVICE_ERROR         -24
+
+#define ATECCCHALLENGE_DEFAULT_TIME_TO_LIVE 150  // ms, a challenge is invalidated after this time
+
+
+/*
+  Symmetric challenge-response authentication with the MAC and CheckMac commands.
+  
+  Both devices hold the same 32 byte key in a slot. The verifier creates a random challenge,
+  the prover answers with MAC(key, challenge) and the verifier checks the answer with CheckMac.
+  This is a fraction of the latency of the ECDSA version (Random + Sign + Verify), at the price
+  of a shared secret.
+*/
+
+class ATECCChallengeProver
+{
+  public:
+	  ATECCChallengeProver(ATECCX08A *atecc, uint16_t slot);
+		int     getStatus();
+		boolean respond(const uint8_t *challenge, int sizeChallenge, uint8_t *response, int sizeResponse, boolean debug = false);
+
+  protected:
+	  void setStatus(int status);
+
+	private:
+	  ATECCX08A   *atecc;
+		uint16_t    slot;
+		int         status;
+};
+
+class ATECCChallengeVerifier
+{
+  public:
+	  ATECCChallengeVerifier(ATECCX08A *atecc, uint16_t slot, unsigned long timeToLive = ATECCCHALLENGE_DEFAULT_TIME_TO_LIVE);
+		int     getStatus();
+		boolean createChallenge(uint8_t *challenge, int sizeChallenge, boolean debug = false);
+		boolean verifyResponse(const uint8_t *response, int sizeResponse, boolean debug = false);
+		void    invalidateChallenge();
+
+  protected:
+	  void setStatus(int status);
+
+	private:
+	  ATECCX08A     *atecc;
+		uint16_t      slot;
+		int           status;
+		unsigned long timeToLive;
+		unsigned long challengeTime;
+		boolean       challengeValid = false;
+		uint8_t       challenge[MAC_CHALLENGE_SIZE];
+};
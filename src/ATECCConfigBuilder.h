@@ -0,0 +1,261 @@
+#pragma once
+
+#include "SparkFun_ATECCX08a_Arduino_Library.h"
+
+#if __cplusplus < 201402L
+#error "ATECCConfigBuilder.h needs C++14 (e.g. -std=gnu++14)"
+#endif
+
+
+// error codes of ATECCConfigBuilder::getError()
+#define ATECCCONFIG_VALID                       0
+#define ATECCCONFIG_INVALID_SLOT                1  // slot number not 0-15
+#define ATECCCONFIG_PRIVATE_NOT_ECC             2  // KeyConfig.Private without KeyType P256
+#define ATECCCONFIG_PRIVATE_NOT_SECRET          3  // KeyConfig.Private without SlotConfig.IsSecret
+#define ATECCCONFIG_ENCRYPT_READ_NOT_SECRET     4  // SlotConfig.EncryptRead without IsSecret
+#define ATECCCONFIG_PUBLIC_KEY_TOO_LARGE        5  // ECC public key in a 36 byte slot (0-7)
+#define ATECCCONFIG_INVALID_I2C_ADDRESS         6  // not a 7 bit address
+#define ATECCCONFIG_INVALID_CLOCK_DIVIDER       7  // ChipMode clock divider not M0, M1 or M2 (0x00, 0x05, 0x0D in bits 7-3)
+
+// KeyConfig.KeyType
+#define KEY_TYPE_P256                           4
+#define KEY_TYPE_AES                            6  // ATECC608A
+#define KEY_TYPE_SHA                            7  // SHA key or other data
+
+// SlotConfig.WriteConfig for Write commands
+#define WRITE_CONFIG_ALWAYS                   0x0
+#define WRITE_CONFIG_PUB_INVALID              0x1
+#define WRITE_CONFIG_NEVER                    0x2
+#define WRITE_CONFIG_ENCRYPT                  0x4
+
+
+// called when an invalid configuration is built in a constant expression, which makes it a compile error
+inline void ATECCConfigInvalid() {}
+
+
+/*
+  A 128 byte configuration zone image, built at compile time by ATECCConfigBuilder.
+
+  bytes can be passed to ATECCX08A::provisionConfigZone(). The CRC which the Lock command
+  expects covers the whole zone, including the serial number and revision in bytes 0-15,
+  which are only known at runtime. The CRC is linear (initial value 0), so the part for bytes
+  16-127 and the effect of 112 more bytes on the CRC of bytes 0-15 are calculated at compile
+  time. lockCrc() only needs the CRC of the 16 bytes of the device.
+*/
+
+struct ATECCConfigImage
+{
+	uint8_t  bytes[CONFIG_ZONE_SIZE] = {};
+	uint16_t tailCrc = 0;           // CRC of 16 zero bytes followed by bytes[16-127]
+	uint16_t zeroAdvance[16] = {};  // CRC register after 112 zero bytes, starting with bit i set
+
+	static constexpr uint16_t crcUpdate(uint16_t crc, uint8_t data)
+	{
+		// same algorithm as ATECCX08A::atca_calculate_crc()
+		for (uint8_t bit = 0x01; bit > 0x00; bit <<= 1)
+		{
+			uint8_t dataBit = (data & bit) ? 1 : 0;
+			uint8_t crcBit = crc >> 15;
+			crc <<= 1;
+			if (dataBit != crcBit)
+				crc ^= 0x8005;
+		}
+		return crc;
+	}
+
+	// CRC of the configuration zone of a device, configZone are its 128 (or at least the first 16) bytes
+	constexpr uint16_t lockCrc(const uint8_t *configZone) const
+	{
+		uint16_t head = 0;
+		uint16_t crc = tailCrc;
+
+		for (int i = 0; i < CONFIG_ZONE_WRITABLE_START; i++)
+			head = crcUpdate(head, configZone[i]);
+		for (int bit = 0; bit < 16; bit++)
+		{
+			if (head & (1 << bit))
+				crc ^= zeroAdvance[bit];
+		}
+		return crc;
+	}
+};
+
+
+/*
+  Compile time builder for the writable part of the configuration zone (bytes 16-127).
+
+  Every setter returns a modified copy, so a configuration can be written as one constant expression:
+
+    constexpr ATECCConfigBuilder myConfig = ATECCConfigBuilder()
+      .i2cAddress(0x60)
+      .slot(0, ATECCConfigBuilder::slotConfig(0, false, false, false, true, 0, WRITE_CONFIG_NEVER),
+               ATECCConfigBuilder::keyConfig(true, true, KEY_TYPE_P256, true, false, false, 0))
+      .slot(9, ATECCConfigBuilder::slotConfig(0, false, false, false, false, 0, WRITE_CONFIG_ALWAYS),
+               ATECCConfigBuilder::keyConfig(false, false, KEY_TYPE_SHA, true, false, false, 0));
+    static_assert(myConfig.isValid(), "invalid ATECC configuration");
+    constexpr ATECCConfigImage myImage = myConfig.build();
+
+    atecc.provisionConfigZone(myImage.bytes);
+    uint16_t crc = myImage.lockCrc(atecc.getConfigZone());
+    atecc.lock(LOCK_MODE_ZONE_CONFIG, crc);      // or simply atecc.lockConfiguration(myImage.bytes)
+
+  build() of an invalid configuration in a constant expression doesn't compile either.
+  The validation covers the combinations the datasheet forbids, not every unwise one.
+*/
+
+class ATECCConfigBuilder
+{
+  public:
+	  constexpr explicit ATECCConfigBuilder(uint8_t model = ATECC_MODEL_508A)
+		{
+			// factory defaults (bytes 16-127 of a fresh IC): I2C address 0xC0, OTP mode 0x55, the SlotConfig
+			// and KeyConfig of the sample configuration, Counter[0] and Counter[1] (bytes 52-67) with value 0,
+			// zones and slots unlocked. Bytes 68-83 are LastKeyUse (all 0xFF) on the ATECC508A; the ATECC608A
+			// has UseLock, VolatileKeyPermission, SecureBoot and KdfIv there, all 0x00
+			const uint8_t defaults[CONFIG_ZONE_SIZE - CONFIG_ZONE_WRITABLE_START] = {
+				0xC0, 0x00, 0x55, 0x00, 0x83, 0x20, 0x87, 0x20, 0x8F, 0x20, 0xC4, 0x8F, 0x8F, 0x8F, 0x8F, 0x8F,
+				0x9F, 0x8F, 0xAF, 0x8F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+				0x00, 0x00, 0xAF, 0x8F, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+				0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+				0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x55, 0x55, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+				0x33, 0x00, 0x33, 0x00, 0x33, 0x00, 0x1C, 0x00, 0x1C, 0x00, 0x1C, 0x00, 0x1C, 0x00, 0x1C, 0x00,
+				0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x1C, 0x00,
+			};
+
+			for (int i = CONFIG_ZONE_WRITABLE_START; i < CONFIG_ZONE_SIZE; i++)
+				bytes[i] = defaults[i - CONFIG_ZONE_WRITABLE_START];
+			if (model == ATECC_MODEL_608A || model == ATECC_MODEL_608B)
+			{
+				for (int i = CONFIG_ZONE_LAST_KEY_USE; i < CONFIG_ZONE_USER_EXTRA; i++)
+					bytes[i] = 0x00;
+			}
+		}
+
+		static constexpr uint16_t slotConfig(uint8_t readKey, boolean noMac, boolean limitedUse, boolean encryptRead,
+		                                     boolean isSecret, uint8_t writeKey, uint8_t writeConfig)
+		{
+			return (readKey & 0x0F) | (noMac ? 0x0010 : 0) | (limitedUse ? 0x0020 : 0) | (encryptRead ? SLOT_CONFIG_ENCRYPT_READ : 0) |
+			       (isSecret ? SLOT_CONFIG_IS_SECRET : 0) | ((writeKey & 0x0F) << 8) | ((writeConfig & 0x0F) << 12);
+		}
+
+		static constexpr uint16_t keyConfig(boolean privateKey, boolean pubInfo, uint8_t keyType, boolean lockable,
+		                                    boolean reqRandom, boolean reqAuth, uint8_t authKey, boolean persistentDisable = false)
+		{
+			return (privateKey ? 0x0001 : 0) | (pubInfo ? 0x0002 : 0) | ((keyType & 0x07) << 2) | (lockable ? 0x0020 : 0) |
+			       (reqRandom ? 0x0040 : 0) | (reqAuth ? 0x0080 : 0) | ((authKey & 0x0F) << 8) | (persistentDisable ? 0x1000 : 0);
+		}
+
+		constexpr ATECCConfigBuilder i2cAddress(uint8_t address) const
+		{
+			ATECCConfigBuilder builder = *this;
+			if (address > 0x7F)
+				builder.fail(ATECCCONFIG_INVALID_I2C_ADDRESS);
+			builder.bytes[CONFIG_ZONE_I2C_ADDRESS] = address << 1;
+			return builder;
+		}
+
+		constexpr ATECCConfigBuilder otpMode(uint8_t mode) const
+		{
+			ATECCConfigBuilder builder = *this;
+			builder.bytes[CONFIG_ZONE_OTP_MODE] = mode;
+			return builder;
+		}
+
+		constexpr ATECCConfigBuilder chipMode(uint8_t mode) const
+		{
+			ATECCConfigBuilder builder = *this;
+			uint8_t divider = mode & CHIP_MODE_CLOCK_DIVIDER_MASK;
+			if (divider != CHIP_MODE_CLOCK_DIVIDER_M0 && divider != CHIP_MODE_CLOCK_DIVIDER_M1 && divider != CHIP_MODE_CLOCK_DIVIDER_M2)
+				builder.fail(ATECCCONFIG_INVALID_CLOCK_DIVIDER);
+			builder.bytes[CONFIG_ZONE_CHIP_MODE] = mode;
+			return builder;
+		}
+
+		constexpr ATECCConfigBuilder slot(int slot, uint16_t slotConfig, uint16_t keyConfig) const
+		{
+			ATECCConfigBuilder builder = *this;
+			if (slot < 0 || slot > 15)
+			{
+				builder.fail(ATECCCONFIG_INVALID_SLOT);
+				return builder;
+			}
+			builder.check(slot, slotConfig, keyConfig);
+			builder.bytes[CONFIG_ZONE_SLOT_CONFIG + slot * 2] = slotConfig & 0xFF;
+			builder.bytes[CONFIG_ZONE_SLOT_CONFIG + slot * 2 + 1] = slotConfig >> 8;
+			builder.bytes[CONFIG_ZONE_KEY_CONFIG + slot * 2] = keyConfig & 0xFF;
+			builder.bytes[CONFIG_ZONE_KEY_CONFIG + slot * 2 + 1] = keyConfig >> 8;
+			return builder;
+		}
+
+		// a cleared SlotLocked bit locks the slot as soon as the data zone is locked
+		constexpr ATECCConfigBuilder slotLocked(int slot, boolean locked = true) const
+		{
+			ATECCConfigBuilder builder = *this;
+			if (slot < 0 || slot > 15)
+			{
+				builder.fail(ATECCCONFIG_INVALID_SLOT);
+				return builder;
+			}
+			if (locked)
+				builder.bytes[CONFIG_ZONE_SLOTS_LOCK0 + slot / 8] &= ~(1 << (slot % 8));
+			else
+				builder.bytes[CONFIG_ZONE_SLOTS_LOCK0 + slot / 8] |= (1 << (slot % 8));
+			return builder;
+		}
+
+		constexpr int getError() const
+		{
+			return error;
+		}
+
+		constexpr boolean isValid() const
+		{
+			return error == ATECCCONFIG_VALID;
+		}
+
+		constexpr ATECCConfigImage build() const
+		{
+			ATECCConfigImage image;
+
+			if (error != ATECCCONFIG_VALID)
+				ATECCConfigInvalid();
+
+			for (int i = 0; i < CONFIG_ZONE_SIZE; i++)
+				image.bytes[i] = bytes[i];
+			for (int i = 0; i < CONFIG_ZONE_SIZE; i++)
+				image.tailCrc = ATECCConfigImage::crcUpdate(image.tailCrc, (i < CONFIG_ZONE_WRITABLE_START) ? 0 : bytes[i]);
+			for (int bit = 0; bit < 16; bit++)
+			{
+				uint16_t crc = 1 << bit;
+				for (int i = CONFIG_ZONE_WRITABLE_START; i < CONFIG_ZONE_SIZE; i++)
+					crc = ATECCConfigImage::crcUpdate(crc, 0);
+				image.zeroAdvance[bit] = crc;
+			}
+			return image;
+		}
+
+  private:
+	  uint8_t bytes[CONFIG_ZONE_SIZE] = {};
+		int     error = ATECCCONFIG_VALID;
+
+		constexpr void fail(int code)
+		{
+			if (error == ATECCCONFIG_VALID)
+				error = code;
+		}
+
+		constexpr void check(int slot, uint16_t slotConfig, uint16_t keyConfig)
+		{
+			boolean privateKey = keyConfig & 0x0001;
+			uint8_t keyType = (keyConfig >> 2) & 0x07;
+
+			if (privateKey && keyType != KEY_TYPE_P256)
+				fail(ATECCCONFIG_PRIVATE_NOT_ECC);
+			if (privateKey && (slotConfig & SLOT_CONFIG_IS_SECRET) == 0)
+				fail(ATECCCONFIG_PRIVATE_NOT_SECRET);
+			if ((slotConfig & SLOT_CONFIG_ENCRYPT_READ) && (slotConfig & SLOT_CONFIG_IS_SECRET) == 0)
+				fail(ATECCCONFIG_ENCRYPT_READ_NOT_SECRET);
+			if (!privateKey && keyType == KEY_TYPE_P256 && slot < 8)  // slots 0-7 have 36 bytes, a public key needs 72
+				fail(ATECCCONFIG_PUBLIC_KEY_TOO_LARGE);
+		}
+};
@@ -0,0 +1,211 @@
+// only compiled with C++20, see ATECCCoroutine.h
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+
+#include "ATECCCoroutine.h"
+
+
+/** \brief
+
+	poll()
+
+	Polls the commands the coroutines are waiting for and resumes the coroutines whose command
+	has finished. Returns true as long as coroutines are waiting.
+*/
+
+boolean ATECCScheduler::poll()
+{
+	std::vector<std::coroutine_handle<>> ready;
+
+	for (size_t i = 0; i < waiters.size(); )
+	{
+		if (waiters[i].atecc->pollCommand() != ATECC_COMMAND_BUSY)
+		{
+			ready.push_back(waiters[i].handle);
+			waiters.erase(waiters.begin() + i);
+		}
+		else
+			i++;
+	}
+	// resumed coroutines may submit their next command and wait again
+	for (std::coroutine_handle<> handle : ready)
+		handle.resume();
+	return waiters.empty() == false;
+}
+
+/** \brief
+
+	run()
+
+	Polls until no coroutine is waiting any more.
+*/
+
+void ATECCScheduler::run()
+{
+	while (poll() == true)
+		;
+}
+
+size_t ATECCScheduler::getPending()
+{
+	return waiters.size();
+}
+
+// forgets a coroutine which is destroyed while it waits, see ATECCCommandAwaiter
+void ATECCScheduler::remove(std::coroutine_handle<> handle)
+{
+	for (size_t i = 0; i < waiters.size(); i++)
+	{
+		if (waiters[i].handle == handle)
+		{
+			waiters.erase(waiters.begin() + i);
+			return;
+		}
+	}
+}
+
+
+ATECCCoroutineDevice::ATECCCoroutineDevice(ATECCX08A *atecc, ATECCScheduler *scheduler)
+{
+	this->atecc = atecc;
+	this->scheduler = scheduler;
+}
+
+ATECCX08A *ATECCCoroutineDevice::getDevice()
+{
+	return atecc;
+}
+
+/** \brief
+
+	command(uint8_t opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length, uint8_t responseLength, uint8_t command)
+
+	Submits a command (see ATECCX08A::submitCommand()), co_await returns when it has finished.
+	The response data is available with getDevice()->getCommandResult().
+*/
+
+ATECCCommandAwaiter ATECCCoroutineDevice::command(uint8_t opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length, uint8_t responseLength, uint8_t command)
+{
+	boolean submitted = atecc->submitCommand(opcode, param1, param2, data, length, responseLength, command);
+
+	return ATECCCommandAwaiter(atecc, scheduler, submitted);
+}
+
+/** \brief
+
+	random(uint8_t *value, int size)
+
+	Gets up to 32 random bytes, like ATECCX08A::generateRandomBytes().
+*/
+
+ATECCTask<boolean> ATECCCoroutineDevice::random(uint8_t *value, int size)
+{
+	uint8_t response[32];
+	boolean result;
+
+	if (value == NULL || size < 0 || size > (int) sizeof(response) || lock() == false)
+		co_return false;
+	Unlocker unlocker{ this };
+
+	// count (1), random bytes (32), crc (2)
+	result = co_await command(COMMAND_OPCODE_RANDOM, 0x00, 0x0000, NULL, 0, 35, ATECC_CMD_RANDOM);
+	if (result == true)
+		result = (atecc->getCommandResult(response, sizeof(response)) == sizeof(response));
+	if (result == true)
+		memcpy(value, response, size);
+	co_return result;
+}
+
+/** \brief
+
+	sign(uint8_t *signature, int size, const uint8_t *message, uint16_t slot)
+
+	Signs the 32 byte message (e.g. a SHA-256 digest) with the private key in slot, like 
+	ATECCX08A::createSignature(): Nonce in passthrough mode, then Sign.
+*/
+
+ATECCTask<boolean> ATECCCoroutineDevice::sign(uint8_t *signature, int size, const uint8_t *message, uint16_t slot)
+{
+	boolean result;
+
+	if (signature == NULL || size < SIGNATURE_SIZE || message == NULL || lock() == false)
+		co_return false;
+	Unlocker unlocker{ this };
+
+	result = co_await command(COMMAND_OPCODE_NONCE, NONCE_MODE_PASSTHROUGH, 0x0000, message, 32, 4, ATECC_CMD_NONCE);
+	if (result == true)
+	{
+		// signature (64), plus crc (2), plus count (1)
+		result = co_await command(COMMAND_OPCODE_SIGN, SIGN_MODE_TEMPKEY, slot, NULL, 0, SIGNATURE_SIZE + 2 + 1, ATECC_CMD_SIGN);
+	}
+	if (result == true)
+		result = (atecc->getCommandResult(signature, size) == SIGNATURE_SIZE);
+	co_return result;
+}
+
+/** \brief
+
+	verify(const uint8_t *message, const uint8_t *signature, const uint8_t *publicKey)
+
+	Verifies the signature of the 32 byte message with an external public key, like
+	ATECCX08A::verifySignature().
+*/
+
+ATECCTask<boolean> ATECCCoroutineDevice::verify(const uint8_t *message, const uint8_t *signature, const uint8_t *publicKey)
+{
+	uint8_t data[SIGNATURE_SIZE + PUBLIC_KEY_SIZE];
+	boolean result;
+
+	if (message == NULL || signature == NULL || publicKey == NULL || lock() == false)
+		co_return false;
+	Unlocker unlocker{ this };
+
+	memcpy(&data[0], signature, SIGNATURE_SIZE);
+	memcpy(&data[SIGNATURE_SIZE], publicKey, PUBLIC_KEY_SIZE);
+	result = co_await command(COMMAND_OPCODE_NONCE, NONCE_MODE_PASSTHROUGH, 0x0000, message, 32, 4, ATECC_CMD_NONCE);
+	if (result == true)
+		result = co_await command(COMMAND_OPCODE_VERIFY, VERIFY_MODE_EXTERNAL, VERIFY_PARAM2_KEYTYPE_ECC, data, sizeof(data), 4, ATECC_CMD_VERIFY);
+	co_return result;
+}
+
+/** \brief
+
+	sha256(const uint8_t *data, size_t length, uint8_t *hash, int size)
+
+	Calculates the SHA-256 digest of data on the IC: Start, one Update per 64 byte block and
+	End with the remaining 0-63 bytes.
+*/
+
+ATECCTask<boolean> ATECCCoroutineDevice::sha256(const uint8_t *data, size_t length, uint8_t *hash, int size)
+{
+	size_t  blocks = length / SHA_BLOCK_SIZE;
+	uint8_t rest = length % SHA_BLOCK_SIZE;
+	boolean result;
+
+	if ((data == NULL && length > 0) || hash == NULL || size < SHA256_SIZE || lock() == false)
+		co_return false;
+	Unlocker unlocker{ this };
+
+	result = co_await command(COMMAND_OPCODE_SHA, SHA_START, 0, NULL, 0, RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE, ATECC_CMD_SHA);
+	for (size_t i = 0; i < blocks && result == true; i++)
+		result = co_await command(COMMAND_OPCODE_SHA, SHA_UPDATE, SHA_BLOCK_SIZE, data + i * SHA_BLOCK_SIZE, SHA_BLOCK_SIZE, RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE, ATECC_CMD_SHA);
+	if (result == true)
+		result = co_await command(COMMAND_OPCODE_SHA, SHA_END, rest, data + blocks * SHA_BLOCK_SIZE, rest, RESPONSE_COUNT_SIZE + RESPONSE_SHA_SIZE + CRC_SIZE, ATECC_CMD_SHA);
+	if (result == true)
+		result = (atecc->getCommandResult(hash, size) == SHA256_SIZE);
+	co_return result;
+}
+
+boolean ATECCCoroutineDevice::lock()
+{
+	if (busy == true)
+		return false;
+	busy = true;
+	return true;
+}
+
+void ATECCCoroutineDevice::unlock()
+{
+	busy = false;
+}
+
+#endif
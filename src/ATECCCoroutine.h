@@ -0,0 +1,214 @@
+#pragma once
+
+#include "SparkFun_ATECCX08a_Arduino_Library.h"
+
+#if __cplusplus < 202002L || !__has_include(<coroutine>)
+#error "ATECCCoroutine.h needs C++20 coroutines (e.g. -std=gnu++20)"
+#else
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <vector>
+
+
+/*
+  Coroutine front-end for host builds (e.g. Linux gateways with several ICs).
+
+  The commands are sent with ATECCX08A::submitCommand(). Instead of waiting in delay(), the
+  coroutine is suspended and an ATECCScheduler resumes it when pollCommand() reports that the
+  command has finished, so one thread drives any number of devices:
+
+    ATECCTask<boolean> signJob(ATECCCoroutineDevice &device, const uint8_t *message, uint8_t *signature)
+    {
+      co_return co_await device.sign(signature, SIGNATURE_SIZE, message, 0);
+    }
+
+    ATECCScheduler scheduler;
+    ATECCCoroutineDevice device1(&atecc1, &scheduler), device2(&atecc2, &scheduler);
+    ATECCTask<boolean> job1 = signJob(device1, hash1, signature1);
+    ATECCTask<boolean> job2 = signJob(device2, hash2, signature2);
+    scheduler.start(job1);
+    scheduler.start(job2);
+    scheduler.run();                      // or scheduler.poll() from an existing event loop
+    boolean ok = job1.result() && job2.result();
+
+  Only the execution time of the IC is awaited; the wake pulse and the I2C transfers still block.
+  A device runs one sequence (e.g. Nonce + Sign) at a time, a second one returns false right away.
+  A task can be destroyed while it waits for a command: it is removed from the scheduler and the
+  device is free again, but the IC still executes the abandoned command. Until pollCommand() of
+  the ATECCX08A has finished it, new commands fail with STATUS_COMMAND_PENDING.
+*/
+
+class ATECCScheduler;
+
+template <typename T>
+class ATECCTask
+{
+  public:
+	  struct promise_type
+		{
+			T value{};
+			std::coroutine_handle<> continuation;
+			std::exception_ptr exception;
+
+			ATECCTask get_return_object()
+			{
+				return ATECCTask(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			auto final_suspend() noexcept
+			{
+				// continue with the awaiting coroutine, if there is one
+				struct FinalAwaiter
+				{
+					bool await_ready() noexcept { return false; }
+					std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+					{
+						if (handle.promise().continuation)
+							return handle.promise().continuation;
+						return std::noop_coroutine();
+					}
+					void await_resume() noexcept {}
+				};
+				return FinalAwaiter{};
+			}
+			void return_value(T result) { value = std::move(result); }
+			void unhandled_exception() { exception = std::current_exception(); }
+		};
+
+		ATECCTask(ATECCTask &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+		ATECCTask(const ATECCTask &) = delete;
+		ATECCTask &operator=(const ATECCTask &) = delete;
+		~ATECCTask()
+		{
+			if (handle)
+				handle.destroy();
+		}
+
+		boolean done() const
+		{
+			return !handle || handle.done();
+		}
+
+		// result of a finished task
+		T result()
+		{
+			if (handle.promise().exception)
+				std::rethrow_exception(handle.promise().exception);
+			return handle.promise().value;
+		}
+
+		// co_await of a task starts it and resumes the caller when it has finished
+		bool await_ready() const noexcept { return false; }
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+		{
+			handle.promise().continuation = caller;
+			return handle;
+		}
+		T await_resume() { return result(); }
+
+	private:
+	  friend class ATECCScheduler;
+		explicit ATECCTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+		std::coroutine_handle<promise_type> handle;
+};
+
+
+// resumes the coroutines waiting for a command when pollCommand() reports that it has finished
+class ATECCScheduler
+{
+  public:
+	  template <typename T>
+		void start(ATECCTask<T> &task)
+		{
+			// runs the task up to its first command, the task object keeps the ownership
+			if (task.handle && !task.handle.done())
+				task.handle.resume();
+		}
+		boolean poll();
+		void    run();
+		size_t  getPending();
+
+	private:
+	  friend class ATECCCommandAwaiter;
+
+		void    remove(std::coroutine_handle<> handle);
+
+		typedef struct
+		{
+			ATECCX08A               *atecc;
+			std::coroutine_handle<> handle;
+		} Waiter;
+
+		std::vector<Waiter> waiters;
+};
+
+
+// co_await of a submitted command, the result is true if the command succeeded (see ATECCX08A::getCommandResult())
+class ATECCCommandAwaiter
+{
+  public:
+	  ATECCCommandAwaiter(ATECCX08A *atecc, ATECCScheduler *scheduler, boolean submitted)
+			: atecc(atecc), scheduler(scheduler), submitted(submitted) {}
+		~ATECCCommandAwaiter()
+		{
+			// the coroutine was destroyed while it was waiting
+			if (waiting == true)
+				scheduler->remove(handle);
+		}
+
+		bool await_ready() const noexcept
+		{
+			return submitted == false;  // nothing to wait for
+		}
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			this->handle = handle;
+			waiting = true;
+			scheduler->waiters.push_back({ atecc, handle });
+		}
+		boolean await_resume() const
+		{
+			return submitted == true && atecc->getCommandState() == ATECC_COMMAND_DONE;
+		}
+
+	private:
+	  ATECCX08A      *atecc;
+		ATECCScheduler *scheduler;
+		boolean        submitted;
+		boolean        waiting = false;
+		std::coroutine_handle<> handle;
+};
+
+
+class ATECCCoroutineDevice
+{
+  public:
+	  ATECCCoroutineDevice(ATECCX08A *atecc, ATECCScheduler *scheduler);
+
+		ATECCCommandAwaiter command(uint8_t opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length, uint8_t responseLength, uint8_t command);
+		ATECCTask<boolean> random(uint8_t *value, int size);
+		ATECCTask<boolean> sign(uint8_t *signature, int size, const uint8_t *message, uint16_t slot);
+		ATECCTask<boolean> verify(const uint8_t *message, const uint8_t *signature, const uint8_t *publicKey);
+		ATECCTask<boolean> sha256(const uint8_t *data, size_t length, uint8_t *hash, int size);
+		ATECCX08A *getDevice();
+
+	private:
+	  // releases the device at the end of a sequence, also when its coroutine is destroyed
+	  struct Unlocker
+		{
+			ATECCCoroutineDevice *device;
+			~Unlocker() { device->unlock(); }
+		};
+
+	  boolean lock();
+		void    unlock();
+
+	  ATECCX08A      *atecc;
+		ATECCScheduler *scheduler;
+		boolean        busy = false;  // a sequence is running
+};
+
+#endif
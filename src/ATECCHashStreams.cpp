@@ -0,0 +1,239 @@
+#include "ATECCHashStreams.h"
+
+
+ATECCHashStreams::ATECCHashStreams(ATECCX08A *atecc)
+{
+	this->atecc = atecc;
+	this->status = ATECCHASHSTREAMS_SUCCESS;
+	memset(streams, 0, sizeof(streams));
+}
+
+int ATECCHashStreams::getStatus()
+{
+	return status;
+}
+
+void ATECCHashStreams::setStatus(int status)
+{
+	this->status = status;
+}
+
+unsigned long ATECCHashStreams::getSwapCount()
+{
+	return swapCount;
+}
+
+boolean ATECCHashStreams::isValidHandle(int handle)
+{
+	if (handle < 0 || handle >= ATECCHASHSTREAMS_MAX_STREAMS || streams[handle].used == false)
+	{
+		setStatus(ATECCHASHSTREAMS_INVALID_HANDLE);
+		return false;
+	}
+	return true;
+}
+
+/** \brief
+
+	open()
+
+	Opens a new hash stream. Returns the handle, or -1 if all streams are in use.
+	Nothing is sent to the IC here.
+*/
+
+int ATECCHashStreams::open()
+{
+	for (int handle = 0; handle < ATECCHASHSTREAMS_MAX_STREAMS; handle++)
+	{
+		if (streams[handle].used == false)
+		{
+			memset(&streams[handle], 0, sizeof(HashStream));
+			streams[handle].used = true;
+			setStatus(ATECCHASHSTREAMS_SUCCESS);
+			return handle;
+		}
+	}
+	setStatus(ATECCHASHSTREAMS_NO_FREE_STREAM);
+	return -1;
+}
+
+/** \brief
+
+	update(int handle, const uint8_t *data, int length)
+
+	Adds data to a stream. Full blocks are sent to the IC as soon as the block after them
+	starts (the last block of a message may be sent with the end command).
+*/
+
+boolean ATECCHashStreams::update(int handle, const uint8_t *data, int length)
+{
+	HashStream *stream;
+
+	if (isValidHandle(handle) == false)
+		return false;
+
+	stream = &streams[handle];
+	while (length > 0)
+	{
+		int size;
+
+		if (stream->blockLength == SHA_BLOCK_SIZE)
+		{
+			// more data is coming, so the full block can go to the IC
+			if (activate(handle) == false)
+				return false;
+			if (atecc->shaUpdateBlock(stream->block) == false)
+			{
+				setStatus(ATECCHASHSTREAMS_DEVICE_ERROR);
+				return false;
+			}
+			stream->dirty = true;
+			stream->blockLength = 0;
+		}
+
+		size = SHA_BLOCK_SIZE - stream->blockLength;
+		if (size > length)
+			size = length;
+		memcpy(&stream->block[stream->blockLength], data, size);
+		stream->blockLength += size;
+		data += size;
+		length -= size;
+	}
+	setStatus(ATECCHASHSTREAMS_SUCCESS);
+	return true;
+}
+
+/** \brief
+
+	finish(int handle, uint8_t *hash, int size)
+
+	Sends the remaining data of the stream, reads the digest and closes the stream.
+*/
+
+boolean ATECCHashStreams::finish(int handle, uint8_t *hash, int size)
+{
+	HashStream *stream;
+	boolean    result;
+
+	if (isValidHandle(handle) == false)
+		return false;
+
+	stream = &streams[handle];
+	if (activate(handle) == false)
+		return false;
+
+	result = true;
+	if (stream->blockLength == SHA_BLOCK_SIZE)
+	{
+		// the end command takes less than a full block
+		result = atecc->shaUpdateBlock(stream->block);
+		stream->blockLength = 0;
+	}
+	if (result == true)
+		result = atecc->shaEnd(stream->block, stream->blockLength, hash, size);
+
+	close(handle);
+	if (result == false)
+	{
+		setStatus(ATECCHASHSTREAMS_DEVICE_ERROR);
+		return false;
+	}
+	setStatus(ATECCHASHSTREAMS_SUCCESS);
+	return true;
+}
+
+/** \brief
+
+	close(int handle)
+
+	Closes a stream without calculating the digest.
+*/
+
+void ATECCHashStreams::close(int handle)
+{
+	if (handle < 0 || handle >= ATECCHASHSTREAMS_MAX_STREAMS)
+		return;
+	if (resident == handle)
+		resident = -1;
+	memset(&streams[handle], 0, sizeof(HashStream));
+}
+
+/** \brief
+
+	suspend()
+
+	Saves the context of the resident stream, so the SHA engine can be used for something else.
+*/
+
+boolean ATECCHashStreams::suspend()
+{
+	if (saveResident() == false)
+		return false;
+	resident = -1;
+	return true;
+}
+
+boolean ATECCHashStreams::saveResident()
+{
+	HashStream *stream;
+	int        contextSize;
+
+	if (resident < 0)
+		return true;
+
+	stream = &streams[resident];
+	if (stream->dirty == true)
+	{
+		if (atecc->readSHAContext(stream->context, sizeof(stream->context), contextSize) == false)
+		{
+			setStatus(ATECCHASHSTREAMS_DEVICE_ERROR);
+			return false;
+		}
+		stream->contextSize = contextSize;
+		stream->dirty = false;
+	}
+	else if (stream->contextSize == 0)
+	{
+		stream->started = false;  // no block sent yet, simply start again next time
+	}
+	return true;
+}
+
+/** \brief
+
+	activate(int handle)
+
+	Makes sure the context of stream handle is on the IC.
+*/
+
+boolean ATECCHashStreams::activate(int handle)
+{
+	HashStream *stream = &streams[handle];
+	boolean    result;
+
+	if (resident == handle)
+		return true;
+
+	if (saveResident() == false)
+		return false;
+	resident = -1;
+
+	if (stream->started == false)
+	{
+		result = atecc->shaStart();
+		stream->started = true;
+	}
+	else
+	{
+		result = atecc->writeSHAContext(stream->context, stream->contextSize);
+		swapCount++;
+	}
+	if (result == false)
+	{
+		setStatus(ATECCHASHSTREAMS_DEVICE_ERROR);
+		return false;
+	}
+	stream->dirty = false;
+	resident = handle;
+	return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "SparkFun_ATECCX08a_Arduino_Library.h"
+
+
+#define ATECCHASHSTREAMS_SUCCESS                0
+#define ATECCHASHSTREAMS_NO_FREE_STREAM       -30
+#define ATECCHASHSTREAMS_INVALID_HANDLE       -31
+#define ATECCHASHSTREAMS_DEVICE_ERROR         -32
+
+#define ATECCHASHSTREAMS_MAX_STREAMS            4
+
+
+/*
+  Several SHA-256 calculations sharing the single SHA engine of the ATECC608A.
+
+  Each stream gets a handle from open(). The IC holds the context of one stream at a time
+  (the resident stream). When another stream needs the IC, the context of the resident stream
+  is saved with readSHAContext() and the context of the other one is restored with writeSHAContext().
+  
+  To keep the number of swaps low:
+  - data is collected on the host until a full 64 byte block is available, so a stream that only 
+    gets small pieces of data does not need the IC at all until its block is full or it is finished
+  - the resident stream stays on the IC until another stream needs it (no eager save)
+  - a context is only read back if blocks have been sent since it was restored
+  - a stream which has not sent a block yet is started with SHA start, there is no context to restore
+  
+  Don't use sha256(), hmac() or other SHA based commands while streams are open, or call suspend() first.
+  The SHA context is lost when the IC goes to sleep (watchdog), so streams should not be kept open for long.
+*/
+
+class ATECCHashStreams
+{
+  public:
+	  ATECCHashStreams(ATECCX08A *atecc);
+		int     getStatus();
+		int     open();
+		boolean update(int handle, const uint8_t *data, int length);
+		boolean finish(int handle, uint8_t *hash, int size);
+		void    close(int handle);
+		boolean suspend();
+		unsigned long getSwapCount();
+
+  protected:
+	  void    setStatus(int status);
+		boolean activate(int handle);
+		boolean saveResident();
+		boolean isValidHandle(int handle);
+
+	private:
+	  typedef struct
+		{
+			boolean used;
+			boolean started;           // SHA start has been sent for this stream
+			boolean dirty;             // blocks have been sent since the context was saved/restored
+			uint8_t contextSize;
+			uint8_t context[SHA_CONTEXT_MAX_SIZE];
+			uint8_t blockLength;
+			uint8_t block[SHA_BLOCK_SIZE];  // data not yet sent to the IC
+		} HashStream;
+
+	  ATECCX08A     *atecc;
+		HashStream    streams[ATECCHASHSTREAMS_MAX_STREAMS];
+		int           resident = -1;   // handle of the stream whose context is on the IC
+		int           status;
+		unsigned long swapCount = 0;
+};
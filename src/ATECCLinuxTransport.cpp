@@ -0,0 +1,93 @@
+// only compiled on Linux, see ATECCLinuxTransport.h
+#if defined(__linux__) && __has_include(<linux/i2c-dev.h>)
+
+#include "ATECCLinuxTransport.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+
+ATECCLinuxTransport::ATECCLinuxTransport(const char *device)
+{
+	this->device = device;
+}
+
+ATECCLinuxTransport::~ATECCLinuxTransport()
+{
+	end();
+}
+
+boolean ATECCLinuxTransport::begin()
+{
+	end();
+	fd = open(device, O_RDWR);
+	return fd >= 0;
+}
+
+void ATECCLinuxTransport::end()
+{
+	if (fd >= 0)
+		close(fd);
+	fd = -1;
+}
+
+boolean ATECCLinuxTransport::transfer(uint8_t address, uint16_t flags, uint8_t *data, size_t length)
+{
+	struct i2c_msg message;
+	struct i2c_rdwr_ioctl_data transaction;
+
+	if (fd < 0)
+		return false;
+	message.addr = address;
+	message.flags = flags;
+	message.len = length;
+	message.buf = data;
+	transaction.msgs = &message;
+	transaction.nmsgs = 1;
+	return ioctl(fd, I2C_RDWR, &transaction) >= 0;
+}
+
+boolean ATECCLinuxTransport::wake()
+{
+	uint8_t zero = 0x00;
+
+	transfer(0x00, 0, &zero, 1); // nobody ACKs address 0x00, the pulse on SDA is what counts
+	return fd >= 0;
+}
+
+boolean ATECCLinuxTransport::write(uint8_t address, const uint8_t *data, size_t length)
+{
+	return transfer(address, 0, (uint8_t *) data, length);
+}
+
+int ATECCLinuxTransport::read(uint8_t address, uint8_t *data, size_t length)
+{
+	// the IC NACKs its address while it is busy, the caller retries
+	if (transfer(address, I2C_M_RD, data, length) == false)
+		return 0;
+	return length;
+}
+
+unsigned long ATECCLinuxTransport::micros()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long) now.tv_sec * 1000000UL + now.tv_nsec / 1000;
+}
+
+void ATECCLinuxTransport::delayMicroseconds(unsigned long us)
+{
+	struct timespec wait;
+
+	wait.tv_sec = us / 1000000UL;
+	wait.tv_nsec = (us % 1000000UL) * 1000;
+	while (nanosleep(&wait, &wait) != 0)
+		;  // interrupted by a signal, sleep the rest
+}
+
+#endif
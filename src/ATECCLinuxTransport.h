@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ATECCTransport.h"
+
+#if !defined(__linux__) || !__has_include(<linux/i2c-dev.h>)
+#error "ATECCLinuxTransport.h needs Linux with i2c-dev"
+#else
+
+
+/*
+  Transport for /dev/i2c-N on Linux (e.g. a Raspberry Pi or another SBC):
+
+    ATECCLinuxTransport bus("/dev/i2c-1");
+    if (bus.begin() == true && atecc.begin(bus) == true)
+      ...
+
+  Every frame is one I2C_RDWR transaction with a single message, the address is set per message
+  (no I2C_SLAVE), so other devices can share the file descriptor. write() and read() are not combined
+  into one write+read transaction (repeated start) like a register read: the IC only answers after
+  the execution time of the command (tEXEC, up to tens of ms) and NACKs its address until then, and
+  the wake response needs tWHI after the pulse. Other masters may use the bus in between, the response
+  stays in the I/O buffer of the IC until it is read.
+  The wake pulse is a write of 0x00 to address 0x00, which keeps SDA low for 9 clock cycles: the
+  bus must run at 100 kHz (or slower) for the 60 us of tWLO.
+*/
+
+class ATECCLinuxTransport : public ATECCTransport
+{
+  public:
+	  ATECCLinuxTransport(const char *device = "/dev/i2c-1");
+		~ATECCLinuxTransport();
+		boolean begin();
+		void    end();
+		boolean wake();
+		boolean write(uint8_t address, const uint8_t *data, size_t length);
+		int     read(uint8_t address, uint8_t *data, size_t length);
+		unsigned long micros();
+		void    delayMicroseconds(unsigned long us);
+
+	private:
+	  boolean transfer(uint8_t address, uint16_t flags, uint8_t *data, size_t length);
+
+	  const char *device;
+		int        fd = -1;
+};
+
+#endif
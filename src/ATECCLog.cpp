@@ -0,0 +1,171 @@
+#include "ATECCLog.h"
+#include "SparkFun_ATECCX08a_Arduino_Library.h"
+
+
+ATECCLog::ATECCLog(ATECCLogRecord *records, int count, uint8_t *payload, size_t payloadSize)
+{
+	this->records = records;
+	this->count = count;
+	this->payload = payload;
+	this->payloadSize = (payload != NULL) ? payloadSize : 0;
+}
+
+/** \brief
+
+	add(uint8_t opcode, uint8_t param1, uint16_t param2, uint8_t command, uint16_t status, boolean success,
+	    uint32_t time, uint32_t latency, const uint8_t *data, size_t length)
+
+	Called by ATECCX08A when a command has finished. Stores the record and up to the payload limit
+	of data, the oldest record is dropped if the log is full. Takes constant time, nothing is printed.
+*/
+
+void ATECCLog::add(uint8_t opcode, uint8_t param1, uint16_t param2, uint8_t command, uint16_t status, boolean success,
+                   uint32_t time, uint32_t latency, const uint8_t *data, size_t length)
+{
+	ATECCLogRecord &record = records[head];
+
+	if (enabled == false || count <= 0)
+		return;
+	if (used == count)
+	{
+		used--;
+		dropped++;
+	}
+	if (length > payloadLimit)
+		length = payloadLimit;
+	if (length > payloadSize)
+		length = payloadSize;
+	record.sequence = sequence++;
+	record.time = time;
+	record.latency = latency;
+	record.opcode = opcode;
+	record.param1 = param1;
+	record.param2 = param2;
+	record.command = command;
+	record.status = status;
+	record.success = success;
+	record.payloadLength = length;
+	record.payloadPosition = payloadWritten;
+	for (size_t i = 0; i < length; i++)
+		payload[(payloadWritten + i) % payloadSize] = data[i];
+	payloadWritten += length;
+	head = (head + 1) % count;
+	used++;
+}
+
+// records which can be read
+int ATECCLog::available()
+{
+	return used;
+}
+
+/** \brief
+
+	read(ATECCLogRecord &record)
+
+	Removes the oldest record from the log and copies it to record.
+	Returns false if the log is empty.
+*/
+
+boolean ATECCLog::read(ATECCLogRecord &record)
+{
+	if (used == 0)
+		return false;
+	record = records[(head + count - used) % count];
+	used--;
+	return true;
+}
+
+/** \brief
+
+	readPayload(const ATECCLogRecord &record, uint8_t *data, int size)
+
+	Copies the response data of a record (also one already taken with read()) to data.
+	Returns its length, ATECC_LOG_PAYLOAD_LOST if newer payloads have overwritten it
+	or -1 if size is too small.
+*/
+
+int ATECCLog::readPayload(const ATECCLogRecord &record, uint8_t *data, int size)
+{
+	if (payloadWritten - record.payloadPosition > payloadSize)
+		return ATECC_LOG_PAYLOAD_LOST;
+	if (record.payloadLength > size)
+		return -1;
+	for (int i = 0; i < record.payloadLength; i++)
+		data[i] = payload[(record.payloadPosition + i) % payloadSize];
+	return record.payloadLength;
+}
+
+/** \brief
+
+	print(Print &port, int maxRecords)
+
+	Reads up to maxRecords records and prints them to port, one line per record followed by
+	the payload in hex:
+	  #12 t=5210448 op=0x41 p1=0x80 p2=0x0000 cmd=9 status=0x00 ok 51234 us
+	Returns the number of records printed. Meant for the idle time of the sketch, it blocks as
+	long as port needs for the output.
+*/
+
+int ATECCLog::print(Print &port, int maxRecords)
+{
+	ATECCLogRecord record;
+	uint8_t data[0xFF];
+	int printed = 0;
+	int length;
+
+	while (printed < maxRecords && read(record) == true)
+	{
+		port.print('#');
+		port.print(record.sequence);
+		port.print(" t=");
+		port.print(record.time);
+		port.print(" op=0x");
+		port.print(record.opcode, HEX);
+		port.print(" p1=0x");
+		port.print(record.param1, HEX);
+		port.print(" p2=0x");
+		port.print(record.param2, HEX);
+		port.print(" cmd=");
+		port.print(record.command);
+		port.print(" status=0x");
+		port.print(record.status, HEX);
+		port.print(record.success ? " ok " : " failed ");
+		port.print(record.latency);
+		port.println(" us");
+		length = readPayload(record, data, sizeof(data));
+		if (length == ATECC_LOG_PAYLOAD_LOST)
+			port.println("  payload lost");
+		else if (length > 0)
+			ATECCX08A::printHex(port, data, length, " ");
+		printed++;
+	}
+	return printed;
+}
+
+void ATECCLog::clear()
+{
+	head = 0;
+	used = 0;
+	sequence = 0;
+	dropped = 0;
+	payloadWritten = 0;
+}
+
+// records lost because the log was full
+unsigned long ATECCLog::getDropped()
+{
+	return dropped;
+}
+
+// maximum number of response bytes stored per record, 0 stores none
+void ATECCLog::setPayloadLimit(uint8_t bytes)
+{
+	payloadLimit = bytes;
+}
+
+// logging can be paused, e.g. around commands with secret responses
+void ATECCLog::setEnabled(boolean enabled)
+{
+	this->enabled = enabled;
+}
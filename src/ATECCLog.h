@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Arduino.h"
+
+
+/*
+  Log of the commands for diagnostics in production. The library only stores records in RAM
+  (no printing, no String), so logging doesn't stretch a command sequence past the watchdog;
+  the sketch drains the log whenever it has time:
+
+    ATECCLogRecord logRecords[32];
+    uint8_t logPayload[512];
+    ATECCLog log(logRecords, 32, logPayload, sizeof(logPayload));
+    atecc.setLog(&log);
+    ...
+    log.print(Serial, 4);               // e.g. in loop(): up to 4 records, oldest first
+
+  Every command (submitted with submitCommand(), which all commands of the library use) adds one
+  ATECCLogRecord when its response has been checked: opcode, parameters, status and result,
+  time and latency. The data of the response (or the status byte) is copied into a separate ring
+  buffer, the record only refers to it, so the size of a record is fixed. Both rings drop the
+  oldest entries when they are full: records are counted by getDropped(), an overwritten payload
+  is reported by readPayload().
+  Responses can contain secrets (Read of a clear slot, Random, AES, KDF to the host), so
+  setPayloadLimit() limits or disables the copy.
+
+  The log isn't interrupt safe: the library and the sketch must use it from the same context.
+*/
+
+#define ATECC_LOG_PAYLOAD_LOST   -2   // readPayload(): the payload has been overwritten
+
+typedef struct
+{
+	uint32_t sequence;           // number of the record since the start (or clear()), gaps are dropped records
+	uint32_t time;               // micros() of the transport when the command was submitted
+	uint32_t latency;            // us from submitting the command until the response was checked
+	uint8_t  opcode;             // COMMAND_OPCODE_*
+	uint8_t  param1;
+	uint16_t param2;
+	uint8_t  command;            // ATECC_CMD_*
+	uint16_t status;             // getStatus() after the command, STATUS_* of the IC or the library (0x1000 and up)
+	boolean  success;
+	uint8_t  payloadLength;      // bytes of the response data in the payload ring
+	uint32_t payloadPosition;    // position of the data in the stream of payload bytes
+} ATECCLogRecord;
+
+
+class ATECCLog
+{
+  public:
+	  ATECCLog(ATECCLogRecord *records, int count, uint8_t *payload = NULL, size_t payloadSize = 0);
+
+		// library side, never blocks
+		void    add(uint8_t opcode, uint8_t param1, uint16_t param2, uint8_t command, uint16_t status, boolean success,
+		            uint32_t time, uint32_t latency, const uint8_t *data, size_t length);
+
+		// sketch side
+		int     available();
+		boolean read(ATECCLogRecord &record);
+		int     readPayload(const ATECCLogRecord &record, uint8_t *data, int size);
+		int     print(Print &port, int maxRecords = 1);
+		void    clear();
+		unsigned long getDropped();
+		void    setPayloadLimit(uint8_t bytes);
+		void    setEnabled(boolean enabled);
+
+	private:
+	  ATECCLogRecord *records;
+		int      count;
+		int      head = 0;           // next record to write
+		int      used = 0;           // records in the ring, the oldest is at head - used
+		uint32_t sequence = 0;
+		unsigned long dropped = 0;
+		uint8_t *payload;
+		size_t   payloadSize;
+		uint32_t payloadWritten = 0; // payload bytes written since the start, the ring holds the last payloadSize
+		uint8_t  payloadLimit = 0xFF;
+		boolean  enabled = true;
+};
@@ -0,0 +1,459 @@
+#include "ATECCRecordLog.h"
+
+
+ATECCRecordLog::ATECCRecordLog(ATECCX08A *atecc, int slot)
+{
+	this->atecc = atecc;
+	this->slot = slot;
+	this->slotSize = ATECCX08A::getSlotSize(slot);
+	this->status = ATECCRECORDLOG_NOT_STARTED;
+	memset(tailBlock, ATECCRECORDLOG_EMPTY, sizeof(tailBlock));
+}
+
+int ATECCRecordLog::getStatus()
+{
+	return status;
+}
+
+void ATECCRecordLog::setStatus(int status)
+{
+	this->status = status;
+}
+
+uint8_t ATECCRecordLog::getGeneration()
+{
+	return generation;
+}
+
+unsigned long ATECCRecordLog::getCompactionCount()
+{
+	return compactionCount;
+}
+
+int ATECCRecordLog::getFreeSpace()
+{
+	if (started == false)
+		return 0;
+	return slotSize - tail;
+}
+
+/** \brief
+
+	begin(boolean format)
+
+	Reads the slot with one bulk read and builds the index. If the slot doesn't contain a log yet,
+	it is formatted (format = true) or begin() fails with ATECCRECORDLOG_NOT_FOUND (format = false).
+	A compaction interrupted by a reset is finished.
+*/
+
+boolean ATECCRecordLog::begin(boolean format)
+{
+	uint8_t *image;
+	boolean result;
+
+	started = false;
+	if (slotSize < 8)
+	{
+		setStatus(ATECCRECORDLOG_INVALID_PARAMETER);
+		return false;
+	}
+	image = (uint8_t *) malloc(slotSize);
+	if (image == NULL)
+	{
+		setStatus(ATECCRECORDLOG_NO_MEMORY);
+		return false;
+	}
+
+	if (atecc->readSlotData(slot, 0, image, slotSize) == false)
+	{
+		setStatus(ATECCRECORDLOG_DEVICE_ERROR);
+		result = false;
+	}
+	else if (image[0] == ATECCRECORDLOG_MAGIC_0 && image[1] == ATECCRECORDLOG_MAGIC_1)
+	{
+		result = scan(image);
+	}
+	else if (format == true)
+	{
+		result = this->format();
+	}
+	else
+	{
+		setStatus(ATECCRECORDLOG_NOT_FOUND);
+		result = false;
+	}
+	free(image);
+
+	started = result;
+	if (result == true && compactionPending == true)
+		result = compact();
+	if (result == true)
+		setStatus(ATECCRECORDLOG_SUCCESS);
+	return result;
+}
+
+/** \brief
+
+	scan(const uint8_t *image)
+
+	Builds the index from the contents of the slot and finds the end of the log.
+	A damaged record is skipped together with the rest of its block, so are records of other
+	generations. Records of the next generation come from an interrupted compaction: they win
+	over the records of the current generation and set compactionPending.
+*/
+
+boolean ATECCRecordLog::scan(const uint8_t *image)
+{
+	int position = 4;
+	int blockStart;
+	uint8_t next;
+
+	generation = image[2];
+	next = generation + 1;
+	compactionPending = false;
+	indexSize = 0;
+	while (position + 4 <= slotSize)
+	{
+		const uint8_t *header = &image[position];
+		int nextBlock = (position / 32 + 1) * 32;
+		int size;
+		int entry;
+
+		if (header[0] == ATECCRECORDLOG_EMPTY)
+		{
+			// the rest of the block is padding if the log continues in the next block
+			if (nextBlock + 4 > slotSize || image[nextBlock] == ATECCRECORDLOG_EMPTY)
+				break;
+			position = nextBlock;
+			continue;
+		}
+
+		size = recordSize(header[1]);
+		if (header[1] > ATECCRECORDLOG_MAX_VALUE_SIZE || position + size > nextBlock || position + size > slotSize ||
+		    crc8(&header[4], header[1], crc8(header, 2)) != header[2] || (header[3] != generation && header[3] != next))
+		{
+			position = nextBlock;
+			continue;
+		}
+
+		if (header[3] == next)
+			compactionPending = true;
+		entry = findKey(header[0]);
+		if (entry < 0 && indexSize < ATECCRECORDLOG_MAX_KEYS)
+		{
+			entry = indexSize++;
+			index[entry].generation = generation;
+		}
+		if (entry >= 0 && (index[entry].generation != next || header[3] == next))
+		{
+			index[entry].key = header[0];
+			index[entry].length = header[1];
+			index[entry].offset = position;
+			index[entry].generation = header[3];
+		}
+		position += size;
+	}
+
+	tail = (position < slotSize) ? position : slotSize;
+	blockStart = (tail / 32) * 32;
+	memset(tailBlock, ATECCRECORDLOG_EMPTY, sizeof(tailBlock));
+	if (blockStart < slotSize)
+		memcpy(tailBlock, &image[blockStart], (slotSize - blockStart < 32) ? slotSize - blockStart : 32);
+	return true;
+}
+
+/** \brief
+
+	format()
+
+	Writes an empty log (only the slot header) to the slot.
+*/
+
+boolean ATECCRecordLog::format()
+{
+	uint8_t *image = (uint8_t *) malloc(slotSize);
+	boolean result;
+
+	if (image == NULL)
+	{
+		setStatus(ATECCRECORDLOG_NO_MEMORY);
+		return false;
+	}
+	memset(image, ATECCRECORDLOG_EMPTY, slotSize);
+	image[0] = ATECCRECORDLOG_MAGIC_0;
+	image[1] = ATECCRECORDLOG_MAGIC_1;
+	image[2] = 0;
+	image[3] = 0;
+
+	result = atecc->writeSlotDifferential(slot, 0, image, slotSize);
+	if (result == true)
+		scan(image);
+	else
+		setStatus(ATECCRECORDLOG_DEVICE_ERROR);
+	free(image);
+	return result;
+}
+
+/** \brief
+
+	set(uint8_t key, const uint8_t *value, int length)
+
+	Appends a record for key (0x00-0xFE) with up to ATECCRECORDLOG_MAX_VALUE_SIZE bytes.
+	This is one write command, unless the slot is full and has to be compacted first.
+*/
+
+boolean ATECCRecordLog::set(uint8_t key, const uint8_t *value, int length)
+{
+	uint8_t record[32];
+	int     size = recordSize(length);
+	int     entry;
+	int     offset;
+
+	if (started == false)
+	{
+		setStatus(ATECCRECORDLOG_NOT_STARTED);
+		return false;
+	}
+	if (key == ATECCRECORDLOG_EMPTY || length < 0 || length > ATECCRECORDLOG_MAX_VALUE_SIZE || (length > 0 && value == NULL))
+	{
+		setStatus(ATECCRECORDLOG_INVALID_PARAMETER);
+		return false;
+	}
+	entry = findKey(key);
+	if (entry < 0 && indexSize == ATECCRECORDLOG_MAX_KEYS)
+	{
+		setStatus(ATECCRECORDLOG_FULL);
+		return false;
+	}
+
+	memset(record, ATECCRECORDLOG_EMPTY, sizeof(record));
+	record[0] = key;
+	record[1] = length;
+	if (length > 0)
+		memcpy(&record[4], value, length);
+	record[2] = crc8(&record[4], length, crc8(record, 2));
+	record[3] = generation;
+
+	offset = appendRecord(record, size);
+	if (offset < 0 && status == ATECCRECORDLOG_FULL)
+	{
+		if (compact() == false)
+			return false;
+		record[3] = generation;
+		offset = appendRecord(record, size);
+	}
+	if (offset < 0)
+		return false;
+
+	// compact() rebuilds the index in another order
+	entry = findKey(key);
+	if (entry < 0)
+		entry = indexSize++;
+	index[entry].key = key;
+	index[entry].length = length;
+	index[entry].offset = offset;
+	index[entry].generation = generation;
+	setStatus(ATECCRECORDLOG_SUCCESS);
+	return true;
+}
+
+/** \brief
+
+	appendRecord(const uint8_t *record, int size)
+
+	Writes record at the end of the log and returns its position, or -1 (status ATECCRECORDLOG_FULL
+	if there is no room left).
+*/
+
+int ATECCRecordLog::appendRecord(const uint8_t *record, int size)
+{
+	uint8_t block[32];
+	int     position = tail;
+	int     blockStart;
+	boolean result;
+
+	if (position % 32 + size > 32)
+		position = (position / 32 + 1) * 32;  // records don't cross blocks
+	blockStart = (position / 32) * 32;
+	if (position + size > slotSize || (size > 4 && blockStart + 32 > slotSize))
+	{
+		setStatus(ATECCRECORDLOG_FULL);
+		return -1;
+	}
+
+	if (blockStart == (tail / 32) * 32)
+		memcpy(block, tailBlock, 32);
+	else
+		memset(block, ATECCRECORDLOG_EMPTY, 32);
+	memcpy(&block[position - blockStart], record, size);
+
+	if (size == 4)
+		result = atecc->write(ZONE_DATA, atecc->addressForSlotOffset(slot, position), record, 4);
+	else
+		result = atecc->write(ZONE_DATA, atecc->addressForSlotOffset(slot, blockStart), block, 32);
+	if (result == false)
+	{
+		setStatus(ATECCRECORDLOG_DEVICE_ERROR);
+		return -1;
+	}
+
+	tail = position + size;
+	if ((tail / 32) * 32 == blockStart)
+		memcpy(tailBlock, block, 32);
+	else
+		memset(tailBlock, ATECCRECORDLOG_EMPTY, 32);
+	return position;
+}
+
+/** \brief
+
+	get(uint8_t key, uint8_t *value, int size)
+
+	Reads the latest value of key. Returns its length, or -1 if key isn't found, value is too
+	small or the record can't be read.
+*/
+
+int ATECCRecordLog::get(uint8_t key, uint8_t *value, int size)
+{
+	uint8_t record[32];
+	int     entry;
+
+	if (started == false)
+	{
+		setStatus(ATECCRECORDLOG_NOT_STARTED);
+		return -1;
+	}
+	entry = findKey(key);
+	if (entry < 0)
+	{
+		setStatus(ATECCRECORDLOG_NOT_FOUND);
+		return -1;
+	}
+	if (index[entry].length > size || (index[entry].length > 0 && value == NULL))
+	{
+		setStatus(ATECCRECORDLOG_INVALID_PARAMETER);
+		return -1;
+	}
+	if (atecc->readSlotData(slot, index[entry].offset, record, recordSize(index[entry].length)) == false ||
+	    record[0] != key || crc8(&record[4], record[1], crc8(record, 2)) != record[2])
+	{
+		setStatus(ATECCRECORDLOG_DEVICE_ERROR);
+		return -1;
+	}
+	memcpy(value, &record[4], index[entry].length);
+	setStatus(ATECCRECORDLOG_SUCCESS);
+	return index[entry].length;
+}
+
+boolean ATECCRecordLog::contains(uint8_t key)
+{
+	return started == true && findKey(key) >= 0;
+}
+
+/** \brief
+
+	compact()
+
+	Moves the latest record of every key to the front of the log and rewrites the slot with
+	writeSlotDifferential(). Records keep their order, so every record moves towards the front
+	and the slot image can be compacted in place.
+	The moved records are tagged with the next generation, the slot header follows in a separate
+	write when all blocks have been written. After a reset in between, begin() finds the moved
+	records and runs the compaction again (see scan()).
+*/
+
+boolean ATECCRecordLog::compact()
+{
+	uint8_t *image;
+	uint8_t header[4] = { ATECCRECORDLOG_MAGIC_0, ATECCRECORDLOG_MAGIC_1, (uint8_t) (generation + 1), 0x00 };
+	int     position = 4;
+
+	if (started == false)
+	{
+		setStatus(ATECCRECORDLOG_NOT_STARTED);
+		return false;
+	}
+	image = (uint8_t *) malloc(slotSize);
+	if (image == NULL)
+	{
+		setStatus(ATECCRECORDLOG_NO_MEMORY);
+		return false;
+	}
+	if (atecc->readSlotData(slot, 0, image, slotSize) == false)
+	{
+		free(image);
+		setStatus(ATECCRECORDLOG_DEVICE_ERROR);
+		return false;
+	}
+
+	// sort the index by position, the records are moved in this order
+	for (int i = 1; i < indexSize; i++)
+	{
+		IndexEntry entry = index[i];
+		int j = i;
+		while (j > 0 && index[j - 1].offset > entry.offset)
+		{
+			index[j] = index[j - 1];
+			j--;
+		}
+		index[j] = entry;
+	}
+
+	for (int i = 0; i < indexSize; i++)
+	{
+		int size = recordSize(index[i].length);
+		int start = position;
+
+		if (start % 32 + size > 32)
+			start = (start / 32 + 1) * 32;
+		memset(&image[position], ATECCRECORDLOG_EMPTY, start - position);
+		memmove(&image[start], &image[index[i].offset], size);
+		image[start + 3] = header[2];
+		index[i].offset = start;
+		position = start + size;
+	}
+	memset(&image[position], ATECCRECORDLOG_EMPTY, slotSize - position);
+
+	// the records first (the old header stays in word 0), the header last
+	if (atecc->writeSlotDifferential(slot, 0, image, slotSize) == false ||
+	    atecc->write(ZONE_DATA, atecc->addressForSlotOffset(slot, 0), header, 4) == false)
+	{
+		free(image);
+		started = false;  // the index doesn't match the slot any more, call begin() again
+		setStatus(ATECCRECORDLOG_DEVICE_ERROR);
+		return false;
+	}
+	memcpy(image, header, 4);
+	scan(image);
+	free(image);
+	compactionCount++;
+	setStatus(ATECCRECORDLOG_SUCCESS);
+	return true;
+}
+
+int ATECCRecordLog::findKey(uint8_t key)
+{
+	for (int i = 0; i < indexSize; i++)
+	{
+		if (index[i].key == key)
+			return i;
+	}
+	return -1;
+}
+
+int ATECCRecordLog::recordSize(int length)
+{
+	return 4 + ((length + 3) / 4) * 4;
+}
+
+// CRC-8, polynomial 0x07
+uint8_t ATECCRecordLog::crc8(const uint8_t *data, int length, uint8_t crc)
+{
+	for (int i = 0; i < length; i++)
+	{
+		crc ^= data[i];
+		for (int bit = 0; bit < 8; bit++)
+			crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 0x07) : (uint8_t) (crc << 1);
+	}
+	return crc;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "SparkFun_ATECCX08a_Arduino_Library.h"
+
+
+#define ATECCRECORDLOG_SUCCESS                  0
+#define ATECCRECORDLOG_NOT_STARTED            -40
+#define ATECCRECORDLOG_INVALID_PARAMETER      -41
+#define ATECCRECORDLOG_FULL                   -42
+#define ATECCRECORDLOG_NOT_FOUND              -43
+#define ATECCRECORDLOG_DEVICE_ERROR           -44
+#define ATECCRECORDLOG_NO_MEMORY              -45
+
+#define ATECCRECORDLOG_MAX_KEYS                16
+#define ATECCRECORDLOG_MAX_VALUE_SIZE          28   // a record (4 byte header + value) fits into one block
+#define ATECCRECORDLOG_EMPTY                 0xFF   // contents of unused words, also the invalid key
+
+#define ATECCRECORDLOG_MAGIC_0                'R'
+#define ATECCRECORDLOG_MAGIC_1                'L'
+
+
+/*
+  A small key/value store in a data slot (slot 8 with its 416 bytes is the natural choice),
+  written as an append-only log instead of rewriting the slot in place.
+
+  Layout of the slot (all records start on a word boundary):
+  - word 0: 'R', 'L', generation, 0x00 (generation is incremented by every compaction)
+  - records: header word {key, length, crc8(key, length, value), generation} followed by the value,
+    padded with 0xFF to a multiple of 4 bytes
+  - unused words are 0xFF
+  A record never crosses a block boundary, so every set() is a single write command: a 4 byte
+  write for a record without value, a 32 byte write of the block at the end of the log otherwise
+  (the contents of that block are kept in RAM). If the record doesn't fit into the rest of the
+  block, it starts at the next block and the rest stays 0xFF.
+  When the slot is full, the latest record of every key is moved to the front and the slot is
+  rewritten with writeSlotDifferential(), which skips the blocks that didn't change.
+
+  Compaction survives a reset: the moved records carry the next generation and the slot header
+  is written last. Records only move towards the front, so every record a partial compaction
+  has overwritten already has its copy of the next generation in front of it. begin() prefers
+  these copies to the records of the current generation and finishes the compaction.
+
+  begin() reads the whole slot with one readSlotData() call and builds the index (key -> position
+  of the latest record). get() reads only the words of the record.
+
+  The data zone must be locked and the slot must allow clear reads and writes.
+*/
+
+class ATECCRecordLog
+{
+  public:
+	  ATECCRecordLog(ATECCX08A *atecc, int slot = 8);
+		int     getStatus();
+		boolean begin(boolean format = true);
+		boolean set(uint8_t key, const uint8_t *value, int length);
+		int     get(uint8_t key, uint8_t *value, int size);
+		boolean contains(uint8_t key);
+		boolean compact();
+		int     getFreeSpace();
+		uint8_t getGeneration();
+		unsigned long getCompactionCount();
+
+  protected:
+	  void    setStatus(int status);
+		boolean scan(const uint8_t *image);
+		boolean format();
+		int     appendRecord(const uint8_t *record, int size);
+		int     findKey(uint8_t key);
+		static uint8_t crc8(const uint8_t *data, int length, uint8_t crc = 0);
+		static int recordSize(int length);
+
+	private:
+	  typedef struct
+		{
+			uint8_t  key;
+			uint8_t  length;
+			uint16_t offset;    // position of the record header in the slot
+			uint8_t  generation;
+		} IndexEntry;
+
+	  ATECCX08A     *atecc;
+		int           slot;
+		int           slotSize;
+		boolean       started = false;
+		uint8_t       generation = 0;
+		boolean       compactionPending = false; // scan() found records of an interrupted compaction
+		int           tail = 0;             // first unused byte of the slot
+		uint8_t       tailBlock[32];        // contents of the block containing tail
+		IndexEntry    index[ATECCRECORDLOG_MAX_KEYS];
+		int           indexSize = 0;
+		int           status;
+		unsigned long compactionCount = 0;
+};
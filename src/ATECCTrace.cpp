@@ -0,0 +1,278 @@
+#include "ATECCTrace.h"
+
+
+ATECCTraceTransport::ATECCTraceTransport(ATECCTransport &transport, uint8_t *buffer, size_t size)
+{
+	this->transport = &transport;
+	this->buffer = buffer;
+	this->size = size;
+}
+
+boolean ATECCTraceTransport::wake()
+{
+	uint32_t time = transport->micros();
+	boolean result = transport->wake();
+
+	record(ATECC_TRACE_WAKE, time, 0, result, NULL, 0);
+	return result;
+}
+
+boolean ATECCTraceTransport::write(uint8_t address, const uint8_t *data, size_t length)
+{
+	uint32_t time = transport->micros();
+	boolean result = transport->write(address, data, length);
+
+	record(ATECC_TRACE_WRITE, time, address, result, data, length);
+	return result;
+}
+
+int ATECCTraceTransport::read(uint8_t address, uint8_t *data, size_t length)
+{
+	uint32_t time = transport->micros();
+	int received = transport->read(address, data, length);
+
+	record(ATECC_TRACE_READ, time, address, length, data, (received > 0) ? received : 0);
+	return received;
+}
+
+unsigned long ATECCTraceTransport::micros()
+{
+	return transport->micros();
+}
+
+void ATECCTraceTransport::delayMicroseconds(unsigned long us)
+{
+	transport->delayMicroseconds(us);
+}
+
+// recording can be paused, the calls still go to the transport
+void ATECCTraceTransport::setEnabled(boolean enabled)
+{
+	this->enabled = enabled;
+}
+
+void ATECCTraceTransport::clear()
+{
+	head = 0;
+	used = 0;
+	dropped = 0;
+}
+
+// bytes getTrace() needs
+size_t ATECCTraceTransport::getTraceSize()
+{
+	return ATECC_TRACE_HEADER_SIZE + used;
+}
+
+// records lost because the ring buffer was full (or a record was larger than the buffer)
+unsigned long ATECCTraceTransport::getDropped()
+{
+	return dropped;
+}
+
+/** \brief
+
+	getTrace(uint8_t *output, size_t size)
+
+	Copies the trace (header and records, oldest first) to output. Returns the length of the
+	trace, or 0 if size is smaller than getTraceSize(). The records stay in the buffer.
+*/
+
+size_t ATECCTraceTransport::getTrace(uint8_t *output, size_t size)
+{
+	size_t start = (head + this->size - used) % this->size;
+	size_t first;
+
+	if (size < getTraceSize())
+		return 0;
+	output[0] = 'A';
+	output[1] = 'T';
+	output[2] = ATECC_TRACE_VERSION;
+	output[3] = 0x00;
+	for (int i = 0; i < 4; i++)
+		output[4 + i] = (dropped >> (8 * i)) & 0xFF;
+	first = (used < this->size - start) ? used : this->size - start;
+	memcpy(&output[ATECC_TRACE_HEADER_SIZE], &buffer[start], first);
+	memcpy(&output[ATECC_TRACE_HEADER_SIZE + first], buffer, used - first);
+	return getTraceSize();
+}
+
+// appends a record, drops the oldest records until it fits
+void ATECCTraceTransport::record(uint8_t type, uint32_t time, uint8_t address, uint8_t param, const uint8_t *data, size_t length)
+{
+	uint8_t header[ATECC_TRACE_RECORD_SIZE];
+
+	if (enabled == false)
+		return;
+	if (length > 0xFF)
+		length = 0xFF;
+	if (ATECC_TRACE_RECORD_SIZE + length > size)
+	{
+		dropped++;
+		return;
+	}
+	while (size - used < ATECC_TRACE_RECORD_SIZE + length)
+	{
+		// the length byte is the last byte of the header of the oldest record
+		size_t oldest = (head + size - used) % size;
+
+		used -= ATECC_TRACE_RECORD_SIZE + buffer[(oldest + ATECC_TRACE_RECORD_SIZE - 1) % size];
+		dropped++;
+	}
+	header[0] = type;
+	for (int i = 0; i < 4; i++)
+		header[1 + i] = (time >> (8 * i)) & 0xFF;
+	header[5] = address;
+	header[6] = param;
+	header[7] = length;
+	put(header, sizeof(header));
+	put(data, length);
+}
+
+void ATECCTraceTransport::put(const uint8_t *data, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		buffer[head] = data[i];
+		head = (head + 1) % size;
+	}
+	used += length;
+}
+
+/** \brief
+
+	parseRecord(const uint8_t *data, size_t length, ATECCTraceRecord &record)
+
+	Decodes the record at data (length bytes left in the trace).
+	Returns the size of the record, or 0 if there is no complete record.
+*/
+
+int ATECCTraceTransport::parseRecord(const uint8_t *data, size_t length, ATECCTraceRecord &record)
+{
+	if (length < ATECC_TRACE_RECORD_SIZE || length < (size_t) ATECC_TRACE_RECORD_SIZE + data[7])
+		return 0;
+	record.type = data[0];
+	record.time = data[1] | (data[2] << 8) | ((uint32_t) data[3] << 16) | ((uint32_t) data[4] << 24);
+	record.address = data[5];
+	record.param = data[6];
+	record.length = data[7];
+	record.data = &data[ATECC_TRACE_RECORD_SIZE];
+	return ATECC_TRACE_RECORD_SIZE + record.length;
+}
+
+// true if trace starts with the header of this version, dropped (optional) is set to its number of dropped records
+boolean ATECCTraceTransport::checkHeader(const uint8_t *trace, size_t length, unsigned long *dropped)
+{
+	if (length < ATECC_TRACE_HEADER_SIZE || trace[0] != 'A' || trace[1] != 'T' || trace[2] != ATECC_TRACE_VERSION)
+		return false;
+	if (dropped != NULL)
+		*dropped = trace[4] | (trace[5] << 8) | ((unsigned long) trace[6] << 16) | ((unsigned long) trace[7] << 24);
+	return true;
+}
+
+
+ATECCReplayTransport::ATECCReplayTransport(const uint8_t *trace, size_t length)
+{
+	this->trace = trace;
+	this->length = length;
+	valid = ATECCTraceTransport::checkHeader(trace, length);
+}
+
+boolean ATECCReplayTransport::wake()
+{
+	ATECCTraceRecord record;
+
+	if (next(ATECC_TRACE_WAKE, 0, record) == false)
+		return false;
+	return record.param;
+}
+
+boolean ATECCReplayTransport::write(uint8_t address, const uint8_t *data, size_t length)
+{
+	ATECCTraceRecord record;
+
+	if (next(ATECC_TRACE_WRITE, address, record) == false)
+		return false;
+	if (record.length != length || memcmp(record.data, data, length) != 0)
+	{
+		divergence = position - 1;   // the library sent another frame
+		return false;
+	}
+	return record.param;
+}
+
+int ATECCReplayTransport::read(uint8_t address, uint8_t *data, size_t length)
+{
+	ATECCTraceRecord record;
+
+	if (next(ATECC_TRACE_READ, address, record) == false)
+		return 0;
+	if (record.param != length)
+	{
+		divergence = position - 1;
+		return 0;
+	}
+	memcpy(data, record.data, record.length);
+	return record.length;
+}
+
+unsigned long ATECCReplayTransport::micros()
+{
+	return now;
+}
+
+void ATECCReplayTransport::delayMicroseconds(unsigned long us)
+{
+	now += us;
+}
+
+// false if the trace isn't valid
+boolean ATECCReplayTransport::isValid()
+{
+	return valid;
+}
+
+// true if all records have been played
+boolean ATECCReplayTransport::isFinished()
+{
+	return offset >= length;
+}
+
+boolean ATECCReplayTransport::hasDiverged()
+{
+	return divergence >= 0;
+}
+
+// index of the record where the library did something else than the trace, -1 if it didn't
+long ATECCReplayTransport::getDivergence()
+{
+	return divergence;
+}
+
+// number of records played so far
+long ATECCReplayTransport::getPosition()
+{
+	return position;
+}
+
+// takes the next record, which must be of type and for address
+boolean ATECCReplayTransport::next(uint8_t type, uint8_t address, ATECCTraceRecord &record)
+{
+	int recordSize;
+
+	if (valid == false || divergence >= 0)
+		return false;
+	recordSize = ATECCTraceTransport::parseRecord(&trace[offset], (offset < length) ? length - offset : 0, record);
+	if (recordSize == 0 || record.type != type || record.address != address)
+	{
+		divergence = position;   // another call than in the trace, or the trace has ended
+		return false;
+	}
+	offset += recordSize;
+	position++;
+	// the clock starts at the first record and never runs behind the trace
+	if (started == false || (long) (record.time - now) > 0)
+		now = record.time;
+	started = true;
+	return true;
+}
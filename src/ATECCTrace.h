@@ -0,0 +1,119 @@
+#pragma once
+
+#include "ATECCTransport.h"
+
+
+/*
+  Binary trace of the bus, recorded without changing the timing (no printing, no String):
+
+    uint8_t traceBuffer[1024];
+    ATECCWireTransport wire(&Wire);
+    ATECCTraceTransport trace(wire, traceBuffer, sizeof(traceBuffer));
+    atecc.begin(trace);
+    ...
+    length = trace.getTrace(output, sizeof(output));   // e.g. to a file, flash or Serial.write()
+
+  ATECCTraceTransport sits between ATECCX08A and any other transport and keeps the latest records in
+  a ring buffer (the oldest records are dropped when it's full). extras/tools/atecc_trace.cpp decodes
+  a trace on the host, ATECCReplayTransport feeds it back into the library, so a problem of the field
+  can be reproduced deterministically, e.g. on Linux.
+
+  Trace format (all numbers little endian):
+  - header (ATECC_TRACE_HEADER_SIZE bytes): 'A', 'T', ATECC_TRACE_VERSION, 0x00, number of dropped records (4 bytes)
+  - records, oldest first, each ATECC_TRACE_RECORD_SIZE bytes followed by length bytes of data:
+    type, time (4 bytes, micros() of the transport when the call started), address, param, length
+      ATECC_TRACE_WAKE:  param = result, no data
+      ATECC_TRACE_WRITE: param = result, data = the frame (word address, count, opcode, param1, param2, data, CRC)
+      ATECC_TRACE_READ:  param = requested bytes, length = received bytes, data = the bytes received
+*/
+
+#define ATECC_TRACE_VERSION      1
+#define ATECC_TRACE_HEADER_SIZE  8
+#define ATECC_TRACE_RECORD_SIZE  8   // without the data
+
+// record types
+#define ATECC_TRACE_WAKE         1
+#define ATECC_TRACE_WRITE        2
+#define ATECC_TRACE_READ         3
+
+typedef struct
+{
+	uint8_t  type;               // ATECC_TRACE_*
+	uint32_t time;               // us
+	uint8_t  address;
+	uint8_t  param;              // result of wake and write, requested bytes of read
+	uint8_t  length;             // bytes of data
+	const uint8_t *data;         // points into the trace
+} ATECCTraceRecord;
+
+
+class ATECCTraceTransport : public ATECCTransport
+{
+  public:
+	  ATECCTraceTransport(ATECCTransport &transport, uint8_t *buffer, size_t size);
+		boolean wake();
+		boolean write(uint8_t address, const uint8_t *data, size_t length);
+		int     read(uint8_t address, uint8_t *data, size_t length);
+		unsigned long micros();
+		void    delayMicroseconds(unsigned long us);
+
+		void    setEnabled(boolean enabled);
+		void    clear();
+		size_t  getTraceSize();
+		size_t  getTrace(uint8_t *output, size_t size);
+		unsigned long getDropped();
+
+		static int parseRecord(const uint8_t *data, size_t length, ATECCTraceRecord &record);
+		static boolean checkHeader(const uint8_t *trace, size_t length, unsigned long *dropped = NULL);
+
+	private:
+	  void    record(uint8_t type, uint32_t time, uint8_t address, uint8_t param, const uint8_t *data, size_t length);
+		void    put(const uint8_t *data, size_t length);
+
+		ATECCTransport *transport;
+		uint8_t *buffer;
+		size_t   size;
+		size_t   head = 0;       // next byte to write
+		size_t   used = 0;       // bytes of records in the buffer, the oldest starts at head - used
+		unsigned long dropped = 0;
+		boolean  enabled = true;
+};
+
+
+/*
+  Plays a trace back to ATECCX08A: every wake(), write() and read() takes the next record of the trace
+  and returns what the IC returned in the field. The clock is simulated, it runs with delayMicroseconds()
+  and jumps to the time of the record if the field was slower, so the library sees the same timing.
+  If the library does something else than the trace (another call or another frame), the replay has
+  diverged: getDivergence() tells the record, the calls fail from then on.
+  The trace isn't copied, it must stay valid while the replay runs.
+*/
+
+class ATECCReplayTransport : public ATECCTransport
+{
+  public:
+	  ATECCReplayTransport(const uint8_t *trace, size_t length);
+		boolean wake();
+		boolean write(uint8_t address, const uint8_t *data, size_t length);
+		int     read(uint8_t address, uint8_t *data, size_t length);
+		unsigned long micros();
+		void    delayMicroseconds(unsigned long us);
+
+		boolean isValid();
+		boolean isFinished();
+		boolean hasDiverged();
+		long    getDivergence();
+		long    getPosition();
+
+	private:
+	  boolean next(uint8_t type, uint8_t address, ATECCTraceRecord &record);
+
+		const uint8_t *trace;
+		size_t   length;
+		size_t   offset = ATECC_TRACE_HEADER_SIZE;  // next record
+		long     position = 0;   // number of records played
+		long     divergence = -1;
+		boolean  valid;
+		boolean  started = false;
+		unsigned long now = 0;
+};
@@ -0,0 +1,208 @@
+#include "SparkFun_ATECCX08a_Arduino_Library.h"
+
+
+ATECCWireTransport::ATECCWireTransport(TwoWire *wirePort)
+{
+	this->wirePort = wirePort;
+}
+
+void ATECCWireTransport::setPort(TwoWire *wirePort)
+{
+	this->wirePort = wirePort;
+}
+
+boolean ATECCWireTransport::wake()
+{
+  wirePort->beginTransmission(0x00); // set up to write to address "0x00",
+  // This creates a "wake condition" where SDA is held low for at least tWLO
+  // tWLO means "wake low duration" and must be at least 60 uSeconds (which is acheived by writing 0x00 at 100KHz I2C)
+  wirePort->endTransmission(); // actually send it
+	return true;
+}
+
+boolean ATECCWireTransport::write(uint8_t address, const uint8_t *data, size_t length)
+{
+  wirePort->beginTransmission(address);
+  wirePort->write(data, length);
+  return wirePort->endTransmission() == 0;
+}
+
+int ATECCWireTransport::read(uint8_t address, uint8_t *data, size_t length)
+{
+	int count = 0;
+
+  wirePort->requestFrom(address, (uint8_t) length);    // request bytes from slave
+	while (wirePort->available() && count < (int) length)   // slave may send less than requested
+		data[count++] = wirePort->read();
+	return count;
+}
+
+unsigned long ATECCWireTransport::micros()
+{
+	return ::micros();
+}
+
+void ATECCWireTransport::delayMicroseconds(unsigned long us)
+{
+	// delayMicroseconds() of the Arduino core is only accurate up to ~16 ms
+	if (us >= 1000)
+		delay(us / 1000);
+	::delayMicroseconds(us % 1000);
+}
+
+
+ATECCMockTransport::ATECCMockTransport()
+{
+}
+
+// the wake response is read before the queued responses
+static const uint8_t mockWakeResponse[] = { 0x04, STATUS_WAKE_TOKEN_RECEIVED, 0x33, 0x43 };
+
+boolean ATECCMockTransport::wake()
+{
+	wakeCount++;
+	wakeResponseIndex = 0;
+	return true;
+}
+
+boolean ATECCMockTransport::write(uint8_t /* address */, const uint8_t *data, size_t length)
+{
+	if (length == 1 && data[0] == WORD_ADDRESS_VALUE_IDLE)
+	{
+		idleCount++;
+		return true;
+	}
+	frameCount++;
+	wakeResponseIndex = sizeof(mockWakeResponse);  // not read any more after a command
+	lastFrameLength = (length < sizeof(lastFrame)) ? length : sizeof(lastFrame);
+	memcpy(lastFrame, data, lastFrameLength);
+	if (handler != NULL && length > 0 && data[0] == WORD_ADDRESS_VALUE_COMMAND)
+		handler(this, data, length, handlerContext);
+	return true;
+}
+
+int ATECCMockTransport::read(uint8_t /* address */, uint8_t *data, size_t length)
+{
+	int count = 0;
+
+	if (nacks > 0)
+	{
+		nacks--;
+		nackCount++;
+		return 0;
+	}
+	if (readLimit > 0 && length > readLimit)
+		length = readLimit;
+
+	while (count < (int) length && wakeResponseIndex < sizeof(mockWakeResponse))
+		data[count++] = mockWakeResponse[wakeResponseIndex++];
+	while (count < (int) length && responseStart < responseEnd)
+		data[count++] = responses[responseStart++];
+	if (responseStart == responseEnd)
+		clearResponses();
+	return count;
+}
+
+unsigned long ATECCMockTransport::micros()
+{
+	return now;
+}
+
+void ATECCMockTransport::delayMicroseconds(unsigned long us)
+{
+	now += us;
+}
+
+void ATECCMockTransport::advance(unsigned long us)
+{
+	now += us;
+}
+
+/** \brief
+
+	setHandler(ATECCMockHandler handler, void *context)
+
+	handler is called for every command frame (word address, count, opcode, param1, param2, data, CRC)
+	and queues the response of the simulated IC.
+*/
+
+void ATECCMockTransport::setHandler(ATECCMockHandler handler, void *context)
+{
+	this->handler = handler;
+	this->handlerContext = context;
+}
+
+boolean ATECCMockTransport::queueResponse(const uint8_t *data, size_t length)
+{
+	if (responseEnd + length > sizeof(responses))
+		return false;
+	memcpy(&responses[responseEnd], data, length);
+	responseEnd += length;
+	return true;
+}
+
+// queues count, data and CRC
+boolean ATECCMockTransport::queueData(const uint8_t *data, size_t length)
+{
+	uint8_t  count = RESPONSE_COUNT_SIZE + length + CRC_SIZE;
+	uint16_t crc;
+
+	if (responseEnd + count > sizeof(responses))
+		return false;
+	crc = ATECCX08A::calculateSummaryCrc(&count, 1);
+	crc = ATECCX08A::calculateSummaryCrc(data, length, crc);
+	responses[responseEnd++] = count;
+	queueResponse(data, length);
+	responses[responseEnd++] = crc & 0xFF;
+	responses[responseEnd++] = crc >> 8;
+	return true;
+}
+
+boolean ATECCMockTransport::queueStatus(uint8_t status)
+{
+	return queueData(&status, 1);
+}
+
+void ATECCMockTransport::clearResponses()
+{
+	responseStart = 0;
+	responseEnd = 0;
+}
+
+// the next reads return 0 bytes, like the IC does while it is asleep or busy
+void ATECCMockTransport::setNacks(unsigned int reads)
+{
+	nacks = reads;
+}
+
+// every read returns at most bytes (0 = as many as requested)
+void ATECCMockTransport::setReadLimit(size_t bytes)
+{
+	readLimit = bytes;
+}
+
+const uint8_t *ATECCMockTransport::getLastFrame(size_t &length)
+{
+	length = lastFrameLength;
+	return lastFrame;
+}
+
+unsigned long ATECCMockTransport::getWakeCount()
+{
+	return wakeCount;
+}
+
+unsigned long ATECCMockTransport::getFrameCount()
+{
+	return frameCount;
+}
+
+unsigned long ATECCMockTransport::getIdleCount()
+{
+	return idleCount;
+}
+
+unsigned long ATECCMockTransport::getNackCount()
+{
+	return nackCount;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#if (ARDUINO >= 100)
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "Wire.h"
+
+
+/*
+  The bus between ATECCX08A and the IC. ATECCX08A only needs four operations:
+  - wake():   the wake pulse (SDA low for at least 60 us), without the wake delay
+  - write():  one frame to the IC (word address followed by the command packet)
+  - read():   up to length bytes from the IC, returns the number of bytes received (0 if the IC NACKs)
+  - micros() and delayMicroseconds(): the time base for the execution times
+
+  ATECCWireTransport runs on the Arduino Wire library and is used by ATECCX08A::begin(address, wirePort).
+  ATECCLinuxTransport (ATECCLinuxTransport.h) uses /dev/i2c-N on Linux, ATECCMockTransport runs the
+  library without hardware.
+*/
+
+class ATECCTransport
+{
+  public:
+	  virtual ~ATECCTransport() {}
+		virtual boolean wake() = 0;
+		virtual boolean write(uint8_t address, const uint8_t *data, size_t length) = 0;
+		virtual int     read(uint8_t address, uint8_t *data, size_t length) = 0;
+		virtual unsigned long micros() = 0;
+		virtual void    delayMicroseconds(unsigned long us) = 0;
+};
+
+
+class ATECCWireTransport : public ATECCTransport
+{
+  public:
+	  ATECCWireTransport(TwoWire *wirePort = NULL);
+		void    setPort(TwoWire *wirePort);
+		boolean wake();
+		boolean write(uint8_t address, const uint8_t *data, size_t length);
+		int     read(uint8_t address, uint8_t *data, size_t length);
+		unsigned long micros();
+		void    delayMicroseconds(unsigned long us);
+
+	private:
+	  TwoWire *wirePort;
+};
+
+
+#define ATECC_MOCK_BUFFER_SIZE  256  // pending response bytes
+#define ATECC_MOCK_FRAME_SIZE   160  // longest frame kept by getLastFrame() (Verify: 1 + 7 + 128 bytes)
+
+class ATECCMockTransport;
+typedef void (*ATECCMockHandler)(ATECCMockTransport *mock, const uint8_t *frame, size_t length, void *context);
+
+/*
+  In-memory transport for tests on the host. The responses of the IC are queued with queueResponse()
+  (raw bytes) or queueData() (count and CRC are added), or created by a handler which is called for
+  every command frame. After wake() the wake response (0x04, 0x11, 0x33, 0x43) is read first.
+  The clock is simulated: delayMicroseconds() and advance() move it forward.
+  setNacks() lets the next reads fail like an IC which is still busy, setReadLimit() delivers
+  at most a number of bytes per read (short reads).
+*/
+
+class ATECCMockTransport : public ATECCTransport
+{
+  public:
+	  ATECCMockTransport();
+		boolean wake();
+		boolean write(uint8_t address, const uint8_t *data, size_t length);
+		int     read(uint8_t address, uint8_t *data, size_t length);
+		unsigned long micros();
+		void    delayMicroseconds(unsigned long us);
+
+		void    setHandler(ATECCMockHandler handler, void *context = NULL);
+		boolean queueResponse(const uint8_t *data, size_t length);
+		boolean queueData(const uint8_t *data, size_t length);
+		boolean queueStatus(uint8_t status);
+		void    clearResponses();
+		void    setNacks(unsigned int reads);
+		void    setReadLimit(size_t bytes);
+		void    advance(unsigned long us);
+		const uint8_t *getLastFrame(size_t &length);
+		unsigned long getWakeCount();
+		unsigned long getFrameCount();
+		unsigned long getIdleCount();
+		unsigned long getNackCount();
+
+	private:
+	  ATECCMockHandler handler = NULL;
+		void          *handlerContext = NULL;
+		uint8_t       responses[ATECC_MOCK_BUFFER_SIZE];
+		size_t        responseStart = 0;
+		size_t        responseEnd = 0;
+		size_t        wakeResponseIndex = 4;  // next byte of the wake response, 4 = none pending
+		uint8_t       lastFrame[ATECC_MOCK_FRAME_SIZE];
+		size_t        lastFrameLength = 0;
+		unsigned int  nacks = 0;              // reads left which are NACKed
+		size_t        readLimit = 0;          // bytes per read, 0 = no limit
+		unsigned long now = 0;
+		unsigned long wakeCount = 0;
+		unsigned long frameCount = 0;
+		unsigned long idleCount = 0;
+		unsigned long nackCount = 0;
+};
@@ -22,6 +22,24 @@
 */
 
 #include "SparkFun_ATECCX08a_Arduino_Library.h"
+#include "ATECCLog.h"
+
+constexpr uint16_t ATECCX08A::slotSizes[16];
+
+// execution times in ms, indexed by ATECC_CMD_*. The ATECC608B uses the ATECC608A tables.
+// The clock divider slows down the ECC and SHA engines, EEPROM accesses don't change.
+//                                                                                AES CheckMac GenKey HMAC Info KDF Lock MAC Nonce Random Read SHA Sign Verify Write
+static constexpr ATECCDeviceProfile deviceProfiles[] = {
+  { ATECC_MODEL_UNKNOWN, CHIP_MODE_CLOCK_DIVIDER_M0, "unknown",   0xFF,        { 27,  40,     115,   36,  1,   165, 35,  55,  20,   23,    1,   36, 115,  105,  45 } },
+  { ATECC_MODEL_508A,    CHIP_MODE_CLOCK_DIVIDER_M0, "ATECC508A", ATECC_FEATURE_HMAC_COMMAND,
+                                                                               {  0,  13,     115,   23,  1,     0, 32,  14,   7,   23,    1,    9,  70,   58,  26 } },
+  { ATECC_MODEL_608A,    CHIP_MODE_CLOCK_DIVIDER_M0, "ATECC608A", ATECC_FEATURE_AES | ATECC_FEATURE_KDF | ATECC_FEATURE_SHA_CONTEXT | ATECC_FEATURE_DIGEST_BUFFER,
+                                                                               { 27,  40,     115,   36,  1,   165, 35,  55,  20,   23,    1,   36, 115,  105,  45 } },
+  { ATECC_MODEL_608A,    CHIP_MODE_CLOCK_DIVIDER_M1, "ATECC608A", ATECC_FEATURE_AES | ATECC_FEATURE_KDF | ATECC_FEATURE_SHA_CONTEXT | ATECC_FEATURE_DIGEST_BUFFER,
+                                                                               { 27,  40,     215,   42,  1,   165, 35,  55,  20,   23,    1,   42, 220,  295,  45 } },
+  { ATECC_MODEL_608A,    CHIP_MODE_CLOCK_DIVIDER_M2, "ATECC608A", ATECC_FEATURE_AES | ATECC_FEATURE_KDF | ATECC_FEATURE_SHA_CONTEXT | ATECC_FEATURE_DIGEST_BUFFER,
+                                                                               { 27,  40,     653,   75,  1,   165, 35,  55,  20,   23,    1,   75, 665, 1085,  45 } },
+};
 
 /** \brief 
 
@@ -39,10 +57,37 @@
 
 boolean ATECCX08A::begin(uint8_t i2caddr, TwoWire &wirePort, Stream &serialPort)
 {
-  _i2cPort = &wirePort;        //Grab which port the user wants us to use
+  wireTransport.setPort(&wirePort);  //Grab which port the user wants us to use
+  return begin(wireTransport, i2caddr, serialPort);
+}
+
+/** \brief 
+
+	begin(ATECCTransport &transport, uint8_t i2caddr, Stream &serialPort)
+	
+	Same as begin(i2caddr, wirePort, serialPort), but the IC is accessed through transport
+	(e.g. ATECCLinuxTransport or ATECCMockTransport, see ATECCTransport.h).
+*/
+
+boolean ATECCX08A::begin(ATECCTransport &transport, uint8_t i2caddr, Stream &serialPort)
+{
+  this->transport = &transport;
   _debugSerial = &serialPort;  //Grab which port the user wants us to use
   _i2caddr = i2caddr;
-  return ( wakeUp() );        // see if the IC wakes up properly, return response.
+  deviceModel = ATECC_MODEL_UNKNOWN;
+  clockDivider = CHIP_MODE_CLOCK_DIVIDER_M0;
+  if (wakeUp() == false)      // see if the IC wakes up properly
+    return false;
+  getInfo();                  // select the execution time and feature table of the model
+  if (isATECC608A() == true)
+  {
+    uint8_t word[4];
+
+    // the clock divider in ChipMode changes the execution times
+    if (read(ZONE_CONFIG, CONFIG_ZONE_I2C_ADDRESS / 4, word, 4) == true)
+      clockDivider = word[CONFIG_ZONE_CHIP_MODE - CONFIG_ZONE_I2C_ADDRESS] & CHIP_MODE_CLOCK_DIVIDER_MASK;
+  }
+  return true;
 }
 
 /** \brief 
@@ -64,26 +109,24 @@ boolean ATECCX08A::begin(uint8_t i2caddr, TwoWire &wirePort, Stream &serialPort)
 
 boolean ATECCX08A::wakeUp()
 {
-  _i2cPort->beginTransmission(0x00); // set up to write to address "0x00",
   // This creates a "wake condition" where SDA is held low for at least tWLO
-  // tWLO means "wake low duration" and must be at least 60 uSeconds (which is acheived by writing 0x00 at 100KHz I2C)
-  _i2cPort->endTransmission(); // actually send it
+  // tWLO means "wake low duration" and must be at least 60 uSeconds
+  transport->wake();
 
-  delayMicroseconds(1500); // required for the IC to actually wake up.
+  transport->delayMicroseconds(1500); // required for the IC to actually wake up.
   // 1500 uSeconds is minimum and known as "Wake High Delay to Data Comm." tWHI, and SDA must be high during this time.
+#if ATECC_ENABLE_METRICS
+  metrics.wakes++;
+#endif
 
   // Now let's read back from the IC and see if it reports back good things.
   countGlobal = 0; 
-  if (receiveResponseData(4) == false) 
-		return false;
-  if (checkCount() == false) 
-		return false;
-  if (checkCrc() == false) 
-		return false;
-  if (inputBuffer[1] == 0x11) 
+  if (receiveResponseData(4) == true && checkCount() == true && checkCrc() == true && inputBuffer[1] == 0x11)
 		return true;   // If we hear a "0x11", that means it had a successful wake up.
-  else 
-		return false;
+#if ATECC_ENABLE_METRICS
+  metrics.wakeFailures++;
+#endif
+  return false;
 }
 
 /** \brief
@@ -98,9 +141,10 @@ boolean ATECCX08A::wakeUp()
 
 void ATECCX08A::idleMode()
 {
-  _i2cPort->beginTransmission(_i2caddr); // set up to write to address
-  _i2cPort->write(WORD_ADDRESS_VALUE_IDLE); // enter idle command (aka word address - the first part of every communication to the IC)
-  _i2cPort->endTransmission(); // actually send it  
+  if (sessionDepth > 0)
+    return; // the IC stays awake until the session ends (see endSession())
+  uint8_t wordAddress = WORD_ADDRESS_VALUE_IDLE; // enter idle command (aka word address - the first part of every communication to the IC)
+  transport->write(_i2caddr, &wordAddress, 1);
 }
 
 /** \brief
@@ -116,21 +160,18 @@ void ATECCX08A::idleMode()
 
 boolean ATECCX08A::getInfo()
 {
-  sendCommand(COMMAND_OPCODE_INFO, 0x00, 0x0000); // param1 - 0x00 (revision mode).
-
-  delay(1); // time for IC to process command and exectute
-  
-    // Now let's read back from the IC and see if it reports back good things.
-  countGlobal = 0; 
-  if (receiveResponseData(7, false) == false) 
-		return false;
-  idleMode();
-  if (checkCount() == false) 
+  // param1 - 0x00 (revision mode).
+  if (executeCommand(COMMAND_OPCODE_INFO, 0x00, 0x0000, NULL, 0, 7, ATECC_CMD_INFO) == false) 
 		return false;
-  if (checkCrc() == false) 
-		return false;
-  if (inputBuffer[3] == 0x50 || inputBuffer[3] == 0x60) 
+  if (inputBuffer[3] == 0x50 || inputBuffer[3] == 0x60)
 	{
+		// Info response: 0x00 0x00 0x50 0x00 (ATECC508A), 0x00 0x00 0x60 0x02 (ATECC608A), 0x00 0x00 0x60 0x03 (ATECC608B)
+		if (inputBuffer[3] == 0x50)
+			deviceModel = ATECC_MODEL_508A;
+		else if (inputBuffer[4] >= 0x03)
+			deviceModel = ATECC_MODEL_608B;
+		else
+			deviceModel = ATECC_MODEL_608A;
   	setStatus(STATUS_SUCCESS);
 		return true;   // If we hear a "0x50" or a 0x60, that means it had a successful version response.
 	}
@@ -162,59 +203,38 @@ boolean ATECCX08A::lockConfiguration()
 	It stores them for vewieing in a large array called configZone[128].
 	In addition to configuration settings, the configuration memory on the IC also
 	contains the serial number, revision number, lock statuses, and much more.
-	This function also updates global variables for these other things.
+	This function also decodes these other things into config (see getConfig()).
+	The four blocks are read in one wake session. The result is cached, it is 
+	invalidated by lock() and updated by writes to the configuration zone.
 */
 
 boolean ATECCX08A::readConfigZone(boolean debug)
 {
-  // read block 0, the first 32 bytes of config zone into inputBuffer
-  read(ZONE_CONFIG, ADDRESS_CONFIG_READ_BLOCK_0, 32); 
-  
-  // copy current contents of inputBuffer into configZone[] (for later viewing/comparing)
-  memcpy(&configZone[0], &inputBuffer[1], 32);
-  
-  read(ZONE_CONFIG, ADDRESS_CONFIG_READ_BLOCK_1, 32); 	// read block 1
-  memcpy(&configZone[32], &inputBuffer[1], 32); 	// copy block 1
-  
-  read(ZONE_CONFIG, ADDRESS_CONFIG_READ_BLOCK_2, 32); 	// read block 2
-  memcpy(&configZone[64], &inputBuffer[1], 32); 	// copy block 2
-  
-  read(ZONE_CONFIG, ADDRESS_CONFIG_READ_BLOCK_3, 32); 	// read block 3
-  memcpy(&configZone[96], &inputBuffer[1], 32); 	// copy block 3  
-  
-  // pull out serial number from configZone, and copy to public variable within this instance
-  memcpy(&serialNumber[0], &configZone[0], 4); 	// copy SN<0:3> 
-  memcpy(&serialNumber[4], &configZone[8], 5); 	// copy SN<4:8> 
-  
-  // pull out revision number from configZone, and copy to public variable within this instance
-  memcpy(&revisionNumber[0], &configZone[4], 4); 	// copy RevNum<0:3>   
-  
-  // set lock statuses for config, data/otp, and slot 0
-  if (configZone[87] == 0x00) configLockStatus = true;
-  else configLockStatus = false;
-  
-  if (configZone[86] == 0x00) dataOTPLockStatus = true;
-  else dataOTPLockStatus = false;
+  static const uint16_t blockAddress[4] = { ADDRESS_CONFIG_READ_BLOCK_0, ADDRESS_CONFIG_READ_BLOCK_1, 
+                                            ADDRESS_CONFIG_READ_BLOCK_2, ADDRESS_CONFIG_READ_BLOCK_3 };
+  boolean result = true;
 
-/*  
-  if ( (configZone[88] & (1<<0) ) == true) slot0LockStatus = false; // LSB is slot 0. if bit set = UN-locked.
-  else slot0LockStatus = true;
-*/	
+  setConfigZoneRead(false);
+
+  // read the four 32 byte blocks directly into configZone[], all in one wake session
+  if (beginSession() == false)
+    return false;
+  for (int block = 0; block < 4 && result == true; block++)
+  {
+    result = read(ZONE_CONFIG, blockAddress[block], &configZone[block * CONFIG_ZONE_READ_SIZE], CONFIG_ZONE_READ_SIZE, debug);
+  }
+  endSession();
+  if (result == false)
+    return false;
+
+  // decode serial number, revision, lock statuses, slot and key configurations into config
+  decodeConfigZone();
+  setConfigZoneRead(true);
   
-  if (debug == true)
+  if (ATECC_DEBUG_OUTPUT(debug))
   {
     _debugSerial->println("configZone: ");
-    for (int i = 0; i < sizeof(configZone) ; i++)
-    {
-      _debugSerial->print(i);
-	  _debugSerial->print(": 0x");
-	  if ((configZone[i] >> 4) == 0) _debugSerial->print("0"); // print preceeding high nibble if it's zero
-	  _debugSerial->print(configZone[i], HEX); 
-	  _debugSerial->print(" \t0b");
-	  for(int bit = 7; bit >= 0; bit--) _debugSerial->print(bitRead(configZone[i],bit)); // print binary WITH preceding '0' bits
-	  _debugSerial->println();
-    }
-    _debugSerial->println();
+    printHexValue(configZone, sizeof(configZone), " ");  // 16 bytes per line
   }
   
   
@@ -223,230 +243,651 @@ boolean ATECCX08A::readConfigZone(boolean debug)
 
 /** \brief
 
-	lockDataAndOTP()
-	
-	This function sends the LOCK Command with the Data and OTP (one-time-programming) zone parameter, 
-	and listens for success response (0x00).
+	decodeConfigZone()
+
+	Decodes the raw configZone[] into config, so the per slot queries (getKeyConfig, 
+	getSlotConfig, isSlotLocked, ...) don't need to parse the raw bytes or touch the bus.
 */
 
-boolean ATECCX08A::lockDataAndOTP()
+void ATECCX08A::decodeConfigZone()
 {
-  return lock(LOCK_MODE_ZONE_DATA_AND_OTP);
+  uint16_t slotsLocked;
+
+  // pull out serial number and revision number from configZone
+  memcpy(&config.serialNumber[0], &configZone[CONFIG_ZONE_SERIAL_PART0], 4); 	// copy SN<0:3> 
+  memcpy(&config.serialNumber[4], &configZone[CONFIG_ZONE_SERIAL_PART1], 5); 	// copy SN<4:8> 
+  memcpy(&config.revisionNumber[0], &configZone[CONFIG_ZONE_REVISION_NUMBER], 4); 	// copy RevNum<0:3>   
+
+  config.aesEnable  = configZone[CONFIG_ZONE_AES_STATUS];
+  config.i2cEnable  = configZone[CONFIG_ZONE_I2C_ENABLE];
+  config.i2cAddress = configZone[CONFIG_ZONE_I2C_ADDRESS];
+  config.otpMode    = configZone[CONFIG_ZONE_OTP_MODE];
+  config.chipMode   = configZone[CONFIG_ZONE_CHIP_MODE];
+
+  for (int slot = 0; slot < 16; slot++)
+  {
+    config.slotConfig[slot] = configZone[CONFIG_ZONE_SLOT_CONFIG + slot * 2] | (configZone[CONFIG_ZONE_SLOT_CONFIG + slot * 2 + 1] << 8);
+    config.keyConfig[slot]  = configZone[CONFIG_ZONE_KEY_CONFIG + slot * 2] | (configZone[CONFIG_ZONE_KEY_CONFIG + slot * 2 + 1] << 8);
+  }
+
+  // lock statuses (0x55 = UNlocked, 0x00 = Locked), a cleared bit in SlotLocked means the slot is locked
+  config.configLocked  = (configZone[CONFIG_ZONE_LOCK_STATUS] == 0x00);
+  config.dataOTPLocked = (configZone[CONFIG_ZONE_OTP_LOCK] == 0x00);
+  slotsLocked = configZone[CONFIG_ZONE_SLOTS_LOCK0] | (configZone[CONFIG_ZONE_SLOTS_LOCK1] << 8);
+  config.slotsLocked = ~slotsLocked;
 }
 
 /** \brief
 
-	lockDataSlot0()
-	
-	This function sends the LOCK Command with the Slot 0 zone parameter, 
-	and listens for success response (0x00).
-*/
+	beginSession() / endSession()
 
+	Keeps the IC awake for a sequence of commands, so that only the first command
+	needs the wake pulse and only the last one is followed by the idle command.
+	The wake pulse is sent with the first command of the session, so a session
+	which is served completely from the read cache never touches the bus.
+	Sessions may be nested, the IC goes idle when the outermost session ends.
+	Keep sessions short: the watchdog puts the IC to sleep 1.3 seconds after the wake.
+*/
 
-boolean ATECCX08A::lockDataSlot(uint16_t slot)
+boolean ATECCX08A::beginSession()
 {
-	uint8_t lockMode;
-	
-	
-	slot = slot << 2; // the slot to be locked is encoded in bits 2 to 5 
-	                  // (see data sheet p. 75), so we need to shift the slot 2 bits left
-	lockMode = LOCK_MODE_SLOT | slot; // set bits in lockmode parameter
-  return lock(lockMode);
+  if (sessionDepth == 0)
+    sessionAwake = false;
+  sessionDepth++;
+  return true;
 }
 
+void ATECCX08A::endSession()
+{
+  if (sessionDepth == 0)
+    return;
+  sessionDepth--;
+  if (sessionDepth == 0 && sessionAwake == true)
+  {
+    sessionAwake = false;
+    idleMode();
+  }
+}
 
 /** \brief
 
-	lock(byte zone)
-	
-	This function sends the LOCK Command using the argument zone as parameter 1, 
-	and listens for success response (0x00).
+	ensureConfigZone()
+
+	Reads the configuration zone if the cached copy is not valid (lazy refresh).
 */
 
-boolean ATECCX08A::lock(uint8_t zone)
+boolean ATECCX08A::ensureConfigZone()
 {
-  sendCommand(COMMAND_OPCODE_LOCK, zone, 0x0000);
+  if (isConfigZoneRead() == true)
+    return true;
+  return readConfigZone(false);
+}
 
-  delay(32); // time for IC to process command and exectute
-  
-  // Now let's read back from the IC and see if it reports back good things.
-  countGlobal = 0; 
-  if (receiveResponseData(4, false) == false) 
-		return false;
-  idleMode();
-  if (checkCount() == false) 
-		return false;
-  if (checkCrc() == false) 
-		return false;
-	setStatus(inputBuffer[1]);
-  if (inputBuffer[1] == 0x00) 
-		return true;   // If we hear a "0x00", that means it had a successful lock
-  else 
-		return false;
+/** \brief
+
+	getConfig()
+
+	Returns the decoded configuration zone, reading it first if necessary.
+	Returns NULL if the configuration zone could not be read.
+*/
+
+const ATECCConfig *ATECCX08A::getConfig()
+{
+  if (ensureConfigZone() == false)
+    return NULL;
+  return &config;
 }
 
 /** \brief
 
-	generateRandomBytes(boolean debug)
-	
-    This function pulls a complete random number (all 32 bytes)
-    In order to keep compatibility with ATmega328 based arduinos,
-    We have offered some other functions that return variables more usable (i.e. byte, int, long)
-    They are getRandomByte(), getRandomInt(), and getRandomLong().
+	createSnapshot(ATECCSnapshot &snapshot, const uint8_t *keySlots, int keyCount)
+
+	Runs the full discovery (configuration zone and the public keys of the keyCount slots in
+	keySlots) and stores the result in snapshot, which can be kept in flash or a file and
+	passed to restoreSnapshot() or warmStart() after the next reset.
 */
 
-boolean ATECCX08A::generateRandomBytes(uint8_t *randomValue, int length, boolean debug)
+boolean ATECCX08A::createSnapshot(ATECCSnapshot &snapshot, const uint8_t *keySlots, int keyCount)
 {
-	if (length < 0 || length > 32)
-		return false;
-	
-  sendCommand(COMMAND_OPCODE_RANDOM, 0x00, 0x0000); 
-  // param1 = 0. - Automatically update EEPROM seed only if necessary prior to random number generation. Recommended for highest security.
-  // param2 = 0x0000. - must be 0x0000.
+  uint16_t snapshotCrc;
+  boolean  result;
+
+  if (keyCount < 0 || keyCount > ATECC_SNAPSHOT_MAX_KEYS || (keyCount > 0 && keySlots == NULL))
+  {
+    setStatus(STATUS_INVALID_PARAMETER);
+    return false;
+  }
+
+  memset(&snapshot, 0, sizeof(snapshot));
+  result = readConfigZone();
+  for (int i = 0; i < keyCount && result == true; i++)
+  {
+    snapshot.keySlot[i] = keySlots[i];
+    result = generatePublicKey(snapshot.publicKey[i], PUBLIC_KEY_SIZE, keySlots[i]);
+  }
+  if (result == false)
+    return false;
 
-  delay(23); // time for IC to process command and exectute
+  snapshot.magic[0] = 'S';
+  snapshot.magic[1] = 'N';
+  snapshot.version = ATECC_SNAPSHOT_VERSION;
+  snapshot.keyCount = keyCount;
+  memcpy(snapshot.configZone, configZone, CONFIG_ZONE_SIZE);
+  snapshotCrc = calculateSummaryCrc((const uint8_t *) &snapshot, sizeof(snapshot) - sizeof(snapshot.crc));
+  snapshot.crc[0] = snapshotCrc & 0xFF;
+  snapshot.crc[1] = snapshotCrc >> 8;
+  snapshotKeysCurrent = 0;
+  for (int i = 0; i < keyCount; i++)
+    snapshotKeysCurrent |= 1 << (keySlots[i] & 0x0F);
+  return true;
+}
 
-  // Now let's read back from the IC. This will be 35 bytes of data (count + 32_data_bytes + crc[0] + crc[1])
+/** \brief
 
-  if (receiveResponseData(35, debug) == false) 
-	{
-		setStatus(STATUS_EXECUTION_ERROR);
-		return false;
-	}
-  idleMode();
-  if (checkCount(debug) == false) 
-	{
-		setStatus(STATUS_EXECUTION_ERROR);
-		return false;
-	}
-	
-  if (checkCrc(debug) == false) 
-	{	
-		setStatus(STATUS_CRC_ERROR);
-		return false;
+	restoreSnapshot(const ATECCSnapshot &snapshot, const uint8_t *keySlots, int keyCount)
+
+	Takes the configuration zone from snapshot instead of reading all of it. The snapshot is 
+	only used if it is intact, was taken with a locked configuration zone and block 0 of the
+	configuration zone of the IC (serial number, revision, I2C settings) is identical, so
+	blocks 1 and 3 can't have changed apart from counter 0 (bytes 52-63, not used by the library).
+	Block 2 (counter 1, LastKeyUse and the lock states) is read from the IC.
+	That are two reads instead of four reads and a GenKey per public key. The IC can't report a
+	CRC of its configuration zone, so block 0 is the cheapest check which includes the serial number.
+	If keySlots is given, the snapshot must contain the public keys of exactly these slots.
+	The public key of a slot which isn't locked may have been regenerated (GenKey) since the
+	snapshot was taken, see isSnapshotKeyCurrent().
+*/
+
+boolean ATECCX08A::restoreSnapshot(const ATECCSnapshot &snapshot, const uint8_t *keySlots, int keyCount)
+{
+  uint8_t block0[CONFIG_ZONE_READ_SIZE];
+  uint8_t block2[CONFIG_ZONE_READ_SIZE];
+  uint16_t snapshotCrc;
+  boolean result;
+
+  snapshotCrc = calculateSummaryCrc((const uint8_t *) &snapshot, sizeof(snapshot) - sizeof(snapshot.crc));
+  if (snapshot.magic[0] != 'S' || snapshot.magic[1] != 'N' || snapshot.version != ATECC_SNAPSHOT_VERSION ||
+      snapshot.keyCount > ATECC_SNAPSHOT_MAX_KEYS || snapshot.crc[0] != (snapshotCrc & 0xFF) || snapshot.crc[1] != (snapshotCrc >> 8) ||
+      snapshot.configZone[CONFIG_ZONE_LOCK_STATUS] != 0x00)
+  {
+    setStatus(STATUS_VERIFICATION_ERROR);
+    return false;
   }
-  
-  // update random32Bytes[] array
-  // we don't need the count value (which is currently the first byte of the inputBuffer)
-  for (int i = 0 ; i < length ; i++) // for loop through to grab all but the first position (which is "count" of the message)
+  if (keySlots != NULL && (keyCount != snapshot.keyCount || memcmp(keySlots, snapshot.keySlot, keyCount) != 0))
   {
-    randomValue[i] = inputBuffer[i + 1];
+    setStatus(STATUS_VERIFICATION_ERROR);
+    return false;
   }
 
-  if (debug == true)
+  if (beginSession() == false)
+    return false;
+  result = read(ZONE_CONFIG, ADDRESS_CONFIG_READ_BLOCK_0, block0, CONFIG_ZONE_READ_SIZE) &&
+           read(ZONE_CONFIG, ADDRESS_CONFIG_READ_BLOCK_2, block2, CONFIG_ZONE_READ_SIZE);
+  endSession();
+  if (result == false)
+    return false;
+
+  if (memcmp(block0, snapshot.configZone, CONFIG_ZONE_READ_SIZE) != 0)
   {
-    _debugSerial->print("randomValue: ");
-    for (int i = 0; i < length; i++)
-    {
-      _debugSerial->print(randomValue[i], HEX);
-      _debugSerial->print(",");
-    }
-    _debugSerial->println();
+    setStatus(STATUS_VERIFICATION_ERROR);
+    return false;
+  }
+
+  memcpy(configZone, snapshot.configZone, CONFIG_ZONE_SIZE);
+  memcpy(&configZone[2 * CONFIG_ZONE_READ_SIZE], block2, CONFIG_ZONE_READ_SIZE);
+  decodeConfigZone();
+  setConfigZoneRead(true);
+  snapshotKeysCurrent = 0;
+  for (int i = 0; i < snapshot.keyCount; i++)
+  {
+    if (config.slotsLocked & (1 << (snapshot.keySlot[i] & 0x0F)))
+      snapshotKeysCurrent |= 1 << (snapshot.keySlot[i] & 0x0F);
   }
-  
   setStatus(STATUS_SUCCESS);
   return true;
 }
 
 /** \brief
 
-	getRandomByte(boolean debug)
-	
-    This function returns a random byte.
-	It calls generateRandomBytes(), then uses the first byte in that array for a return value.
+	warmStart(ATECCSnapshot &snapshot, const uint8_t *keySlots, int keyCount, boolean &updated)
+
+	Uses snapshot if it matches the IC (see restoreSnapshot()), otherwise runs the full discovery
+	and replaces snapshot (updated is set to true, the caller should store the new snapshot).
 */
 
-byte ATECCX08A::getRandomByte(boolean debug)
+boolean ATECCX08A::warmStart(ATECCSnapshot &snapshot, const uint8_t *keySlots, int keyCount, boolean &updated)
 {
-	uint8_t randomValue[32];
-	
-  generateRandomBytes(randomValue, sizeof(randomValue), debug);
-  return randomValue[0];
+  updated = false;
+  if (restoreSnapshot(snapshot, keySlots, keyCount) == true)
+    return true;
+  if (createSnapshot(snapshot, keySlots, keyCount) == false)
+    return false;
+  updated = true;
+  return true;
 }
 
 /** \brief
 
-	getRandomInt(boolean debug)
-	
-    This function returns a random Int.
-	It calls generateRandomBytes(), then uses the first 2 bytes in that array for a return value.
-	It bitwize ORS the first two bytes of the array into the return value.
+	getSnapshotPublicKey(const ATECCSnapshot &snapshot, int slot, uint8_t *publicKey, int size)
+
+	Copies the public key of slot from snapshot. Returns false if the snapshot doesn't contain it.
 */
 
-int ATECCX08A::getRandomInt(boolean debug)
+boolean ATECCX08A::getSnapshotPublicKey(const ATECCSnapshot &snapshot, int slot, uint8_t *publicKey, int size)
 {
-	uint8_t randomValue[32];
-	
-  generateRandomBytes(randomValue, sizeof(randomValue), debug);
-  int return_val;
-  return_val = randomValue[0]; // store first randome byte into return_val
-  return_val <<= 8; // shift it over, to make room for the next byte
-  return_val |= randomValue[1]; // "or in" the next byte in the array
-  return return_val;
+  if (publicKey == NULL || size < PUBLIC_KEY_SIZE)
+    return false;
+  for (int i = 0; i < snapshot.keyCount && i < ATECC_SNAPSHOT_MAX_KEYS; i++)
+  {
+    if (snapshot.keySlot[i] == slot)
+    {
+      memcpy(publicKey, snapshot.publicKey[i], PUBLIC_KEY_SIZE);
+      return true;
+    }
+  }
+  return false;
 }
 
 /** \brief
 
-	getRandomLong(boolean debug)
-	
-    This function returns a random Long.
-	It calls generateRandomBytes(), then uses the first 4 bytes in that array for a return value.
-	It bitwize ORS the first 4 bytes of the array into the return value.
+	isSnapshotKeyCurrent(int slot)
+
+	Returns true if the public key of slot in the snapshot of the last createSnapshot(),
+	restoreSnapshot() or warmStart() is known to match the private key in the IC: the snapshot
+	was just created, or the slot is locked so GenKey can't have replaced the key. Returns false
+	for slots which aren't locked and after createNewKeyPair() on the slot. Their public key
+	should be computed again with generatePublicKey().
 */
 
-long ATECCX08A::getRandomLong(boolean debug)
+boolean ATECCX08A::isSnapshotKeyCurrent(int slot)
 {
-	uint8_t randomValue[32];
-
-  generateRandomBytes(randomValue, sizeof(randomValue), debug);
-  long return_val;
-  return_val = randomValue[0]; // store first randome byte into return_val
-  return_val <<= 8; // shift it over, to make room for the next byte
-  return_val |= randomValue[1]; // "or in" the next byte in the array
-  return_val <<= 8; // shift it over, to make room for the next byte
-  return_val |= randomValue[2]; // "or in" the next byte in the array
-  return_val <<= 8; // shift it over, to make room for the next byte
-  return_val |= randomValue[3]; // "or in" the next byte in the array
-  return return_val;
+  if (slot < 0 || slot > 15)
+    return false;
+  return (snapshotKeysCurrent & (1 << slot)) != 0;
 }
 
 /** \brief
 
-	random(long max)
-	
-    This function returns a positive random Long between 0 and max
-	max can be up to the larges positive value of a long: 2147483647
+	provisionConfigZone(const uint8_t *image, boolean debug)
+
+	Brings the configuration zone to the contents of image (128 bytes, laid out like configZone).
+	The configuration zone is read, and only the words which differ from image in the 
+	writable bytes (see isConfigByteWritable()) are written: blocks 1 and 3 are completely
+	writable, so two or more changed words there are merged into one 32 byte write. Blocks 0
+	and 2 contain read only bytes and are written word by word. All commands run in one wake
+	session, the result is verified by reading the configuration zone again.
+	The read only bytes of image are ignored. The configuration zone must not be locked.
+	getWritesIssued() counts the write commands sent, getWritesSkipped() the writable words
+	which weren't written.
 */
 
-long ATECCX08A::random(long max)
+boolean ATECCX08A::provisionConfigZone(const uint8_t *image, boolean debug)
 {
-  return random(0, max);
+  boolean result;
+
+  if (image == NULL)
+  {
+    setStatus(STATUS_INVALID_PARAMETER);
+    return false;
+  }
+  if (beginSession() == false)
+    return false;
+
+  result = readConfigZone(debug);
+  if (result == true && config.configLocked == true)
+  {
+    setStatus(STATUS_EXECUTION_ERROR);
+    result = false;
+  }
+
+  for (int block = 0; block < 4 && result == true; block++)
+  {
+    int     start = block * CONFIG_ZONE_READ_SIZE;
+    int     words = 0;
+    int     changed = 0;
+    int     changedWord = 0;
+    boolean fullBlock = start >= CONFIG_ZONE_WRITABLE_START && 
+                        (start + CONFIG_ZONE_READ_SIZE <= CONFIG_ZONE_USER_EXTRA || start >= CONFIG_ZONE_USER_EXTRA + 4);
+
+    for (int word = start; word < start + CONFIG_ZONE_READ_SIZE && result == true; word += 4)
+    {
+      if (isConfigByteWritable(word) == false)
+        continue;
+      words++;
+      if (memcmp(&configZone[word], &image[word], 4) == 0)
+        continue;
+      changed++;
+      changedWord = word;
+      if (fullBlock == false)
+      {
+        // a block with read only bytes is written word by word
+        result = write(ZONE_CONFIG, word / 4, &image[word], 4, debug);
+        writesIssued++;
+      }
+    }
+    if (result == false)
+      break;
+
+    if (fullBlock == false || changed == 0)
+    {
+      writesSkipped += words - changed;
+    }
+    else if (changed == 1)
+    {
+      result = write(ZONE_CONFIG, changedWord / 4, &image[changedWord], 4, debug);
+      writesIssued++;
+      writesSkipped += words - 1;
+    }
+    else
+    {
+      result = write(ZONE_CONFIG, start / 4, &image[start], CONFIG_ZONE_READ_SIZE, debug);
+      writesIssued++;
+    }
+  }
+
+  // verify with one more read of the configuration zone
+  if (result == true)
+    result = readConfigZone(debug);
+  endSession();
+  if (result == false)
+    return false;
+
+  for (int i = CONFIG_ZONE_WRITABLE_START; i < CONFIG_ZONE_SIZE; i++)
+  {
+    if (isConfigByteWritable(i) == true && configZone[i] != image[i])
+    {
+      setStatus(STATUS_VERIFICATION_ERROR);
+      return false;
+    }
+  }
+  setStatus(STATUS_SUCCESS);
+  return true;
 }
 
 /** \brief
 
-	random(long min, long max)
-	
-    This function returns a random Long with set boundaries of min and max.
-	If you flip min and max, it still works!
-	Also, it can handle negative numbers. Wahoo!
+	isConfigByteWritable(int offset)
+
+	Returns true if the byte at offset of the configuration zone can be written with the 
+	Write command (bytes 16-83 and 88-127, before the configuration zone is locked).
 */
 
-long ATECCX08A::random(long min, long max)
+boolean ATECCX08A::isConfigByteWritable(int offset)
 {
-  long randomLong = getRandomLong();
-  long halfFSR = (max - min) / 2; // half of desired full scale range
-  long midPoint = (max + min) / 2; // where we "start" out output value, then add in a fraction of halfFSR
-  float fraction = float(randomLong) / 2147483647;
-  return (midPoint + (halfFSR * fraction) );
+  if (offset < CONFIG_ZONE_WRITABLE_START || offset >= CONFIG_ZONE_SIZE)
+    return false;
+  return offset < CONFIG_ZONE_USER_EXTRA || offset >= CONFIG_ZONE_USER_EXTRA + 4;
 }
 
 /** \brief
 
-	receiveResponseData(uint8_t length, boolean debug)
+	lockDataAndOTP()
 	
-	This function receives messages from the ATECCX08a IC (up to 128 Bytes)
-	It will return true if it receives the correct amount of data and good CRCs.
+	This function sends the LOCK Command with the Data and OTP (one-time-programming) zone parameter, 
+	and listens for success response (0x00).
+*/
+
+boolean ATECCX08A::lockDataAndOTP()
+{
+  return lock(LOCK_MODE_ZONE_DATA_AND_OTP);
+}
+
+/** \brief
+
+	lockDataSlot0()
+	
+	This function sends the LOCK Command with the Slot 0 zone parameter, 
+	and listens for success response (0x00).
+*/
+
+
+boolean ATECCX08A::lockDataSlot(uint16_t slot)
+{
+	uint8_t lockMode;
+	
+	
+	slot = slot << 2; // the slot to be locked is encoded in bits 2 to 5 
+	                  // (see data sheet p. 75), so we need to shift the slot 2 bits left
+	lockMode = LOCK_MODE_SLOT | slot; // set bits in lockmode parameter
+  return lock(lockMode);
+}
+
+
+/** \brief
+
+	lock(byte zone)
+	
+	This function sends the LOCK Command using the argument zone as parameter 1, 
+	and listens for success response (0x00).
+*/
+
+boolean ATECCX08A::lock(uint8_t zone)
+{
+  return executeLock(zone, 0x0000);
+}
+
+/** \brief
+
+	lock(uint8_t zone, uint16_t summaryCrc)
+	
+	Sends the LOCK Command with bit 7 of zone cleared, so the IC compares summaryCrc with the 
+	CRC of the zone contents and only locks if they match (otherwise the status is 
+	STATUS_EXECUTION_ERROR, like for a zone which is already locked). This replaces a verifying
+	read of the zone before locking.
+	The summary is the CRC of the configuration zone (128 bytes), of the data zone (all slots,
+	slot 0 to 15 with their full sizes, see getSlotSize()) followed by the OTP zone, or of one slot.
+	calculateSummaryCrc() calculates it piece by piece.
+*/
+
+boolean ATECCX08A::lock(uint8_t zone, uint16_t summaryCrc)
+{
+  return executeLock(zone & ~LOCK_MODE_IGNORE_SUMMARY, summaryCrc);
+}
+
+/** \brief
+
+	lockConfiguration(const uint8_t *image)
+	
+	Locks the configuration zone if it matches image (see provisionConfigZone() and getConfigZoneCrc()).
+*/
+
+boolean ATECCX08A::lockConfiguration(const uint8_t *image)
+{
+  uint16_t crc;
+
+  if (getConfigZoneCrc(image, crc) == false)
+    return false;
+  return lock(LOCK_MODE_ZONE_CONFIG, crc);
+}
+
+boolean ATECCX08A::lockDataAndOTP(uint16_t summaryCrc)
+{
+  return lock(LOCK_MODE_ZONE_DATA_AND_OTP, summaryCrc);
+}
+
+boolean ATECCX08A::lockDataSlot(uint16_t slot, uint16_t summaryCrc)
+{
+  return lock(LOCK_MODE_SLOT | (slot << 2), summaryCrc);
+}
+
+/** \brief
+
+	getConfigZoneCrc(const uint8_t *image, uint16_t &crc)
+	
+	Calculates the CRC the configuration zone will have after provisionConfigZone(image):
+	the writable bytes are taken from image, the read only bytes (serial number, revision,
+	UserExtra, Selector, lock bytes) from the cached configuration zone.
+*/
+
+boolean ATECCX08A::getConfigZoneCrc(const uint8_t *image, uint16_t &crc)
+{
+  if (image == NULL)
+  {
+    setStatus(STATUS_INVALID_PARAMETER);
+    return false;
+  }
+  if (ensureConfigZone() == false)
+    return false;
+
+  crc = 0;
+  for (int i = 0; i < CONFIG_ZONE_SIZE; i++)
+    crc = calculateSummaryCrc(isConfigByteWritable(i) ? &image[i] : &configZone[i], 1, crc);
+  return true;
+}
+
+/** \brief
+
+	executeLock(uint8_t mode, uint16_t summaryCrc)
+	
+	Sends the LOCK Command with mode as parameter 1 and summaryCrc as parameter 2, 
+	and listens for success response (0x00).
+*/
+
+boolean ATECCX08A::executeLock(uint8_t mode, uint16_t summaryCrc)
+{
+  setConfigZoneRead(false); // lock statuses change, read the configuration zone again on next use
+  invalidateReadCache();
+  // If we hear a "0x00", that means it had a successful lock
+  return executeCommand(COMMAND_OPCODE_LOCK, mode, summaryCrc, NULL, 0, 4, ATECC_CMD_LOCK);
+}
+
+/** \brief
+
+	generateRandomBytes(boolean debug)
+	
+    This function pulls a complete random number (all 32 bytes)
+    In order to keep compatibility with ATmega328 based arduinos,
+    We have offered some other functions that return variables more usable (i.e. byte, int, long)
+    They are getRandomByte(), getRandomInt(), and getRandomLong().
+*/
+
+boolean ATECCX08A::generateRandomBytes(uint8_t *randomValue, int length, boolean debug)
+{
+	if (length < 0 || length > 32)
+		return false;
+	
+  // param1 = 0. - Automatically update EEPROM seed only if necessary prior to random number generation. Recommended for highest security.
+  // param2 = 0x0000. - must be 0x0000.
+  // The response has 35 bytes of data (count + 32_data_bytes + crc[0] + crc[1])
+  if (executeCommand(COMMAND_OPCODE_RANDOM, 0x00, 0x0000, NULL, 0, 35, ATECC_CMD_RANDOM, debug) == false) 
+		return false;
+  
+  // update random32Bytes[] array
+  // we don't need the count value (which is currently the first byte of the inputBuffer)
+  for (int i = 0 ; i < length ; i++) // for loop through to grab all but the first position (which is "count" of the message)
+  {
+    randomValue[i] = inputBuffer[i + 1];
+  }
+
+  if (ATECC_DEBUG_OUTPUT(debug))
+  {
+    _debugSerial->println("randomValue: ");
+    printHexValue(randomValue, length, ",");
+  }
+  
+  setStatus(STATUS_SUCCESS);
+  return true;
+}
+
+/** \brief
+
+	getRandomByte(boolean debug)
+	
+    This function returns a random byte.
+	It calls generateRandomBytes(), then uses the first byte in that array for a return value.
+*/
+
+byte ATECCX08A::getRandomByte(boolean debug)
+{
+	uint8_t randomValue[32];
+	
+  generateRandomBytes(randomValue, sizeof(randomValue), debug);
+  return randomValue[0];
+}
+
+/** \brief
+
+	getRandomInt(boolean debug)
+	
+    This function returns a random Int.
+	It calls generateRandomBytes(), then uses the first 2 bytes in that array for a return value.
+	It bitwize ORS the first two bytes of the array into the return value.
+*/
+
+int ATECCX08A::getRandomInt(boolean debug)
+{
+	uint8_t randomValue[32];
+	
+  generateRandomBytes(randomValue, sizeof(randomValue), debug);
+  int return_val;
+  return_val = randomValue[0]; // store first randome byte into return_val
+  return_val <<= 8; // shift it over, to make room for the next byte
+  return_val |= randomValue[1]; // "or in" the next byte in the array
+  return return_val;
+}
+
+/** \brief
+
+	getRandomLong(boolean debug)
+	
+    This function returns a random Long.
+	It calls generateRandomBytes(), then uses the first 4 bytes in that array for a return value.
+	It bitwize ORS the first 4 bytes of the array into the return value.
+*/
+
+long ATECCX08A::getRandomLong(boolean debug)
+{
+	uint8_t randomValue[32];
+
+  generateRandomBytes(randomValue, sizeof(randomValue), debug);
+  long return_val;
+  return_val = randomValue[0]; // store first randome byte into return_val
+  return_val <<= 8; // shift it over, to make room for the next byte
+  return_val |= randomValue[1]; // "or in" the next byte in the array
+  return_val <<= 8; // shift it over, to make room for the next byte
+  return_val |= randomValue[2]; // "or in" the next byte in the array
+  return_val <<= 8; // shift it over, to make room for the next byte
+  return_val |= randomValue[3]; // "or in" the next byte in the array
+  return return_val;
+}
+
+/** \brief
+
+	random(long max)
+	
+    This function returns a positive random Long between 0 and max
+	max can be up to the larges positive value of a long: 2147483647
+*/
+
+long ATECCX08A::random(long max)
+{
+  return random(0, max);
+}
+
+/** \brief
+
+	random(long min, long max)
+	
+    This function returns a random Long with set boundaries of min and max.
+	If you flip min and max, it still works!
+	Also, it can handle negative numbers. Wahoo!
+*/
+
+long ATECCX08A::random(long min, long max)
+{
+  long randomLong = getRandomLong();
+  long halfFSR = (max - min) / 2; // half of desired full scale range
+  long midPoint = (max + min) / 2; // where we "start" out output value, then add in a fraction of halfFSR
+  float fraction = float(randomLong) / 2147483647;
+  return (midPoint + (halfFSR * fraction) );
+}
+
+/** \brief
+
+	receiveResponseData(uint8_t length, boolean debug)
+	
+	This function receives messages from the ATECCX08a IC (up to 128 Bytes)
+	It will return true if it receives the correct amount of data and good CRCs.
 	What we hear back from the IC is always formatted with the following series of bytes:
 	COUNT, DATA, CRC[0], CRC[1]
 	Note, the count number includes itself, the num of data bytes, and the two CRC bytes in the total, 
@@ -459,888 +900,1892 @@ long ATECCX08A::random(long min, long max)
 
 boolean ATECCX08A::receiveResponseData(uint8_t length, boolean debug)
 {	
+  countGlobal = 0; // reset for each new message (most important, like wensleydale at a cheese party)
+  cleanInputBuffer();
+  byte requestAttempts = 0; // keep track of how many times we've attempted to request, to break out if necessary
 
+  boolean complete = appendResponseData(length, requestAttempts);
+
+	if (ATECC_DEBUG_OUTPUT(debug))
+	{
+		_debugSerial->print("countGlobal    : ");
+		_debugSerial->println(countGlobal);
+		_debugSerial->println("inputBuffer: ");
+		printHexValue(inputBuffer, countGlobal, ",");
+	}
+  if (complete == false || countGlobal == 0)
+	{
+		setStatus(STATUS_TIMEOUT_ERROR);
+		return false;
+	}
+	setStatus(STATUS_SUCCESS);
+	return true;
+}
+
+/** \brief
+
+	appendResponseData(uint8_t length, byte &requestAttempts)
+
+	Pulls length bytes from the IC and appends them to inputBuffer at countGlobal.
+	requestAttempts counts the I2C requests, shared by all calls for the same message.
+	Returns false if the IC did not deliver the data within ATRCC508A_MAX_RETRIES requests.
+*/
+
+boolean ATECCX08A::appendResponseData(uint8_t length, byte &requestAttempts)
+{
   // pull in data 32 bytes at at time. (necessary to avoid overflow on atmega328)
   // if length is less than or equal to 32, then just pull it in.
   // if length is greater than 32, then we must first pull in 32, then pull in remainder.
   // lets use length as our tracker and we will subtract from it as we pull in data.
-  const int maxRequests = 20;
-	
-  countGlobal = 0; // reset for each new message (most important, like wensleydale at a cheese party)
-  cleanInputBuffer();
-  byte requestAttempts = 0; // keep track of how many times we've attempted to request, to break out if necessary
-  
   while (length)
   {
     byte requestAmount; // amount of bytes to request, needed to pull in data 32 bytes at a time
-	  if (length > 32) 
-			requestAmount = 32; // as we have more than 32 to pull in, keep pulling in 32 byte chunks
+	  if (length > ATRCC508A_MAX_REQUEST_SIZE) 
+			requestAmount = ATRCC508A_MAX_REQUEST_SIZE; // as we have more than 32 to pull in, keep pulling in 32 byte chunks
 	  else 
 			requestAmount = length; // now we're ready to pull in the last chunk.
-	  _i2cPort->requestFrom(_i2caddr, requestAmount);    // request bytes from slave
+	  int received = transport->read(_i2caddr, &inputBuffer[countGlobal], requestAmount); // slave may send less than requested
 	  requestAttempts++;
-
-		while (_i2cPort->available())   // slave may send less than requested
-		{
-			inputBuffer[countGlobal] = _i2cPort->read();    // receive a byte as character
-			length--; // keep this while loop active until we've pulled in everything
-			countGlobal++; // keep track of the count of the entire message.
-		}  
-		if (requestAttempts == maxRequests) 
-			 break; // this probably means that the device is not responding.
-		 /*
-		 else
-			 delay(1);
-		 */
-	}
-
-	if (debug == true)
-	{
-		_debugSerial->println("countGlobal    : " + String(countGlobal));
-		_debugSerial->print("inputBuffer: ");
-		for (int i = 0; i < countGlobal ; i++)
-		{
-			_debugSerial->print(inputBuffer[i], HEX);
-			_debugSerial->print(",");
-		}
-	_debugSerial->println();	  
-  }
-  if (countGlobal == 0)
-	{
-		setStatus(STATUS_TIMEOUT_ERROR);
+#if ATECC_ENABLE_METRICS
+		if (received < requestAmount)
+			metricsRetries++;
+#endif
+
+		length -= received; // keep this while loop active until we've pulled in everything
+		countGlobal += received; // keep track of the count of the entire message.
+		if (requestAttempts >= ATRCC508A_MAX_RETRIES) 
+			 return false; // this probably means that the device is not responding.
 	}
-	if (requestAttempts < maxRequests)
-	{
-		setStatus(STATUS_SUCCESS);
-    return true;
+	return true;
+}
+
+/** \brief
+
+	receiveVariableResponseData(uint8_t maxLength, boolean debug)
+
+	Receives a response whose length is only known from its count byte (e.g. the SHA context).
+	The count byte is read first, then the rest of the message. maxLength limits the complete message.
+*/
+
+boolean ATECCX08A::receiveVariableResponseData(uint8_t maxLength, boolean debug)
+{
+	byte requestAttempts = 0;
+	uint8_t count;
+
+	countGlobal = 0;
+	cleanInputBuffer();
+	if (appendResponseData(RESPONSE_COUNT_SIZE, requestAttempts) == false)
+	{
+		setStatus(STATUS_TIMEOUT_ERROR);
+		return false;
+	}
+	count = inputBuffer[RESPONSE_COUNT_INDEX];
+	if (count < RESPONSE_COUNT_SIZE + CRC_SIZE || count > maxLength)
+	{
+		setStatus(STATUS_MESSAGE_COUNT_ERROR);
+		return false;
+	}
+	if (appendResponseData(count - RESPONSE_COUNT_SIZE, requestAttempts) == false)
+	{
+		setStatus(STATUS_TIMEOUT_ERROR);
+		return false;
+	}
+	if (ATECC_DEBUG_OUTPUT(debug))
+	{
+		_debugSerial->print("countGlobal    : ");
+		_debugSerial->println(countGlobal);
+		printHexValue(inputBuffer, countGlobal, ",");
+	}
+	setStatus(STATUS_SUCCESS);
+	return true;
+}
+
+/** \brief
+
+	checkCount(boolean debug)
+	
+	This function checks that the count byte received in the most recent message equals countGlobal
+	Call receiveResponseData, and then imeeditately call this to check the count of the complete message.
+	Returns true if inputBuffer[0] == countGlobal.
+*/
+
+boolean ATECCX08A::checkCount(boolean debug)
+{
+  if (ATECC_DEBUG_OUTPUT(debug))
+  {
+    _debugSerial->print("countGlobal: 0x");
+	  _debugSerial->println(countGlobal, HEX);
+	  _debugSerial->print("count heard from IC (inputBuffer[0]): 0x");
+    _debugSerial->println(inputBuffer[0], HEX);
+  }
+  // Check count; the first byte sent from IC is count, and it should be equal to the actual message count
+  if (inputBuffer[0] != countGlobal) 
+  {
+		setStatus(STATUS_MESSAGE_COUNT_ERROR);
+	  if (ATECC_DEBUG_ERROR_OUTPUT) 
+			_debugSerial->println("Message Count Error");
+	  return false;
+  }  
+  return true;
+}
+
+/** \brief
+
+	checkCrc(boolean debug)
+	
+	This function checks that the CRC bytes received in the most recent message equals a calculated CRCs
+	Call receiveResponseData, then call immediately call this to check the CRCs of the complete message.
+*/
+
+boolean ATECCX08A::checkCrc(boolean debug)
+{
+  // Check CRC[0] and CRC[1] are good to go.
+  
+  atca_calculate_crc(countGlobal-2, inputBuffer);   // first calculate it
+  
+  if (ATECC_DEBUG_OUTPUT(debug))
+  {
+    _debugSerial->print("CRC[0] Calc: 0x");
+	  _debugSerial->println(crc[0], HEX);
+	  _debugSerial->print("CRC[1] Calc: 0x");
+    _debugSerial->println(crc[1], HEX);
+  }
+  
+  if ( (inputBuffer[countGlobal-1] != crc[1]) || (inputBuffer[countGlobal-2] != crc[0]) )   // then check the CRCs.
+  {
+		setStatus(STATUS_MESSAGE_CRC_ERROR);
+	  if (ATECC_DEBUG_ERROR_OUTPUT) 
+			_debugSerial->println("Message CRC Error");
+	  return false;
+  }
+  if (ATECC_DEBUG_OUTPUT(debug))
+	{
+		_debugSerial->println("CRC verification ok");
+	}
+  return true;
+}
+
+/** \brief
+
+	atca_calculate_crc(uint8_t length, uint8_t *data)
+	
+    This function calculates CRC.
+    It was copied directly from the App Note provided from Microchip.
+    Note, it seems to be their own unique type of CRC cacluation.
+    View the entire app note here:
+    http://ww1.microchip.com/downloads/en/AppNotes/Atmel-8936-CryptoAuth-Data-Zone-CRC-Calculation-ApplicationNote.pdf
+    \param[in] length number of bytes in buffer
+    \param[in] data pointer to data for which CRC should be calculated
+*/
+
+void ATECCX08A::atca_calculate_crc(uint8_t length, const uint8_t *data)
+{
+  uint16_t crc_register = calculateSummaryCrc(data, length);
+
+  crc[0] = (uint8_t) (crc_register & 0x00FF);
+  crc[1] = (uint8_t) (crc_register >> 8);
+}
+
+/** \brief
+
+	calculateSummaryCrc(const uint8_t *data, int length, uint16_t crc)
+
+	Continues the CRC crc (0 to start) over length bytes of data and returns it.
+	This is the CRC of atca_calculate_crc() as a 16 bit value, which is the format of the 
+	summary for lock(zone, summaryCrc). A zone can be passed in several pieces.
+*/
+
+uint16_t ATECCX08A::calculateSummaryCrc(const uint8_t *data, int length, uint16_t crc)
+{
+  uint16_t polynom = 0x8005;
+  uint8_t shift_register;
+  uint8_t data_bit, crc_bit;
+  for (int counter = 0; counter < length; counter++) 
+	{
+    for (shift_register = 0x01; shift_register > 0x00; shift_register <<= 1) 
+		{
+      data_bit = (data[counter] & shift_register) ? 1 : 0;
+      crc_bit = crc >> 15;
+      crc <<= 1;
+      if (data_bit != crc_bit)
+        crc ^= polynom;
+    }
+  }
+  return crc;
+}
+
+
+/** \brief
+
+	cleanInputBuffer()
+	
+    This function sets the entire inputBuffer to 0xFFs.
+	It is helpful for debugging message/count/CRCs errors.
+*/
+
+void ATECCX08A::cleanInputBuffer()
+{
+  for (int i = 0; i < sizeof(inputBuffer) ; i++)
+  {
+    inputBuffer[i] = 0xFF;
+  }
+}
+
+/** \brief
+
+	createNewKeyPair(uint16_t slot)
+	
+    This function sends the command to create a new key pair (private AND public)
+	in the slot designated by argument slot (default slot 0).
+	Sparkfun Default Configuration Sketch calls this, and then locks the data/otp zones and slot 0.
+*/
+
+boolean ATECCX08A::createNewKeyPair(uint8_t *publicKey, int size, uint16_t slot)
+{  
+  invalidateCachedSlot(slot); // the private key overwrites the slot
+  snapshotKeysCurrent &= ~(1 << (slot & 0x0F));
+  // public key (64), plus crc (2), plus count (1)
+	if (executeCommand(COMMAND_OPCODE_GENKEY, GENKEY_MODE_NEW_PRIVATE, slot, NULL, 0, 64 + 2 + 1, ATECC_CMD_GENKEY) == false) 
+		return false;
+
+	// we don't need the count value (which is currently the first byte of the inputBuffer)
+	if (publicKey != NULL && size >= PUBLIC_KEY_SIZE)
+	{
+    for (int i = 0 ; i < 64 ; i++) // for loop through to grab all but the first position (which is "count" of the message)
+    {
+      publicKey[i] = inputBuffer[i+1];
+	  }
+	}
+  return true;
+}
+
+/** \brief
+
+	generatePublicKey(uint16_t slot, boolean debug)
+
+    This function uses the GENKEY command in "Public Key Computation" mode.
+	
+    Generates an ECC public key based upon the private key stored in the slot defined by the KeyID
+	parameter (aka slot). Defaults to slot 0. 
+	
+	Note, if you haven't created a private key in the slot already, then this will fail.
+	
+	The generated public key is read back from the device, and then copied from inputBuffer to 
+	a global variable named publicKey64Bytes for later use.
+*/
+
+boolean ATECCX08A::generatePublicKey(uint8_t *publicKey, int size, uint16_t slot, boolean debug)
+{
+  if (publicKey == NULL)
+	{
+		setStatus(STATUS_INVALID_PARAMETER);
+		return false;
+	}
+	if (size < PUBLIC_KEY_SIZE)
+	{
+		setStatus(STATUS_INPUT_BUFFER_TOO_SMALL);
+    return false;		
+	}
+  // public key (64), plus crc (2), plus count (1)
+  if (executeCommand(COMMAND_OPCODE_GENKEY, GENKEY_MODE_PUBLIC, slot, NULL, 0, 64 + 2 + 1, ATECC_CMD_GENKEY) == false)
+    return false;
+  
+  // update publicKey64Bytes[] array
+  // we don't need the count value (which is currently the first byte of the inputBuffer)
+  for (int i = 0 ; i < 64 ; i++) // for loop through to grab all but the first position (which is "count" of the message)
+  {
+    publicKey[i] = inputBuffer[i+1];
+  }
+
+	if (ATECC_DEBUG_OUTPUT(debug))
+	{
+		_debugSerial->print("This device's Public Key for slot :");
+		_debugSerial->println(slot);
+		printHexValue(publicKey, PUBLIC_KEY_SIZE, " ");
+	}
+  return true;
+}
+
+/** \brief
+
+	read(uint8_t zone, uint16_t address, uint8_t length, boolean debug)
+
+    Reads data from the IC at a specific zone and address.
+	Your data response will be available at inputBuffer[].
+	
+	For more info on address encoding, see datasheet pg 58.
+*/
+
+boolean ATECCX08A::read(uint8_t zone, uint16_t address, uint8_t *response, uint8_t length, boolean debug)
+{
+  // adjust zone as needed for whether it's 4 or 32 bytes length read
+  // bit 7 of zone needs to be set correctly 
+  // (0 = 4 Bytes are read) 
+  // (1 = 32 Bytes are read)
+  if (length == 32) 
+  {
+	  zone |= 0b10000000; // set bit 7
+  }
+  else if (length == 4)
+  {
+	  zone &= ~0b10000000; // clear bit 7
+  }
+  else
+  {
+	  return false; // invalid length, abort.
+  }
+
+  // serve data and OTP reads from the read cache if possible
+  boolean cacheable = isCacheable(zone, address);
+  if (cacheable == true)
+  {
+    if (readFromCache(zone, address, response, length) == true)
+    {
+      readCacheHits++;
+      setStatus(STATUS_SUCCESS);
+      return true;
+    }
+    readCacheMisses++;
+  }
+
+  // Now let's read back from the IC. 
+  if (executeCommand(COMMAND_OPCODE_READ, zone, address, NULL, 0, length + 3, ATECC_CMD_READ, debug) == false) 
+		return false;
+  memcpy(response, &inputBuffer[1], length);
+  if (cacheable == true && length == 32)
+    addToCache(zone, address, response);
+  return true;
+}
+
+boolean ATECCX08A::read(uint8_t zone, uint16_t address, uint8_t length, boolean debug)
+{
+  // adjust zone as needed for whether it's 4 or 32 bytes length read
+  // bit 7 of zone needs to be set correctly 
+  // (0 = 4 Bytes are read) 
+  // (1 = 32 Bytes are read)
+  if (length == 32) 
+  {
+	  zone |= 0b10000000; // set bit 7
+  }
+  else if (length == 4)
+  {
+	  zone &= ~0b10000000; // clear bit 7
+  }
+  else
+  {
+	  return 0; // invalid length, abort.
+  }
+
+  // Now let's read back from the IC. 
+  if (executeCommand(COMMAND_OPCODE_READ, zone, address, NULL, 0, length + 3, ATECC_CMD_READ, debug) == false) 
+		return false;
+  return true;
+}
+
+
+/** \brief
+
+	write(uint8_t zone, uint16_t address, uint8_t *data, uint8_t length_of_data)
+
+    Writes data to a specific zone and address on the IC.
+	
+	For more info on zone and address encoding, see datasheet pg 58.
+*/
+
+boolean ATECCX08A::write(uint8_t zone, uint16_t address, const uint8_t *data, uint8_t length_of_data, boolean debug)
+{
+  // adjust zone as needed for whether it's 4 or 32 bytes length write
+  // bit 7 of param1 needs to be set correctly 
+  // (0 = 4 Bytes are written) 
+  // (1 = 32 Bytes are written)
+  if (length_of_data == 32) 
+  {
+	  zone |= 0b10000000; // set bit 7
+  }
+  else if (length_of_data == 4)
+  {
+	  zone &= ~0b10000000; // clear bit 7
+  }
+  else
+  {
+	  return 0; // invalid length, abort.
+  }
+ 
+  // Now let's read back from the IC and see if it reports back good things.
+  if (executeCommand(COMMAND_OPCODE_WRITE, zone, address, data, length_of_data, 4, ATECC_CMD_WRITE, debug) == false) 
+		return false;
+
+	// If we hear a "0x00", that means it had a successful write
+	if ((zone & 0x03) != ZONE_CONFIG)
+		invalidateCachedBlock(zone, address);
+	if ((zone & 0x03) == ZONE_CONFIG && isConfigZoneRead() == true)
+	{
+		// keep the cached configuration zone up to date instead of reading it again
+		int offset = (address & 0x001F) * 4;
+		if (offset + length_of_data <= CONFIG_ZONE_SIZE)
+		{
+			memcpy(&configZone[offset], data, length_of_data);
+			decodeConfigZone();
+		}
+		else
+			setConfigZoneRead(false);
+	}
+	return true;
+}
+
+/** \brief
+
+	readSlot(uint8_t *data, int length, int slot, boolean debug)
+
+	Reads the first length bytes of slot, see readSlotData().
+*/
+
+boolean ATECCX08A::readSlot(uint8_t *data, int length, int slot, boolean debug)
+{
+  return readSlotData(slot, 0, data, length, debug);
+}
+
+/** \brief
+
+	readSlotData(int slot, int offset, uint8_t *data, int length, boolean debug)
+
+	Reads length bytes starting at offset of slot into data. offset and length must be 
+	multiples of 4 and the range must fit into the slot (see getSlotSize()).
+	The reads are planned with planSlotTransfer() and executed in one wake session.
+	Blocks which are completely requested are read directly into data.
+*/
+
+boolean ATECCX08A::readSlotData(int slot, int offset, uint8_t *data, int length, boolean debug)
+{
+  ATECCTransfer plan[ATECC_MAX_TRANSFER_STEPS];
+  uint8_t       block[32];
+  int           steps;
+  boolean       result = true;
+
+  if (data == NULL)
+  {
+    setStatus(STATUS_INVALID_PARAMETER);
+    return false;
+  }
+  steps = planSlotTransfer(slot, offset, length, plan, ATECC_MAX_TRANSFER_STEPS);
+  if (steps < 0)
+  {
+    setStatus(STATUS_INVALID_PARAMETER);
+    return false;
+  }
+
+  if (beginSession() == false)
+    return false;
+  for (int i = 0; i < steps && result == true; i++)
+  {
+    if (plan[i].first == 0 && plan[i].count == plan[i].size)
+    {
+      result = read(ZONE_DATA, plan[i].address, &data[plan[i].bufferOffset], plan[i].size, debug);
+    }
+    else
+    {
+      result = read(ZONE_DATA, plan[i].address, block, plan[i].size, debug);
+      if (result == true)
+        memcpy(&data[plan[i].bufferOffset], &block[plan[i].first], plan[i].count);
+    }
+  }
+  endSession();
+  return result;
+}
+
+/** \brief
+
+	planSlotTransfer(int slot, int offset, int length, ATECCTransfer *plan, int maxSteps)
+
+	Plans the minimum number of 32 and 4 byte accesses for the range offset..offset+length of slot.
+	A 32 byte access is used for every block which lies completely within the slot and from which
+	at least two words are needed, single words otherwise (e.g. the last 4 bytes of slots 0-7 or the 
+	last 8 bytes of slots 9-15, which don't form a complete block).
+	Returns the number of steps in plan, or -1 if the range is invalid or plan is too small.
+*/
+
+int ATECCX08A::planSlotTransfer(int slot, int offset, int length, ATECCTransfer *plan, int maxSteps)
+{
+  int slotSize = getSlotSize(slot);
+  int position = offset;
+  int end = offset + length;
+  int steps = 0;
+
+  if (slotSize == 0 || plan == NULL || offset < 0 || length < 0 || (offset % 4) != 0 || (length % 4) != 0 || end > slotSize)
+    return -1;
+
+  while (position < end)
+  {
+    int blockStart = (position / 32) * 32;
+    int blockEnd = blockStart + 32;
+    int count = ((end < blockEnd) ? end : blockEnd) - position;
+
+    if (steps == maxSteps)
+      return -1;
+
+    if (blockEnd <= slotSize && count >= 8)
+    {
+      plan[steps].address = addressForSlotOffset(slot, blockStart);
+      plan[steps].size = 32;
+      plan[steps].first = position - blockStart;
+      plan[steps].count = count;
+    }
+    else
+    {
+      plan[steps].address = addressForSlotOffset(slot, position);
+      plan[steps].size = 4;
+      plan[steps].first = 0;
+      plan[steps].count = 4;
+    }
+    plan[steps].bufferOffset = position - offset;
+    position += plan[steps].count;
+    steps++;
+  }
+  return steps;
+}
+
+/** \brief
+
+	getSlotSize(int slot)
+
+	Returns the size of slot in bytes (0 for an invalid slot).
+*/
+
+int ATECCX08A::getSlotSize(int slot)
+{
+  if (slot < 0 || slot > 15)
+    return 0;
+  return slotSizes[slot];
+}
+
+/** \brief
+
+	enableReadCache(size_t ramBudget)
+
+	Enables an LRU cache of 32 byte blocks of the data and OTP zones. As many blocks as fit
+	into ramBudget bytes are allocated. read(), readSlot() and readSlotData() are served from the 
+	cache when possible. Blocks of slots configured as secret or encrypted read (SlotConfig 
+	bits 7 and 6) are never cached. The commands which change the data zone invalidate the blocks
+	concerned: write() and writeSlot() the written block, kdf() the target slot, createNewKeyPair()
+	the key slot and lock() the whole cache.
+	Returns false if ramBudget is too small for one block or the memory can't be allocated.
+*/
+
+boolean ATECCX08A::enableReadCache(size_t ramBudget)
+{
+	int entries = ramBudget / sizeof(ATECCCacheEntry);
+
+	disableReadCache();
+	if (entries < 1)
+		return false;
+	if (entries > 255)
+		entries = 255;
+	readCache = (ATECCCacheEntry *) calloc(entries, sizeof(ATECCCacheEntry));
+	if (readCache == NULL)
+		return false;
+	readCacheSize = entries;
+	return true;
+}
+
+void ATECCX08A::disableReadCache()
+{
+	if (readCache != NULL)
+		free(readCache);
+	readCache = NULL;
+	readCacheSize = 0;
+}
+
+void ATECCX08A::invalidateReadCache()
+{
+	for (int i = 0; i < readCacheSize; i++)
+		readCache[i].valid = false;
+}
+
+unsigned long ATECCX08A::getReadCacheHits()
+{
+	return readCacheHits;
+}
+
+unsigned long ATECCX08A::getReadCacheMisses()
+{
+	return readCacheMisses;
+}
+
+void ATECCX08A::resetReadCacheCounters()
+{
+	readCacheHits = 0;
+	readCacheMisses = 0;
+}
+
+/** \brief
+
+	isCacheable(uint8_t zone, uint16_t address)
+
+	Returns true if the block at address may be kept in the read cache.
+*/
+
+boolean ATECCX08A::isCacheable(uint8_t zone, uint16_t address)
+{
+	int slotConfig;
+
+	if (readCache == NULL)
+		return false;
+	zone &= 0x03;
+	if (zone == ZONE_OTP)
+		return true;
+	if (zone != ZONE_DATA)
+		return false;
+
+	slotConfig = getSlotConfig((address >> 3) & 0x0F);
+	if (slotConfig < 0)
+		return false;
+	return (slotConfig & (SLOT_CONFIG_IS_SECRET | SLOT_CONFIG_ENCRYPT_READ)) == 0;
+}
+
+boolean ATECCX08A::readFromCache(uint8_t zone, uint16_t address, uint8_t *data, uint8_t length)
+{
+	uint16_t blockAddress = address & ~0x0007;
+
+	zone &= 0x03;
+	for (int i = 0; i < readCacheSize; i++)
+	{
+		if (readCache[i].valid == true && readCache[i].zone == zone && readCache[i].address == blockAddress)
+		{
+			if (length == 32)
+				memcpy(data, readCache[i].data, 32);
+			else
+				memcpy(data, &readCache[i].data[(address & 0x0007) * 4], length);
+			readCache[i].lastUse = ++readCacheTick;
+			return true;
+		}
+	}
+	return false;
+}
+
+void ATECCX08A::addToCache(uint8_t zone, uint16_t address, const uint8_t *data)
+{
+	int victim = 0;
+
+	// take a free entry, or the least recently used one
+	for (int i = 0; i < readCacheSize; i++)
+	{
+		if (readCache[i].valid == false)
+		{
+			victim = i;
+			break;
+		}
+		if (readCache[i].lastUse < readCache[victim].lastUse)
+			victim = i;
+	}
+	readCache[victim].valid = true;
+	readCache[victim].zone = zone & 0x03;
+	readCache[victim].address = address & ~0x0007;
+	readCache[victim].lastUse = ++readCacheTick;
+	memcpy(readCache[victim].data, data, 32);
+}
+
+// all cached blocks of a data slot
+void ATECCX08A::invalidateCachedSlot(int slot)
+{
+	for (int i = 0; i < readCacheSize; i++)
+	{
+		if (readCache[i].zone == ZONE_DATA && ((readCache[i].address >> 3) & 0x0F) == (slot & 0x0F))
+			readCache[i].valid = false;
+	}
+}
+
+void ATECCX08A::invalidateCachedBlock(uint8_t zone, uint16_t address)
+{
+	uint16_t blockAddress = address & ~0x0007;
+
+	zone &= 0x03;
+	for (int i = 0; i < readCacheSize; i++)
+	{
+		if (readCache[i].zone == zone && readCache[i].address == blockAddress)
+			readCache[i].valid = false;
+	}
+}
+
+/** \brief
+
+	writeSlotDifferential(int slot, int offset, const uint8_t *data, int length, boolean debug)
+
+	Writes length bytes of data to slot starting at offset, but only the words which differ
+	from the current contents. The range is planned with planSlotTransfer(), the current
+	contents are taken from the read cache or read back from the IC. Per block a single
+	changed word is written with a 4 byte write, two or more changed words are merged into
+	one 32 byte write, unchanged blocks are skipped. All commands run in one wake session.
+	If the contents can't be read (data zone not locked, secret or encrypted read slot) every
+	access of the plan is written.
+	getWritesIssued() counts the write commands sent, getWritesSkipped() the words of the range
+	which weren't written.
+*/
+
+boolean ATECCX08A::writeSlotDifferential(int slot, int offset, const uint8_t *data, int length, boolean debug)
+{
+  ATECCTransfer plan[ATECC_MAX_TRANSFER_STEPS];
+  uint8_t       block[32];
+  int           steps;
+  int           slotConfig;
+  boolean       compare;
+  boolean       result = true;
+
+  if (data == NULL)
+  {
+    setStatus(STATUS_INVALID_PARAMETER);
+    return false;
+  }
+  steps = planSlotTransfer(slot, offset, length, plan, ATECC_MAX_TRANSFER_STEPS);
+  if (steps < 0)
+  {
+    setStatus(STATUS_INVALID_PARAMETER);
+    return false;
+  }
+
+  if (beginSession() == false)
+    return false;
+
+  slotConfig = getSlotConfig(slot);
+  compare = getDataOTPLockStatus() == true && slotConfig >= 0 && 
+            (slotConfig & (SLOT_CONFIG_IS_SECRET | SLOT_CONFIG_ENCRYPT_READ)) == 0;
+
+  for (int i = 0; i < steps && result == true; i++)
+  {
+    const uint8_t *source = &data[plan[i].bufferOffset];
+    int  changed = 0;
+    int  changedWord = 0;
+
+    if (compare == true && read(ZONE_DATA, plan[i].address, block, plan[i].size, debug) == true)
+    {
+      for (int word = plan[i].first; word < plan[i].first + plan[i].count; word += 4)
+      {
+        if (memcmp(&block[word], &source[word - plan[i].first], 4) != 0)
+        {
+          changed++;
+          changedWord = word;
+        }
+      }
+    }
+    else if (plan[i].size == 32 && (plan[i].first != 0 || plan[i].count != 32))
+    {
+      // a partial block can't be merged without the current contents
+      setStatus(STATUS_INVALID_PARAMETER);
+      result = false;
+      break;
+    }
+    else
+    {
+      memcpy(&block[plan[i].first], source, plan[i].count);
+      changed = plan[i].count / 4;
+      changedWord = plan[i].first;
+    }
+
+    if (changed == 0)
+    {
+      writesSkipped += plan[i].count / 4;
+      continue;
+    }
+
+    memcpy(&block[plan[i].first], source, plan[i].count);
+    if (changed == 1 && plan[i].size == 32)
+    {
+      result = write(ZONE_DATA, plan[i].address + changedWord / 4, &block[changedWord], 4, debug);
+      writesSkipped += plan[i].count / 4 - 1;
+    }
+    else
+      result = write(ZONE_DATA, plan[i].address, block, plan[i].size, debug);
+    writesIssued++;
+  }
+  endSession();
+  return result;
+}
+
+/** \brief
+
+	getWritesIssued(), getWritesSkipped(), resetWriteCounters()
+
+	Counters of provisionConfigZone() and writeSlotDifferential(). getWritesIssued() counts
+	write commands (4 or 32 bytes). getWritesSkipped() counts 4 byte words: every word of the
+	requested range (for the configuration zone every writable word) which wasn't written
+	because it already had the value. A word written as part of a merged 32 byte write
+	doesn't count as skipped, even if it was unchanged.
+*/
+
+unsigned long ATECCX08A::getWritesIssued()
+{
+	return writesIssued;
+}
+
+unsigned long ATECCX08A::getWritesSkipped()
+{
+	return writesSkipped;
+}
+
+void ATECCX08A::resetWriteCounters()
+{
+	writesIssued = 0;
+	writesSkipped = 0;
+}
+
+// TODO: Documentation
+
+boolean ATECCX08A::writeSlot(const uint8_t *data, int length, int slot, boolean debug)
+{
+  int chunkSize = 32;
+	
+  if (slot < 0 || slot > 15) 
+	{
+    return false;
+  }
+  if (length % 4 != 0) 
+	{
+    return false;
+  }
+
+  for (int i = 0; i < length; i += chunkSize) 
+	{
+    if ((length - i) < 32) 
+		{
+      chunkSize = 4;
+    }
+
+    if (!write(ZONE_DATA, addressForSlotOffset(slot, i), &data[i], chunkSize, debug)) 
+		{
+      return false;
+    }
+  }
+  return true;
+}
+
+// TODO: Documentation
+
+int ATECCX08A::addressForSlotOffset(int slot, int offset)
+{
+  int block = offset / 32;
+  offset = (offset % 32) / 4;  
+
+  return (slot << 3) | (block << 8) | (offset);
+}
+
+/** \brief
+
+	getKeyConfig(int slot) / getSlotConfig(int slot)
+
+	Return the KeyConfig and SlotConfig words of slot from the cached configuration zone,
+	or -1 if slot is invalid or the configuration zone can't be read.
+*/
+
+int ATECCX08A::getKeyConfig(int slot)
+{
+	if (slot < 0 || slot > 15 || ensureConfigZone() == false)
+		return -1;
+	return config.keyConfig[slot];
+}
+
+int ATECCX08A::getSlotConfig(int slot)
+{
+	if (slot < 0 || slot > 15 || ensureConfigZone() == false)
+		return -1;
+	return config.slotConfig[slot];
+}
+
+/** \brief
+
+	createSignature(uint8_t *data, uint16_t slot)
+
+    Creates a 64-byte ECC signature on 32 bytes of data.
+	Defautes to use private key located in slot 0.
+	
+	Note, the IC actually needs you to store your data in a temporary memory location
+	called TempKey. This function first loads TempKey, and then signs TempKey. Then it 
+	receives the signature and copies it to signature[].
+*/
+
+boolean ATECCX08A::createSignature(uint8_t *signature, int size, const uint8_t *data, uint16_t slot, boolean debug)
+{
+  boolean loadTempKeyResult = loadTempKey(data);
+  boolean signTempKeyResult = signTempKey(signature, size, slot);
+	
+	// Serial.println("createSignature for slot : " + String(slot));
+	// Serial.println("loadTempKeyResult: " + String(loadTempKeyResult) + ", signTempKeyResult: " + String(signTempKeyResult));
+  if (loadTempKeyResult && signTempKeyResult) 
+		return true;
+  else 
+		return false;
+}
+
+/** \brief
+
+	loadTempKey(uint8_t *data)
+
+	Writes 32 bytes of data to memory location "TempKey" on the IC.
+	Note, the data is provided externally by you, the user, and is included in the
+	command NONCE.
+
+    We will use the NONCE command in passthrough mode to load tempKey with our data (aka message).
+    Note, the datasheet warns that this does not provide protection agains replay attacks,
+    but we will protect again this because our server (Bob) is going to send us it's own unique random TOKEN,
+    when it requests data, and this will allow us to create a unique data + signature for every communication.
+*/
+
+boolean ATECCX08A::loadTempKey(const uint8_t *data)
+{
+  // note, param2 is 0x0000 (and param1 is PASSTHROUGH), so OutData will be just a single byte of zero upon completion.
+  // see ds pg 77 for more info
+  // responds with "0x00" if NONCE executed properly
+  return executeCommand(COMMAND_OPCODE_NONCE, NONCE_MODE_PASSTHROUGH, 0x0000, data, 32, 4, ATECC_CMD_NONCE);
+}
+
+/** \brief
+
+	signTempKey(uint16_t slot)
+
+	Create a 64 byte ECC signature for the contents of TempKey using the private key in slot.
+	Default slot is 0.
+	
+	The response from this command (the signature) is stored in global varaible signature[].
+*/
+
+boolean ATECCX08A::signTempKey(uint8_t *signature, int size, uint16_t slot, boolean debug)
+{
+  // signature (64), plus crc (2), plus count (1)
+  if (executeCommand(COMMAND_OPCODE_SIGN, SIGN_MODE_TEMPKEY, slot, NULL, 0, 64 + 2 + 1, ATECC_CMD_SIGN, debug) == false) 
+  	return false;
+	
+  // update signature[] array and print it to serial terminal nicely formatted for easy copy/pasting between sketches
+  // we don't need the count value (which is currently the first byte of the inputBuffer)
+  for (int i = 0 ; i < 64 ; i++) // for loop through to grab all but the first position (which is "count" of the message)
+  {
+    signature[i] = inputBuffer[i + 1];
+  }
+
+  if (ATECC_DEBUG_OUTPUT(debug))
+	{
+		_debugSerial->println("signature: ");
+		printHexValue(signature, SIGNATURE_SIZE, " ");
 	}
-	else
+  return true;
+}
+
+/** \brief
+
+	verifySignature(uint8_t *message, uint8_t *signature, uint8_t *publicKey)
+	
+	Verifies a ECC signature using the message, signature and external public key.
+	Returns true if successful.
+	
+	Note, it acutally uses loadTempKey, then uses the verify command in "external public key" mode.
+*/
+
+boolean ATECCX08A::verifySignature(const uint8_t *message, const uint8_t *signature, const uint8_t *publicKey)
+{
+  // first, let's load the message into TempKey on the device, this uses NONCE command in passthrough mode.
+  boolean loadTempKeyResult = loadTempKey(message);
+  if (loadTempKeyResult == false) 
+  {
+    if (ATECC_DEBUG_ERROR_OUTPUT)
+      _debugSerial->println("Load TempKey Failure");
+    return false;
+  }
+
+  // We can only send one *single* data array to sendCommand as Param2, so we need to combine signature and public key.
+  uint8_t data_sigAndPub[128]; 
+  memcpy(&data_sigAndPub[0], &signature[0], 64);	// append signature
+  memcpy(&data_sigAndPub[64], &publicKey[0], 64);	// append external public key
+  
+  // If we hear a "0x00", that means it had a successful verify
+  return executeCommand(COMMAND_OPCODE_VERIFY, VERIFY_MODE_EXTERNAL, VERIFY_PARAM2_KEYTYPE_ECC, data_sigAndPub, sizeof(data_sigAndPub), 4, ATECC_CMD_VERIFY);
+}
+
+
+/** \brief
+
+	sendCommand(uint8_t command_opcode, uint8_t param1, uint16_t param2, uint8_t *data, size_t length_of_data)
+	
+	Generic function for sending commands to the IC. 
+	
+	This function handles creating the "total transmission" to the IC.
+	This contains WORD_ADDRESS_VALUE, COUNT, OPCODE, PARAM1, PARAM2, DATA (optional), and CRCs.
+	
+	Note, it always calls the "wake()" function, assuming that you have let the IC fall asleep (default 1.7 sec)
+	
+	Note, for anything other than a command (reset, sleep and idle), you need a different "Word Address Value",
+	So those specific transmissions are handled in unique functions.
+*/
+
+boolean ATECCX08A::sendCommand(uint8_t command_opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length_of_data, boolean debug)
+{
+  // build packet array (total_transmission) to send a communication to IC, with opcode COMMAND
+  // It expects to see: word address, count, command opcode, param1, param2, data (optional), CRC[0], CRC[1]
+  
+  uint8_t total_transmission_length;
+  total_transmission_length = (1 +1 +1 +1 +2 +length_of_data +2); 
+  // word address val (1) + count (1) + command opcode (1) param1 (1) + param2 (2) data (0-?) + crc (2)
+
+  uint8_t total_transmission[total_transmission_length];
+  total_transmission[0] = WORD_ADDRESS_VALUE_COMMAND; 		// word address value (type command)
+  total_transmission[1] = total_transmission_length-1; 		// count, does not include itself, so "-1"
+  total_transmission[2] = command_opcode; 			// command
+  total_transmission[3] = param1;							// param1
+  memcpy(&total_transmission[4], &param2, sizeof(param2));	// append param2 
+  memcpy(&total_transmission[6], &data[0], length_of_data);	// append data
+  
+  // update CRCs
+  uint8_t packet_to_CRC[total_transmission_length-3]; // minus word address (1) and crc (2).
+  memcpy(&packet_to_CRC[0], &total_transmission[1], (total_transmission_length-3)); // copy over just what we need to CRC starting at index 1
+  
+	if (ATECC_DEBUG_OUTPUT(debug))
+	{
+    _debugSerial->println("packet_to_CRC: ");
+    printHexValue(packet_to_CRC, sizeof(packet_to_CRC), ",");
+	}
+  
+  atca_calculate_crc((total_transmission_length-3), packet_to_CRC); // count includes crc[0] and crc[1], so we must subtract 2 before creating crc
+	if (ATECC_DEBUG_OUTPUT(debug))
+    printHexValue(crc, sizeof(crc), ",");
+
+  memcpy(&total_transmission[total_transmission_length-2], &crc[0], 2);  // append crcs
+  if (sessionDepth == 0 || sessionAwake == false)
+  {
+    wakeUp();  // within a session only the first command needs the wake pulse
+    if (sessionDepth > 0)
+      sessionAwake = true;
+  }
+  transport->write(_i2caddr, total_transmission, total_transmission_length);
+  
+  return true;
+}
+
+
+boolean ATECCX08A::beginSHA256()
+{
+	boolean result;
+	
+	result = submitCommand(COMMAND_OPCODE_SHA, SHA_START, 0, NULL, 0, RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE, ATECC_CMD_SHA);
+	return result;
+}
+
+
+boolean ATECCX08A::updateSHA256(const uint8_t *plainText, int length)
+{
+	boolean result;
+	int i;
+	size_t chunks = length / SHA_BLOCK_SIZE + !!(length % SHA_BLOCK_SIZE);
+	
+  if ((length % SHA_BLOCK_SIZE) == 0) 
+		chunks += 1; // END command can only accept up to 63 bytes, so we must add a "blank chunk" for the end command
+
+  // Serial.print("chunks:");
+  // Serial.println(chunks);
+
+	/* Divide into blocks of 64 bytes per chunk */
+	for (i = 0; i < chunks; ++i)
+	{
+		size_t data_size = SHA_BLOCK_SIZE;
+
+		// wait for the previous command (START or UPDATE) before sending the next block
+		if (!waitSHAResponse())
+			return false;
+		if (i + 1 == chunks) // if we're on the last chunk, there will be a remainder or 0 (and 0 is okay for an end command)
+			data_size = length % SHA_BLOCK_SIZE;
+
+		/* Send next, the END command responds with the digest */
+		if (i + 1 != chunks)
+			result = submitCommand(COMMAND_OPCODE_SHA, SHA_UPDATE, data_size, plainText + i * SHA_BLOCK_SIZE, data_size, RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE, ATECC_CMD_SHA);
+		else
+			result = submitCommand(COMMAND_OPCODE_SHA, SHA_END, data_size, plainText + i * SHA_BLOCK_SIZE, data_size, RESPONSE_COUNT_SIZE + RESPONSE_SHA_SIZE + CRC_SIZE, ATECC_CMD_SHA);
+		if (!result)
+			return false;
+	}
+	return true;
+}
+
+
+/** \brief
+
+	waitSHAResponse()
+
+	Waits for the status response of a pending SHA command (START or UPDATE).
+	The SHA commands are pipelined: a command is submitted, and its response is picked up
+	right before the next command is sent.
+*/
+
+boolean ATECCX08A::waitSHAResponse()
+{
+	// If we hear a "0x00", that means it had a successful load
+	return waitCommand();
+}
+
+
+boolean ATECCX08A::endSHA256(uint8_t *hash, int size)
+{
+	/* Read digest */
+	if (!waitCommand())
+		return false;
+
+	/* Copy digest */
+	for (int i = 0; i < SHA256_SIZE; ++i)
+	{
+		hash[i] = inputBuffer[RESPONSE_SHA_INDEX + i];
+	}
+
+	setStatus(STATUS_SUCCESS);
+	return true;
+}
+
+boolean ATECCX08A::sha256(const uint8_t *plain, size_t len, uint8_t *hash)
+{
+	boolean result;
+	
+	result = beginSHA256();
+	if (result == false)
 		return false;
+
+  result = updateSHA256(plain, len);
+	if (result == false)
+		return result;
+		
+	/* Read digest */
+	result = endSHA256(hash, SHA256_SIZE);
+	return result;
 }
 
 /** \brief
 
-	checkCount(boolean debug)
-	
-	This function checks that the count byte received in the most recent message equals countGlobal
-	Call receiveResponseData, and then imeeditately call this to check the count of the complete message.
-	Returns true if inputBuffer[0] == countGlobal.
+	shaStart()
+
+	Starts a new SHA-256 calculation and waits for the response.
+	Unlike sha256(), shaStart(), shaUpdateBlock() and shaEnd() are not pipelined,
+	so the SHA context may be saved and restored between them (see ATECCHashStreams).
 */
 
-boolean ATECCX08A::checkCount(boolean debug)
+boolean ATECCX08A::shaStart()
 {
-  if (debug == true)
-  {
-    _debugSerial->print("countGlobal: 0x");
-	  _debugSerial->println(countGlobal, HEX);
-	  _debugSerial->print("count heard from IC (inputBuffer[0]): 0x");
-    _debugSerial->println(inputBuffer[0], HEX);
-  }
-  // Check count; the first byte sent from IC is count, and it should be equal to the actual message count
-  if (inputBuffer[0] != countGlobal) 
-  {
-		setStatus(STATUS_MESSAGE_COUNT_ERROR);
-	  if (debug) 
-			_debugSerial->println("Message Count Error");
-	  return false;
-  }  
-  return true;
+	return executeCommand(COMMAND_OPCODE_SHA, SHA_START, 0, NULL, 0, RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE, ATECC_CMD_SHA);
 }
 
 /** \brief
 
-	checkCrc(boolean debug)
-	
-	This function checks that the CRC bytes received in the most recent message equals a calculated CRCs
-	Call receiveResponseData, then call immediately call this to check the CRCs of the complete message.
+	shaUpdateBlock(const uint8_t *block)
+
+	Adds one 64 byte block to the running SHA-256 calculation and waits for the response.
 */
 
-boolean ATECCX08A::checkCrc(boolean debug)
+boolean ATECCX08A::shaUpdateBlock(const uint8_t *block)
 {
-  // Check CRC[0] and CRC[1] are good to go.
-  
-  atca_calculate_crc(countGlobal-2, inputBuffer);   // first calculate it
-  
-  if (debug)
-  {
-    _debugSerial->print("CRC[0] Calc: 0x");
-	  _debugSerial->println(crc[0], HEX);
-	  _debugSerial->print("CRC[1] Calc: 0x");
-    _debugSerial->println(crc[1], HEX);
-  }
-  
-  if ( (inputBuffer[countGlobal-1] != crc[1]) || (inputBuffer[countGlobal-2] != crc[0]) )   // then check the CRCs.
-  {
-		setStatus(STATUS_MESSAGE_COUNT_ERROR);
-	  if (debug) 
-			_debugSerial->println("Message CRC Error");
-	  return false;
-  }
-  if (debug)
+	if (block == NULL)
 	{
-		_debugSerial->println("CRC verification ok");
+		setStatus(STATUS_INVALID_PARAMETER);
+		return false;
 	}
-  return true;
+	return executeCommand(COMMAND_OPCODE_SHA, SHA_UPDATE, SHA_BLOCK_SIZE, block, SHA_BLOCK_SIZE, RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE, ATECC_CMD_SHA);
 }
 
 /** \brief
 
-	atca_calculate_crc(uint8_t length, uint8_t *data)
-	
-    This function calculates CRC.
-    It was copied directly from the App Note provided from Microchip.
-    Note, it seems to be their own unique type of CRC cacluation.
-    View the entire app note here:
-    http://ww1.microchip.com/downloads/en/AppNotes/Atmel-8936-CryptoAuth-Data-Zone-CRC-Calculation-ApplicationNote.pdf
-    \param[in] length number of bytes in buffer
-    \param[in] data pointer to data for which CRC should be calculated
+	shaEnd(const uint8_t *data, int length, uint8_t *hash, int size)
+
+	Sends the last 0-63 bytes of the message and reads the digest.
 */
 
-void ATECCX08A::atca_calculate_crc(uint8_t length, const uint8_t *data)
+boolean ATECCX08A::shaEnd(const uint8_t *data, int length, uint8_t *hash, int size)
 {
-  uint8_t counter;
-  uint16_t crc_register = 0;
-  uint16_t polynom = 0x8005;
-  uint8_t shift_register;
-  uint8_t data_bit, crc_bit;
-  for (counter = 0; counter < length; counter++) 
+	if (length < 0 || length >= SHA_BLOCK_SIZE || (length > 0 && data == NULL))
 	{
-    for (shift_register = 0x01; shift_register > 0x00; shift_register <<= 1) 
-		{
-      data_bit = (data[counter] & shift_register) ? 1 : 0;
-      crc_bit = crc_register >> 15;
-      crc_register <<= 1;
-      if (data_bit != crc_bit)
-        crc_register ^= polynom;
-    }
-  }
-  crc[0] = (uint8_t) (crc_register & 0x00FF);
-  crc[1] = (uint8_t) (crc_register >> 8);
+		setStatus(STATUS_INVALID_PARAMETER);
+		return false;
+	}
+	if (hash == NULL || size < SHA256_SIZE)
+	{
+		setStatus(STATUS_INPUT_BUFFER_TOO_SMALL);
+		return false;
+	}
+	if (!submitCommand(COMMAND_OPCODE_SHA, SHA_END, length, data, length, RESPONSE_COUNT_SIZE + RESPONSE_SHA_SIZE + CRC_SIZE, ATECC_CMD_SHA))
+		return false;
+	return endSHA256(hash, size);
 }
 
-
 /** \brief
 
-	cleanInputBuffer()
-	
-    This function sets the entire inputBuffer to 0xFFs.
-	It is helpful for debugging message/count/CRCs errors.
+	readSHAContext(uint8_t *context, int size, int &contextSize)
+
+	Reads the SHA context of the running calculation (ATECC608A only).
+	The context can be written back later with writeSHAContext() to continue the calculation,
+	so several hash streams can share the single SHA engine of the IC.
 */
 
-void ATECCX08A::cleanInputBuffer()
+boolean ATECCX08A::readSHAContext(uint8_t *context, int size, int &contextSize)
 {
-  for (int i = 0; i < sizeof(inputBuffer) ; i++)
-  {
-    inputBuffer[i] = 0xFF;
-  }
+	if (hasFeature(ATECC_FEATURE_SHA_CONTEXT) == false)
+	{
+		setStatus(STATUS_NOT_SUPPORTED);
+		return false;
+	}
+	if (context == NULL)
+	{
+		setStatus(STATUS_INVALID_PARAMETER);
+		return false;
+	}
+	// the length of the context depends on the state of the calculation, an error is a status response instead
+	if (!executeCommand(COMMAND_OPCODE_SHA, SHA_READ_CONTEXT, 0, NULL, 0, (RESPONSE_COUNT_SIZE + SHA_CONTEXT_MAX_SIZE + CRC_SIZE) | ATECC_RESPONSE_VARIABLE, ATECC_CMD_SHA))
+		return false;
+
+	contextSize = countGlobal - RESPONSE_COUNT_SIZE - CRC_SIZE;
+	if (contextSize > size)
+	{
+		setStatus(STATUS_INPUT_BUFFER_TOO_SMALL);
+		return false;
+	}
+	memcpy(context, &inputBuffer[RESPONSE_READ_INDEX], contextSize);
+	setStatus(STATUS_SUCCESS);
+	return true;
 }
 
 /** \brief
 
-	createNewKeyPair(uint16_t slot)
-	
-    This function sends the command to create a new key pair (private AND public)
-	in the slot designated by argument slot (default slot 0).
-	Sparkfun Default Configuration Sketch calls this, and then locks the data/otp zones and slot 0.
-*/
+	writeSHAContext(const uint8_t *context, int contextSize)
 
-boolean ATECCX08A::createNewKeyPair(uint8_t *publicKey, int size, uint16_t slot)
-{  
-	sendCommand(COMMAND_OPCODE_GENKEY, GENKEY_MODE_NEW_PRIVATE, slot);
-  delay(115); // time for IC to process command and exectute
+	Restores a SHA context read with readSHAContext() (ATECC608A only).
+*/
 
-  // Now let's read back from the IC.
-  if (receiveResponseData(64 + 2 + 1) == false) 
+boolean ATECCX08A::writeSHAContext(const uint8_t *context, int contextSize)
+{
+	if (hasFeature(ATECC_FEATURE_SHA_CONTEXT) == false)
 	{
-		return false; // public key (64), plus crc (2), plus count (1)
+		setStatus(STATUS_NOT_SUPPORTED);
+		return false;
 	}
-  idleMode();
-  boolean checkCountResult = checkCount();
-  boolean checkCrcResult = checkCrc();
-
-  if (checkCountResult && checkCrcResult) // check that it was a good message
-  {
-  	// we don't need the count value (which is currently the first byte of the inputBuffer)
-		if (publicKey != NULL && size >= PUBLIC_KEY_SIZE)
-		{
-	    for (int i = 0 ; i < 64 ; i++) // for loop through to grab all but the first position (which is "count" of the message)
-	    {
-	      publicKey[i] = inputBuffer[i+1];
-  	  }
-		  setStatus(STATUS_SUCCESS);
-	    return true;
-		}
-  }
-  else 
+	if (context == NULL || contextSize < 0 || contextSize > SHA_CONTEXT_MAX_SIZE)
 	{
+		setStatus(STATUS_INVALID_PARAMETER);
 		return false;
 	}
+	return executeCommand(COMMAND_OPCODE_SHA, SHA_WRITE_CONTEXT, contextSize, context, contextSize, RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE, ATECC_CMD_SHA);
 }
 
 /** \brief
 
-	generatePublicKey(uint16_t slot, boolean debug)
+	beginHMAC(uint16_t slot)
 
-    This function uses the GENKEY command in "Public Key Computation" mode.
-	
-    Generates an ECC public key based upon the private key stored in the slot defined by the KeyID
-	parameter (aka slot). Defaults to slot 0. 
-	
-	Note, if you haven't created a private key in the slot already, then this will fail.
-	
-	The generated public key is read back from the device, and then copied from inputBuffer to 
-	a global variable named publicKey64Bytes for later use.
+	Starts an HMAC-SHA256 calculation on the IC with the key stored in slot.
+	The key never leaves the IC. Feed the message with updateHMAC() (as often as needed)
+	and get the result with endHMAC().
+	Like sha256(), the commands are pipelined: the response of each command is only read
+	right before the next one is sent.
 */
 
-boolean ATECCX08A::generatePublicKey(uint8_t *publicKey, int size, uint16_t slot, boolean debug)
+boolean ATECCX08A::beginHMAC(uint16_t slot)
 {
-  if (publicKey == NULL)
+	if (slot > 15)
 	{
 		setStatus(STATUS_INVALID_PARAMETER);
 		return false;
 	}
-	if (size < PUBLIC_KEY_SIZE)
+	isATECC608A(); // make sure the device type is known before the SHA sequence starts
+	hmacBlockLength = 0;
+	return submitCommand(COMMAND_OPCODE_SHA, SHA_HMAC_START, slot, NULL, 0, RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE, ATECC_CMD_SHA);
+}
+
+/** \brief
+
+	updateHMAC(const uint8_t *data, int length)
+
+	Adds data to the running HMAC. Full 64 byte blocks are sent to the IC right away,
+	the remainder is kept until the next call to updateHMAC() or endHMAC().
+*/
+
+boolean ATECCX08A::updateHMAC(const uint8_t *data, int length)
+{
+	while (length > 0)
 	{
-		setStatus(STATUS_INPUT_BUFFER_TOO_SMALL);
-    return false;		
-	}
-  sendCommand(COMMAND_OPCODE_GENKEY, GENKEY_MODE_PUBLIC, slot);
-  delay(115); // time for IC to process command and exectute
+		int size = SHA_BLOCK_SIZE - hmacBlockLength;
 
-  // Now let's read back from the IC.
-  if (receiveResponseData(64 + 2 + 1) == false)
-	{ 
-    return false; // public key (64), plus crc (2), plus count (1)
-	}
-  idleMode();
-  boolean checkCountResult = checkCount();
-  boolean checkCrcResult = checkCrc();
-  
-  // update publicKey64Bytes[] array
-  if (checkCountResult && checkCrcResult) // check that it was a good message
-  {  
-    // we don't need the count value (which is currently the first byte of the inputBuffer)
-    for (int i = 0 ; i < 64 ; i++) // for loop through to grab all but the first position (which is "count" of the message)
-    {
-      publicKey[i] = inputBuffer[i+1];
-    }
-	
-		if (debug)
+		if (size > length)
+			size = length;
+		memcpy(&hmacBlock[hmacBlockLength], data, size);
+		hmacBlockLength += size;
+		data += size;
+		length -= size;
+
+		if (hmacBlockLength == SHA_BLOCK_SIZE)
 		{
-			_debugSerial->println("This device's Public Key for slot :" + String(slot));
-			_debugSerial->println();
-			_debugSerial->println("uint8_t publicKey[64] = {");
-			for (int i = 0; i < size; i++)
-			{
-				_debugSerial->print("0x");
-				if ((publicKey[i] >> 4) == 0) _debugSerial->print("0"); // print preceeding high nibble if it's zero
-				_debugSerial->print(publicKey[i], HEX);
-				if (i != 63) _debugSerial->print(", ");
-				if ((63-i) % 16 == 0) _debugSerial->println();
-			}
-			_debugSerial->println("};");
-			_debugSerial->println();
+			if (!waitSHAResponse())
+				return false;
+			if (!submitCommand(COMMAND_OPCODE_SHA, SHA_UPDATE, SHA_BLOCK_SIZE, hmacBlock, SHA_BLOCK_SIZE, RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE, ATECC_CMD_SHA))
+				return false;
+			hmacBlockLength = 0;
 		}
-  	setStatus(STATUS_SUCCESS);
-  	return true;
-  }
-  else 
-	{
-  	setStatus(STATUS_EXECUTION_ERROR);
-		return false;
 	}
+	return true;
 }
 
 /** \brief
 
-	read(uint8_t zone, uint16_t address, uint8_t length, boolean debug)
+	endHMAC(uint8_t *mac, int size)
 
-    Reads data from the IC at a specific zone and address.
-	Your data response will be available at inputBuffer[].
-	
-	For more info on address encoding, see datasheet pg 58.
+	Sends the remaining data with the HMAC end command and reads the 32 byte result.
 */
 
-boolean ATECCX08A::read(uint8_t zone, uint16_t address, uint8_t *response, uint8_t length, boolean debug)
+boolean ATECCX08A::endHMAC(uint8_t *mac, int size)
 {
-  // adjust zone as needed for whether it's 4 or 32 bytes length read
-  // bit 7 of zone needs to be set correctly 
-  // (0 = 4 Bytes are read) 
-  // (1 = 32 Bytes are read)
-  if (length == 32) 
-  {
-	  zone |= 0b10000000; // set bit 7
-  }
-  else if (length == 4)
-  {
-	  zone &= ~0b10000000; // clear bit 7
-  }
-  else
-  {
-	  return false; // invalid length, abort.
-  }
-
-  sendCommand(COMMAND_OPCODE_READ, zone, address);
-  
-  delay(1); // time for IC to process command and exectute
+	uint8_t mode;
 
-  // Now let's read back from the IC. 
-  
-  if (receiveResponseData(length + 3, debug) == false) 
+	if (mac == NULL || size < HMAC_SIZE)
 	{
-		setStatus(STATUS_EXECUTION_ERROR);
+		setStatus(STATUS_INPUT_BUFFER_TOO_SMALL);
 		return false;
 	}
-  idleMode();
-  if (checkCount(debug) == false) 
-	{
-		setStatus(STATUS_EXECUTION_ERROR);
+	if (!waitSHAResponse())
 		return false;
-	}
-  if (checkCrc(debug) == false) 
+
+	if (isATECC608A())
+		mode = SHA_608_HMAC_END | SHA_MODE_TARGET_OUTPUT;
+	else
+		mode = SHA_HMAC_END;
+	// the HMAC end runs the inner and the outer hash
+	if (!submitCommand(COMMAND_OPCODE_SHA, mode, hmacBlockLength, hmacBlock, hmacBlockLength, RESPONSE_COUNT_SIZE + HMAC_SIZE + CRC_SIZE, ATECC_CMD_HMAC))
+		return false;
+	hmacBlockLength = 0;
+
+	return endSHA256(mac, size);
+}
+
+/** \brief
+
+	hmac(const uint8_t *data, size_t len, uint16_t slot, uint8_t *mac)
+
+	Calculates the HMAC-SHA256 of data with the key in slot.
+*/
+
+boolean ATECCX08A::hmac(const uint8_t *data, size_t len, uint16_t slot, uint8_t *mac)
+{
+	boolean result;
+
+	result = beginHMAC(slot);
+	if (result == false)
+		return false;
+
+	result = updateHMAC(data, len);
+	if (result == false)
+		return false;
+
+	result = endHMAC(mac, HMAC_SIZE);
+	return result;
+}
+
+/** \brief
+
+	isATECC608A()
+
+	Returns true if the device is an ATECC608A. The revision is read with getInfo() on first use.
+*/
+
+boolean ATECCX08A::isATECC608A()
+{
+	uint8_t model = getModel();
+	return model == ATECC_MODEL_608A || model == ATECC_MODEL_608B;
+}
+
+/** \brief
+
+	getModel()
+
+	Returns the device model (ATECC_MODEL_*) found by begin(). If it is not known yet,
+	the Info command is sent first. ATECC_MODEL_UNKNOWN if the IC doesn't answer.
+*/
+
+uint8_t ATECCX08A::getModel()
+{
+	if (deviceModel == ATECC_MODEL_UNKNOWN)
+		getInfo();
+	return deviceModel;
+}
+
+/** \brief
+
+	getDeviceProfile()
+
+	Returns the execution times and features of the device model. Until the model is known
+	this is a conservative profile with the longest times of all models and all features.
+*/
+
+const ATECCDeviceProfile *ATECCX08A::getDeviceProfile()
+{
+	return findDeviceProfile(deviceModel, clockDivider);
+}
+
+/** \brief
+
+	findDeviceProfile(uint8_t model, uint8_t clockDivider)
+
+	Returns the execution time table of model running with clockDivider (CHIP_MODE_CLOCK_DIVIDER_*).
+	An ATECC608A with a divider which isn't M0, M1 or M2 gets the slowest table (M2), 
+	other unknown combinations the conservative profile.
+*/
+
+const ATECCDeviceProfile *ATECCX08A::findDeviceProfile(uint8_t model, uint8_t clockDivider)
+{
+	if (model == ATECC_MODEL_608B)
+		model = ATECC_MODEL_608A;
+	for (unsigned int i = 0; i < sizeof(deviceProfiles) / sizeof(deviceProfiles[0]); i++)
 	{
-		setStatus(STATUS_CRC_ERROR);
-  	return false;
+		if (deviceProfiles[i].model == model && deviceProfiles[i].clockDivider == clockDivider)
+			return &deviceProfiles[i];
 	}
-  memcpy(response, &inputBuffer[1], length);
-	setStatus(STATUS_SUCCESS);
-  return true;
+	if (model == ATECC_MODEL_608A)
+		return findDeviceProfile(model, CHIP_MODE_CLOCK_DIVIDER_M2);
+	return &deviceProfiles[0];
 }
 
-boolean ATECCX08A::read(uint8_t zone, uint16_t address, uint8_t length, boolean debug)
+boolean ATECCX08A::hasFeature(uint8_t feature)
 {
-  // adjust zone as needed for whether it's 4 or 32 bytes length read
-  // bit 7 of zone needs to be set correctly 
-  // (0 = 4 Bytes are read) 
-  // (1 = 32 Bytes are read)
-  if (length == 32) 
-  {
-	  zone |= 0b10000000; // set bit 7
-  }
-  else if (length == 4)
-  {
-	  zone &= ~0b10000000; // clear bit 7
-  }
-  else
-  {
-	  return 0; // invalid length, abort.
-  }
+	getModel();
+	return (getDeviceProfile()->features & feature) == feature;
+}
 
-  sendCommand(COMMAND_OPCODE_READ, zone, address);
-  
-  delay(1); // time for IC to process command and exectute
+uint16_t ATECCX08A::getExecutionTime(uint8_t command)
+{
+	if (command >= ATECC_CMD_COUNT)
+		return 0;
+	return getDeviceProfile()->executionTime[command];
+}
 
-  // Now let's read back from the IC. 
-  
-  if (receiveResponseData(length + 3, debug) == false) 
+/** \brief
+
+	submitCommand(uint8_t opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length,
+	              uint8_t responseLength, uint8_t command, ATECCCallback callback, void *context)
+
+	Sends a command to the IC and returns right away. The sketch can do other work while the IC
+	executes it and calls pollCommand() until the state is ATECC_COMMAND_DONE or ATECC_COMMAND_FAILED,
+	then it picks up the response with getCommandResult(). callback (optional) is called by
+	pollCommand() when the command has finished.
+	responseLength is the complete length of the response (count + data + 2 CRC bytes), or the
+	maximum length | ATECC_RESPONSE_VARIABLE. A response of 4 bytes is a status: the command fails
+	if it isn't 0x00. command (ATECC_CMD_*) selects the execution time to wait for.
+	Only one command can be submitted at a time. All blocking commands of the library are built on it.
+*/
+
+boolean ATECCX08A::submitCommand(uint8_t opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length, uint8_t responseLength, uint8_t command, ATECCCallback callback, void *context)
+{
+	if (commandState == ATECC_COMMAND_BUSY)
 	{
-		setStatus(STATUS_EXECUTION_ERROR);
+		setStatus(STATUS_COMMAND_PENDING);
 		return false;
 	}
-  idleMode();
-  if (checkCount(debug) == false) 
+	if (command >= ATECC_CMD_COUNT || (responseLength & ~ATECC_RESPONSE_VARIABLE) < RESPONSE_COUNT_SIZE + CRC_SIZE)
 	{
-		setStatus(STATUS_EXECUTION_ERROR);
+		setStatus(STATUS_INVALID_PARAMETER);
 		return false;
 	}
-  if (checkCrc(debug) == false) 
+	commandTiming = command;
+	commandResponseLength = responseLength;
+	commandCallback = callback;
+	commandContext = context;
+	if (log != NULL)
 	{
-		setStatus(STATUS_CRC_ERROR);
-  	return false;
+		logOpcode = opcode;
+		logParam1 = param1;
+		logParam2 = param2;
+		logStart = transport->micros();
 	}
-  
-	setStatus(STATUS_SUCCESS);
-  return true;
+#if ATECC_ENABLE_METRICS
+	metrics.command[command].count++;
+	metricsStart = transport->micros();
+	metricsRetries = 0;
+#endif
+	sendCommand(opcode, param1, param2, data, length);
+	commandStart = getCommandClock();
+	commandState = ATECC_COMMAND_BUSY;
+	return true;
 }
 
-
 /** \brief
 
-	write(uint8_t zone, uint16_t address, uint8_t *data, uint8_t length_of_data)
+	pollCommand(boolean debug)
 
-    Writes data to a specific zone and address on the IC.
-	
-	For more info on zone and address encoding, see datasheet pg 58.
+	Returns the state of the submitted command (ATECC_COMMAND_*). Once the execution time of the
+	command has passed, the response is received and checked.
 */
 
-boolean ATECCX08A::write(uint8_t zone, uint16_t address, const uint8_t *data, uint8_t length_of_data, boolean debug)
+uint8_t ATECCX08A::pollCommand(boolean debug)
 {
-  // adjust zone as needed for whether it's 4 or 32 bytes length write
-  // bit 7 of param1 needs to be set correctly 
-  // (0 = 4 Bytes are written) 
-  // (1 = 32 Bytes are written)
-  if (length_of_data == 32) 
-  {
-	  zone |= 0b10000000; // set bit 7
-  }
-  else if (length_of_data == 4)
-  {
-	  zone &= ~0b10000000; // clear bit 7
-  }
-  else
-  {
-	  return 0; // invalid length, abort.
-  }
- 
-  sendCommand(COMMAND_OPCODE_WRITE, zone, address, data, length_of_data);
+	if (commandState == ATECC_COMMAND_BUSY && getCommandElapsed() >= getExecutionTime(commandTiming))
+		finishCommand(debug);
+	return commandState;
+}
 
-  delay(26); // time for IC to process command and exectute
-  
-  // Now let's read back from the IC and see if it reports back good things.
-  countGlobal = 0; 
-  if (receiveResponseData(4, debug) == false) 
-	{
-		setStatus(STATUS_EXECUTION_ERROR);
-		return false;
-	}
-  idleMode();
-  if (checkCount(debug) == false)
-  {		
-		setStatus(STATUS_EXECUTION_ERROR);
-		return false;
-	}
-  if (checkCrc(debug) == false)
-	{		
-		setStatus(STATUS_CRC_ERROR);
-		return false;
-	}
-	setStatus(inputBuffer[1]);
-  if (inputBuffer[1] == 0x00) 
-		return true;   // If we hear a "0x00", that means it had a successful write
-  else 
-		return false;
+uint8_t ATECCX08A::getCommandState()
+{
+	return commandState;
 }
 
-// TODO: Documentation
+/** \brief
 
+	getCommandResult(uint8_t *response, int size)
 
-boolean ATECCX08A::readSlot(uint8_t *data, int length, int slot, boolean debug)
+	Copies the data of the response (without count and CRC) of a finished command to response.
+	Returns the length of the data, or -1 if there is no successful response or size is too small.
+	The state goes back to ATECC_COMMAND_IDLE.
+*/
+
+int ATECCX08A::getCommandResult(uint8_t *response, int size)
 {
-  int chunkSize = 32;
+	int length = countGlobal - RESPONSE_COUNT_SIZE - CRC_SIZE;
 
-  if (slot < 0 || slot > 15) 
-	{
-    return false;
-  }
-  if (length % 4 != 0) 
+	if (commandState != ATECC_COMMAND_DONE)
+		return -1;
+	commandState = ATECC_COMMAND_IDLE;
+	if (length > size || (length > 0 && response == NULL))
 	{
-    return false;
-  }
+		setStatus(STATUS_INPUT_BUFFER_TOO_SMALL);
+		return -1;
+	}
+	memcpy(response, &inputBuffer[RESPONSE_READ_INDEX], length);
+	return length;
+}
 
-  for (int i = 0; i < length; i += chunkSize) 
-	{
-    if ((length - i) < 32) 
-		{
-      chunkSize = 4;
-    }
+/** \brief
 
-    if (!read(ZONE_DATA, addressForSlotOffset(slot, i), &data[i], chunkSize, debug)) 
-		{
-      return false;
-    }
-  }
-  return true;
-}
+	setClock(unsigned long (*clock)())
 
-// TODO: Documentation
+	Replaces the time base (ms) of pollCommand(), micros() of the transport by default (clock = NULL). 
+	A simulated clock allows to step through a command without waiting.
+*/
 
-boolean ATECCX08A::writeSlot(const uint8_t *data, int length, int slot, boolean debug)
+void ATECCX08A::setClock(unsigned long (*clock)())
 {
-  int chunkSize = 32;
-	
-  if (slot < 0 || slot > 15) 
-	{
-    return false;
-  }
-  if (length % 4 != 0) 
-	{
-    return false;
-  }
+	commandClock = clock;
+}
 
-  for (int i = 0; i < length; i += chunkSize) 
-	{
-    if ((length - i) < 32) 
-		{
-      chunkSize = 4;
-    }
+/** \brief
 
-    if (!write(ZONE_DATA, addressForSlotOffset(slot, i), &data[i], chunkSize, debug)) 
-		{
-      return false;
-    }
-  }
-  return true;
-}
+	setLog(ATECCLog *log)
 
-// TODO: Documentation
+	Every command adds a record to log when it has finished (see ATECCLog.h), NULL stops logging.
+	The log is only written to, the sketch drains it when it has time.
+*/
 
-int ATECCX08A::addressForSlotOffset(int slot, int offset)
+void ATECCX08A::setLog(ATECCLog *log)
 {
-  int block = offset / 32;
-  offset = (offset % 32) / 4;  
-
-  return (slot << 3) | (block << 8) | (offset);
+	this->log = log;
 }
 
-int ATECCX08A::getKeyConfig(int slot)
+unsigned long ATECCX08A::getCommandClock()
 {
-  int keyConfig;
-	int offset;
+	if (commandClock != NULL)
+		return commandClock();
+	return transport->micros();
+}
 
-	offset = 96 + slot * 2;
-  keyConfig = configZone[offset] + configZone[offset+1] * 256;
-	return keyConfig;
+// time in ms since the command was sent
+unsigned long ATECCX08A::getCommandElapsed()
+{
+	if (commandClock != NULL)
+		return commandClock() - commandStart;
+	return (transport->micros() - commandStart) / 1000;
 }
 
 /** \brief
 
-	createSignature(uint8_t *data, uint16_t slot)
+	executeCommand(uint8_t opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length,
+	               uint8_t responseLength, uint8_t command, boolean debug)
 
-    Creates a 64-byte ECC signature on 32 bytes of data.
-	Defautes to use private key located in slot 0.
-	
-	Note, the IC actually needs you to store your data in a temporary memory location
-	called TempKey. This function first loads TempKey, and then signs TempKey. Then it 
-	receives the signature and copies it to signature[].
+	Blocking version of submitCommand(): waits for the execution time and receives the response,
+	which is left in inputBuffer for the caller.
 */
 
-boolean ATECCX08A::createSignature(uint8_t *signature, int size, const uint8_t *data, uint16_t slot, boolean debug)
+boolean ATECCX08A::executeCommand(uint8_t opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length, uint8_t responseLength, uint8_t command, boolean debug)
 {
-  boolean loadTempKeyResult = loadTempKey(data);
-  boolean signTempKeyResult = signTempKey(signature, size, slot);
-	
-	// Serial.println("createSignature for slot : " + String(slot));
-	// Serial.println("loadTempKeyResult: " + String(loadTempKeyResult) + ", signTempKeyResult: " + String(signTempKeyResult));
-  if (loadTempKeyResult && signTempKeyResult) 
-		return true;
-  else 
+	if (submitCommand(opcode, param1, param2, data, length, responseLength, command) == false)
 		return false;
+	return waitCommand(debug);
 }
 
 /** \brief
 
-	loadTempKey(uint8_t *data)
-
-	Writes 32 bytes of data to memory location "TempKey" on the IC.
-	Note, the data is provided externally by you, the user, and is included in the
-	command NONCE.
+	waitCommand(boolean debug)
 
-    We will use the NONCE command in passthrough mode to load tempKey with our data (aka message).
-    Note, the datasheet warns that this does not provide protection agains replay attacks,
-    but we will protect again this because our server (Bob) is going to send us it's own unique random TOKEN,
-    when it requests data, and this will allow us to create a unique data + signature for every communication.
+	Waits for the rest of the execution time of the submitted command and finishes it.
+	The state goes back to ATECC_COMMAND_IDLE, the response stays in inputBuffer.
 */
 
-boolean ATECCX08A::loadTempKey(const uint8_t *data)
+boolean ATECCX08A::waitCommand(boolean debug)
 {
-  sendCommand(COMMAND_OPCODE_NONCE, NONCE_MODE_PASSTHROUGH, 0x0000, data, 32);
-  
-  // note, param2 is 0x0000 (and param1 is PASSTHROUGH), so OutData will be just a single byte of zero upon completion.
-  // see ds pg 77 for more info
-
-  delay(7); // time for IC to process command and exectute
+	unsigned long elapsed;
+	boolean result;
 
-  // Now let's read back from the IC.
-  
-  if (receiveResponseData(4) == false) 
+	if (commandState == ATECC_COMMAND_IDLE)
 	{
-  	setStatus(STATUS_EXECUTION_ERROR);
-		return false; // responds with "0x00" if NONCE executed properly
+		setStatus(STATUS_INVALID_PARAMETER);
+		return false;
 	}
-  idleMode();
-  boolean checkCountResult = checkCount();
-  boolean checkCrcResult = checkCrc();
-  
-  if ( (checkCountResult == false) || (checkCrcResult == false) ) 
+	if (commandState == ATECC_COMMAND_BUSY)
 	{
-		setStatus(STATUS_EXECUTION_ERROR);
-		return false;
+		elapsed = getCommandElapsed();
+		if (elapsed < getExecutionTime(commandTiming))
+			transport->delayMicroseconds((getExecutionTime(commandTiming) - elapsed) * 1000UL); // time for IC to process command and execute
+		finishCommand(debug);
 	}
-
-	setStatus(inputBuffer[1]);
-   if (inputBuffer[1] == 0x00) 
-		 return true;   // If we hear a "0x00", that means it had a successful nonce
-  else 
-		return false;
+	result = (commandState == ATECC_COMMAND_DONE);
+	commandState = ATECC_COMMAND_IDLE;
+	return result;
 }
 
 /** \brief
 
-	signTempKey(uint16_t slot)
+	finishCommand(boolean debug)
 
-	Create a 64 byte ECC signature for the contents of TempKey using the private key in slot.
-	Default slot is 0.
-	
-	The response from this command (the signature) is stored in global varaible signature[].
+	Receives and checks the response of the submitted command and calls the callback.
 */
 
-boolean ATECCX08A::signTempKey(uint8_t *signature, int size, uint16_t slot, boolean debug)
+boolean ATECCX08A::finishCommand(boolean debug)
 {
-  sendCommand(COMMAND_OPCODE_SIGN, SIGN_MODE_TEMPKEY, slot);
-
-  delay(70); // time for IC to process command and execute
+	boolean result;
+	uint8_t checkedLength;
 
-  // Now let's read back from the IC.
-  
-  if (receiveResponseData(64 + 2 + 1, debug) == false) 
+	if (commandResponseLength & ATECC_RESPONSE_VARIABLE)
+		result = receiveVariableResponseData(commandResponseLength & ~ATECC_RESPONSE_VARIABLE, debug);
+	else
 	{
-  	return false; // signature (64), plus crc (2), plus count (1)
+		result = receiveResponseData(commandResponseLength, debug);
+		if (result == false)
+			setStatus(STATUS_TIMEOUT_ERROR);
 	}
-  idleMode();
-  boolean checkCountResult = checkCount();
-  boolean checkCrcResult = checkCrc();
-	
-  // update signature[] array and print it to serial terminal nicely formatted for easy copy/pasting between sketches
-  if (checkCountResult && checkCrcResult) // check that it was a good message
-  {  
-    // we don't need the count value (which is currently the first byte of the inputBuffer)
-    for (int i = 0 ; i < 64 ; i++) // for loop through to grab all but the first position (which is "count" of the message)
-    {
-      signature[i] = inputBuffer[i + 1];
-    }
-  
-	  if (debug == true)
-		{
-			_debugSerial->println();
-			_debugSerial->println("uint8_t signature[64] = {");
-			for (int i = 0; i < 64 ; i++)
-			{
-				_debugSerial->print("0x");
-				if ((signature[i] >> 4) == 0) _debugSerial->print("0"); // print preceeding high nibble if it's zero
-					_debugSerial->print(signature[i], HEX);
-				if (i != 63) 
-					_debugSerial->print(", ");
-				if ((63-i) % 16 == 0) 
-					_debugSerial->println();
-			}
-			_debugSerial->println("};");
-		}
+	idleMode();
+	// the IC answers with a status instead of the data if the command failed
+	if (result == true && inputBuffer[RESPONSE_COUNT_INDEX] == RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE)
+		countGlobal = RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE;
+	// checkCount() and checkCrc() set STATUS_MESSAGE_COUNT_ERROR and STATUS_MESSAGE_CRC_ERROR
+	if (result == true && checkCount(debug) == false)
+		result = false;
+	if (result == true && checkCrc(debug) == false)
+		result = false;
+	// the data (or the status byte) of a response which passed the count and CRC checks
+	checkedLength = result ? countGlobal - RESPONSE_COUNT_SIZE - CRC_SIZE : 0;
+	if (result == true && countGlobal == RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE)
+	{
+		setStatus(inputBuffer[RESPONSE_SIGNAL_INDEX]); // a status response, 0x00 is success
+		result = (inputBuffer[RESPONSE_SIGNAL_INDEX] == STATUS_SUCCESS);
+	}
+	else if (result == true)
 		setStatus(STATUS_SUCCESS);
-	  return true;
-  }
-  else 
+
+	commandState = result ? ATECC_COMMAND_DONE : ATECC_COMMAND_FAILED;
+#if ATECC_ENABLE_METRICS
+	recordMetrics(result);
+#endif
+	if (log != NULL)
+		log->add(logOpcode, logParam1, logParam2, commandTiming, getStatus(), result, logStart,
+		         transport->micros() - logStart, &inputBuffer[RESPONSE_READ_INDEX], checkedLength);
+	if (commandCallback != NULL)
+		commandCallback(this, result, commandContext);
+	return result;
+}
+
+#if ATECC_ENABLE_METRICS
+// adds the finished command to its metrics
+void ATECCX08A::recordMetrics(boolean success)
+{
+	ATECCCommandMetrics &entry = metrics.command[commandTiming];
+	uint32_t latency = transport->micros() - metricsStart;
+
+	entry.totalLatency += latency;
+	if (latency > entry.maxLatency)
+		entry.maxLatency = latency;
+	entry.retries += metricsRetries;
+	if (success == true)
+		return;
+	entry.failures++;
+	switch (getStatus())
 	{
-		setStatus(STATUS_EXECUTION_ERROR);
-		return false;
+		case STATUS_TIMEOUT_ERROR:       entry.timeouts++;       break;
+		case STATUS_MESSAGE_COUNT_ERROR: entry.countErrors++;    break;
+		case STATUS_MESSAGE_CRC_ERROR:   entry.crcErrors++;      break;
+		case STATUS_WATCHDOG_EXPIRATION: entry.watchdogErrors++; break;
 	}
 }
 
 /** \brief
 
-	verifySignature(uint8_t *message, uint8_t *signature, uint8_t *publicKey)
-	
-	Verifies a ECC signature using the message, signature and external public key.
-	Returns true if successful.
-	
-	Note, it acutally uses loadTempKey, then uses the verify command in "external public key" mode.
+	getMetrics(ATECCMetrics &metrics, boolean reset)
+
+	Copies the counters of all commands since the start (or the last reset) to metrics:
+	per command (ATECC_CMD_*) the number of commands and failures, the latency from submitting
+	the command until its response was checked (sum and maximum, us), the I2C reads that had
+	to be repeated and the errors by cause. With reset the counters start again from zero,
+	read them regularly that way as totalLatency wraps after about 71 minutes of command time.
+	Only available with ATECC_ENABLE_METRICS 1, without it the counters cost nothing.
 */
 
-boolean ATECCX08A::verifySignature(const uint8_t *message, const uint8_t *signature, const uint8_t *publicKey)
+void ATECCX08A::getMetrics(ATECCMetrics &metrics, boolean reset)
 {
-  // first, let's load the message into TempKey on the device, this uses NONCE command in passthrough mode.
-  boolean loadTempKeyResult = loadTempKey(message);
-  if (loadTempKeyResult == false) 
-  {
-    _debugSerial->println("Load TempKey Failure");
-    return false;
-  }
+	metrics = this->metrics;
+	if (reset == true)
+		resetMetrics();
+}
 
-  // We can only send one *single* data array to sendCommand as Param2, so we need to combine signature and public key.
-  uint8_t data_sigAndPub[128]; 
-  memcpy(&data_sigAndPub[0], &signature[0], 64);	// append signature
-  memcpy(&data_sigAndPub[64], &publicKey[0], 64);	// append external public key
-  
-  sendCommand(COMMAND_OPCODE_VERIFY, VERIFY_MODE_EXTERNAL, VERIFY_PARAM2_KEYTYPE_ECC, data_sigAndPub, sizeof(data_sigAndPub));
-	
+void ATECCX08A::resetMetrics()
+{
+	memset(&metrics, 0, sizeof(metrics));
+}
+#endif
 
-  delay(58); // time for IC to process command and exectute
+/** \brief
 
-  // Now let's read back from the IC.
-  
-  if (receiveResponseData(4, false) == false) 
-	{
-    _debugSerial->println("receiveResponseData(4) Failure");
-		setStatus(STATUS_EXECUTION_ERROR);
-		return false;
-	}
-  idleMode();
-  boolean checkCountResult = checkCount(false);
-  boolean checkCrcResult = checkCrc(false);
-  
-  if ((checkCountResult == false) || (checkCrcResult == false)) 
-	{
-		setStatus(STATUS_EXECUTION_ERROR);
-		return false;
-	}
-  
-	setStatus(inputBuffer[1]);
-  if (inputBuffer[1] == 0x00) 
-		return true;   // If we hear a "0x00", that means it had a successful verify
-  else 
-		return false;
+	getClockDivider() / getWatchdogTimeout()
+
+	getClockDivider() returns the clock divider (CHIP_MODE_CLOCK_DIVIDER_*) the execution times
+	are based on, read from ChipMode by begin(). getWatchdogTimeout() returns the watchdog 
+	timeout in ms selected by ChipMode, which limits the length of a session.
+*/
+
+uint8_t ATECCX08A::getClockDivider()
+{
+	return clockDivider;
 }
 
+uint16_t ATECCX08A::getWatchdogTimeout()
+{
+	if (ensureConfigZone() == true && (config.chipMode & CHIP_MODE_WATCHDOG_10S))
+		return WATCHDOG_TIMEOUT_LONG;
+	return WATCHDOG_TIMEOUT_SHORT;
+}
 
 /** \brief
 
-	sendCommand(uint8_t command_opcode, uint8_t param1, uint16_t param2, uint8_t *data, size_t length_of_data)
-	
-	Generic function for sending commands to the IC. 
-	
-	This function handles creating the "total transmission" to the IC.
-	This contains WORD_ADDRESS_VALUE, COUNT, OPCODE, PARAM1, PARAM2, DATA (optional), and CRCs.
-	
-	Note, it always calls the "wake()" function, assuming that you have let the IC fall asleep (default 1.7 sec)
-	
-	Note, for anything other than a command (reset, sleep and idle), you need a different "Word Address Value",
-	So those specific transmissions are handled in unique functions.
+	setChipMode(uint8_t clockDivider, boolean longWatchdog)
+
+	Writes the clock divider (CHIP_MODE_CLOCK_DIVIDER_*, ATECC608A only) and the watchdog timeout 
+	(10 s instead of 1.3 s) to ChipMode. The other ChipMode bits are kept. Only possible while 
+	the configuration zone is unlocked. A slower clock needs less power and longer waits.
+	The IC may keep running with the old clock until it is power cycled, so until begin() is 
+	called again the waits are based on the slower one of the old and the new clock divider.
 */
 
-boolean ATECCX08A::sendCommand(uint8_t command_opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length_of_data, boolean debug)
+boolean ATECCX08A::setChipMode(uint8_t clockDivider, boolean longWatchdog)
 {
-  // build packet array (total_transmission) to send a communication to IC, with opcode COMMAND
-  // It expects to see: word address, count, command opcode, param1, param2, data (optional), CRC[0], CRC[1]
-  
-  uint8_t total_transmission_length;
-  total_transmission_length = (1 +1 +1 +1 +2 +length_of_data +2); 
-  // word address val (1) + count (1) + command opcode (1) param1 (1) + param2 (2) data (0-?) + crc (2)
+	uint8_t word[4];
+	uint8_t previous = this->clockDivider;
 
-  uint8_t total_transmission[total_transmission_length];
-  total_transmission[0] = WORD_ADDRESS_VALUE_COMMAND; 		// word address value (type command)
-  total_transmission[1] = total_transmission_length-1; 		// count, does not include itself, so "-1"
-  total_transmission[2] = command_opcode; 			// command
-  total_transmission[3] = param1;							// param1
-  memcpy(&total_transmission[4], &param2, sizeof(param2));	// append param2 
-  memcpy(&total_transmission[6], &data[0], length_of_data);	// append data
-  
-  // update CRCs
-  uint8_t packet_to_CRC[total_transmission_length-3]; // minus word address (1) and crc (2).
-  memcpy(&packet_to_CRC[0], &total_transmission[1], (total_transmission_length-3)); // copy over just what we need to CRC starting at index 1
-  
-	if (debug == true)
+	if (clockDivider != CHIP_MODE_CLOCK_DIVIDER_M0 && clockDivider != CHIP_MODE_CLOCK_DIVIDER_M1 && clockDivider != CHIP_MODE_CLOCK_DIVIDER_M2)
 	{
-    _debugSerial->println("packet_to_CRC: ");
-    for (int i = 0; i < sizeof(packet_to_CRC) ; i++)
-    {
-      _debugSerial->print(packet_to_CRC[i], HEX);
-      _debugSerial->print(",");
-    }
-    _debugSerial->println();
+		setStatus(STATUS_INVALID_PARAMETER);
+		return false;
 	}
-  
-  atca_calculate_crc((total_transmission_length-3), packet_to_CRC); // count includes crc[0] and crc[1], so we must subtract 2 before creating crc
-	if (debug == true)
+	if (clockDivider != CHIP_MODE_CLOCK_DIVIDER_M0 && isATECC608A() == false)
 	{
-    _debugSerial->println(crc[0], HEX);
-    _debugSerial->println(crc[1], HEX);
+		setStatus(STATUS_NOT_SUPPORTED);
+		return false;
+	}
+	if (ensureConfigZone() == false)
+		return false;
+	if (config.configLocked == true)
+	{
+		setStatus(STATUS_EXECUTION_ERROR);
+		return false;
 	}
 
-  memcpy(&total_transmission[total_transmission_length-2], &crc[0], 2);  // append crcs
-  wakeUp();
-  _i2cPort->beginTransmission(_i2caddr);
-  _i2cPort->write(total_transmission, total_transmission_length); 
-  _i2cPort->endTransmission();
-  
-  return true;
+	// ChipMode is the last byte of word 4 (I2C address, reserved/CountMatch, OTP mode, ChipMode)
+	memcpy(word, &configZone[CONFIG_ZONE_I2C_ADDRESS], 4);
+	word[3] = (word[3] & (CHIP_MODE_I2C_USER_EXTRA_ADD | CHIP_MODE_TTL_ENABLE)) | (longWatchdog ? CHIP_MODE_WATCHDOG_10S : 0) | clockDivider;
+	if (write(ZONE_CONFIG, CONFIG_ZONE_I2C_ADDRESS / 4, word, 4) == false)
+		return false;
+
+	if (findDeviceProfile(deviceModel, clockDivider)->executionTime[ATECC_CMD_SIGN] > 
+	    findDeviceProfile(deviceModel, previous)->executionTime[ATECC_CMD_SIGN])
+		this->clockDivider = clockDivider;
+	return true;
 }
 
+/** \brief
 
-boolean ATECCX08A::beginSHA256()
-{
-	boolean result;
-	
-	result = sendCommand(COMMAND_OPCODE_SHA, SHA_START, 0, NULL, 0, false);
-	return result;
-}
+	estimateLatency(uint8_t model, uint8_t clockDivider, const uint8_t *commands, int count, boolean oneSession)
 
+	Host side latency model: returns the time in microseconds the library needs for the count
+	commands (ATECC_CMD_*) in commands on model with clockDivider. It adds the worst case execution
+	times and the wake time (once if the commands run in one session, else once per command).
+	The I2C transfers are not included. Compare the clock dividers with it to find the fastest 
+	one the power budget allows.
+*/
 
-boolean ATECCX08A::updateSHA256(const uint8_t *plainText, int length)
+uint32_t ATECCX08A::estimateLatency(uint8_t model, uint8_t clockDivider, const uint8_t *commands, int count, boolean oneSession)
 {
-	boolean result;
-	int i;
-	size_t chunks = length / SHA_BLOCK_SIZE + !!(length % SHA_BLOCK_SIZE);
-	
-  if ((length % SHA_BLOCK_SIZE) == 0) 
-		chunks += 1; // END command can only accept up to 63 bytes, so we must add a "blank chunk" for the end command
+	const ATECCDeviceProfile *profile = findDeviceProfile(model, clockDivider);
+	uint32_t latency = 0;
 
-  // Serial.print("chunks:");
-  // Serial.println(chunks);
-
-	/* Divide into blocks of 64 bytes per chunk */
-	for (i = 0; i < chunks; ++i)
+	for (int i = 0; i < count; i++)
 	{
-		size_t data_size = SHA_BLOCK_SIZE;
-		uint8_t chunk[SHA_BLOCK_SIZE];
-
-		delay(9);
-		if (!receiveResponseData(RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE))
-		{
-			setStatus(STATUS_EXECUTION_ERROR);
-			return false;
-		}
-		idleMode();
-		if (!checkCount() || !checkCrc())
-		{
-			setStatus(STATUS_EXECUTION_ERROR);
-			return false;
-		}
-		// If we hear a "0x00", that means it had a successful load
-		if (inputBuffer[RESPONSE_SIGNAL_INDEX] != ATRCC508A_SUCCESSFUL_SHA)
-		{
-			setStatus(inputBuffer[RESPONSE_SIGNAL_INDEX]);
-			return false;
-		}
-		if (i + 1 == chunks) // if we're on the last chunk, there will be a remainder or 0 (and 0 is okay for an end command)
-			data_size = length % SHA_BLOCK_SIZE;
-
-		/* Send next */
-		if (!sendCommand(COMMAND_OPCODE_SHA, (i + 1 != chunks) ? SHA_UPDATE : SHA_END, data_size, plainText + i * SHA_BLOCK_SIZE, data_size, false))
-			return false;
+		if (commands[i] < ATECC_CMD_COUNT)
+			latency += (uint32_t) profile->executionTime[commands[i]] * 1000;
+		if (oneSession == false || i == 0)
+			latency += WAKE_TIME_US;
 	}
-	return true;
+	return latency;
 }
 
+/** \brief
+
+	generateMAC(const uint8_t *challenge, uint16_t slot, uint8_t *response, int size, boolean debug)
 
-boolean ATECCX08A::endSHA256(uint8_t *hash, int size)
+	Uses the MAC command to calculate SHA-256(key in slot, 32 byte challenge, ...).
+	This is the prover side of a symmetric challenge-response authentication. The verifier 
+	needs the same key in one of its slots and checks the response with checkMAC().
+	Much faster than signing the challenge with ECDSA, but both sides have to share the key.
+*/
+
+boolean ATECCX08A::generateMAC(const uint8_t *challenge, uint16_t slot, uint8_t *response, int size, boolean debug)
 {
-	/* Read digest */
-	delay(9);
-	if (!receiveResponseData(RESPONSE_COUNT_SIZE + RESPONSE_SHA_SIZE + CRC_SIZE))
+	if (challenge == NULL || response == NULL || slot > 15)
 	{
+		setStatus(STATUS_INVALID_PARAMETER);
 		return false;
 	}
-
-	idleMode();
-	if (!checkCount() || !checkCrc())
+	if (size < MAC_RESPONSE_SIZE)
 	{
+		setStatus(STATUS_INPUT_BUFFER_TOO_SMALL);
 		return false;
 	}
 
-	/* Copy digest */
-	for (int i = 0; i < SHA256_SIZE; ++i)
-	{
-		hash[i] = inputBuffer[RESPONSE_SHA_INDEX + i];
-	}
+	// the IC responds with count (1), digest (32), crc (2)
+	if (executeCommand(COMMAND_OPCODE_MAC, MAC_MODE_CHALLENGE, slot, challenge, MAC_CHALLENGE_SIZE, RESPONSE_COUNT_SIZE + MAC_RESPONSE_SIZE + CRC_SIZE, ATECC_CMD_MAC, debug) == false)
+		return false;
 
-	setStatus(STATUS_SUCCESS);
+	memcpy(response, &inputBuffer[RESPONSE_READ_INDEX], MAC_RESPONSE_SIZE);
 	return true;
 }
 
-boolean ATECCX08A::sha256(const uint8_t *plain, size_t len, uint8_t *hash)
+/** \brief
+
+	checkMAC(const uint8_t *challenge, const uint8_t *response, uint16_t slot, boolean debug)
+
+	Uses the CheckMac command to verify a response that another device created with generateMAC()
+	for challenge. slot must contain the same key as the slot used by the prover.
+	Returns true if the response matches.
+*/
+
+boolean ATECCX08A::checkMAC(const uint8_t *challenge, const uint8_t *response, uint16_t slot, boolean debug)
 {
-	boolean result;
-	
-	result = beginSHA256();
-	if (result == false)
+	uint8_t data[MAC_CHALLENGE_SIZE + MAC_RESPONSE_SIZE + CHECKMAC_OTHER_DATA_SIZE];
+	uint8_t *otherData = &data[MAC_CHALLENGE_SIZE + MAC_RESPONSE_SIZE];
+
+	if (challenge == NULL || response == NULL || slot > 15)
+	{
+		setStatus(STATUS_INVALID_PARAMETER);
 		return false;
+	}
 
-  result = updateSHA256(plain, len);
-	if (result == false)
-		return result;
-		
-	/* Read digest */
-	result = endSHA256(hash, SHA256_SIZE);
-	return result;
+	// ClientChal, ClientResp and OtherData. OtherData holds the opcode, mode and key id the prover used
+	// with the MAC command, the optional OTP and serial number bytes are not included by MAC_MODE_CHALLENGE.
+	memcpy(&data[0], challenge, MAC_CHALLENGE_SIZE);
+	memcpy(&data[MAC_CHALLENGE_SIZE], response, MAC_RESPONSE_SIZE);
+	memset(otherData, 0, CHECKMAC_OTHER_DATA_SIZE);
+	otherData[0] = COMMAND_OPCODE_MAC;
+	otherData[1] = MAC_MODE_CHALLENGE;
+	otherData[2] = (uint8_t) (slot & 0x00FF);
+	otherData[3] = (uint8_t) (slot >> 8);
+
+	// 0x00 = match, 0x01 = CHECKMAC_MISMATCH
+	return executeCommand(COMMAND_OPCODE_CHECKMAC, CHECKMAC_MODE_CHALLENGE, slot, data, sizeof(data), RESPONSE_COUNT_SIZE + RESPONSE_SIGNAL_SIZE + CRC_SIZE, ATECC_CMD_CHECKMAC, debug);
 }
 
 
@@ -1353,154 +2798,230 @@ boolean ATECCX08A::encryptDecryptBlock(const uint8_t *input, int inputSize, uint
 		setStatus(STATUS_INVALID_PARAMETER);
 		return false;
 	}
+	if (hasFeature(ATECC_FEATURE_AES) == false)
+	{
+		setStatus(STATUS_NOT_SUPPORTED);
+		return false;
+	}
 	
-	if (slot < 0 || slot > 15)
+	if (slot > 15)
 	{
 		setStatus(STATUS_INVALID_PARAMETER);
 		return false;
 	}
 	
-	if (keyIndex < 0 || keyIndex > 3)
+	if (keyIndex > 3)
 	{
 		setStatus(STATUS_INVALID_PARAMETER);
 		return false;
 	}
 
 	mode |= (keyIndex << 6);
-	if (debug)
+	if (ATECC_DEBUG_OUTPUT(debug))
 	{
 		if ((mode & AES_ENCRYPT) == AES_ENCRYPT)
 		  _debugSerial->println("Encryption:");
 		else
 		  _debugSerial->println("Decryption:");
-/*		
-		_debugSerial->println("size cleartext : " + String(sizeClearText));
-		_debugSerial->println("Slot           : " + String(slot));
-		_debugSerial->println("KeyIndex       : " + String(keyIndex));
-		_debugSerial->println("Mode           : " + String(mode));
-		_debugSerial->print("Input data     : " );
-		for (int index = 0; index < AES_BLOCKSIZE; index++)
-		{
-			printHexValue(clearText[index]);
-		}
-		_debugSerial->println();
-*/		
+		printHexValue(input, AES_BLOCKSIZE, ", ");
 	}
 	
-  sendCommand(COMMAND_OPCODE_AES, mode, slot, input, inputSize, false);
-
-  delay(10); // time for IC to process command and execute
-
-  // Now let's read the response 
 	size = 1 + AES_BLOCKSIZE + 2;  // length byte, encrypted data (16 bytes), crc (2 bytes)
-  if (receiveResponseData(size, false) == false)
+  if (executeCommand(COMMAND_OPCODE_AES, mode, slot, input, inputSize, size, ATECC_CMD_AES) == false)
 	{ 
-    _debugSerial->println("receiveResponseData return false");
-		setStatus(STATUS_EXECUTION_ERROR);
-    return false; // encrypted data (16), plus crc (2), plus count (1)
+		if (ATECC_DEBUG_ERROR_OUTPUT)
+			_debugSerial->println("AES command failed");
+    return false;
 	}
-  idleMode();
-  boolean checkCountResult = checkCount(false);
-  boolean checkCrcResult = checkCrc(false);
-  
-  if (checkCountResult && checkCrcResult) // check that it was a good message
-  {  
-    // ignore first byte (length byte), so we start from offset 1
-		memcpy(output, &inputBuffer[1], AES_BLOCKSIZE);
-		if (debug)
-		{
-			_debugSerial->println("output data:");
-			_debugSerial->println();
-			printHexValue(output, AES_BLOCKSIZE, ", ");
-		}
-  	setStatus(STATUS_SUCCESS);
-  	return true;
-  }
-  else 
+
+  // ignore first byte (length byte), so we start from offset 1
+	memcpy(output, &inputBuffer[1], AES_BLOCKSIZE);
+	if (ATECC_DEBUG_OUTPUT(debug))
 	{
-     _debugSerial->println("checkCount() or checkCrc() returned false");
-  	setStatus(STATUS_EXECUTION_ERROR);
-		return false;
+		_debugSerial->println("output data:");
+		printHexValue(output, AES_BLOCKSIZE, ", ");
 	}
+	return true;
 }
 
 
+/** \brief
 
-boolean ATECCX08A::getSlotLockStatus(uint16_t slot)
-{
-	byte configByte;
-	int  bitPosition;
-	bool result;
+	kdf(uint8_t mode, uint16_t keyId, uint32_t details, const uint8_t *message, int messageLength, uint8_t *output, int outputSize, boolean debug)
+
+	Sends the KDF command (ATECC608A only). One command derives a complete key with HKDF, the TLS PRF 
+	or AES, instead of running the derivation on the host with repeated SHA commands.
+	
+	mode    : algorithm | target | source (see KDF_MODE_xxx)
+	keyId   : bits 0-7 source slot, bits 8-15 target slot
+	details : algorithm specific details (see KDF_DETAILS_xxx). For PRF and HKDF the message length
+	          is put into bits 24-31 by this function, for AES the message must be 16 bytes.
 	
-	if (slot > 16)
+	The derived key is only returned when the target is KDF_MODE_TARGET_OUTPUT or KDF_MODE_TARGET_OUTPUT_ENC.
+	Otherwise it stays in TempKey, the alternate key buffer or the target slot, where it can be used directly 
+	by the following commands (e.g. encryptDecryptBlock() with the target slot, or signTempKey()).
+	For the encrypted output the 32 byte output nonce is appended to the key in output.
+*/
+
+boolean ATECCX08A::kdf(uint8_t mode, uint16_t keyId, uint32_t details, const uint8_t *message, int messageLength, uint8_t *output, int outputSize, boolean debug)
+{
+	uint8_t data[KDF_DETAILS_SIZE + KDF_MESSAGE_MAX_SIZE];
+	uint8_t target = mode & KDF_MODE_TARGET_MASK;
+	int     keySize = KDF_OUTPUT_SIZE;
+	int     size;
+
+	// an empty message (e.g. HKDF without info) needs no buffer
+	if ((message == NULL && messageLength > 0) || messageLength < 0 || messageLength > KDF_MESSAGE_MAX_SIZE)
 	{
+		setStatus(STATUS_INVALID_PARAMETER);
 		return false;
 	}
-	
-	if (slot < 8)
+	if (hasFeature(ATECC_FEATURE_KDF) == false)
 	{
-	  configByte = configZone[CONFIG_ZONE_SLOTS_LOCK0];
-		bitPosition = slot;
+		setStatus(STATUS_NOT_SUPPORTED);
+		return false;
 	}
-	else
+
+	if ((mode & KDF_MODE_ALG_MASK) == KDF_MODE_ALG_AES)
 	{
-	  configByte = configZone[CONFIG_ZONE_SLOTS_LOCK1];
-		bitPosition = slot - 8;
+		if (messageLength != AES_BLOCKSIZE)
+		{
+			setStatus(STATUS_INVALID_PARAMETER);
+			return false;
+		}
 	}
-	
-	if ((configByte & (1 << bitPosition)) == 0)
+	else
 	{
-		result = true;
+		details = (details & 0x00FFFFFF) | ((uint32_t) messageLength << 24);
+		if ((mode & KDF_MODE_ALG_MASK) == KDF_MODE_ALG_PRF && (details & KDF_DETAILS_PRF_TARGET_LEN_64))
+			keySize = 2 * KDF_OUTPUT_SIZE;
 	}
+
+	// size of the response data, the key is only returned for the output targets
+	if (target == KDF_MODE_TARGET_OUTPUT)
+		size = keySize;
+	else if (target == KDF_MODE_TARGET_OUTPUT_ENC)
+		size = keySize + KDF_NONCE_SIZE;
 	else
+		size = RESPONSE_SIGNAL_SIZE;
+
+	if (size > RESPONSE_SIGNAL_SIZE)
 	{
-		result = false;
+		if (output == NULL)
+		{
+			setStatus(STATUS_INVALID_PARAMETER);
+			return false;
+		}
+		if (outputSize < size)
+		{
+			setStatus(STATUS_INPUT_BUFFER_TOO_SMALL);
+			return false;
+		}
 	}
-	return result;
+
+	// details are sent little endian, followed by the message
+	data[0] = (uint8_t) (details);
+	data[1] = (uint8_t) (details >> 8);
+	data[2] = (uint8_t) (details >> 16);
+	data[3] = (uint8_t) (details >> 24);
+	if (messageLength > 0)
+		memcpy(&data[KDF_DETAILS_SIZE], message, messageLength);
+
+	if (target == KDF_MODE_TARGET_SLOT)
+		invalidateCachedSlot(keyId >> 8); // the target slot gets overwritten
+	// the IC responds with count (1), status or key (and nonce), crc (2)
+	// If we hear a "0x00" as status, the key has been derived into its target
+	if (executeCommand(COMMAND_OPCODE_KDF, mode, keyId, data, KDF_DETAILS_SIZE + messageLength, RESPONSE_COUNT_SIZE + size + CRC_SIZE,
+	                   ((mode & KDF_MODE_ALG_MASK) == KDF_MODE_ALG_AES) ? ATECC_CMD_AES : ATECC_CMD_KDF, debug) == false) // KDF: HKDF and PRF worst case
+		return false;
+
+	if (size > RESPONSE_SIGNAL_SIZE)
+		memcpy(output, &inputBuffer[RESPONSE_READ_INDEX], size);
+	return true;
 }
 
-boolean ATECCX08A::isSlotLocked(uint16_t slot)
+/** \brief
+
+	deriveKeyHKDF(...)
+
+	Derives a key with HKDF-Expand from the input key in source/sourceSlot, using info as message.
+*/
+
+boolean ATECCX08A::deriveKeyHKDF(uint8_t source, uint16_t sourceSlot, uint8_t target, uint16_t targetSlot, const uint8_t *info, int infoLength, uint8_t *output, int outputSize, boolean debug)
 {
-	byte configByte;
-	int  bitPosition;
-	bool result;
-	
-	if (slot > 16)
+	uint8_t  mode = KDF_MODE_ALG_HKDF | (target & KDF_MODE_TARGET_MASK) | (source & 0x03);
+	uint16_t keyId = (sourceSlot & 0x00FF) | (targetSlot << 8);
+
+	return kdf(mode, keyId, KDF_DETAILS_HKDF_MSG_LOC_INPUT, info, infoLength, output, outputSize, debug);
+}
+
+/** \brief
+
+	deriveKeyPRF(...)
+
+	Derives a 32 byte key with the TLS 1.2 PRF from the 32 byte input key in source/sourceSlot.
+	labelSeed is the concatenation of label and seed.
+*/
+
+boolean ATECCX08A::deriveKeyPRF(uint8_t source, uint16_t sourceSlot, uint8_t target, uint16_t targetSlot, const uint8_t *labelSeed, int labelSeedLength, uint8_t *output, int outputSize, boolean debug)
+{
+	uint8_t  mode = KDF_MODE_ALG_PRF | (target & KDF_MODE_TARGET_MASK) | (source & 0x03);
+	uint16_t keyId = (sourceSlot & 0x00FF) | (targetSlot << 8);
+
+	return kdf(mode, keyId, KDF_DETAILS_PRF_KEY_LEN_32 | KDF_DETAILS_PRF_TARGET_LEN_32, labelSeed, labelSeedLength, output, outputSize, debug);
+}
+
+/** \brief
+
+	deriveKeyAES(...)
+
+	Derives a key by encrypting the 16 byte message with the AES key keyIndex of the input key in source/sourceSlot.
+*/
+
+boolean ATECCX08A::deriveKeyAES(uint8_t source, uint16_t sourceSlot, uint8_t keyIndex, uint8_t target, uint16_t targetSlot, const uint8_t *message, int messageLength, uint8_t *output, int outputSize, boolean debug)
+{
+	uint8_t  mode = KDF_MODE_ALG_AES | (target & KDF_MODE_TARGET_MASK) | (source & 0x03);
+	uint16_t keyId = (sourceSlot & 0x00FF) | (targetSlot << 8);
+
+	if (keyIndex > 3)
 	{
+		setStatus(STATUS_INVALID_PARAMETER);
 		return false;
 	}
-	
-	if (slot < 8)
-	{
-	  configByte = configZone[CONFIG_ZONE_SLOTS_LOCK0];
-		bitPosition = slot;
-	}
-	else
-	{
-	  configByte = configZone[CONFIG_ZONE_SLOTS_LOCK1];
-		bitPosition = slot - 8;
-	}
-	
-	if ((configByte & (1 << bitPosition)) == 0)
-	{
-		result = true;
-	}
-	else
+	return kdf(mode, keyId, keyIndex & KDF_DETAILS_AES_KEY_INDEX_MASK, message, messageLength, output, outputSize, debug);
+}
+
+
+/** \brief
+
+	getSlotLockStatus(uint16_t slot) / isSlotLocked(uint16_t slot)
+
+	Return true if slot is locked (from the cached configuration zone).
+*/
+
+boolean ATECCX08A::getSlotLockStatus(uint16_t slot)
+{
+	return isSlotLocked(slot);
+}
+
+boolean ATECCX08A::isSlotLocked(uint16_t slot)
+{
+	if (slot > 15 || ensureConfigZone() == false)
 	{
-		result = false;
+		return false;
 	}
-	return result;
+	return (config.slotsLocked & (1 << slot)) != 0;
 }
 
 
 boolean ATECCX08A::getConfigLockStatus()
 {
-  return configLockStatus;	
+  return ensureConfigZone() && config.configLocked;	
 }
 
 boolean ATECCX08A::getDataOTPLockStatus()
 {
-  return dataOTPLockStatus;	
+  return ensureConfigZone() && config.dataOTPLocked;	
 }
 
 byte   * ATECCX08A::getConfigZone()
@@ -1510,28 +3031,42 @@ byte   * ATECCX08A::getConfigZone()
 
 boolean ATECCX08A::isAESEnabled()
 {
-	return configZone[CONFIG_ZONE_AES_STATUS];
+	return ensureConfigZone() && (config.aesEnable & 0x01);
+}
+
+uint8_t ATECCX08A::getI2CAddress()
+{
+	if (ensureConfigZone() == false)
+		return 0;
+	return config.i2cAddress >> 1; // the config zone holds the address shifted left by one
+}
+
+uint8_t ATECCX08A::getChipMode()
+{
+	if (ensureConfigZone() == false)
+		return 0;
+	return config.chipMode;
 }
 
 
 boolean ATECCX08A::getSerialNumber(uint8_t *serialNo, int length)
 {
-	if (length < sizeof(serialNumber))
+	if (length < SERIAL_NUMBER_SIZE || ensureConfigZone() == false)
 		return false;
 	else
 	{
-		memcpy(serialNo, serialNumber, SERIAL_NUMBER_SIZE);
+		memcpy(serialNo, config.serialNumber, SERIAL_NUMBER_SIZE);
 		return true;
 	}
 }
 
 boolean ATECCX08A::getRevisionNumber(uint8_t *revisionNo, int length)
 {
-	if (length < sizeof(revisionNumber))
+	if (length < REVISION_NUMBER_SIZE || ensureConfigZone() == false)
 		return false;
 	else
 	{
-		memcpy(revisionNo, revisionNumber, REVISION_NUMBER_SIZE);
+		memcpy(revisionNo, config.revisionNumber, REVISION_NUMBER_SIZE);
 		return true;
 	}
 }
@@ -1551,19 +3086,54 @@ void ATECCX08A::setStatus(int status)
 
 void ATECCX08A::printHexValue(byte value)
 {
-	if ((value >> 4) == 0) 
-		_debugSerial->print("0"); // print preceeding high nibble if it's zero
-	_debugSerial->print(value, HEX);
+	static const char digits[] = "0123456789ABCDEF";
+	char text[2] = { digits[value >> 4], digits[value & 0x0F] };
+
+	_debugSerial->write((const uint8_t *) text, sizeof(text));
 }
 
 void ATECCX08A::printHexValue(const byte *value, int length, const char *separator)
 {
+	printHex(*_debugSerial, value, length, separator);
+}
+
+/** \brief
+
+	printHex(Print &port, const uint8_t *data, int length, const char *separator)
+
+	Buffered hex formatter of the debug output: data as hex bytes with separator (up to 4 characters)
+	between them, 16 bytes per line. Each line is formatted in RAM and written with one call, instead
+	of two or three print() calls per byte.
+*/
+
+void ATECCX08A::printHex(Print &port, const uint8_t *data, int length, const char *separator)
+{
+	static const char digits[] = "0123456789ABCDEF";
+	char   line[ATECC_DEBUG_LINE_SIZE];
+	size_t used = 0;
+	size_t separatorLength = strlen(separator);
+
+	if (separatorLength > 4)
+		separatorLength = 4;
 	for (int index = 0; index < length; index++)
 	{
-		printHexValue(value[index]);
-	 _debugSerial->print(String(separator));
+		line[used++] = digits[data[index] >> 4];
+		line[used++] = digits[data[index] & 0x0F];
+		if ((index + 1) % 16 != 0 && index + 1 < length)
+		{
+			memcpy(&line[used], separator, separatorLength);
+			used += separatorLength;
+		}
+		else
+		{
+			line[used++] = '\r';
+			line[used++] = '\n';
+			port.write((const uint8_t *) line, used);
+			used = 0;
+		}
 	}
-	_debugSerial->println();
+	if (length <= 0)
+		port.write((const uint8_t *) "\r\n", 2);
 }
 
 
@@ -1627,12 +3197,9 @@ boolean ATECCX08A::containsPrivateKey(int slot)
   int configValue;
 	boolean result;
 	
-	if (isConfigZoneRead() == false)
-	{
-		readConfigZone(false);
-		setConfigZoneRead(true);
-	}
 	configValue = getKeyConfig(slot);
+	if (configValue < 0)
+		return false;
   result = (configValue & 0x001) == 0x001;
   return result;
 }
@@ -1644,5 +3211,5 @@ boolean ATECCX08A::isConfigZoneRead()
 
 void  ATECCX08A::setConfigZoneRead(boolean value)
 {
-  configZoneRead = true;
+  configZoneRead = value;
 }
@@ -31,6 +31,7 @@
 
 
 #include "Wire.h"
+#include "ATECCTransport.h"
 
 #define ATECC508A_ADDRESS_DEFAULT 0x60 //7-bit unshifted default I2C Address
 // 0x60 on a fresh chip. note, this is software definable
@@ -72,6 +73,9 @@
 #define COMMAND_OPCODE_SIGN 	  0x41 // Create an ECC signature with contents of TempKey and designated key slot
 #define COMMAND_OPCODE_VERIFY 	0x45 // takes an ECDSA <R,S> signature and verifies that it is correctly generated from a given message and public key
 #define COMMAND_OPCODE_AES      0x51 // AES encryption/decryption
+#define COMMAND_OPCODE_KDF      0x56 // Key derivation with HKDF, PRF or AES (ATECC608A only)
+#define COMMAND_OPCODE_MAC      0x08 // Computes a SHA-256 digest of a key stored in the device and a challenge
+#define COMMAND_OPCODE_CHECKMAC 0x28 // Verifies a MAC calculated on another device with a key stored in this device
  
 
 
@@ -79,7 +83,23 @@
 #define SHA_START						0b00000000
 #define SHA_UPDATE					0b00000001
 #define SHA_END							0b00000010
+#define SHA_HMAC_START			0b00000100 // param2 = key slot
+#define SHA_HMAC_END				0b00000101 // ATECC508A
+#define SHA_608_HMAC_END		0b00000010 // ATECC608A, combined with the output target
+#define SHA_MODE_TARGET_OUTPUT	0b11000000 // ATECC608A, digest goes to the output buffer only
+#define SHA_READ_CONTEXT		0b00000110 // ATECC608A, read the current SHA context
+#define SHA_WRITE_CONTEXT		0b00000111 // ATECC608A, restore a SHA context, param2 = context length
 #define SHA_BLOCK_SIZE			64
+#define HMAC_SIZE						32
+#define SHA_CONTEXT_MAX_SIZE	99
+
+// MAC and CheckMac parameters
+#define MAC_MODE_CHALLENGE            0x00    // first 32 bytes from the key slot, second 32 bytes from the input challenge
+#define CHECKMAC_MODE_CHALLENGE       0x00    // ClientChal from the input, key from the slot in param2
+#define MAC_CHALLENGE_SIZE            32
+#define MAC_RESPONSE_SIZE             32
+#define CHECKMAC_OTHER_DATA_SIZE      13
+#define CHECKMAC_MISMATCH             0x01    // CheckMac response if the MAC does not match
 
 // AES paramaters
 
@@ -87,6 +107,48 @@
 #define AES_DECRYPT                   0x01
 #define AES_BLOCKSIZE                 16      // size in bytes
 
+// KDF parameters (ATECC608A only)
+// 		? ? ? _  _ _ _ _ 	Bits 7-5 algorithm (PRF, AES, HKDF)
+// 		_ _ _ ?  ? ? _ _ 	Bits 4-2 target of the derived key
+// 		_ _ _ _  _ _ ? ? 	Bits 1-0 source of the input key
+// param2 (KeyID): bits 0-7 source slot, bits 8-15 target slot
+
+#define KDF_MODE_ALG_PRF              0x00
+#define KDF_MODE_ALG_AES              0x20
+#define KDF_MODE_ALG_HKDF             0x40
+#define KDF_MODE_ALG_MASK             0xE0
+
+#define KDF_MODE_TARGET_TEMPKEY       0x00
+#define KDF_MODE_TARGET_TEMPKEY_UP    0x04
+#define KDF_MODE_TARGET_SLOT          0x08
+#define KDF_MODE_TARGET_ALTKEYBUF     0x0C
+#define KDF_MODE_TARGET_OUTPUT        0x10
+#define KDF_MODE_TARGET_OUTPUT_ENC    0x14
+#define KDF_MODE_TARGET_MASK          0x1C
+
+#define KDF_MODE_SOURCE_TEMPKEY       0x00
+#define KDF_MODE_SOURCE_TEMPKEY_UP    0x01
+#define KDF_MODE_SOURCE_SLOT          0x02
+#define KDF_MODE_SOURCE_ALTKEYBUF     0x03
+
+// KDF details (4 bytes, sent in front of the message). Bits 24-31 hold the message length for PRF and HKDF
+#define KDF_DETAILS_PRF_KEY_LEN_16    0x00000000
+#define KDF_DETAILS_PRF_KEY_LEN_32    0x00000001
+#define KDF_DETAILS_PRF_KEY_LEN_48    0x00000002
+#define KDF_DETAILS_PRF_KEY_LEN_64    0x00000003
+#define KDF_DETAILS_PRF_TARGET_LEN_32 0x00000000
+#define KDF_DETAILS_PRF_TARGET_LEN_64 0x00000100
+#define KDF_DETAILS_HKDF_MSG_LOC_SLOT    0x00000000
+#define KDF_DETAILS_HKDF_MSG_LOC_TEMPKEY 0x00000001
+#define KDF_DETAILS_HKDF_MSG_LOC_INPUT   0x00000002
+#define KDF_DETAILS_HKDF_MSG_LOC_IV      0x00000003
+#define KDF_DETAILS_HKDF_ZERO_KEY        0x00000004
+#define KDF_DETAILS_AES_KEY_INDEX_MASK   0x00000003
+#define KDF_DETAILS_SIZE              4
+#define KDF_MESSAGE_MAX_SIZE          128
+#define KDF_OUTPUT_SIZE               32
+#define KDF_NONCE_SIZE                32
+
 
 /* Protocol Sizes */
 #define ATRCC508A_PROTOCOL_FIELD_SIZE_COMMAND 1
@@ -122,23 +184,75 @@
 #define STATUS_MESSAGE_COUNT_ERROR    0x1002
 #define STATUS_MESSAGE_CRC_ERROR      0x1003
 #define STATUS_INPUT_BUFFER_TOO_SMALL 0x1004
+#define STATUS_NOT_SUPPORTED          0x1005 // the command is not available on this device model
+#define STATUS_COMMAND_PENDING        0x1006 // another command was submitted and not finished yet
 
 /* Receive constants */
 #define ATRCC508A_MAX_REQUEST_SIZE 32
 #define ATRCC508A_MAX_RETRIES 20
 
+/* ChipMode (configZone[19]) */
+#define CHIP_MODE_I2C_USER_EXTRA_ADD  0x01
+#define CHIP_MODE_TTL_ENABLE          0x02
+#define CHIP_MODE_WATCHDOG_10S        0x04
+#define CHIP_MODE_CLOCK_DIVIDER_MASK  0xF8  // ATECC608A only, must be 0 on the ATECC508A
+#define CHIP_MODE_CLOCK_DIVIDER_M0    0x00  // full speed (default)
+#define CHIP_MODE_CLOCK_DIVIDER_M1    0x28  // divider 0x05 in bits 7-3
+#define CHIP_MODE_CLOCK_DIVIDER_M2    0x68  // divider 0x0D in bits 7-3, slowest, lowest power
+#define WATCHDOG_TIMEOUT_SHORT        1300  // ms
+#define WATCHDOG_TIMEOUT_LONG        10000  // ms
+#define WAKE_TIME_US                  1560  // wake pulse (60 us) and tWHI (1500 us)
+
+/* device models, see ATECCX08A::getModel() */
+#define ATECC_MODEL_UNKNOWN         0
+#define ATECC_MODEL_508A            1
+#define ATECC_MODEL_608A            2
+#define ATECC_MODEL_608B            3  // ATECC608A with Info revision 0x03 or later
+
+/* features of a device model, see ATECCX08A::hasFeature() */
+#define ATECC_FEATURE_AES           0x01  // AES command
+#define ATECC_FEATURE_KDF           0x02  // KDF command
+#define ATECC_FEATURE_SHA_CONTEXT   0x04  // SHA context save/restore
+#define ATECC_FEATURE_DIGEST_BUFFER 0x08  // 64 byte message digest buffer
+#define ATECC_FEATURE_HMAC_COMMAND  0x10  // HMAC command (removed in the ATECC608A)
+
+/* commands with an entry in the execution time tables, see ATECCX08A::getExecutionTime() */
+#define ATECC_CMD_AES               0
+#define ATECC_CMD_CHECKMAC          1
+#define ATECC_CMD_GENKEY            2
+#define ATECC_CMD_HMAC              3  // HMAC command or SHA HMAC end
+#define ATECC_CMD_INFO              4
+#define ATECC_CMD_KDF               5
+#define ATECC_CMD_LOCK              6
+#define ATECC_CMD_MAC               7
+#define ATECC_CMD_NONCE             8
+#define ATECC_CMD_RANDOM            9
+#define ATECC_CMD_READ              10
+#define ATECC_CMD_SHA               11
+#define ATECC_CMD_SIGN              12
+#define ATECC_CMD_VERIFY            13
+#define ATECC_CMD_WRITE             14
+#define ATECC_CMD_COUNT             15
+
 /* configZone EEPROM mapping */
 #define CONFIG_ZONE_READ_SIZE       32
 #define CONFIG_ZONE_SERIAL_PART0     0
 #define CONFIG_ZONE_SERIAL_PART1     8
 #define CONFIG_ZONE_REVISION_NUMBER  4
 #define CONFIG_ZONE_AES_STATUS      13
+#define CONFIG_ZONE_I2C_ENABLE      14
+#define CONFIG_ZONE_I2C_ADDRESS     16
+#define CONFIG_ZONE_OTP_MODE        18
+#define CONFIG_ZONE_CHIP_MODE       19
 #define CONFIG_ZONE_SLOT_CONFIG     20
+#define CONFIG_ZONE_LAST_KEY_USE    68 // ATECC508A; UseLock, VolatileKeyPermission, SecureBoot, KdfIv on the ATECC608A
 #define CONFIG_ZONE_OTP_LOCK        86
 #define CONFIG_ZONE_LOCK_STATUS     87
 #define CONFIG_ZONE_SLOTS_LOCK0     88
 #define CONFIG_ZONE_SLOTS_LOCK1     89
 #define CONFIG_ZONE_KEY_CONFIG	    96
+#define CONFIG_ZONE_WRITABLE_START  16 // bytes 0-15 (serial number, revision, I2C enable) are read only
+#define CONFIG_ZONE_USER_EXTRA      84 // bytes 84-87 (UserExtra, Selector, lock bytes) can't be written with Write
 
 
 // Lock command PARAM1 zone options (aka Mode). more info at table on datasheet page 75
@@ -147,6 +261,7 @@
 // 		_ _ ? ?  ? ? _ _ 	Bits 5-2 Slot number (in this example, we use slot 0, so "0 0 0 0")
 // 		_ _ _ _  _ _ ? ? 	Bits 1-0 Zone or locktype. 00=Config, 01=Data/OTP, 10=Single Slot in Data, 11=illegal
 
+#define LOCK_MODE_IGNORE_SUMMARY 		0b10000000 // cleared by lock(zone, summaryCrc)
 #define LOCK_MODE_ZONE_CONFIG 			0b10000000
 #define LOCK_MODE_ZONE_DATA_AND_OTP 	0b10000001
 #define LOCK_MODE_SLOT			0b10000010
@@ -185,6 +300,16 @@
 #define ZONE_OTP 0x01
 #define ZONE_DATA 0x02
 
+// data zone slot geometry
+#define SLOT_SIZE_SMALL   36  // slots 0-7
+#define SLOT_SIZE_LARGE  416  // slot 8
+#define SLOT_SIZE_MEDIUM  72  // slots 9-15
+#define ATECC_MAX_TRANSFER_STEPS 16 // enough for any range of any slot (slot 8 has 13 blocks)
+
+// SlotConfig bits
+#define SLOT_CONFIG_IS_SECRET     0x0080
+#define SLOT_CONFIG_ENCRYPT_READ  0x0040
+
 #define ADDRESS_CONFIG_READ_BLOCK_0 0x0000 // 00000000 00000000 // param2 (byte 0), address block bits: _ _ _ 0  0 _ _ _ 
 #define ADDRESS_CONFIG_READ_BLOCK_1 0x0008 // 00000000 00001000 // param2 (byte 0), address block bits: _ _ _ 0  1 _ _ _ 
 #define ADDRESS_CONFIG_READ_BLOCK_2 0x0010 // 00000000 00010000 // param2 (byte 0), address block bits: _ _ _ 1  0 _ _ _ 
@@ -199,20 +324,146 @@
 
 #define BUFFER_SIZE  256
 
+// state of a submitted command, see ATECCX08A::submitCommand()
+#define ATECC_COMMAND_IDLE      0  // no command submitted
+#define ATECC_COMMAND_BUSY      1  // the IC is executing the command
+#define ATECC_COMMAND_DONE      2  // the response was received, see getCommandResult()
+#define ATECC_COMMAND_FAILED    3  // no valid response or an error status, see getStatus()
+
+// responseLength flag of submitCommand(): the length is only known from the count byte, responseLength is the maximum
+#define ATECC_RESPONSE_VARIABLE 0x80
+
+class ATECCX08A;
+class ATECCLog;
+typedef void (*ATECCCallback)(ATECCX08A *atecc, boolean success, void *context);
+
+
+// decoded configuration zone, see ATECCX08A::getConfig()
+typedef struct
+{
+	uint8_t  serialNumber[SERIAL_NUMBER_SIZE];     // configZone[0-3] and configZone[8-12]
+	uint8_t  revisionNumber[REVISION_NUMBER_SIZE]; // configZone[4-7]
+	uint8_t  aesEnable;                            // configZone[13], bit 0 (ATECC608A)
+	uint8_t  i2cEnable;                            // configZone[14], bit 0
+	uint8_t  i2cAddress;                           // configZone[16], 7 bit address in bits 7-1
+	uint8_t  otpMode;                              // configZone[18]
+	uint8_t  chipMode;                             // configZone[19]
+	uint16_t slotConfig[16];                       // configZone[20-51]
+	uint16_t keyConfig[16];                        // configZone[96-127]
+	uint16_t slotsLocked;                          // configZone[88-89] inverted: bit set = slot locked
+	boolean  configLocked;                         // configZone[87] == 0x00
+	boolean  dataOTPLocked;                        // configZone[86] == 0x00
+} ATECCConfig;
+
+// one 32 or 4 byte access of a slot transfer, see ATECCX08A::planSlotTransfer()
+typedef struct
+{
+	uint16_t address;      // data zone address of the block or word
+	uint8_t  size;         // 32 or 4
+	uint8_t  first;        // first byte of the access that belongs to the requested range
+	uint8_t  count;        // number of bytes of the access that belong to the requested range
+	uint16_t bufferOffset; // position of these bytes in the caller's buffer
+} ATECCTransfer;
+
+// one block of the read cache, see ATECCX08A::enableReadCache()
+typedef struct
+{
+	boolean  valid;
+	uint8_t  zone;
+	uint16_t address;      // address of the block (word offset bits cleared)
+	uint32_t lastUse;
+	uint8_t  data[32];
+} ATECCCacheEntry;
+
+// execution times (ms, worst case) and features of a device model
+typedef struct
+{
+	uint8_t     model;
+	uint8_t     clockDivider;  // CHIP_MODE_CLOCK_DIVIDER_*
+	const char *name;
+	uint8_t     features;
+	uint16_t    executionTime[ATECC_CMD_COUNT];
+} ATECCDeviceProfile;
+
+// warm start snapshot, see ATECCX08A::createSnapshot(). Only bytes, so it can be stored as it is.
+#ifndef ATECC_SNAPSHOT_MAX_KEYS
+#define ATECC_SNAPSHOT_MAX_KEYS 2
+#endif
+#define ATECC_SNAPSHOT_VERSION  1
+
+typedef struct
+{
+	uint8_t magic[2];                                         // 'S', 'N'
+	uint8_t version;                                          // ATECC_SNAPSHOT_VERSION
+	uint8_t keyCount;                                         // number of public keys
+	uint8_t configZone[CONFIG_ZONE_SIZE];
+	uint8_t keySlot[ATECC_SNAPSHOT_MAX_KEYS];
+	uint8_t publicKey[ATECC_SNAPSHOT_MAX_KEYS][PUBLIC_KEY_SIZE];
+	uint8_t crc[2];                                           // CRC of all bytes before
+} ATECCSnapshot;
+
+/*
+  debug output, selected at compile time with ATECC_DEBUG_LEVEL (e.g. a build flag):
+  ATECC_DEBUG_NONE    nothing, the debug code is removed by the compiler and the debug arguments have no effect (default)
+  ATECC_DEBUG_ERRORS  failures of commands (response count and CRC errors, Nonce of verifySignature, AES)
+  ATECC_DEBUG_ALL     also the frames, responses and results of the calls with debug = true
+  The output goes to the serial port of begin().
+*/
+#define ATECC_DEBUG_NONE      0
+#define ATECC_DEBUG_ERRORS    1
+#define ATECC_DEBUG_ALL       2
+#ifndef ATECC_DEBUG_LEVEL
+#define ATECC_DEBUG_LEVEL     ATECC_DEBUG_NONE
+#endif
+#define ATECC_DEBUG_ERROR_OUTPUT   (ATECC_DEBUG_LEVEL >= ATECC_DEBUG_ERRORS)
+#define ATECC_DEBUG_OUTPUT(debug)  (ATECC_DEBUG_LEVEL >= ATECC_DEBUG_ALL && (debug))
+#define ATECC_DEBUG_LINE_SIZE      100  // a line of printHex(): 16 bytes with separators and CR LF
+
+// per command latency and error counters, see ATECCX08A::getMetrics(). Compiled only with ATECC_ENABLE_METRICS 1
+#ifndef ATECC_ENABLE_METRICS
+#define ATECC_ENABLE_METRICS 0
+#endif
+
+#if ATECC_ENABLE_METRICS
+typedef struct
+{
+	uint32_t count;            // commands submitted
+	uint32_t failures;         // commands without a successful response (any reason, incl. an error status)
+	uint32_t totalLatency;     // us from submitCommand() until the response was checked, sum of all commands
+	uint32_t maxLatency;       // us, slowest command
+	uint16_t retries;          // I2C reads (incl. the wake response) that returned less than requested
+	uint16_t timeouts;         // no complete response within ATRCC508A_MAX_RETRIES reads
+	uint16_t countErrors;      // the count byte didn't match the response
+	uint16_t crcErrors;        // the CRC of the response was wrong
+	uint16_t watchdogErrors;   // the IC reported STATUS_WATCHDOG_EXPIRATION
+} ATECCCommandMetrics;
+
+typedef struct
+{
+	ATECCCommandMetrics command[ATECC_CMD_COUNT];  // index ATECC_CMD_*
+	uint32_t wakes;            // wake pulses
+	uint32_t wakeFailures;     // wake pulses without a valid wake response
+} ATECCMetrics;
+#endif
+
 
 class ATECCX08A {
   public:
   
     //By default use Wire, standard I2C speed, and the default ADS1015 address
 		boolean begin(uint8_t i2caddr = ATECC508A_ADDRESS_DEFAULT, TwoWire &wirePort = Wire, Stream &serialPort = Serial); 
+		boolean begin(ATECCTransport &transport, uint8_t i2caddr = ATECC508A_ADDRESS_DEFAULT, Stream &serialPort = Serial);
 		
 		boolean receiveResponseData(uint8_t length = 0, boolean debug = false);
+		boolean receiveVariableResponseData(uint8_t maxLength, boolean debug = false);
 		boolean checkCount(boolean debug = false);
 		boolean checkCrc(boolean debug = false);
 		void cleanInputBuffer();
 		
 		boolean wakeUp();
 		void idleMode();
+		boolean beginSession();
+		void endSession();
 		
 		boolean getInfo();
 		
@@ -221,6 +472,15 @@ class ATECCX08A {
 		boolean lockDataAndOTP();
 		boolean lockDataSlot(uint16_t slot);
 		boolean lock(uint8_t zone);
+
+		// locking with a summary CRC, the IC locks only if the zone contents match
+		boolean lockConfiguration(const uint8_t *image);
+		boolean lockDataAndOTP(uint16_t summaryCrc);
+		boolean lockDataSlot(uint16_t slot, uint16_t summaryCrc);
+		boolean lock(uint8_t zone, uint16_t summaryCrc);
+		boolean getConfigZoneCrc(const uint8_t *image, uint16_t &crc);
+		static uint16_t calculateSummaryCrc(const uint8_t *data, int length, uint16_t crc = 0);
+		static void printHex(Print &port, const uint8_t *data, int length, const char *separator);
 		
 		
 		// Random array and fuctions
@@ -233,6 +493,23 @@ class ATECCX08A {
 		
 	// SHA256
 		boolean sha256(const uint8_t *data, size_t len, uint8_t *hash);
+
+	// HMAC-SHA256 with the key stored in a slot
+		boolean beginHMAC(uint16_t slot);
+		boolean updateHMAC(const uint8_t *data, int length);
+		boolean endHMAC(uint8_t *mac, int size);
+		boolean hmac(const uint8_t *data, size_t len, uint16_t slot, uint8_t *mac);
+
+	// single SHA steps, each waits for its response (used to interleave several hash streams)
+		boolean shaStart();
+		boolean shaUpdateBlock(const uint8_t *block);
+		boolean shaEnd(const uint8_t *data, int length, uint8_t *hash, int size);
+		boolean readSHAContext(uint8_t *context, int size, int &contextSize);  // ATECC608A only
+		boolean writeSHAContext(const uint8_t *context, int contextSize);     // ATECC608A only
+
+	// symmetric challenge-response with the key stored in a slot
+		boolean generateMAC(const uint8_t *challenge, uint16_t slot, uint8_t *response, int size, boolean debug = false);
+		boolean checkMAC(const uint8_t *challenge, const uint8_t *response, uint16_t slot, boolean debug = false);
 		
 		void atca_calculate_crc(uint8_t length, const uint8_t *data);	
 		
@@ -252,15 +529,68 @@ class ATECCX08A {
 		boolean write(uint8_t zone, uint16_t address, const uint8_t *data, uint8_t length_of_data, boolean debug = false);
 		boolean writeSlot(const uint8_t *data, int length, int slot, boolean debug = false);
     boolean readSlot(uint8_t *data, int length, int slot, boolean debug = false);
+    boolean readSlotData(int slot, int offset, uint8_t *data, int length, boolean debug = false);
+    boolean writeSlotDifferential(int slot, int offset, const uint8_t *data, int length, boolean debug = false);
+    int     planSlotTransfer(int slot, int offset, int length, ATECCTransfer *plan, int maxSteps);
+    static int getSlotSize(int slot);
+
+		// read cache for the data and OTP zones
+		boolean enableReadCache(size_t ramBudget);
+		void    disableReadCache();
+		void    invalidateReadCache();
+		unsigned long getReadCacheHits();
+		unsigned long getReadCacheMisses();
+		void    resetReadCacheCounters();
+		unsigned long getWritesIssued();
+		unsigned long getWritesSkipped();
+		void    resetWriteCounters();
 		boolean encryptDecryptBlock(const uint8_t *input, int inputSize, uint8_t *output, int outputSize, uint8_t slot, uint8_t keyIndex, uint8_t mode, boolean debug=false);
+
+		// key derivation (ATECC608A only)
+		boolean kdf(uint8_t mode, uint16_t keyId, uint32_t details, const uint8_t *message, int messageLength, uint8_t *output = NULL, int outputSize = 0, boolean debug = false);
+		boolean deriveKeyHKDF(uint8_t source, uint16_t sourceSlot, uint8_t target, uint16_t targetSlot, const uint8_t *info, int infoLength, uint8_t *output = NULL, int outputSize = 0, boolean debug = false);
+		boolean deriveKeyPRF(uint8_t source, uint16_t sourceSlot, uint8_t target, uint16_t targetSlot, const uint8_t *labelSeed, int labelSeedLength, uint8_t *output = NULL, int outputSize = 0, boolean debug = false);
+		boolean deriveKeyAES(uint8_t source, uint16_t sourceSlot, uint8_t keyIndex, uint8_t target, uint16_t targetSlot, const uint8_t *message, int messageLength, uint8_t *output = NULL, int outputSize = 0, boolean debug = false);
     int     addressForSlotOffset(int slot, int offset);
 		int     getKeyConfig(int slot);
+		int     getSlotConfig(int slot);
 
 		boolean containsPrivateKey(int slot);
 
 		
 		boolean readConfigZone(boolean debug = false);
 		byte    *getConfigZone();
+		const ATECCConfig *getConfig();
+		boolean createSnapshot(ATECCSnapshot &snapshot, const uint8_t *keySlots, int keyCount);
+		boolean restoreSnapshot(const ATECCSnapshot &snapshot, const uint8_t *keySlots = NULL, int keyCount = 0);
+		boolean warmStart(ATECCSnapshot &snapshot, const uint8_t *keySlots, int keyCount, boolean &updated);
+		static boolean getSnapshotPublicKey(const ATECCSnapshot &snapshot, int slot, uint8_t *publicKey, int size);
+		boolean isSnapshotKeyCurrent(int slot);
+		uint8_t getModel();
+		const ATECCDeviceProfile *getDeviceProfile();
+		boolean hasFeature(uint8_t feature);
+		uint16_t getExecutionTime(uint8_t command);
+		uint8_t getClockDivider();
+		uint16_t getWatchdogTimeout();
+		boolean setChipMode(uint8_t clockDivider, boolean longWatchdog);
+		static const ATECCDeviceProfile *findDeviceProfile(uint8_t model, uint8_t clockDivider);
+		static uint32_t estimateLatency(uint8_t model, uint8_t clockDivider, const uint8_t *commands, int count, boolean oneSession = false);
+
+		// non-blocking commands
+		boolean submitCommand(uint8_t opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length, uint8_t responseLength, uint8_t command, ATECCCallback callback = NULL, void *context = NULL);
+		uint8_t pollCommand(boolean debug = false);
+		uint8_t getCommandState();
+		int     getCommandResult(uint8_t *response, int size);
+		void    setClock(unsigned long (*clock)());
+		void    setLog(ATECCLog *log);
+		boolean provisionConfigZone(const uint8_t *image, boolean debug = false);
+		static boolean isConfigByteWritable(int offset);
+		uint8_t getI2CAddress();
+		uint8_t getChipMode();
+#if ATECC_ENABLE_METRICS
+		void    getMetrics(ATECCMetrics &metrics, boolean reset = false);
+		void    resetMetrics();
+#endif
 
 		// get lock states	
 		boolean getConfigLockStatus();
@@ -278,7 +608,15 @@ class ATECCX08A {
 	  void setStatus(int status);
 	
   private:
-		TwoWire *_i2cPort;
+		static constexpr uint16_t slotSizes[16] = {
+			SLOT_SIZE_SMALL, SLOT_SIZE_SMALL, SLOT_SIZE_SMALL, SLOT_SIZE_SMALL,
+			SLOT_SIZE_SMALL, SLOT_SIZE_SMALL, SLOT_SIZE_SMALL, SLOT_SIZE_SMALL,
+			SLOT_SIZE_LARGE, SLOT_SIZE_MEDIUM, SLOT_SIZE_MEDIUM, SLOT_SIZE_MEDIUM,
+			SLOT_SIZE_MEDIUM, SLOT_SIZE_MEDIUM, SLOT_SIZE_MEDIUM, SLOT_SIZE_MEDIUM
+		};
+
+		ATECCTransport *transport = NULL;   // see begin()
+		ATECCWireTransport wireTransport;   // transport of begin(i2caddr, wirePort)
 		uint8_t _i2caddr;
 		Stream *_debugSerial; //The generic connection to user's chosen serial hardware
 		boolean configZoneRead = false;
@@ -286,22 +624,70 @@ class ATECCX08A {
 		uint8_t crc[2] = {0, 0};
   	byte configZone[128]; // used to store configuration zone bytes read from device EEPROM
   	byte inputBuffer[BUFFER_SIZE]; // used to store messages received from the IC as they come in
-    byte status;
-  	boolean configLockStatus; // pulled from configZone[87], then set according to status (0x55=UNlocked, 0x00=Locked)
-	  boolean dataOTPLockStatus; // pulled from configZone[86], then set according to status (0x55=UNlocked, 0x00=Locked)
+    int status;
+		ATECCConfig config; // decoded from configZone, valid if configZoneRead is true
+		uint8_t sessionDepth = 0; // > 0 while the IC is kept awake for a sequence of commands
+		boolean sessionAwake = false; // the IC has been woken up within the current session
+		ATECCCacheEntry *readCache = NULL; // see enableReadCache()
+		uint8_t  readCacheSize = 0;
+		uint32_t readCacheTick = 0;
+		unsigned long readCacheHits = 0;
+		unsigned long readCacheMisses = 0;
+		unsigned long writesIssued = 0;  // see writeSlotDifferential()
+		unsigned long writesSkipped = 0; // 4 byte words
+		uint16_t snapshotKeysCurrent = 0; // bit per slot, see isSnapshotKeyCurrent()
 		uint8_t countGlobal = 0; // used to add up all the bytes on a long message. Important to reset before each new receiveMessageData();
-  	uint8_t revisionNumber[REVISION_NUMBER_SIZE]; // used to store the complete revision number, pulled from configZone[4-7]
-	  uint8_t serialNumber[SERIAL_NUMBER_SIZE]; // used to store the complete Serial number, pulled from configZone[0-3] and configZone[8-12]		
 		
+		uint8_t deviceModel = ATECC_MODEL_UNKNOWN; // from the Info response, see getInfo()
+		uint8_t clockDivider = CHIP_MODE_CLOCK_DIVIDER_M0; // ChipMode read by begin(), selects the execution time table
+		uint8_t commandState = ATECC_COMMAND_IDLE; // see submitCommand()
+		uint8_t commandTiming = 0;         // ATECC_CMD_* of the submitted command
+		uint8_t commandResponseLength = 0;
+		unsigned long commandStart = 0;    // commandClock() (or transport->micros()) when the command was sent
+		ATECCCallback commandCallback = NULL;
+		void    *commandContext = NULL;
+		unsigned long (*commandClock)() = NULL; // time base (ms) of pollCommand(), transport->micros() if NULL, see setClock()
+		ATECCLog *log = NULL;              // see setLog()
+		uint8_t  logOpcode = 0;            // the submitted command for the log
+		uint8_t  logParam1 = 0;
+		uint16_t logParam2 = 0;
+		uint32_t logStart = 0;             // transport->micros() when the command was submitted
+#if ATECC_ENABLE_METRICS
+		ATECCMetrics metrics = {};         // see getMetrics()
+		unsigned long metricsStart = 0;    // transport->micros() when the command was submitted
+		uint16_t metricsRetries = 0;       // short reads since the command was submitted
+#endif
+		uint8_t hmacBlock[SHA_BLOCK_SIZE]; // HMAC data not yet sent to the IC (always less than a full block after updateHMAC)
+		int     hmacBlockLength = 0;
+
 		boolean beginSHA256();
     boolean updateSHA256(const uint8_t *plainText, int length);
 		boolean endSHA256(uint8_t *hash, int size);
+		boolean waitSHAResponse();
+		boolean appendResponseData(uint8_t length, byte &requestAttempts);
+		boolean isATECC608A();
+		boolean executeCommand(uint8_t opcode, uint8_t param1, uint16_t param2, const uint8_t *data, size_t length, uint8_t responseLength, uint8_t command, boolean debug = false);
+		boolean waitCommand(boolean debug = false);
+		boolean finishCommand(boolean debug);
+		unsigned long getCommandClock();
+		unsigned long getCommandElapsed();
+		boolean executeLock(uint8_t mode, uint16_t summaryCrc);
+#if ATECC_ENABLE_METRICS
+		void    recordMetrics(boolean success);
+#endif
 
 
 	  void printHexValue(byte value);
 		void printHexValue(const byte *value, int length, const char *separator);
 		boolean isConfigZoneRead();
 		void    setConfigZoneRead(boolean value);
+		boolean ensureConfigZone();
+		void    decodeConfigZone();
+		boolean isCacheable(uint8_t zone, uint16_t address);
+		boolean readFromCache(uint8_t zone, uint16_t address, uint8_t *data, uint8_t length);
+		void    addToCache(uint8_t zone, uint16_t address, const uint8_t *data);
+		void    invalidateCachedBlock(uint8_t zone, uint16_t address);
+		void    invalidateCachedSlot(int slot);
 };
 
 